@@ -0,0 +1,97 @@
+#include "benchmarks.h"
+#include "vi/la.h"
+#include "vi/nn.h"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+namespace {
+
+const size_t network_size = 256U;
+
+vi::nn::network& shared_network() {
+  static vi::nn::network network = [] {
+    vi::la::context& context = *benchmarks::all_contexts()[0];
+    vi::nn::network created;
+    created.add(std::make_shared<vi::nn::layer>(
+        context, std::make_shared<vi::nn::sigmoid_activation>(), network_size, network_size));
+    created.add(std::make_shared<vi::nn::layer>(
+        context, std::make_shared<vi::nn::softmax_activation>(), 10U, network_size));
+    return created;
+  }();
+  return network;
+}
+
+/// One queue per batch size and wait setting, shared by all client threads of a benchmark
+vi::nn::batching_queue& shared_queue(size_t max_batch_size, size_t max_wait_us) {
+  static std::mutex mutex;
+  static std::map<std::pair<size_t, size_t>, std::unique_ptr<vi::nn::batching_queue>> queues;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  std::unique_ptr<vi::nn::batching_queue>& queue =
+      queues[std::make_pair(max_batch_size, max_wait_us)];
+  if (!queue) {
+    queue.reset(new vi::nn::batching_queue(shared_network(), max_batch_size,
+                                           std::chrono::microseconds(max_wait_us)));
+  }
+  return *queue;
+}
+}
+
+/// Every benchmark thread is a client submitting one request at a time, items
+/// processed gives the throughput and the label the request latency percentiles
+static void BM_batching_queue_requests(benchmark::State& state) {
+  size_t max_batch_size = state.range_x();
+  size_t max_wait_us = state.range_y();
+  vi::nn::batching_queue& queue = shared_queue(max_batch_size, max_wait_us);
+
+  std::vector<float> features(network_size, 0.5f);
+  std::vector<double> latencies;
+  while (state.KeepRunning()) {
+    const std::chrono::high_resolution_clock::time_point start =
+        std::chrono::high_resolution_clock::now();
+    std::vector<float> predictions = queue.submit(features).get();
+    const std::chrono::high_resolution_clock::time_point end =
+        std::chrono::high_resolution_clock::now();
+    latencies.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+  }
+  state.SetItemsProcessed(state.iterations());
+
+  if (!latencies.empty()) {
+    std::sort(latencies.begin(), latencies.end());
+    std::ostringstream label;
+    label << "p50=" << latencies[latencies.size() / 2U] << "us p99="
+          << latencies[std::min(latencies.size() - 1U, (latencies.size() * 99U) / 100U)] << "us";
+    state.SetLabel(label.str());
+  }
+}
+
+/// Unbatched baseline, every client runs its own single row forward pass
+static void BM_unbatched_requests(benchmark::State& state) {
+  const vi::nn::network& network = shared_network();
+  vi::la::matrix features(*benchmarks::all_contexts()[0], 1U, network_size, 0.5f);
+  while (state.KeepRunning()) {
+    vi::la::matrix predictions = network.forward(features);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+static void batch_sizes_and_waits(benchmark::internal::Benchmark* benchmark) {
+  for (size_t max_batch_size : {1U, 8U, 32U}) {
+    for (size_t max_wait_us : {50U, 500U, 2000U}) {
+      benchmark->ArgPair(max_batch_size, max_wait_us);
+    }
+  }
+}
+
+BENCHMARK(BM_batching_queue_requests)
+    ->Apply(batch_sizes_and_waits)
+    ->Threads(1)
+    ->Threads(8)
+    ->Threads(32)
+    ->UseRealTime();
+BENCHMARK(BM_unbatched_requests)->Threads(1)->Threads(8)->Threads(32)->UseRealTime();
@@ -1,6 +1,7 @@
 #include "benchmarks.h"
 #include "vi/la.h"
 #include <cmath>
+#include <fstream>
 
 namespace benchmarks {
 
@@ -27,6 +28,22 @@ void all_contexts_16_to_512(benchmark::internal::Benchmark* benchmark) {
     }
   }
 }
+
+size_t resident_kilobytes(const std::string& counter) {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0U, counter.size(), counter) == 0) {
+      return std::stoul(line.substr(counter.size() + 1U));
+    }
+  }
+  return 0U;
+}
+
+void reset_peak_resident_size() {
+  std::ofstream clear_refs("/proc/self/clear_refs");
+  clear_refs << "5";
+}
 }
 
 BENCHMARK_MAIN();
@@ -2,6 +2,11 @@
 #define __vinn__benchmarks__
 
 #include "benchmark/benchmark.h"
+#include "vi/la/profiler.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
 
 namespace vi {
 namespace la {
@@ -12,6 +17,44 @@ class context;
 namespace benchmarks {
 std::vector<vi::la::context*> all_contexts();
 void all_contexts_16_to_512(benchmark::internal::Benchmark* benchmark);
+
+/// Resident set size counter in kB, VmRSS or the VmHWM high water mark
+size_t resident_kilobytes(const std::string& counter);
+/// Reset the VmHWM high water mark to the current resident set size
+void reset_peak_resident_size();
+
+/// Host memory bandwidth of a STREAM triad over arrays larger than the caches
+double host_bytes_per_second();
+/// Host multiply-add throughput of independent chains on every hardware thread
+double host_flops_per_second();
+/// Device bandwidth and throughput measured with the same kernels in OpenCL C
+double device_bytes_per_second(size_t device_index);
+double device_flops_per_second(size_t device_index);
+
+/// Ceilings of all_contexts()[context_index]
+vi::la::profiler::ceilings measure_ceilings(size_t context_index);
+/// Ceilings of all_contexts()[context_index], measured once on first use
+const vi::la::profiler::ceilings& context_ceilings(size_t context_index);
+
+/// Reports the work of a benchmark against the roofline of its context, create it
+/// right before the timed loop and finish it right after. The bandwidth ceiling is
+/// that of memory, working sets that stay in the caches can exceed 100%.
+class roofline_report {
+public:
+  roofline_report(benchmark::State& state, size_t context_index);
+
+  /// Set the bytes processed and label the benchmark with its arithmetic intensity
+  /// and the percentage of the roofline bound it reached
+  /// \param bytes_per_iteration compulsory traffic: operands read once, results written once
+  /// \param label written before the roofline metrics in the benchmark label
+  void finish(double flops_per_iteration, double bytes_per_iteration,
+              const std::string& label = std::string());
+
+private:
+  benchmark::State& _state;
+  const vi::la::profiler::ceilings& _ceilings;
+  std::chrono::steady_clock::time_point _start;
+};
 }
 
 #endif
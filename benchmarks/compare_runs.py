@@ -0,0 +1,64 @@
+#!/usr/bin/env python3
+"""Compare two benchmark runs written with --benchmark_format=json.
+
+    ./benchmarks --benchmark_format=json > baseline.json
+    ./benchmarks --benchmark_format=json > candidate.json
+    python3 compare_runs.py baseline.json candidate.json
+
+Prints the real time and examples (items) per second of the candidate
+relative to the baseline for every benchmark present in both runs.
+"""
+
+import argparse
+import json
+import sys
+
+
+def load_run(path):
+    with open(path) as run:
+        return {benchmark['name']: benchmark for benchmark in json.load(run)['benchmarks']}
+
+
+def ratio(candidate, baseline):
+    if not baseline:
+        return float('nan')
+    return candidate / baseline
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('baseline')
+    parser.add_argument('candidate')
+    parser.add_argument('--filter', default='', help='only names containing this text')
+    arguments = parser.parse_args()
+
+    baseline = load_run(arguments.baseline)
+    candidate = load_run(arguments.candidate)
+    names = [name for name in baseline if name in candidate and arguments.filter in name]
+    if not names:
+        print('no common benchmarks', file=sys.stderr)
+        return 1
+
+    width = max(len(name) for name in names)
+    print('{:<{}} {:>14} {:>14} {:>8} {:>10}'.format('benchmark', width, 'baseline',
+                                                     'candidate', 'time', 'items/s'))
+    for name in names:
+        before = baseline[name]
+        after = candidate[name]
+        unit = before.get('time_unit', 'ns')
+        print('{:<{}} {:>11.0f} {:<2} {:>11.0f} {:<2} {:>7.3f}x {:>9.3f}x'.format(
+            name, width, before['real_time'], unit, after['real_time'],
+            after.get('time_unit', 'ns'), ratio(after['real_time'], before['real_time']),
+            ratio(after.get('items_per_second', 0.0), before.get('items_per_second', 0.0))))
+        if before.get('label') or after.get('label'):
+            print('{:<{}}   {} -> {}'.format('', width, before.get('label', ''),
+                                             after.get('label', '')))
+    for name in sorted(set(baseline) ^ set(candidate)):
+        if arguments.filter not in name:
+            continue
+        print('{} only in {}'.format(name, 'baseline' if name in baseline else 'candidate'))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,69 @@
+#include "benchmarks.h"
+#include "vi/la.h"
+#include "vi/nn.h"
+
+#include <memory>
+
+namespace {
+
+const size_t network_size = 256U;
+
+/// One network per context shared by all benchmark threads
+vi::nn::network& shared_network(size_t context_index) {
+  static std::vector<std::unique_ptr<vi::nn::network>> networks = [] {
+    std::vector<std::unique_ptr<vi::nn::network>> created;
+    for (vi::la::context* context : benchmarks::all_contexts()) {
+      std::unique_ptr<vi::nn::network> network(new vi::nn::network);
+      network->add(std::make_shared<vi::nn::layer>(
+          *context, std::make_shared<vi::nn::sigmoid_activation>(), network_size, network_size));
+      network->add(std::make_shared<vi::nn::layer>(
+          *context, std::make_shared<vi::nn::softmax_activation>(), 10U, network_size));
+      created.push_back(std::move(network));
+    }
+    return created;
+  }();
+  return *networks[context_index];
+}
+
+const vi::nn::inference_plan& shared_plan() {
+  static const vi::nn::inference_plan plan(shared_network(0U));
+  return plan;
+}
+}
+
+static void BM_concurrent_network_forward(benchmark::State& state) {
+  size_t context_index = state.range_x();
+  size_t batch_size = state.range_y();
+  vi::la::context& context = *benchmarks::all_contexts()[context_index];
+  const vi::nn::network& network = shared_network(context_index);
+
+  vi::la::matrix features(context, batch_size, network_size, 0.5f);
+  while (state.KeepRunning()) {
+    vi::la::matrix predictions = network.forward(features);
+  }
+  state.SetItemsProcessed(state.iterations() * batch_size);
+}
+
+static void BM_concurrent_inference_plan_forward(benchmark::State& state) {
+  const vi::nn::inference_plan& plan = shared_plan();
+
+  std::vector<float> features(network_size, 0.5f);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(plan.forward(features.data()));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+static void all_contexts_batches_1_and_32(benchmark::internal::Benchmark* benchmark) {
+  for (size_t context_index = 0U; context_index < benchmarks::all_contexts().size();
+       ++context_index) {
+    benchmark->ArgPair(context_index, 1U);
+    benchmark->ArgPair(context_index, 32U);
+  }
+}
+
+BENCHMARK(BM_concurrent_network_forward)
+    ->Apply(all_contexts_batches_1_and_32)
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+BENCHMARK(BM_concurrent_inference_plan_forward)->ThreadRange(1, 8)->UseRealTime();
@@ -0,0 +1,120 @@
+#include "benchmarks.h"
+#include "vi/io.h"
+#include "vi/la.h"
+
+#include <cstdio>
+#include <random>
+#include <sstream>
+
+namespace {
+
+std::string create_csv(size_t row_count, size_t column_count) {
+  std::mt19937 generator(1U);
+  std::uniform_real_distribution<float> values(-1.0f, 1.0f);
+  std::string csv;
+  char value[32];
+  for (size_t row = 0U; row < row_count; ++row) {
+    for (size_t column = 0U; column < column_count; ++column) {
+      std::snprintf(value, sizeof(value), "%.6g%c", values(generator),
+                    column + 1U < column_count ? ',' : '\n');
+      csv += value;
+    }
+  }
+  return csv;
+}
+
+vi::la::matrix create_matrix(vi::la::context& context, size_t row_count, size_t column_count) {
+  std::mt19937 generator(1U);
+  std::uniform_real_distribution<float> values(-1.0f, 1.0f);
+  vi::la::matrix m(context, row_count, column_count);
+  for (size_t row = 0U; row < row_count; ++row) {
+    for (size_t column = 0U; column < column_count; ++column) {
+      m[row][column] = values(generator);
+    }
+  }
+  return m;
+}
+}
+
+static void BM_csv_file_load(benchmark::State& state) {
+  vi::la::context& context = *benchmarks::all_contexts()[state.range_x()];
+  const size_t row_count = state.range_y();
+  const std::string csv = create_csv(row_count, 100U);
+
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    std::stringstream stream(csv);
+    vi::io::csv_file file(stream);
+    vi::la::matrix loaded(context, 1U, 1U);
+    state.ResumeTiming();
+
+    file.load(loaded);
+  }
+  state.SetBytesProcessed(state.iterations() * csv.size());
+  state.SetItemsProcessed(state.iterations() * row_count);
+}
+
+static void all_contexts_1k_to_100k_rows(benchmark::internal::Benchmark* benchmark) {
+  for (size_t context_index = 0U; context_index < benchmarks::all_contexts().size();
+       ++context_index) {
+    for (size_t row_count : {1000U, 10000U, 100000U}) {
+      benchmark->ArgPair(context_index, row_count);
+    }
+  }
+}
+
+BENCHMARK(BM_csv_file_load)->Apply(all_contexts_1k_to_100k_rows)->UseRealTime();
+
+/// Formatting every value through std::ostream as csv_file::store used to
+static void BM_csv_ostream_store(benchmark::State& state) {
+  vi::la::context& context = *benchmarks::all_contexts()[state.range_x()];
+  const size_t row_count = state.range_y();
+  const vi::la::matrix m = create_matrix(context, row_count, 100U);
+
+  size_t byte_count = 0U;
+  while (state.KeepRunning()) {
+    std::ostringstream stream;
+    stream.precision(17);
+    for (size_t row = 0U; row < m.row_count(); ++row) {
+      for (size_t column = 0U; column < m.column_count(); ++column) {
+        stream << m[row][column];
+        if (column != m.column_count() - 1U) {
+          stream << ',';
+        }
+      }
+      stream << "\n";
+    }
+    byte_count += stream.str().size();
+  }
+  state.SetBytesProcessed(byte_count);
+  state.SetItemsProcessed(state.iterations() * row_count);
+}
+
+static void BM_csv_writer_append(benchmark::State& state, size_t thread_count) {
+  vi::la::context& context = *benchmarks::all_contexts()[state.range_x()];
+  const size_t row_count = state.range_y();
+  const vi::la::matrix m = create_matrix(context, row_count, 100U);
+
+  size_t byte_count = 0U;
+  while (state.KeepRunning()) {
+    std::ostringstream stream;
+    vi::io::csv_writer writer(stream, ',', thread_count);
+    writer.append(m);
+    writer.flush();
+    byte_count += stream.str().size();
+  }
+  state.SetBytesProcessed(byte_count);
+  state.SetItemsProcessed(state.iterations() * row_count);
+}
+
+static void BM_csv_writer_append_single_thread(benchmark::State& state) {
+  BM_csv_writer_append(state, 1U);
+}
+
+static void BM_csv_writer_append_all_threads(benchmark::State& state) {
+  BM_csv_writer_append(state, 0U);
+}
+
+BENCHMARK(BM_csv_ostream_store)->Apply(all_contexts_1k_to_100k_rows)->UseRealTime();
+BENCHMARK(BM_csv_writer_append_single_thread)->Apply(all_contexts_1k_to_100k_rows)->UseRealTime();
+BENCHMARK(BM_csv_writer_append_all_threads)->Apply(all_contexts_1k_to_100k_rows)->UseRealTime();
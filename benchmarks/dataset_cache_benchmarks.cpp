@@ -0,0 +1,93 @@
+#include "benchmarks.h"
+#include "vi/io.h"
+#include "vi/la.h"
+
+#include <boost/filesystem.hpp>
+#include <cstdio>
+#include <random>
+#include <sstream>
+#include <string>
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+const size_t row_count = 100000U;
+const size_t feature_count = 100U;
+
+/// 8-bit pixel like features scaled to [0, 1] and a class label
+std::pair<vi::la::matrix, vi::la::matrix> create_dataset(vi::la::context& context) {
+  std::mt19937 generator(1U);
+  std::uniform_int_distribution<int> pixels(0, 255);
+  std::uniform_int_distribution<int> labels(0, 9);
+  vi::la::matrix features(context, row_count, feature_count);
+  vi::la::matrix targets(context, row_count, 1U);
+  for (size_t row = 0U; row < row_count; ++row) {
+    for (size_t column = 0U; column < feature_count; ++column) {
+      features[row][column] = static_cast<float>(pixels(generator)) / 255.0f;
+    }
+    targets[row][0] = static_cast<float>(labels(generator));
+  }
+  return std::make_pair(features, targets);
+}
+
+std::string cache_path(vi::io::compression compression) {
+  fs::path path(fs::temp_directory_path());
+  path /= "vinn_benchmark_dataset_" + std::to_string(static_cast<int>(compression)) + ".cache";
+  return path.string();
+}
+}
+
+static void BM_dataset_cache_load(benchmark::State& state) {
+  vi::la::context& context = *benchmarks::all_contexts()[0];
+  const vi::io::compression compression = static_cast<vi::io::compression>(state.range_x());
+  if (!vi::io::compression_available(compression)) {
+    state.SetLabel("unavailable");
+    while (state.KeepRunning()) {
+    }
+    return;
+  }
+
+  const std::string path = cache_path(compression);
+  {
+    std::pair<vi::la::matrix, vi::la::matrix> dataset = create_dataset(context);
+    vi::io::dataset_cache_writer writer(path, feature_count, 1U, compression);
+    writer.append(dataset.first, dataset.second);
+  }
+
+  const size_t value_bytes = row_count * (feature_count + 1U) * sizeof(float);
+  std::ostringstream label;
+  label << "compression_ratio=" << static_cast<double>(value_bytes) / fs::file_size(path);
+  state.SetLabel(label.str());
+
+  while (state.KeepRunning()) {
+    vi::io::dataset_cache_reader reader(path);
+    std::pair<vi::la::matrix, vi::la::matrix> loaded = reader.load(context);
+  }
+  state.SetBytesProcessed(state.iterations() * value_bytes);
+  state.SetItemsProcessed(state.iterations() * row_count);
+  fs::remove(path);
+}
+BENCHMARK(BM_dataset_cache_load)->Arg(0)->Arg(1)->Arg(2)->UseRealTime();
+
+/// Parsing the same dataset from CSV for comparison
+static void BM_dataset_csv_load(benchmark::State& state) {
+  vi::la::context& context = *benchmarks::all_contexts()[0];
+  std::pair<vi::la::matrix, vi::la::matrix> dataset = create_dataset(context);
+  std::stringstream csv;
+  vi::io::csv_file(csv).store(dataset.first << dataset.second);
+  const std::string text = csv.str();
+
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    std::stringstream stream(text);
+    vi::io::csv_file file(stream);
+    vi::la::matrix loaded(context, 1U, 1U);
+    state.ResumeTiming();
+
+    file.load(loaded);
+  }
+  state.SetBytesProcessed(state.iterations() * row_count * (feature_count + 1U) * sizeof(float));
+  state.SetItemsProcessed(state.iterations() * row_count);
+}
+BENCHMARK(BM_dataset_csv_load)->UseRealTime();
@@ -0,0 +1,232 @@
+#include "benchmarks.h"
+#include "vi/la.h"
+#include "vi/nn.h"
+
+#include <chrono>
+#include <random>
+#include <sstream>
+
+namespace {
+
+/// Synthetic problem shapes, the wide shape has sparse features
+struct problem_shape {
+  const char* name;
+  size_t feature_count;
+  size_t hidden_count;
+  size_t class_count;
+  /// Stored features per example of the wide shape
+  size_t non_zeros_per_example;
+};
+
+const problem_shape shapes[] = {{"mnist_like", 784U, 128U, 10U, 784U},
+                                {"wide_sparse", 1U << 16U, 64U, 2U, 64U}};
+
+enum shape_index { mnist_like, wide_sparse };
+
+const size_t example_count = 2048U;
+const size_t batch_size = 128U;
+
+vi::nn::network create_network(vi::la::context& context, const problem_shape& shape) {
+  vi::nn::network network;
+  network.add(std::make_shared<vi::nn::layer>(context,
+                                              std::make_shared<vi::nn::sigmoid_activation>(),
+                                              shape.hidden_count, shape.feature_count));
+  network.add(std::make_shared<vi::nn::layer>(context,
+                                              std::make_shared<vi::nn::softmax_activation>(),
+                                              shape.class_count, shape.hidden_count));
+  return network;
+}
+
+vi::la::matrix dense_features(vi::la::context& context, const problem_shape& shape) {
+  std::mt19937 generator(1U);
+  std::uniform_real_distribution<float> values(0.0f, 1.0f);
+  vi::la::matrix features(context, example_count, shape.feature_count);
+  for (size_t row = 0U; row < example_count; ++row) {
+    for (size_t column = 0U; column < shape.feature_count; ++column) {
+      features[row][column] = values(generator);
+    }
+  }
+  return features;
+}
+
+vi::la::sparse_matrix sparse_features(const problem_shape& shape) {
+  std::mt19937 generator(1U);
+  std::uniform_real_distribution<float> values(0.0f, 1.0f);
+  const size_t stride = shape.feature_count / shape.non_zeros_per_example;
+  std::uniform_int_distribution<uint32_t> offsets(0U, stride - 1U);
+  std::vector<size_t> row_offsets(1U, 0U);
+  std::vector<uint32_t> column_indices;
+  std::vector<float> stored_values;
+  for (size_t row = 0U; row < example_count; ++row) {
+    for (size_t i = 0U; i < shape.non_zeros_per_example; ++i) {
+      column_indices.push_back(i * stride + offsets(generator));
+      stored_values.push_back(values(generator));
+    }
+    row_offsets.push_back(column_indices.size());
+  }
+  return vi::la::sparse_matrix(example_count, shape.feature_count, row_offsets, column_indices,
+                               stored_values);
+}
+
+vi::la::matrix one_hot_targets(vi::la::context& context, const problem_shape& shape) {
+  vi::la::matrix targets(context, example_count, shape.class_count, 0.0f);
+  for (size_t row = 0U; row < example_count; ++row) {
+    targets[row][row % shape.class_count] = 1.0f;
+  }
+  return targets;
+}
+
+/// Multiply-adds of a forward pass, the first layer of the wide shape only
+/// multiplies the stored features
+double forward_flops(const problem_shape& shape) {
+  const double first_layer_inputs =
+      static_cast<double>(shape.non_zeros_per_example) + 1.0;
+  return 2.0 * example_count *
+         (first_layer_inputs * shape.hidden_count +
+          (shape.hidden_count + 1.0) * shape.class_count);
+}
+
+/// Examples per second come from the items processed, the rest goes to the label
+void report(benchmark::State& state, double flops_per_iteration, double seconds) {
+  state.SetItemsProcessed(state.iterations() * example_count);
+  const size_t peak = benchmarks::resident_kilobytes("VmHWM");
+  std::ostringstream label;
+  label.precision(3);
+  label << shapes[state.range_y()].name << " GFLOP/s="
+        << (seconds > 0.0 ? flops_per_iteration * state.iterations() / seconds * 1e-9 : 0.0)
+        << " peak_rss=" << peak << "kB";
+  state.SetLabel(label.str());
+}
+
+typedef std::chrono::steady_clock timer;
+
+double seconds_since(timer::time_point start) {
+  return std::chrono::duration<double>(timer::now() - start).count();
+}
+
+/// Every context with every problem shape
+void contexts_and_shapes(benchmark::internal::Benchmark* benchmark) {
+  for (size_t context_index = 0U; context_index < benchmarks::all_contexts().size();
+       ++context_index) {
+    for (int shape : {mnist_like, wide_sparse}) {
+      benchmark->ArgPair(context_index, shape);
+    }
+  }
+}
+
+/// Contexts with the dense shape, the trainers take dense features only
+void contexts_dense(benchmark::internal::Benchmark* benchmark) {
+  for (size_t context_index = 0U; context_index < benchmarks::all_contexts().size();
+       ++context_index) {
+    benchmark->ArgPair(context_index, mnist_like);
+  }
+}
+}
+
+/// Inference over all examples at once
+static void BM_network_forward(benchmark::State& state) {
+  vi::la::context& context = *benchmarks::all_contexts()[state.range_x()];
+  const problem_shape& shape = shapes[state.range_y()];
+  vi::nn::network network = create_network(context, shape);
+  const bool sparse = state.range_y() == wide_sparse;
+  const vi::la::matrix dense = sparse ? vi::la::matrix() : dense_features(context, shape);
+  const vi::la::sparse_matrix stored = sparse ? sparse_features(shape) : vi::la::sparse_matrix();
+
+  benchmarks::reset_peak_resident_size();
+  const timer::time_point start = timer::now();
+  while (state.KeepRunning()) {
+    vi::la::matrix predictions = sparse ? network.forward(stored) : network.forward(dense);
+    benchmark::DoNotOptimize(predictions[0][0]);
+  }
+  report(state, forward_flops(shape), seconds_since(start));
+}
+BENCHMARK(BM_network_forward)->Apply(contexts_and_shapes)->UseRealTime();
+
+/// One full batch gradient descent epoch: forward, backward and update
+static void BM_batch_gradient_descent_epoch(benchmark::State& state) {
+  vi::la::context& context = *benchmarks::all_contexts()[state.range_x()];
+  const problem_shape& shape = shapes[state.range_y()];
+  vi::nn::network network = create_network(context, shape);
+  const vi::la::matrix features = dense_features(context, shape);
+  const vi::la::matrix targets = one_hot_targets(context, shape);
+  vi::nn::cross_entropy_cost cost_function;
+  vi::nn::batch_gradient_descent trainer(1U, 0.1f);
+
+  benchmarks::reset_peak_resident_size();
+  const timer::time_point start = timer::now();
+  while (state.KeepRunning()) {
+    trainer.train(network, features, targets, cost_function);
+  }
+  // the backward pass costs about twice the forward pass
+  report(state, 3.0 * forward_flops(shape), seconds_since(start));
+}
+BENCHMARK(BM_batch_gradient_descent_epoch)->Apply(contexts_dense)->UseRealTime();
+
+/// One minibatch gradient descent epoch including slicing the minibatches
+static void BM_minibatch_gradient_descent_epoch(benchmark::State& state) {
+  vi::la::context& context = *benchmarks::all_contexts()[state.range_x()];
+  const problem_shape& shape = shapes[state.range_y()];
+  vi::nn::network network = create_network(context, shape);
+  const vi::la::matrix features = dense_features(context, shape);
+  const vi::la::matrix targets = one_hot_targets(context, shape);
+  vi::nn::cross_entropy_cost cost_function;
+  vi::nn::minibatch_gradient_descent trainer(1U, 0.1f, batch_size);
+
+  benchmarks::reset_peak_resident_size();
+  const timer::time_point start = timer::now();
+  while (state.KeepRunning()) {
+    trainer.train(network, features, targets, cost_function);
+  }
+  report(state, 3.0 * forward_flops(shape), seconds_since(start));
+}
+BENCHMARK(BM_minibatch_gradient_descent_epoch)->Apply(contexts_dense)->UseRealTime();
+
+/// Minibatch epoch on sparse features, the trainers take dense features so the
+/// gradients are applied the way batch_gradient_descent does
+static void BM_sparse_minibatch_epoch(benchmark::State& state) {
+  vi::la::context& context = *benchmarks::all_contexts()[state.range_x()];
+  const problem_shape& shape = shapes[wide_sparse];
+  vi::nn::network network = create_network(context, shape);
+  const vi::la::sparse_matrix features = sparse_features(shape);
+  const vi::la::matrix targets = one_hot_targets(context, shape);
+  vi::nn::cross_entropy_cost cost_function;
+
+  std::vector<vi::la::sparse_matrix> batch_features;
+  std::vector<vi::la::matrix> batch_targets;
+  for (size_t first = 0U; first < example_count; first += batch_size) {
+    const size_t begin = features.row_offsets()[first];
+    const size_t end = features.row_offsets()[first + batch_size];
+    std::vector<size_t> row_offsets;
+    for (size_t row = first; row <= first + batch_size; ++row) {
+      row_offsets.push_back(features.row_offsets()[row] - begin);
+    }
+    batch_features.emplace_back(
+        batch_size, shape.feature_count, row_offsets,
+        std::vector<uint32_t>(features.column_indices().begin() + begin,
+                              features.column_indices().begin() + end),
+        std::vector<float>(features.values().begin() + begin, features.values().begin() + end));
+    batch_targets.push_back(targets.rows(first, first + batch_size - 1U));
+  }
+
+  benchmarks::reset_peak_resident_size();
+  const timer::time_point start = timer::now();
+  while (state.KeepRunning()) {
+    for (size_t batch = 0U; batch < batch_features.size(); ++batch) {
+      std::vector<vi::la::matrix> gradients =
+          network.backward(batch_features[batch], batch_targets[batch], cost_function).second;
+      size_t layer_index = 0U;
+      for (std::shared_ptr<vi::nn::layer> l : network) {
+        l->weights(l->weights() - gradients[layer_index++] * (0.1f / batch_size));
+      }
+    }
+  }
+  report(state, 3.0 * forward_flops(shape), seconds_since(start));
+}
+BENCHMARK(BM_sparse_minibatch_epoch)
+    ->Apply([](benchmark::internal::Benchmark* benchmark) {
+      for (size_t context_index = 0U; context_index < benchmarks::all_contexts().size();
+           ++context_index) {
+        benchmark->ArgPair(context_index, wide_sparse);
+      }
+    })
+    ->UseRealTime();
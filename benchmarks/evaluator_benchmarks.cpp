@@ -0,0 +1,71 @@
+#include "benchmarks.h"
+#include "vi/la.h"
+#include "vi/nn.h"
+
+#include <random>
+
+namespace {
+
+struct test_set {
+  test_set(vi::la::context& context, size_t row_count, size_t label_count)
+      : map(label_count), features(context, row_count, 100U), labels(context, row_count, 1U) {
+    network.add(std::make_shared<vi::nn::layer>(
+        context, std::make_shared<vi::nn::sigmoid_activation>(), 32U, 100U));
+    network.add(std::make_shared<vi::nn::layer>(
+        context, std::make_shared<vi::nn::softmax_activation>(), label_count, 32U));
+
+    std::mt19937 generator(1U);
+    std::uniform_real_distribution<float> values(-1.0f, 1.0f);
+    std::uniform_int_distribution<int> classes(0, static_cast<int>(label_count) - 1);
+    for (size_t row = 0U; row < row_count; ++row) {
+      for (size_t column = 0U; column < features.column_count(); ++column) {
+        features[row][column] = values(generator);
+      }
+      labels[row][0] = static_cast<float>(classes(generator));
+    }
+  }
+
+  vi::nn::network network;
+  vi::nn::label_map map;
+  vi::la::matrix features;
+  vi::la::matrix labels;
+};
+}
+
+/// Forward the whole test set and count the results one label at a time
+static void BM_forward_and_add_results(benchmark::State& state) {
+  vi::la::context& context = *benchmarks::all_contexts()[state.range_x()];
+  test_set test(context, state.range_y(), 100U);
+
+  while (state.KeepRunning()) {
+    vi::nn::result_measurements measurements(context, test.map.labels());
+    measurements.add_results(test.labels,
+                             test.map.activations_to_labels(test.network.forward(test.features)));
+    benchmark::DoNotOptimize(measurements.accuracy());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range_y());
+}
+
+static void BM_evaluator(benchmark::State& state) {
+  vi::la::context& context = *benchmarks::all_contexts()[state.range_x()];
+  test_set test(context, state.range_y(), 100U);
+  const vi::nn::evaluator evaluator(test.network, test.map);
+
+  while (state.KeepRunning()) {
+    const vi::nn::result_measurements measurements = evaluator.evaluate(test.features, test.labels);
+    benchmark::DoNotOptimize(measurements.accuracy());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range_y());
+}
+
+static void all_contexts_10k_and_100k_rows(benchmark::internal::Benchmark* benchmark) {
+  for (size_t context_index = 0U; context_index < benchmarks::all_contexts().size();
+       ++context_index) {
+    for (size_t row_count : {10000U, 100000U}) {
+      benchmark->ArgPair(context_index, row_count);
+    }
+  }
+}
+
+BENCHMARK(BM_forward_and_add_results)->Apply(all_contexts_10k_and_100k_rows)->UseRealTime();
+BENCHMARK(BM_evaluator)->Apply(all_contexts_10k_and_100k_rows)->UseRealTime();
@@ -0,0 +1,76 @@
+#include "benchmarks.h"
+#include "vi/la.h"
+#include "vi/nn.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <sstream>
+
+namespace {
+
+vi::nn::network create_network(vi::la::context& context, size_t size) {
+  vi::nn::network network;
+  network.add(std::make_shared<vi::nn::layer>(
+      context, std::make_shared<vi::nn::sigmoid_activation>(), size, size));
+  network.add(std::make_shared<vi::nn::layer>(
+      context, std::make_shared<vi::nn::sigmoid_activation>(), size, size));
+  network.add(std::make_shared<vi::nn::layer>(
+      context, std::make_shared<vi::nn::softmax_activation>(), 10U, size));
+  return network;
+}
+
+/// Label a benchmark with latency percentiles of individual forward passes
+void set_latency_label(benchmark::State& state, std::vector<double>& latencies) {
+  if (latencies.empty()) {
+    return;
+  }
+  std::sort(latencies.begin(), latencies.end());
+  const double p50 = latencies[latencies.size() / 2U];
+  const double p99 = latencies[std::min(latencies.size() - 1U, (latencies.size() * 99U) / 100U)];
+
+  std::ostringstream label;
+  label << "p50=" << p50 << "us p99=" << p99 << "us";
+  state.SetLabel(label.str());
+}
+
+template <typename F> void measure_latencies(benchmark::State& state, F forward) {
+  std::vector<double> latencies;
+  while (state.KeepRunning()) {
+    const std::chrono::high_resolution_clock::time_point start =
+        std::chrono::high_resolution_clock::now();
+    forward();
+    const std::chrono::high_resolution_clock::time_point end =
+        std::chrono::high_resolution_clock::now();
+    latencies.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+  }
+  set_latency_label(state, latencies);
+  state.SetItemsProcessed(state.iterations());
+}
+}
+
+static void BM_network_forward_single_row(benchmark::State& state) {
+  size_t context_index = state.range_x();
+  size_t size = state.range_y();
+  vi::la::context& context = *benchmarks::all_contexts()[context_index];
+
+  vi::nn::network network = create_network(context, size);
+  vi::la::matrix features(context, 1U, size, 0.5f);
+  measure_latencies(state, [&]() { vi::la::matrix predictions = network.forward(features); });
+}
+
+static void BM_inference_plan_forward_single_row(benchmark::State& state) {
+  size_t context_index = state.range_x();
+  size_t size = state.range_y();
+  vi::la::context& context = *benchmarks::all_contexts()[context_index];
+
+  vi::nn::network network = create_network(context, size);
+  vi::nn::inference_plan plan(network);
+  std::vector<float> features(size, 0.5f);
+  measure_latencies(state, [&]() { benchmark::DoNotOptimize(plan.forward(features.data())); });
+}
+
+using benchmarks::all_contexts_16_to_512;
+
+BENCHMARK(BM_network_forward_single_row)->Apply(all_contexts_16_to_512);
+BENCHMARK(BM_inference_plan_forward_single_row)->Apply(all_contexts_16_to_512);
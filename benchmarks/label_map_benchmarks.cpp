@@ -0,0 +1,107 @@
+#include "benchmarks.h"
+#include "vi/la.h"
+#include "vi/nn.h"
+
+#include <random>
+
+namespace {
+
+/// Labels far apart so that the map can not rely on them being unit indices
+std::vector<int> sparse_labels(size_t label_count) {
+  std::vector<int> labels;
+  for (size_t i = 0U; i < label_count; ++i) {
+    labels.push_back(static_cast<int>(i * 31U + 7U));
+  }
+  return labels;
+}
+}
+
+static void BM_activations_to_labels(benchmark::State& state) {
+  vi::la::context& context = *benchmarks::all_contexts()[state.range_x()];
+  const size_t label_count = state.range_y();
+  const vi::nn::label_map map(sparse_labels(label_count));
+
+  std::mt19937 generator(1U);
+  std::uniform_real_distribution<float> values(0.0f, 1.0f);
+  vi::la::matrix activations(context, 256U, label_count);
+  for (size_t row = 0U; row < activations.row_count(); ++row) {
+    for (size_t column = 0U; column < label_count; ++column) {
+      activations[row][column] = values(generator);
+    }
+  }
+
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(map.activations_to_labels(activations));
+  }
+  state.SetItemsProcessed(state.iterations() * activations.row_count());
+  state.SetBytesProcessed(state.iterations() * activations.row_count() * label_count *
+                          sizeof(float));
+}
+
+/// Select the labels of the k highest activations of every row
+template <size_t k> static void BM_activations_to_top_labels(benchmark::State& state) {
+  vi::la::context& context = *benchmarks::all_contexts()[state.range_x()];
+  const size_t label_count = state.range_y();
+  const vi::nn::label_map map(sparse_labels(label_count));
+
+  std::mt19937 generator(1U);
+  std::uniform_real_distribution<float> values(0.0f, 1.0f);
+  vi::la::matrix activations(context, 256U, label_count);
+  for (size_t row = 0U; row < activations.row_count(); ++row) {
+    for (size_t column = 0U; column < label_count; ++column) {
+      activations[row][column] = values(generator);
+    }
+  }
+
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(map.activations_to_top_labels(activations, k));
+  }
+  state.SetItemsProcessed(state.iterations() * activations.row_count());
+  state.SetBytesProcessed(state.iterations() * activations.row_count() * label_count *
+                          sizeof(float));
+}
+
+static void BM_labels_to_activations(benchmark::State& state) {
+  vi::la::context& context = *benchmarks::all_contexts()[state.range_x()];
+  const size_t label_count = state.range_y();
+  const std::vector<int> labels = sparse_labels(label_count);
+  const vi::nn::label_map map(labels);
+
+  std::mt19937 generator(1U);
+  std::uniform_int_distribution<size_t> units(0U, label_count - 1U);
+  vi::la::matrix label_matrix(context, 256U, 1U);
+  for (size_t row = 0U; row < label_matrix.row_count(); ++row) {
+    label_matrix[row][0] = static_cast<float>(labels[units(generator)]);
+  }
+  vi::la::matrix activations(context, label_matrix.row_count(), label_count);
+
+  while (state.KeepRunning()) {
+    map.labels_to_activations(label_matrix, activations);
+    benchmark::DoNotOptimize(activations[0]);
+  }
+  state.SetItemsProcessed(state.iterations() * label_matrix.row_count());
+}
+
+static void all_contexts_1k_and_50k_labels(benchmark::internal::Benchmark* benchmark) {
+  for (size_t context_index = 0U; context_index < benchmarks::all_contexts().size();
+       ++context_index) {
+    for (size_t label_count : {1000U, 50000U}) {
+      benchmark->ArgPair(context_index, label_count);
+    }
+  }
+}
+
+static void all_contexts_10k_and_100k_labels(benchmark::internal::Benchmark* benchmark) {
+  for (size_t context_index = 0U; context_index < benchmarks::all_contexts().size();
+       ++context_index) {
+    for (size_t label_count : {10000U, 100000U}) {
+      benchmark->ArgPair(context_index, label_count);
+    }
+  }
+}
+
+BENCHMARK(BM_activations_to_labels)->Apply(all_contexts_1k_and_50k_labels);
+BENCHMARK_TEMPLATE(BM_activations_to_top_labels, 1)->Apply(all_contexts_10k_and_100k_labels);
+BENCHMARK_TEMPLATE(BM_activations_to_top_labels, 5)->Apply(all_contexts_10k_and_100k_labels);
+BENCHMARK_TEMPLATE(BM_activations_to_top_labels, 100)->Apply(all_contexts_10k_and_100k_labels);
+BENCHMARK(BM_labels_to_activations)->Apply(all_contexts_1k_and_50k_labels);
@@ -11,14 +11,17 @@ static void BM_layer_forward(benchmark::State& state) {
   const size_t example_count = 50;
   const size_t input_count = size - 1;
   vi::la::matrix inputs(context, example_count, input_count);
+  benchmarks::roofline_report roofline(state, context_index);
   while (state.KeepRunning()) {
     vi::la::matrix outputs = layer.forward(inputs);
   }
 
-  size_t examples_per_iteration = example_count;
-  size_t bytes_per_iteration = examples_per_iteration * input_count * sizeof(float);
-  state.SetBytesProcessed(state.iterations() * bytes_per_iteration);
-  state.SetItemsProcessed(state.iterations() * examples_per_iteration);
+  // product with the weights and the sigmoid, reading inputs and weights and writing outputs
+  const double flops_per_iteration = 2.0 * example_count * size * size + 3.0 * example_count * size;
+  const double bytes_per_iteration =
+      (example_count * input_count + size * size + example_count * size) * sizeof(float);
+  roofline.finish(flops_per_iteration, bytes_per_iteration);
+  state.SetItemsProcessed(state.iterations() * example_count);
 }
 
 static void BM_layer_backward(benchmark::State& state) {
@@ -34,15 +37,22 @@ static void BM_layer_backward(benchmark::State& state) {
   vi::la::matrix activations(context, example_count, size, 0.8);
   vi::la::matrix delta(context, example_count, size, 0.2);
 
+  benchmarks::roofline_report roofline(state, context_index);
   while (state.KeepRunning()) {
     std::pair<vi::la::matrix, vi::la::matrix> delta_and_gradient =
         layer.backward(inputs, activations, delta);
   }
 
-  size_t examples_per_iteration = example_count;
-  size_t bytes_per_iteration = examples_per_iteration * input_count * sizeof(float);
-  state.SetBytesProcessed(state.iterations() * bytes_per_iteration);
-  state.SetItemsProcessed(state.iterations() * examples_per_iteration);
+  // weight gradient and propagated delta products, the sigmoid gradient and the
+  // elementwise product; reading inputs, activations, delta and weights and writing
+  // the gradient and the propagated delta
+  const double flops_per_iteration =
+      4.0 * example_count * size * size + 6.0 * example_count * size + size * size;
+  const double bytes_per_iteration =
+      (2.0 * example_count * input_count + 2.0 * example_count * size + 2.0 * size * size) *
+      sizeof(float);
+  roofline.finish(flops_per_iteration, bytes_per_iteration);
+  state.SetItemsProcessed(state.iterations() * example_count);
 }
 
 using benchmarks::all_contexts_16_to_512;
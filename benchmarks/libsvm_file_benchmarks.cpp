@@ -0,0 +1,93 @@
+#include "benchmarks.h"
+#include "vi/io.h"
+#include "vi/la.h"
+
+#include <random>
+#include <sstream>
+#include <string>
+
+namespace {
+
+std::string create_libsvm(size_t row_count, size_t feature_count, size_t features_per_row) {
+  std::mt19937 generator(1U);
+  std::uniform_int_distribution<size_t> indices(1U, feature_count);
+  std::uniform_real_distribution<float> values(-1.0f, 1.0f);
+  std::ostringstream libsvm;
+  for (size_t row = 0U; row < row_count; ++row) {
+    libsvm << row % 10U;
+    for (size_t i = 0U; i < features_per_row; ++i) {
+      libsvm << " " << indices(generator) << ":" << values(generator);
+    }
+    libsvm << "\n";
+  }
+  return libsvm.str();
+}
+
+/// Load once before the timed loop, which reuses freed memory, and label the peak memory growth
+template <typename L> void label_peak_memory(benchmark::State& state, const std::string& libsvm,
+                                             L load) {
+  std::stringstream stream(libsvm);
+  vi::io::libsvm_file file(stream);
+  benchmarks::reset_peak_resident_size();
+  const size_t resident_before = benchmarks::resident_kilobytes("VmRSS");
+  load(file);
+  const size_t peak = benchmarks::resident_kilobytes("VmHWM");
+
+  std::ostringstream label;
+  label << "peak_rss_growth=" << (peak > resident_before ? peak - resident_before : 0U) / 1024U
+        << "MB";
+  state.SetLabel(label.str());
+}
+}
+
+static void BM_libsvm_file_load_dense(benchmark::State& state) {
+  vi::la::context& context = *benchmarks::all_contexts()[0];
+  const std::string libsvm = create_libsvm(state.range_x(), state.range_y(), 20U);
+  auto load = [&](vi::io::libsvm_file& file) {
+    std::pair<vi::la::matrix, vi::la::matrix> loaded =
+        file.load_labels_and_features(context, state.range_y());
+  };
+
+  label_peak_memory(state, libsvm, load);
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    std::stringstream stream(libsvm);
+    vi::io::libsvm_file file(stream);
+    state.ResumeTiming();
+
+    load(file);
+  }
+  state.SetBytesProcessed(state.iterations() * libsvm.size());
+}
+
+static void BM_libsvm_file_load_sparse(benchmark::State& state) {
+  vi::la::context& context = *benchmarks::all_contexts()[0];
+  const std::string libsvm = create_libsvm(state.range_x(), state.range_y(), 20U);
+  auto load = [&](vi::io::libsvm_file& file) {
+    std::pair<vi::la::matrix, vi::la::sparse_matrix> loaded =
+        file.load_labels_and_sparse_features(context, state.range_y());
+  };
+
+  label_peak_memory(state, libsvm, load);
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    std::stringstream stream(libsvm);
+    vi::io::libsvm_file file(stream);
+    state.ResumeTiming();
+
+    load(file);
+  }
+  state.SetBytesProcessed(state.iterations() * libsvm.size());
+}
+
+static void rows_and_features(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgPair(10000U, 1000U);
+  benchmark->ArgPair(10000U, 10000U);
+  benchmark->ArgPair(1000U, 100000U);
+}
+
+BENCHMARK(BM_libsvm_file_load_dense)->Apply(rows_and_features)->UseRealTime();
+BENCHMARK(BM_libsvm_file_load_sparse)
+    ->Apply(rows_and_features)
+    ->ArgPair(100000U, 1000000U)
+    ->UseRealTime();
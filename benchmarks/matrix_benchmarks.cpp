@@ -1,5 +1,7 @@
 #include "benchmarks.h"
 #include "vi/la.h"
+#include <cmath>
+#include <sstream>
 
 static void BM_matrix_scalar_multiply(benchmark::State& state) {
   size_t context_index = state.range_x();
@@ -7,13 +9,14 @@ static void BM_matrix_scalar_multiply(benchmark::State& state) {
   vi::la::context& context = *benchmarks::all_contexts()[context_index];
 
   vi::la::matrix m(context, size, size, 2.0);
+  benchmarks::roofline_report roofline(state, context_index);
   while (state.KeepRunning()) {
     vi::la::matrix result = m * 2.0;
   }
 
+  // one multiply per element, the operand is read and the result written
   size_t flops_per_iteration = size * size;
-  size_t bytes_per_iteration = flops_per_iteration * sizeof(float);
-  state.SetBytesProcessed(state.iterations() * bytes_per_iteration);
+  roofline.finish(flops_per_iteration, 2.0 * size * size * sizeof(float));
   state.SetItemsProcessed(state.iterations() * flops_per_iteration);
 }
 
@@ -24,17 +27,57 @@ static void BM_matrix_matrix_multiply(benchmark::State& state) {
 
   vi::la::matrix a(context, size, size, 2.0);
   vi::la::matrix b(context, size, size, 2.0);
+  benchmarks::roofline_report roofline(state, context_index);
   while (state.KeepRunning()) {
     vi::la::matrix result = a * b;
   }
 
-  // x^2 * (x multiplies + x additions)
+  // x^2 * (x multiplies + x additions), two operands read and the product written
   size_t flops_per_iteration = (size + size) * size * size;
-  size_t bytes_per_iteration = flops_per_iteration * sizeof(float);
-  state.SetBytesProcessed(state.iterations() * bytes_per_iteration);
+  roofline.finish(flops_per_iteration, 3.0 * size * size * sizeof(float));
   state.SetItemsProcessed(state.iterations() * flops_per_iteration);
 }
 
+static void BM_matrix_matrix_multiply_reduced_precision(benchmark::State& state) {
+  const vi::la::precision storage_precision = static_cast<vi::la::precision>(state.range_x());
+  size_t size = state.range_y();
+  vi::la::cpu_context context(storage_precision);
+  vi::la::allocation_tracker allocations;
+  const size_t live_bytes = allocations.statistics().live_bytes;
+
+  vi::la::matrix a(context, size, size, 2.0);
+  vi::la::matrix b(context, size, size, 2.0);
+  // the host context runs on the same hardware
+  benchmarks::roofline_report roofline(state, 0U);
+  while (state.KeepRunning()) {
+    vi::la::matrix result = a * b;
+  }
+
+  // b stays packed between products: the operands take the single precision values and
+  // the packed copy, a product reads a in single precision and the packed copy of b
+  const size_t operand_bytes = allocations.statistics().live_bytes - live_bytes;
+  const size_t single_operand_bytes = 2U * size * size * sizeof(float);
+  std::ostringstream label;
+  label << vi::la::precision_name(storage_precision) << " operands=" << operand_bytes / 1024U
+        << "KiB fp32=" << single_operand_bytes / 1024U << "KiB";
+  size_t flops_per_iteration = (size + size) * size * size;
+  roofline.finish(flops_per_iteration,
+                  (2.0 * sizeof(float) + vi::la::bytes_per_element(storage_precision)) * size *
+                      size,
+                  label.str());
+  state.SetItemsProcessed(state.iterations() * flops_per_iteration);
+}
+
+static void all_precisions_16_to_512(benchmark::internal::Benchmark* benchmark) {
+  const vi::la::precision precisions[] = {vi::la::precision::single, vi::la::precision::bfloat16,
+                                          vi::la::precision::half};
+  for (vi::la::precision storage_precision : precisions) {
+    for (size_t exponent = 4; exponent < 10; ++exponent) {
+      benchmark = benchmark->ArgPair(static_cast<int>(storage_precision), std::pow(2, exponent));
+    }
+  }
+}
+
 static void BM_matrix_sub_matrix(benchmark::State& state) {
   size_t context_index = state.range_x();
   size_t size = state.range_y();
@@ -43,14 +86,15 @@ static void BM_matrix_sub_matrix(benchmark::State& state) {
   const size_t MAX_SIZE = 512;
 
   vi::la::matrix m(context, MAX_SIZE, MAX_SIZE, 2.0);
+  benchmarks::roofline_report roofline(state, context_index);
   while (state.KeepRunning()) {
     vi::la::matrix sub_matrix = m.sub_matrix(0, size - 1, 0, size - 1);
   }
 
-  size_t flops_per_iteration = size * size;
-  size_t bytes_per_iteration = flops_per_iteration * sizeof(float);
-  state.SetBytesProcessed(state.iterations() * bytes_per_iteration);
-  state.SetItemsProcessed(state.iterations() * flops_per_iteration);
+  // a copy without arithmetic, elements are read and written once
+  size_t elements_per_iteration = size * size;
+  roofline.finish(0.0, 2.0 * elements_per_iteration * sizeof(float));
+  state.SetItemsProcessed(state.iterations() * elements_per_iteration);
 }
 
 static void BM_matrix_transpose(benchmark::State& state) {
@@ -59,19 +103,20 @@ static void BM_matrix_transpose(benchmark::State& state) {
   vi::la::context& context = *benchmarks::all_contexts()[context_index];
 
   vi::la::matrix m(context, size, size, 2.0);
+  benchmarks::roofline_report roofline(state, context_index);
   while (state.KeepRunning()) {
     vi::la::matrix result = m.transpose();
   }
 
-  size_t flops_per_iteration = size * size;
-  size_t bytes_per_iteration = flops_per_iteration * sizeof(float);
-  state.SetBytesProcessed(state.iterations() * bytes_per_iteration);
-  state.SetItemsProcessed(state.iterations() * flops_per_iteration);
+  size_t elements_per_iteration = size * size;
+  roofline.finish(0.0, 2.0 * elements_per_iteration * sizeof(float));
+  state.SetItemsProcessed(state.iterations() * elements_per_iteration);
 }
 
 using benchmarks::all_contexts_16_to_512;
 
 BENCHMARK(BM_matrix_scalar_multiply)->Apply(all_contexts_16_to_512);
 BENCHMARK(BM_matrix_matrix_multiply)->Apply(all_contexts_16_to_512);
+BENCHMARK(BM_matrix_matrix_multiply_reduced_precision)->Apply(all_precisions_16_to_512);
 BENCHMARK(BM_matrix_sub_matrix)->Apply(all_contexts_16_to_512);
 BENCHMARK(BM_matrix_transpose)->Apply(all_contexts_16_to_512);
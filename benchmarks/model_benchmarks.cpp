@@ -0,0 +1,125 @@
+#include "benchmarks.h"
+#include "vi/io.h"
+#include "vi/la.h"
+#include "vi/nn.h"
+
+#include <algorithm>
+#include <boost/filesystem.hpp>
+#include <fcntl.h>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+/// Values per layer, 2048 x 2049 floats are about 16 MB
+const size_t layer_width = 2048U;
+
+size_t layer_count(size_t megabytes) {
+  const size_t layer_bytes = layer_width * (layer_width + 1U) * sizeof(float);
+  return std::max<size_t>(1U, (megabytes << 20) / layer_bytes);
+}
+
+/// Store a model of roughly the requested size once per size and format
+std::string stored_model(size_t megabytes, vi::io::model::weight_format format) {
+  std::ostringstream name;
+  name << "vinn_benchmark_" << megabytes << "MB"
+       << (format == vi::io::model::weight_format::binary ? "_binary" : "_csv") << ".model";
+  fs::path path(fs::temp_directory_path());
+  path /= name.str();
+
+  if (!fs::exists(path / "model.json")) {
+    vi::la::context& context = *benchmarks::all_contexts()[0];
+    vi::nn::network network;
+    for (size_t i = 0U; i < layer_count(megabytes); ++i) {
+      network.add(std::make_shared<vi::nn::layer>(
+          context, std::make_shared<vi::nn::sigmoid_activation>(), layer_width, layer_width));
+    }
+    vi::io::model(path.string()).store(network, format);
+  }
+  return path.string();
+}
+
+/// Evict the model files from the page cache so that loads read from disk
+void evict_from_page_cache(const std::string& model_path) {
+  for (fs::recursive_directory_iterator it(model_path), end; it != end; ++it) {
+    if (fs::is_regular_file(it->path())) {
+      const int descriptor = ::open(it->path().c_str(), O_RDONLY);
+      if (descriptor >= 0) {
+        ::fdatasync(descriptor);
+        ::posix_fadvise(descriptor, 0, 0, POSIX_FADV_DONTNEED);
+        ::close(descriptor);
+      }
+    }
+  }
+}
+
+/// Binary weights are mapped lazily, verifying their checksums reads every value
+/// so that the bytes processed are the bytes loaded, as they are for CSV
+const vi::io::weight_file::verification read_every_value =
+    vi::io::weight_file::verification::checksum;
+
+void model_load_cold(benchmark::State& state, vi::io::model::weight_format format) {
+  vi::la::context& context = *benchmarks::all_contexts()[0];
+  const std::string path = stored_model(state.range_x(), format);
+
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    evict_from_page_cache(path);
+    state.ResumeTiming();
+
+    vi::nn::network network;
+    vi::io::model(path).load(network, context, read_every_value);
+    benchmark::DoNotOptimize(network.size());
+  }
+  state.SetBytesProcessed(state.iterations() * layer_count(state.range_x()) * layer_width *
+                          (layer_width + 1U) * sizeof(float));
+}
+}
+
+static void BM_model_load_cold_binary(benchmark::State& state) {
+  model_load_cold(state, vi::io::model::weight_format::binary);
+}
+BENCHMARK(BM_model_load_cold_binary)->Arg(100)->Arg(1024)->UseRealTime();
+
+/// CSV export as the baseline, parsing 1 GB of text takes too long to repeat
+static void BM_model_load_cold_csv(benchmark::State& state) {
+  model_load_cold(state, vi::io::model::weight_format::csv);
+}
+BENCHMARK(BM_model_load_cold_csv)->Arg(100)->UseRealTime();
+
+/// Load with the files in the page cache, isolates parsing from disk reads
+static void BM_model_load_warm_binary(benchmark::State& state) {
+  vi::la::context& context = *benchmarks::all_contexts()[0];
+  const std::string path = stored_model(state.range_x(), vi::io::model::weight_format::binary);
+
+  while (state.KeepRunning()) {
+    vi::nn::network network;
+    vi::io::model(path).load(network, context, read_every_value);
+    benchmark::DoNotOptimize(network.size());
+  }
+  state.SetBytesProcessed(state.iterations() * layer_count(state.range_x()) * layer_width *
+                          (layer_width + 1U) * sizeof(float));
+}
+BENCHMARK(BM_model_load_warm_binary)->Arg(100)->UseRealTime();
+
+static void BM_model_store_binary(benchmark::State& state) {
+  vi::la::context& context = *benchmarks::all_contexts()[0];
+  vi::nn::network network;
+  for (size_t i = 0U; i < layer_count(state.range_x()); ++i) {
+    network.add(std::make_shared<vi::nn::layer>(
+        context, std::make_shared<vi::nn::sigmoid_activation>(), layer_width, layer_width));
+  }
+  fs::path path(fs::temp_directory_path());
+  path /= "vinn_benchmark_store.model";
+
+  while (state.KeepRunning()) {
+    vi::io::model(path.string()).store(network, vi::io::model::weight_format::binary);
+  }
+  fs::remove_all(path);
+  state.SetBytesProcessed(state.iterations() * layer_count(state.range_x()) * layer_width *
+                          (layer_width + 1U) * sizeof(float));
+}
+BENCHMARK(BM_model_store_binary)->Arg(100)->UseRealTime();
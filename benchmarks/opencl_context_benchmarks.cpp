@@ -0,0 +1,101 @@
+#include "benchmarks.h"
+#include "vi/la.h"
+
+#include <boost/filesystem.hpp>
+#include <map>
+#include <vector>
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+std::vector<cl_device_id>& supported_devices() {
+  static std::vector<cl_device_id> devices = vi::la::opencl_context::supported_devices();
+  return devices;
+}
+
+void all_devices(benchmark::internal::Benchmark* benchmark) {
+  for (size_t device_index = 0U; device_index < supported_devices().size(); ++device_index) {
+    benchmark->Arg(device_index);
+  }
+}
+
+/// Supported devices of the platform with the most of them, a context can only
+/// hold devices of a single platform
+std::vector<cl_device_id>& platform_devices() {
+  static std::vector<cl_device_id> devices;
+  if (devices.empty()) {
+    std::map<cl_platform_id, std::vector<cl_device_id>> platforms;
+    for (cl_device_id device : supported_devices()) {
+      cl_platform_id platform = nullptr;
+      clGetDeviceInfo(device, CL_DEVICE_PLATFORM, sizeof(platform), &platform, nullptr);
+      platforms[platform].push_back(device);
+    }
+    for (auto& platform : platforms) {
+      if (platform.second.size() > devices.size()) {
+        devices = platform.second;
+      }
+    }
+  }
+  return devices;
+}
+
+void device_counts(benchmark::internal::Benchmark* benchmark) {
+  for (size_t device_count = 1U; device_count <= platform_devices().size(); ++device_count) {
+    benchmark->Arg(device_count);
+  }
+}
+}
+
+static void BM_opencl_supported_devices(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(vi::la::opencl_context::supported_devices());
+  }
+}
+
+/// Construct a context compiling every kernel from source
+static void BM_opencl_context_cold_start(benchmark::State& state) {
+  const cl_device_id device_id = supported_devices()[state.range_x()];
+  while (state.KeepRunning()) {
+    vi::la::opencl_context context({device_id}, vi::la::precision::single, "");
+  }
+}
+
+/// Construct a context loading its kernels from the program cache
+static void BM_opencl_context_warm_start(benchmark::State& state) {
+  const cl_device_id device_id = supported_devices()[state.range_x()];
+  const fs::path cache_directory =
+      fs::temp_directory_path() / fs::unique_path("vinn_program_cache_%%%%%%%%");
+  // the first construction fills the cache
+  {
+    vi::la::opencl_context context({device_id}, vi::la::precision::single,
+                                   cache_directory.string());
+  }
+
+  while (state.KeepRunning()) {
+    vi::la::opencl_context context({device_id}, vi::la::precision::single,
+                                   cache_directory.string());
+  }
+
+  boost::system::error_code error;
+  fs::remove_all(cache_directory, error);
+}
+
+/// Multiply large matrices with their rows split across the devices
+static void BM_opencl_multi_device_multiply(benchmark::State& state) {
+  const std::vector<cl_device_id> devices(platform_devices().begin(),
+                                          platform_devices().begin() + state.range_x());
+  vi::la::opencl_context context(devices);
+  vi::la::matrix operand_1(context, 1024U, 1024U, 1.0f);
+  vi::la::matrix operand_2(context, 1024U, 1024U, 1.0f);
+  vi::la::matrix product(context, 1024U, 1024U, 0.0f);
+  while (state.KeepRunning()) {
+    context.multiply(product, operand_1, operand_2);
+  }
+  state.SetItemsProcessed(state.iterations() * 1024 * 1024 * 1024);
+}
+
+BENCHMARK(BM_opencl_supported_devices)->UseRealTime();
+BENCHMARK(BM_opencl_context_cold_start)->Apply(all_devices)->UseRealTime();
+BENCHMARK(BM_opencl_context_warm_start)->Apply(all_devices)->UseRealTime();
+BENCHMARK(BM_opencl_multi_device_multiply)->Apply(device_counts)->UseRealTime();
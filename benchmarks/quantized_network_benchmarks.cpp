@@ -0,0 +1,170 @@
+#include "benchmarks.h"
+#include "vi/la.h"
+#include "vi/nn.h"
+
+#include <cmath>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+
+namespace {
+
+const size_t example_count = 256U;
+const size_t label_count = 10U;
+/// Only the first features depend on the label, so that every size is about as hard to classify
+const size_t informative_feature_count = 16U;
+/// Standard deviation of the noise added to every feature, large enough that some held-out
+/// examples are misclassified
+const float noise_deviation = 1.0f;
+
+vi::nn::network create_network(vi::la::context& context, size_t size) {
+  vi::nn::network network;
+  network.add(std::make_shared<vi::nn::layer>(
+      context, std::make_shared<vi::nn::sigmoid_activation>(), size, size));
+  network.add(std::make_shared<vi::nn::layer>(
+      context, std::make_shared<vi::nn::sigmoid_activation>(), size, size));
+  network.add(std::make_shared<vi::nn::layer>(
+      context, std::make_shared<vi::nn::softmax_activation>(), label_count, size));
+  return network;
+}
+
+vi::la::matrix create_features(vi::la::context& context, size_t size) {
+  vi::la::matrix features(context, example_count, size);
+  for (size_t m = 0U; m < example_count; ++m) {
+    for (size_t n = 0U; n < size; ++n) {
+      features[m][n] = std::sin(static_cast<float>(m * size + n));
+    }
+  }
+  return features;
+}
+
+/// Network trained on noisy examples around one prototype per label, with
+/// examples that were not trained on to measure accuracy with
+struct classification_task {
+  classification_task(vi::la::context& context, size_t size)
+      : network(create_network(context, size)),
+        training_features(context, example_count, size),
+        training_targets(context, example_count, label_count, 0.0f),
+        test_features(context, example_count, size),
+        test_labels(context, example_count, 1U) {
+    vi::la::matrix test_targets(context, example_count, label_count, 0.0f);
+    create_examples(training_features, training_targets, 0U);
+    create_examples(test_features, test_targets, example_count);
+    for (size_t m = 0U; m < example_count; ++m) {
+      test_labels[m][0] = m % label_count;
+    }
+
+    vi::nn::cross_entropy_cost cost_function;
+    vi::nn::minibatch_gradient_descent trainer(20U, 0.5f, 16U);
+    trainer.train(network, training_features, training_targets, cost_function);
+  }
+
+  /// \param first_example seeds the noise, so that training and test examples differ
+  static void create_examples(vi::la::matrix& features, vi::la::matrix& targets,
+                              size_t first_example) {
+    const size_t size = features.column_count();
+    std::mt19937 generator(static_cast<std::mt19937::result_type>(first_example));
+    std::normal_distribution<float> noise(0.0f, noise_deviation);
+    for (size_t m = 0U; m < features.row_count(); ++m) {
+      const size_t label = m % label_count;
+      for (size_t n = 0U; n < size; ++n) {
+        const float prototype = n < informative_feature_count
+                                    ? std::sin(static_cast<float>((label + 1U) * (n + 1U)))
+                                    : 0.0f;
+        features[m][n] = prototype + noise(generator);
+      }
+      targets[m][label] = 1.0f;
+    }
+  }
+
+  vi::nn::network network;
+  vi::la::matrix training_features;
+  vi::la::matrix training_targets;
+  vi::la::matrix test_features;
+  vi::la::matrix test_labels;
+};
+
+/// Tasks are trained once per size and shared by the instruction sets
+const classification_task& trained_task(size_t size) {
+  static vi::la::cpu_context context;
+  static std::map<size_t, std::unique_ptr<classification_task>> tasks;
+  std::unique_ptr<classification_task>& task = tasks[size];
+  if (!task) {
+    task.reset(new classification_task(context, size));
+  }
+  return *task;
+}
+
+float accuracy(const vi::la::matrix& labels, const vi::la::matrix& predictions) {
+  vi::nn::label_map label_map(label_count);
+  vi::nn::result_measurements measurements(labels.owning_context(), label_map.labels());
+  measurements.add_results(labels, label_map.activations_to_labels(predictions));
+  return measurements.accuracy();
+}
+}
+
+static void BM_network_forward_fp32(benchmark::State& state) {
+  size_t context_index = state.range_x();
+  size_t size = state.range_y();
+  vi::la::context& context = *benchmarks::all_contexts()[context_index];
+
+  vi::nn::network network = create_network(context, size);
+  vi::la::matrix features = create_features(context, size);
+  while (state.KeepRunning()) {
+    vi::la::matrix predictions = network.forward(features);
+  }
+
+  state.SetItemsProcessed(state.iterations() * example_count);
+}
+
+/// Reports the accuracy of fp32 and int8 predictions on held-out examples of a trained network
+static void BM_network_forward_int8(benchmark::State& state) {
+  const vi::la::cpu::int8_instruction_set instruction_set =
+      static_cast<vi::la::cpu::int8_instruction_set>(state.range_x());
+  size_t size = state.range_y();
+
+  const classification_task& task = trained_task(size);
+  vi::nn::quantizer quantizer(task.network);
+  quantizer.calibrate(task.training_features);
+  vi::nn::quantized_network quantized = quantizer.quantize();
+  quantized.instruction_set(instruction_set);
+
+  while (state.KeepRunning()) {
+    vi::la::matrix predictions = quantized.forward(task.test_features);
+  }
+
+  std::ostringstream label;
+  label << vi::la::cpu::int8_instruction_set_name(instruction_set)
+        << " held-out accuracy fp32: "
+        << accuracy(task.test_labels, task.network.forward(task.test_features))
+        << " int8: " << accuracy(task.test_labels, quantized.forward(task.test_features));
+  state.SetLabel(label.str());
+  state.SetItemsProcessed(state.iterations() * example_count);
+}
+
+static void supported_instruction_sets_64_to_1024(benchmark::internal::Benchmark* benchmark) {
+  const vi::la::cpu::int8_instruction_set instruction_sets[] = {
+      vi::la::cpu::int8_instruction_set::scalar, vi::la::cpu::int8_instruction_set::avx2,
+      vi::la::cpu::int8_instruction_set::avx_vnni, vi::la::cpu::int8_instruction_set::avx512_vnni};
+  for (vi::la::cpu::int8_instruction_set instruction_set : instruction_sets) {
+    if (!vi::la::cpu::int8_instruction_set_supported(instruction_set)) {
+      continue;
+    }
+    for (size_t exponent = 6; exponent < 11; ++exponent) {
+      benchmark = benchmark->ArgPair(static_cast<int>(instruction_set), std::pow(2, exponent));
+    }
+  }
+}
+
+static void all_contexts_64_to_1024(benchmark::internal::Benchmark* benchmark) {
+  for (size_t context_index = 0U; context_index < benchmarks::all_contexts().size();
+       ++context_index) {
+    for (size_t exponent = 6; exponent < 11; ++exponent) {
+      benchmark = benchmark->ArgPair(context_index, std::pow(2, exponent));
+    }
+  }
+}
+
+BENCHMARK(BM_network_forward_fp32)->Apply(all_contexts_64_to_1024);
+BENCHMARK(BM_network_forward_int8)->Apply(supported_instruction_sets_64_to_1024);
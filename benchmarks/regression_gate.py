@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+"""Fail when hot paths got slower than the stored baseline.
+
+    python3 regression_gate.py ./benchmarks baseline.json
+    python3 regression_gate.py ./benchmarks baseline.json --update
+
+Runs a fixed subset of the benchmarks several times and compares the median
+real time of every benchmark with the baseline. A benchmark regresses when its
+median is slower than the baseline by more than the relative tolerance and by
+more than the noise of both runs, estimated from the median absolute deviation
+(MAD). A gated benchmark missing from the run or from the baseline fails the
+gate as well, so that renamed or dropped benchmarks are noticed.
+
+Baselines are specific to a machine, record one with --update before gating
+changes on a new machine. The baseline covers the contexts of the machine it
+was recorded on, the committed one has the host context (/0/) only.
+"""
+
+import argparse
+import json
+import math
+import subprocess
+import sys
+
+# Benchmarks of the hot paths on every context, as --benchmark_filter alternatives
+GATED_BENCHMARKS = [
+    'BM_matrix_matrix_multiply/[0-9]+/128$',
+    'BM_matrix_scalar_multiply/[0-9]+/512$',
+    'BM_matrix_transpose/[0-9]+/512$',
+    'BM_sparse_matrix_multiply/[0-9]+/10/',
+    'BM_sparse_matrix_transpose_multiply/[0-9]+/10/',
+    'BM_layer_forward/[0-9]+/128$',
+    'BM_layer_backward/[0-9]+/128$',
+]
+
+NANOSECONDS = {'ns': 1.0, 'us': 1e3, 'ms': 1e6, 's': 1e9}
+AGGREGATE_SUFFIXES = ('_mean', '_median', '_stddev', '_cv')
+# scales the MAD of normally distributed samples to their standard deviation
+MAD_TO_SIGMA = 1.4826
+
+
+def median(values):
+    ordered = sorted(values)
+    middle = len(ordered) // 2
+    if len(ordered) % 2:
+        return ordered[middle]
+    return (ordered[middle - 1] + ordered[middle]) / 2.0
+
+
+def statistics(times):
+    center = median(times)
+    return {'median_ns': round(center, 1),
+            'mad_ns': round(median([abs(time - center) for time in times]), 1),
+            'repetitions': len(times)}
+
+
+def run_benchmarks(binary, repetitions, benchmark_filter):
+    output = subprocess.check_output([binary,
+                                      '--benchmark_filter=' + benchmark_filter,
+                                      '--benchmark_repetitions={}'.format(repetitions),
+                                      '--benchmark_format=json'])
+    return json.loads(output.decode('utf-8'))
+
+
+def summarize(run):
+    """Statistics of the repetitions of every benchmark, skipping the aggregates"""
+    times = {}
+    for benchmark in run['benchmarks']:
+        name = benchmark['name']
+        if benchmark.get('run_type', 'iteration') != 'iteration' or \
+                name.endswith(AGGREGATE_SUFFIXES):
+            continue
+        time = benchmark['real_time'] * NANOSECONDS[benchmark.get('time_unit', 'ns')]
+        times.setdefault(name, []).append(time)
+    return {name: statistics(samples) for name, samples in times.items()}
+
+
+def machine(run):
+    context = run.get('context', {})
+    return {key: context[key] for key in ('num_cpus', 'mhz_per_cpu', 'library_build_type')
+            if key in context}
+
+
+def compare(baseline, candidate, tolerance, noise_sigmas):
+    """Print a line per benchmark and return the names of the regressions and of
+    the benchmarks that are missing from the run or from the baseline"""
+    regressions = []
+    width = max(len(name) for name in set(baseline) | set(candidate))
+    print('{:<{}} {:>14} {:>14} {:>9}  {}'.format('benchmark', width, 'baseline ns',
+                                                 'median ns', 'change', 'verdict'))
+    for name in sorted(set(baseline) | set(candidate)):
+        if name not in candidate:
+            print('{:<{}} {:>14.0f} {:>14} {:>9}  MISSING, not run'.format(
+                name, width, baseline[name]['median_ns'], '-', '-'))
+            regressions.append(name)
+            continue
+        if name not in baseline:
+            print('{:<{}} {:>14} {:>14.0f} {:>9}  MISSING, not in baseline'.format(
+                name, width, '-', candidate[name]['median_ns'], '-'))
+            regressions.append(name)
+            continue
+
+        before = baseline[name]
+        after = candidate[name]
+        difference = after['median_ns'] - before['median_ns']
+        noise = noise_sigmas * MAD_TO_SIGMA * math.hypot(before['mad_ns'], after['mad_ns'])
+        change = difference / before['median_ns']
+        if change > tolerance and difference > noise:
+            verdict = 'REGRESSION (tolerance {:+.0%}, noise {:.0f} ns)'.format(tolerance, noise)
+            regressions.append(name)
+        elif -change > tolerance and -difference > noise:
+            verdict = 'faster, consider --update'
+        else:
+            verdict = 'ok'
+        print('{:<{}} {:>14.0f} {:>14.0f} {:>+8.1%}  {}'.format(
+            name, width, before['median_ns'], after['median_ns'], change, verdict))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('benchmarks', help='benchmarks executable')
+    parser.add_argument('baseline', help='baseline JSON file')
+    parser.add_argument('--repetitions', type=int, default=5)
+    parser.add_argument('--tolerance', type=float, default=0.10,
+                        help='relative slowdown allowed, 0.10 by default')
+    parser.add_argument('--noise-sigmas', type=float, default=3.0,
+                        help='slowdowns within this many standard deviations are noise')
+    parser.add_argument('--update', action='store_true',
+                        help='store the run as the new baseline instead of comparing')
+    arguments = parser.parse_args()
+
+    run = run_benchmarks(arguments.benchmarks, arguments.repetitions,
+                         '|'.join(GATED_BENCHMARKS))
+    candidate = summarize(run)
+    if arguments.update:
+        with open(arguments.baseline, 'w') as baseline_file:
+            json.dump({'machine': machine(run), 'benchmarks': candidate}, baseline_file,
+                      indent=2, sort_keys=True)
+            baseline_file.write('\n')
+        print('stored {} benchmarks in {}'.format(len(candidate), arguments.baseline))
+        return 0
+
+    with open(arguments.baseline) as baseline_file:
+        baseline = json.load(baseline_file)
+    if baseline.get('machine') != machine(run):
+        print('warning: baseline recorded on {}, running on {}'.format(
+            baseline.get('machine'), machine(run)), file=sys.stderr)
+
+    regressions = compare(baseline['benchmarks'], candidate, arguments.tolerance,
+                          arguments.noise_sigmas)
+    if regressions:
+        print('{} benchmarks regressed or are missing: {}'.format(
+            len(regressions), ', '.join(regressions)), file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,245 @@
+#include "benchmarks.h"
+#include "vi/la.h"
+
+#include <CL/cl.hpp>
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <numeric>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+typedef std::chrono::steady_clock timer;
+
+/// Floats per STREAM array, three arrays of 32 MB exceed the last level caches
+const size_t stream_size = 1U << 23;
+/// Independent multiply-add chains per thread, enough to hide the latency of the adds
+const size_t chain_count = 64U;
+const size_t chain_length = 1U << 20;
+const size_t repetitions = 5U;
+
+size_t host_thread_count() { return std::max(1U, std::thread::hardware_concurrency()); }
+
+double seconds_since(timer::time_point start) {
+  return std::chrono::duration<double>(timer::now() - start).count();
+}
+
+/// Run task(thread_index) on every hardware thread and return the seconds it took
+template <typename task_type> double run_on_host_threads(task_type task) {
+  const timer::time_point start = timer::now();
+  std::vector<std::thread> threads;
+  for (size_t thread_index = 1U; thread_index < host_thread_count(); ++thread_index) {
+    threads.emplace_back(task, thread_index);
+  }
+  task(0U);
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  return seconds_since(start);
+}
+
+/// Multiply-add chains on registers, 2 FLOPs per update
+void multiply_add_chains(float multiplier, float addend, float* result) {
+  float chains[chain_count];
+  for (size_t i = 0U; i < chain_count; ++i) {
+    chains[i] = static_cast<float>(i);
+  }
+  for (size_t step = 0U; step < chain_length; ++step) {
+    for (size_t i = 0U; i < chain_count; ++i) {
+      chains[i] = chains[i] * multiplier + addend;
+    }
+  }
+  *result = std::accumulate(chains, chains + chain_count, 0.0f);
+}
+
+const char* device_kernels = R"(
+__kernel void stream_triad(__global float* a, __global const float* b, __global const float* c,
+                           float scalar) {
+  const size_t i = get_global_id(0);
+  a[i] = b[i] + scalar * c[i];
+}
+
+__kernel void multiply_add_chains(__global float* result, float multiplier, float addend) {
+  float4 chains[4];
+  for (int i = 0; i < 4; ++i) {
+    chains[i] = (float4)((float)(get_global_id(0) + i));
+  }
+  for (int step = 0; step < 256; ++step) {
+    for (int i = 0; i < 4; ++i) {
+      chains[i] = chains[i] * multiplier + addend;
+    }
+  }
+  const float4 sum = chains[0] + chains[1] + chains[2] + chains[3];
+  result[get_global_id(0)] = sum.x + sum.y + sum.z + sum.w;
+}
+)";
+
+/// Work items of the device FLOP kernel, 4 x float4 chains of 256 steps each
+const size_t device_work_items = 1U << 18;
+const double device_flops_per_work_item = 2.0 * 16.0 * 256.0;
+
+/// Program with the measurement kernels on a single device
+struct device_program {
+  explicit device_program(size_t device_index)
+      : device(vi::la::opencl_context::supported_devices()[device_index]), context(device),
+        queue(context, device, CL_QUEUE_PROFILING_ENABLE),
+        program(context, cl::Program::Sources(
+                             1U, std::make_pair(device_kernels, std::strlen(device_kernels)))) {
+    program.build({device});
+  }
+
+  /// Kernel seconds measured with a profiling event
+  double seconds(cl::Kernel& kernel, size_t work_items) {
+    cl::Event event;
+    queue.enqueueNDRangeKernel(kernel, cl::NullRange, cl::NDRange(work_items), cl::NullRange,
+                               nullptr, &event);
+    event.wait();
+    return static_cast<double>(event.getProfilingInfo<CL_PROFILING_COMMAND_END>() -
+                               event.getProfilingInfo<CL_PROFILING_COMMAND_START>()) *
+           1e-9;
+  }
+
+  /// Shortest kernel time of the repetitions, after a launch that allocates the buffers
+  double best_seconds(cl::Kernel& kernel, size_t work_items) {
+    seconds(kernel, work_items);
+    double best = seconds(kernel, work_items);
+    for (size_t repetition = 1U; repetition < repetitions; ++repetition) {
+      best = std::min(best, seconds(kernel, work_items));
+    }
+    return best;
+  }
+
+  cl::Device device;
+  cl::Context context;
+  cl::CommandQueue queue;
+  cl::Program program;
+};
+}
+
+namespace benchmarks {
+
+double host_bytes_per_second() {
+  std::vector<float> a(stream_size), b(stream_size, 1.0f), c(stream_size, 2.0f);
+  const size_t slice = stream_size / host_thread_count();
+  const float scalar = 3.0f;
+  double best = 0.0;
+  for (size_t repetition = 0U; repetition < repetitions; ++repetition) {
+    const double seconds = run_on_host_threads([&](size_t thread_index) {
+      const size_t end =
+          thread_index + 1U == host_thread_count() ? stream_size : (thread_index + 1U) * slice;
+      for (size_t i = thread_index * slice; i < end; ++i) {
+        a[i] = b[i] + scalar * c[i];
+      }
+    });
+    benchmark::DoNotOptimize(a[0]);
+    best = std::max(best, 3.0 * stream_size * sizeof(float) / seconds);
+  }
+  return best;
+}
+
+double host_flops_per_second() {
+  std::vector<float> results(host_thread_count());
+  // read through volatiles so that the chains can not be folded at compile time
+  volatile float multiplier = 0.999f;
+  volatile float addend = 0.001f;
+  double best = 0.0;
+  for (size_t repetition = 0U; repetition < repetitions; ++repetition) {
+    const double seconds = run_on_host_threads([&](size_t thread_index) {
+      multiply_add_chains(multiplier, addend, &results[thread_index]);
+    });
+    benchmark::DoNotOptimize(results[0]);
+    best = std::max(best, 2.0 * chain_count * chain_length * host_thread_count() / seconds);
+  }
+  return best;
+}
+
+double device_bytes_per_second(size_t device_index) {
+  device_program measurement(device_index);
+  const size_t bytes = stream_size * sizeof(cl_float);
+  cl::Buffer a(measurement.context, CL_MEM_WRITE_ONLY, bytes);
+  cl::Buffer b(measurement.context, CL_MEM_READ_ONLY, bytes);
+  cl::Buffer c(measurement.context, CL_MEM_READ_ONLY, bytes);
+  cl::Kernel triad(measurement.program, "stream_triad");
+  triad.setArg(0, a);
+  triad.setArg(1, b);
+  triad.setArg(2, c);
+  triad.setArg(3, 3.0f);
+  return 3.0 * bytes / measurement.best_seconds(triad, stream_size);
+}
+
+double device_flops_per_second(size_t device_index) {
+  device_program measurement(device_index);
+  cl::Buffer result(measurement.context, CL_MEM_WRITE_ONLY, device_work_items * sizeof(cl_float));
+  cl::Kernel chains(measurement.program, "multiply_add_chains");
+  chains.setArg(0, result);
+  chains.setArg(1, 0.999f);
+  chains.setArg(2, 0.001f);
+  return device_flops_per_work_item * device_work_items /
+         measurement.best_seconds(chains, device_work_items);
+}
+
+vi::la::profiler::ceilings measure_ceilings(size_t context_index) {
+  // all_contexts() holds the host context followed by one context per device
+  if (context_index == 0U) {
+    return {host_flops_per_second(), host_bytes_per_second()};
+  }
+  return {device_flops_per_second(context_index - 1U),
+          device_bytes_per_second(context_index - 1U)};
+}
+
+const vi::la::profiler::ceilings& context_ceilings(size_t context_index) {
+  static std::map<size_t, vi::la::profiler::ceilings> measured;
+  if (measured.find(context_index) == measured.end()) {
+    measured[context_index] = measure_ceilings(context_index);
+  }
+  return measured[context_index];
+}
+
+roofline_report::roofline_report(benchmark::State& state, size_t context_index)
+    : _state(state), _ceilings(context_ceilings(context_index)), _start(timer::now()) {}
+
+void roofline_report::finish(double flops_per_iteration, double bytes_per_iteration,
+                             const std::string& label_prefix) {
+  const double seconds = seconds_since(_start);
+  const double iterations = static_cast<double>(_state.iterations());
+  _state.SetBytesProcessed(_state.iterations() * static_cast<size_t>(bytes_per_iteration));
+
+  const double bound_seconds = std::max(flops_per_iteration / _ceilings.flops_per_second,
+                                        bytes_per_iteration / _ceilings.bytes_per_second);
+  std::ostringstream label;
+  label.precision(3);
+  if (!label_prefix.empty()) {
+    label << label_prefix << " ";
+  }
+  label << "FLOP/B=" << flops_per_iteration / bytes_per_iteration
+        << " GFLOP/s=" << flops_per_iteration * iterations / seconds * 1e-9
+        << " GB/s=" << bytes_per_iteration * iterations / seconds * 1e-9
+        << " roofline=" << bound_seconds * iterations / seconds * 100.0 << "%";
+  _state.SetLabel(label.str());
+}
+}
+
+/// Ceilings of every context, the denominators of the roofline reports
+static void BM_roofline_ceilings(benchmark::State& state) {
+  const size_t context_index = state.range_x();
+  vi::la::profiler::ceilings measured = {0.0, 0.0};
+  while (state.KeepRunning()) {
+    measured = benchmarks::measure_ceilings(context_index);
+  }
+  std::ostringstream label;
+  label.precision(3);
+  label << "peak GFLOP/s=" << measured.flops_per_second * 1e-9
+        << " GB/s=" << measured.bytes_per_second * 1e-9 << " ridge FLOP/B="
+        << measured.flops_per_second / measured.bytes_per_second;
+  state.SetLabel(label.str());
+}
+BENCHMARK(BM_roofline_ceilings)
+    ->Apply([](benchmark::internal::Benchmark* benchmark) {
+      for (size_t context_index = 0U; context_index < benchmarks::all_contexts().size();
+           ++context_index) {
+        benchmark->Arg(context_index);
+      }
+    })
+    ->UseRealTime();
@@ -0,0 +1,81 @@
+#include "benchmarks.h"
+#include "vi/la.h"
+#include "vi/nn.h"
+
+#include <memory>
+
+namespace {
+
+const size_t example_count = 2048U;
+const size_t feature_count = 512U;
+const size_t hidden_count = 512U;
+const size_t class_count = 10U;
+const size_t batch_size = 256U;
+
+enum mode { host_only, device_only, scheduled };
+
+std::vector<cl_device_id>& supported_devices() {
+  static std::vector<cl_device_id> devices = vi::la::opencl_context::supported_devices();
+  return devices;
+}
+
+/// Every device with every way of running on it
+void devices_and_modes(benchmark::internal::Benchmark* benchmark) {
+  for (size_t device_index = 0U; device_index < supported_devices().size(); ++device_index) {
+    for (int training_mode : {host_only, device_only, scheduled}) {
+      benchmark->ArgPair(device_index, training_mode);
+    }
+  }
+}
+}
+
+/// Train a network on the host, on a device, or scheduled between the two
+static void BM_scheduled_training(benchmark::State& state) {
+  vi::la::cpu_context host;
+  vi::la::opencl_context device({supported_devices()[state.range_x()]});
+  std::unique_ptr<vi::la::scheduling_context> scheduler;
+  vi::la::context* context = &host;
+  if (state.range_y() == device_only) {
+    context = &device;
+  } else if (state.range_y() == scheduled) {
+    scheduler.reset(new vi::la::scheduling_context(host, device));
+    context = scheduler.get();
+  }
+
+  vi::la::matrix features(*context, example_count, feature_count, 0.0f);
+  vi::la::matrix targets(*context, example_count, class_count, 0.0f);
+  for (size_t row = 0U; row < example_count; ++row) {
+    for (size_t column = 0U; column < feature_count; ++column) {
+      features[row][column] = static_cast<float>((row + column) % 13U) / 13.0f;
+    }
+    targets[row][row % class_count] = 1.0f;
+  }
+
+  vi::nn::network network;
+  network.add(std::make_shared<vi::nn::layer>(
+      *context, std::make_shared<vi::nn::sigmoid_activation>(), hidden_count, feature_count));
+  network.add(std::make_shared<vi::nn::layer>(
+      *context, std::make_shared<vi::nn::softmax_activation>(), class_count, hidden_count));
+  vi::nn::cross_entropy_cost cost_function;
+  vi::nn::minibatch_gradient_descent trainer(1U, 0.1f, batch_size);
+
+  const vi::la::transfer_statistics before = device.transfers();
+  while (state.KeepRunning()) {
+    trainer.train(network, features, targets, cost_function);
+  }
+  state.SetItemsProcessed(state.iterations() * example_count);
+  if (state.range_y() == device_only) {
+    const vi::la::transfer_statistics after = device.transfers();
+    const size_t step_count = state.iterations() * (example_count / batch_size);
+    state.SetLabel("bytes/step to_device=" +
+                   std::to_string((after.bytes_to_device - before.bytes_to_device) / step_count) +
+                   " to_host=" +
+                   std::to_string((after.bytes_to_host - before.bytes_to_host) / step_count));
+  } else if (scheduler) {
+    const vi::la::scheduling_context::statistics counters = scheduler->counters();
+    state.SetLabel("host=" + std::to_string(counters.host_operations) + " device=" +
+                   std::to_string(counters.device_operations) + " split=" +
+                   std::to_string(counters.split_operations));
+  }
+}
+BENCHMARK(BM_scheduled_training)->Apply(devices_and_modes)->UseRealTime();
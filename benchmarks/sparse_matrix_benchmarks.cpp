@@ -0,0 +1,98 @@
+#include "benchmarks.h"
+#include "vi/la.h"
+
+#include <random>
+
+namespace {
+
+const size_t row_count = 256U;
+const size_t inner_count = 16384U;
+const size_t column_count = 64U;
+
+/// Random sparse matrix with the given density in parts per thousand
+vi::la::sparse_matrix create_sparse(size_t rows, size_t columns, size_t density_per_mille) {
+  std::mt19937 generator(1U);
+  std::uniform_int_distribution<size_t> per_mille(0U, 999U);
+  std::uniform_real_distribution<float> values(-1.0f, 1.0f);
+
+  std::vector<size_t> offsets(1U, 0U);
+  std::vector<uint32_t> indices;
+  std::vector<float> entries;
+  for (size_t m = 0U; m < rows; ++m) {
+    for (size_t n = 0U; n < columns; ++n) {
+      if (per_mille(generator) < density_per_mille) {
+        indices.push_back(static_cast<uint32_t>(n));
+        entries.push_back(values(generator));
+      }
+    }
+    offsets.push_back(indices.size());
+  }
+  return vi::la::sparse_matrix(rows, columns, offsets, indices, entries);
+}
+}
+
+static void BM_sparse_matrix_multiply(benchmark::State& state) {
+  vi::la::context& context = *benchmarks::all_contexts()[state.range_x()];
+  const vi::la::sparse_matrix sparse = create_sparse(row_count, inner_count, state.range_y());
+  const vi::la::matrix dense(context, inner_count, column_count, 0.5f);
+
+  benchmarks::roofline_report roofline(state, state.range_x());
+  while (state.KeepRunning()) {
+    vi::la::matrix product = sparse * dense;
+  }
+  roofline.finish(2.0 * sparse.non_zero_count() * column_count,
+                  sparse.stored_bytes() + (inner_count + row_count) * column_count * sizeof(float));
+  // multiply-adds
+  state.SetItemsProcessed(state.iterations() * sparse.non_zero_count() * column_count);
+}
+
+static void BM_sparse_matrix_transpose_multiply(benchmark::State& state) {
+  vi::la::context& context = *benchmarks::all_contexts()[state.range_x()];
+  const vi::la::sparse_matrix sparse = create_sparse(row_count, inner_count, state.range_y());
+  const vi::la::matrix dense(context, row_count, column_count, 0.5f);
+
+  benchmarks::roofline_report roofline(state, state.range_x());
+  while (state.KeepRunning()) {
+    vi::la::matrix product = sparse.transpose_multiply(dense);
+  }
+  roofline.finish(2.0 * sparse.non_zero_count() * column_count,
+                  sparse.stored_bytes() + (row_count + inner_count) * column_count * sizeof(float));
+  state.SetItemsProcessed(state.iterations() * sparse.non_zero_count() * column_count);
+}
+
+/// Dense product of the same shape for comparison
+static void BM_dense_matrix_multiply_same_shape(benchmark::State& state) {
+  vi::la::context& context = *benchmarks::all_contexts()[state.range_x()];
+  const vi::la::matrix operand_1 = create_sparse(row_count, inner_count, 10U).to_dense(context);
+  const vi::la::matrix operand_2(context, inner_count, column_count, 0.5f);
+
+  benchmarks::roofline_report roofline(state, state.range_x());
+  while (state.KeepRunning()) {
+    vi::la::matrix product = operand_1 * operand_2;
+  }
+  roofline.finish(2.0 * row_count * inner_count * column_count,
+                  (row_count * inner_count + (inner_count + row_count) * column_count) *
+                      sizeof(float));
+  state.SetItemsProcessed(state.iterations() * row_count * inner_count * column_count);
+}
+
+static void all_contexts_densities(benchmark::internal::Benchmark* benchmark) {
+  for (size_t context_index = 0U; context_index < benchmarks::all_contexts().size();
+       ++context_index) {
+    // 0.1%, 1% and 10% of the values are stored
+    for (size_t density_per_mille : {1U, 10U, 100U}) {
+      benchmark->ArgPair(context_index, density_per_mille);
+    }
+  }
+}
+
+static void all_context_indices(benchmark::internal::Benchmark* benchmark) {
+  for (size_t context_index = 0U; context_index < benchmarks::all_contexts().size();
+       ++context_index) {
+    benchmark->Arg(context_index);
+  }
+}
+
+BENCHMARK(BM_sparse_matrix_multiply)->Apply(all_contexts_densities)->UseRealTime();
+BENCHMARK(BM_sparse_matrix_transpose_multiply)->Apply(all_contexts_densities)->UseRealTime();
+BENCHMARK(BM_dense_matrix_multiply_same_shape)->Apply(all_context_indices)->UseRealTime();
@@ -0,0 +1,75 @@
+#include "benchmarks.h"
+#include "vi/la.h"
+#include "vi/nn.h"
+
+#include <random>
+#include <sstream>
+
+namespace {
+
+const size_t feature_count = 100U;
+const size_t class_count = 10U;
+
+/// Random examples generated as they are read, standing in for a file larger than memory
+class generated_dataset : public vi::nn::dataset {
+public:
+  generated_dataset(size_t row_count) : _row_count(row_count), _next_row(0U) {}
+
+  size_t feature_count() const { return ::feature_count; }
+  size_t target_count() const { return class_count; }
+  void rewind() {
+    _next_row = 0U;
+    _generator.seed(1U);
+  }
+
+  size_t read(float* features, float* targets, size_t max_rows) {
+    std::uniform_real_distribution<float> values(0.0f, 1.0f);
+    std::uniform_int_distribution<size_t> labels(0U, class_count - 1U);
+    size_t row_count = 0U;
+    for (; row_count < max_rows && _next_row < _row_count; ++row_count, ++_next_row) {
+      for (size_t i = 0U; i < ::feature_count; ++i) {
+        features[row_count * ::feature_count + i] = values(_generator);
+      }
+      std::fill(targets + row_count * class_count, targets + (row_count + 1U) * class_count, 0.0f);
+      targets[row_count * class_count + labels(_generator)] = 1.0f;
+    }
+    return row_count;
+  }
+
+private:
+  size_t _row_count;
+  size_t _next_row;
+  std::mt19937 _generator;
+};
+}
+
+/// One epoch over datasets of growing size, peak memory growth should stay constant
+static void BM_streaming_minibatch_training(benchmark::State& state) {
+  vi::la::context& context = *benchmarks::all_contexts()[0];
+  vi::nn::network network;
+  network.add(std::make_shared<vi::nn::layer>(
+      context, std::make_shared<vi::nn::sigmoid_activation>(), 32U, feature_count));
+  network.add(std::make_shared<vi::nn::layer>(
+      context, std::make_shared<vi::nn::softmax_activation>(), class_count, 32U));
+  vi::nn::cross_entropy_cost cost_function;
+  generated_dataset dataset(state.range_x());
+  vi::nn::minibatch_gradient_descent trainer(1U, 0.1f, 128U);
+
+  benchmarks::reset_peak_resident_size();
+  const size_t resident_before = benchmarks::resident_kilobytes("VmRSS");
+  while (state.KeepRunning()) {
+    trainer.train(network, dataset, cost_function, state.range_y());
+  }
+  const size_t peak = benchmarks::resident_kilobytes("VmHWM");
+
+  std::ostringstream label;
+  label << "peak_rss_growth=" << (peak > resident_before ? peak - resident_before : 0U) << "kB";
+  state.SetLabel(label.str());
+  state.SetItemsProcessed(state.iterations() * state.range_x());
+}
+BENCHMARK(BM_streaming_minibatch_training)
+    ->ArgPair(10000, 0)
+    ->ArgPair(100000, 0)
+    ->ArgPair(1000000, 0)
+    ->ArgPair(1000000, 10000)
+    ->UseRealTime();
@@ -37,3 +37,30 @@ class test_trainers(unittest.TestCase):
         trainer.set_stop_early_callback(cb)
         final_cost = trainer.train(net, features, targets, cost_function)
         self.assertEqual(5, cb.call_count)
+
+    @parameterized.expand(contexts().enumerate, contexts().name)
+    def test_minibatch_telemetry(self, context):
+        net = self.build_network(context)
+
+        cost_function = vinnpy.squared_error_cost()
+        example_count = 10
+        features = vinnpy.matrix(context, example_count, 4, 2.0)
+        targets = vinnpy.matrix(context, example_count, 4, 1.0)
+
+        trainer = vinnpy.minibatch_gradient_descent(3, 0.01, 2, 5)
+
+        class epoch_telemetry(vinnpy.training_telemetry):
+            def __init__(self):
+                self.epochs = []
+                super(epoch_telemetry, self).__init__()
+
+            def __call__(self, statistics):
+                self.epochs.append((statistics.epoch, statistics.example_count,
+                                    statistics.examples_per_second))
+
+        telemetry = epoch_telemetry()
+        trainer.set_telemetry(telemetry)
+        trainer.train(net, features, targets, cost_function)
+        self.assertEqual([1, 2, 3], [epoch[0] for epoch in telemetry.epochs])
+        self.assertEqual([example_count] * 3, [epoch[1] for epoch in telemetry.epochs])
+        self.assertTrue(all(epoch[2] > 0.0 for epoch in telemetry.epochs))
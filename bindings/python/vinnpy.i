@@ -21,8 +21,9 @@
 
 // include type information in doc strings
 %feature("autodoc", "3");
-// allow python subclasses of training_callback
+// allow python subclasses of training_callback and training_telemetry
 %feature("director") vi::nn::training_callback;
+%feature("director") vi::nn::training_telemetry;
 
 %shared_ptr(vi::nn::activation_function);
 %shared_ptr(vi::nn::sigmoid_activation);
@@ -32,12 +33,25 @@
 
 %shared_ptr(vi::nn::layer);
 
+%shared_ptr(vi::la::profiler);
+%shared_ptr(vi::nn::training_telemetry);
+
 %template(matrix_vector) std::vector<vi::la::matrix>;
 %template(matrix_matrix_pair) std::pair<vi::la::matrix, vi::la::matrix>;
 %template(float_matrix_vector_pair) std::pair<float, std::vector<vi::la::matrix> >;
 %template(size_t_pair) std::pair<size_t, size_t>;
+%template(profiler_event_vector) std::vector<vi::la::profiler::event>;
+%template(profiler_summary_vector) std::vector<vi::la::profiler::summary>;
+%template(string_vector) std::vector<std::string>;
 
 %ignore vi::la::matrix::operator[];
+%ignore vi::la::profiler::scope;
+%ignore vi::la::profiler::write_trace;
+%ignore vi::la::profiler::write_report;
+// contexts load the tuning profile written by vinn_autotune themselves
+%ignore vi::la::context::set_tuning_profile;
+%ignore vi::la::context::attached_tuning_profile;
+%ignore vi::la::scheduling_context::set_tuning_profile;
 %ignore vi::la::operator<<;
 %ignore vi::nn::operator<<;
 
@@ -68,6 +82,21 @@
   }
 }
 
+// return the trace and the report as strings instead of writing to streams
+%extend vi::la::profiler {
+  std::string trace() const {
+    std::ostringstream trace;
+    self->write_trace(trace);
+    return trace.str();
+  }
+
+  std::string report() const {
+    std::ostringstream report;
+    self->write_report(report);
+    return report.str();
+  }
+}
+
 // map rows returned from matrix::__getitem__ as numpy array views
 %apply (float** ARGOUTVIEW_ARRAY1, int* DIM1) { (float**data, int* length) }
 
@@ -76,10 +105,13 @@
 
 
 // Linear Algebra
+%include <vi/la/profiler.h>
 %include <vi/la/context.h>
 %include <vi/la/matrix.h>
 %include <vi/la/opencl/opencl_context.h>
 %include <vi/la/cpu/cpu_context.h>
+%include <vi/la/scheduling/cost_model.h>
+%include <vi/la/scheduling/scheduling_context.h>
 
 // Neural Networks
 %include <vi/nn/running_average.h>
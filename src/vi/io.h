@@ -1,8 +1,15 @@
 #ifndef __vinn__io__
 #define __vinn__io__
 
+#include <vi/io/cache_dataset.h>
+#include <vi/io/csv_dataset.h>
 #include <vi/io/csv_file.h>
+#include <vi/io/csv_writer.h>
+#include <vi/io/dataset_cache.h>
+#include <vi/io/libsvm_dataset.h>
 #include <vi/io/libsvm_file.h>
 #include <vi/io/model.h>
+#include <vi/io/quantized_model_file.h>
+#include <vi/io/weight_file.h>
 
 #endif
@@ -0,0 +1,35 @@
+#include "vi/io/activation_name.h"
+
+#include <typeinfo>
+
+namespace vi {
+namespace io {
+
+std::string activation_name(const vi::nn::activation_function& activation) {
+  if (typeid(activation) == typeid(vi::nn::sigmoid_activation)) {
+    return "sigmoid";
+  } else if (typeid(activation) == typeid(vi::nn::softmax_activation)) {
+    return "softmax";
+  } else if (typeid(activation) == typeid(vi::nn::hyperbolic_tangent)) {
+    return "tanh";
+  } else if (typeid(activation) == typeid(vi::nn::linear_activation)) {
+    return "linear";
+  }
+  return std::string();
+}
+
+std::shared_ptr<vi::nn::activation_function> activation_for_name(const std::string& name) {
+  std::shared_ptr<vi::nn::activation_function> activation;
+  if (name == "sigmoid") {
+    activation.reset(new vi::nn::sigmoid_activation);
+  } else if (name == "softmax") {
+    activation.reset(new vi::nn::softmax_activation);
+  } else if (name == "tanh") {
+    activation.reset(new vi::nn::hyperbolic_tangent);
+  } else if (name == "linear") {
+    activation.reset(new vi::nn::linear_activation);
+  }
+  return activation;
+}
+}
+}
@@ -0,0 +1,21 @@
+#ifndef __vinn__activation_name__
+#define __vinn__activation_name__
+
+#include <vi/nn/activation_function.h>
+
+#include <memory>
+#include <string>
+
+namespace vi {
+namespace io {
+
+/// \return name stored models use for the activation, empty for activations
+///         that can not be stored
+std::string activation_name(const vi::nn::activation_function& activation);
+
+/// \return activation stored under the name, nullptr for unknown names
+std::shared_ptr<vi::nn::activation_function> activation_for_name(const std::string& name);
+}
+}
+
+#endif
@@ -0,0 +1,53 @@
+#include "vi/io/cache_dataset.h"
+
+#include <algorithm>
+
+namespace vi {
+namespace io {
+
+cache_dataset::cache_dataset(const std::string& path)
+    : _reader(path), _chunk_index(0U), _chunk_row(0U), _chunk_row_count(0U) {
+  _features.resize(_reader.chunk_row_count(0U) * _reader.feature_count());
+  _targets.resize(_reader.chunk_row_count(0U) * _reader.target_count());
+}
+
+size_t cache_dataset::feature_count() const { return _reader.feature_count(); }
+
+size_t cache_dataset::target_count() const { return _reader.target_count(); }
+
+void cache_dataset::rewind() {
+  _chunk_index = 0U;
+  _chunk_row = 0U;
+  _chunk_row_count = 0U;
+}
+
+size_t cache_dataset::read(float* features, float* targets, size_t max_rows) {
+  const size_t feature_count = _reader.feature_count();
+  const size_t target_count = _reader.target_count();
+  size_t row_count = 0U;
+  while (row_count < max_rows) {
+    if (_chunk_row == _chunk_row_count) {
+      if (_chunk_index == _reader.chunk_count()) {
+        break;
+      }
+      _reader.read_chunk(_chunk_index, _features.data(), _targets.data());
+      _reader.release_chunk(_chunk_index);
+      _chunk_row_count = _reader.chunk_row_count(_chunk_index);
+      _chunk_row = 0U;
+      ++_chunk_index;
+    }
+
+    const size_t copy_count = std::min(max_rows - row_count, _chunk_row_count - _chunk_row);
+    std::copy(_features.begin() + _chunk_row * feature_count,
+              _features.begin() + (_chunk_row + copy_count) * feature_count,
+              features + row_count * feature_count);
+    std::copy(_targets.begin() + _chunk_row * target_count,
+              _targets.begin() + (_chunk_row + copy_count) * target_count,
+              targets + row_count * target_count);
+    _chunk_row += copy_count;
+    row_count += copy_count;
+  }
+  return row_count;
+}
+}
+}
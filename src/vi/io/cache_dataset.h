@@ -0,0 +1,39 @@
+#ifndef __vinn__cache_dataset__
+#define __vinn__cache_dataset__
+
+#include <vi/io/dataset_cache.h>
+#include <vi/nn/dataset.h>
+
+#include <string>
+#include <vector>
+
+namespace vi {
+namespace io {
+
+/// Stream examples from a dataset cache one chunk at a time. Chunks are
+/// released from memory once read, so only the current chunk stays resident.
+class cache_dataset : public vi::nn::dataset {
+public:
+  /// \throw dataset_cache_reader::exception if the file is not a valid cache
+  cache_dataset(const std::string& path);
+
+  size_t feature_count() const;
+  size_t target_count() const;
+
+  void rewind();
+
+  /// \throw dataset_cache_reader::exception if a chunk is corrupted
+  size_t read(float* features, float* targets, size_t max_rows);
+
+private:
+  dataset_cache_reader _reader;
+  size_t _chunk_index;
+  size_t _chunk_row;
+  size_t _chunk_row_count;
+  std::vector<float> _features;
+  std::vector<float> _targets;
+};
+}
+}
+
+#endif
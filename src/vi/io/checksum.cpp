@@ -0,0 +1,95 @@
+#include "vi/io/checksum.h"
+
+#include <cstring>
+
+namespace {
+
+const uint64_t prime_1 = 11400714785074694791ULL;
+const uint64_t prime_2 = 14029467366897019727ULL;
+const uint64_t prime_3 = 1609587929392839161ULL;
+const uint64_t prime_4 = 9650029242287828579ULL;
+const uint64_t prime_5 = 2870177450012600261ULL;
+
+uint64_t rotate_left(uint64_t value, int bits) { return (value << bits) | (value >> (64 - bits)); }
+
+uint64_t read_64(const unsigned char* p) {
+  uint64_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+uint32_t read_32(const unsigned char* p) {
+  uint32_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+uint64_t round(uint64_t accumulator, uint64_t input) {
+  accumulator += input * prime_2;
+  accumulator = rotate_left(accumulator, 31);
+  return accumulator * prime_1;
+}
+
+uint64_t merge_round(uint64_t accumulator, uint64_t value) {
+  accumulator ^= round(0U, value);
+  return accumulator * prime_1 + prime_4;
+}
+}
+
+namespace vi {
+namespace io {
+
+uint64_t checksum(const void* data, size_t size, uint64_t seed) {
+  const unsigned char* p = static_cast<const unsigned char*>(data);
+  const unsigned char* const end = p + size;
+  uint64_t hash;
+
+  if (size >= 32U) {
+    // four independent lanes keep the multipliers busy
+    uint64_t lane_1 = seed + prime_1 + prime_2;
+    uint64_t lane_2 = seed + prime_2;
+    uint64_t lane_3 = seed;
+    uint64_t lane_4 = seed - prime_1;
+    const unsigned char* const last_stripe = end - 32;
+    do {
+      lane_1 = round(lane_1, read_64(p));
+      lane_2 = round(lane_2, read_64(p + 8));
+      lane_3 = round(lane_3, read_64(p + 16));
+      lane_4 = round(lane_4, read_64(p + 24));
+      p += 32;
+    } while (p <= last_stripe);
+
+    hash = rotate_left(lane_1, 1) + rotate_left(lane_2, 7) + rotate_left(lane_3, 12) +
+           rotate_left(lane_4, 18);
+    hash = merge_round(hash, lane_1);
+    hash = merge_round(hash, lane_2);
+    hash = merge_round(hash, lane_3);
+    hash = merge_round(hash, lane_4);
+  } else {
+    hash = seed + prime_5;
+  }
+  hash += static_cast<uint64_t>(size);
+
+  for (; p + 8 <= end; p += 8) {
+    hash ^= round(0U, read_64(p));
+    hash = rotate_left(hash, 27) * prime_1 + prime_4;
+  }
+  if (p + 4 <= end) {
+    hash ^= static_cast<uint64_t>(read_32(p)) * prime_1;
+    hash = rotate_left(hash, 23) * prime_2 + prime_3;
+    p += 4;
+  }
+  for (; p < end; ++p) {
+    hash ^= static_cast<uint64_t>(*p) * prime_5;
+    hash = rotate_left(hash, 11) * prime_1;
+  }
+
+  hash ^= hash >> 33;
+  hash *= prime_2;
+  hash ^= hash >> 29;
+  hash *= prime_3;
+  hash ^= hash >> 32;
+  return hash;
+}
+}
+}
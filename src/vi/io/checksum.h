@@ -0,0 +1,16 @@
+#ifndef __vinn__checksum__
+#define __vinn__checksum__
+
+#include <cstddef>
+#include <cstdint>
+
+namespace vi {
+namespace io {
+
+/// 64-bit non-cryptographic checksum (XXH64) for detecting corrupted files,
+/// processes several gigabytes per second so large files can be verified on load
+uint64_t checksum(const void* data, size_t size, uint64_t seed = 0U);
+}
+}
+
+#endif
@@ -0,0 +1,79 @@
+#include "vi/io/csv_dataset.h"
+
+#include <algorithm>
+
+namespace vi {
+namespace io {
+
+csv_dataset::csv_dataset(std::istream& stream, size_t target_count, char delimiter,
+                         bool has_header)
+    : _lines(stream), _delimiter(delimiter), _has_header(has_header), _column_count(0U),
+      _target_count(target_count), _line_number(0U) {
+  rewind();
+  text_range row;
+  if (next_row(row)) {
+    _column_count = 1U + std::count(row.first, row.second, delimiter);
+  }
+  if (_column_count <= target_count) {
+    throw exception("CSV stream has no rows with features and " + std::to_string(target_count) +
+                    " targets.");
+  }
+  rewind();
+}
+
+size_t csv_dataset::feature_count() const { return _column_count - _target_count; }
+
+size_t csv_dataset::target_count() const { return _target_count; }
+
+void csv_dataset::rewind() {
+  _lines.rewind();
+  _line_number = 0U;
+  text_range header;
+  if (_has_header && _lines.next(header)) {
+    ++_line_number;
+  }
+}
+
+bool csv_dataset::next_row(text_range& row) {
+  while (_lines.next(row)) {
+    ++_line_number;
+    if (token_begin(row.first, row.second) != row.second) {
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t csv_dataset::read(float* features, float* targets, size_t max_rows) {
+  const size_t feature_count = this->feature_count();
+  size_t row_count = 0U;
+  text_range row;
+  for (; row_count < max_rows && next_row(row); ++row_count) {
+    float* row_features = features + row_count * feature_count;
+    float* row_targets = targets + row_count * _target_count;
+    std::fill(row_features, row_features + feature_count, 0.0f);
+    std::fill(row_targets, row_targets + _target_count, 0.0f);
+
+    size_t column = 0U;
+    for (const char* value = row.first;; ++column) {
+      const char* value_end = std::find(value, row.second, _delimiter);
+      if (column == _column_count) {
+        throw exception("Line " + std::to_string(_line_number) + " has more than " +
+                        std::to_string(_column_count) + " columns.");
+      }
+      float& parsed = column < feature_count ? row_features[column]
+                                             : row_targets[column - feature_count];
+      if (!parse_float(value, value_end, parsed)) {
+        throw exception("Invalid value '" + std::string(value, value_end) + "' on line " +
+                        std::to_string(_line_number) + ".");
+      }
+      if (value_end == row.second) {
+        break;
+      }
+      value = value_end + 1;
+    }
+  }
+  return row_count;
+}
+}
+}
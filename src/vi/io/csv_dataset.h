@@ -0,0 +1,52 @@
+#ifndef __vinn__csv_dataset__
+#define __vinn__csv_dataset__
+
+#include <vi/io/text_parser.h>
+#include <vi/nn/dataset.h>
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace vi {
+namespace io {
+
+/// Stream examples from CSV rows holding the features followed by the
+/// targets. The stream is read in blocks as examples are requested, so the
+/// whole file is never held in memory. Rows shorter than the first row are
+/// padded with zeros.
+class csv_dataset : public vi::nn::dataset {
+public:
+  class exception : public std::runtime_error {
+  public:
+    exception(const std::string& text) : runtime_error(text) {}
+  };
+
+  /// \param target_count number of trailing columns holding targets
+  /// \param has_header skip the first line
+  /// \throw exception if the stream has no row with more than target_count columns
+  csv_dataset(std::istream& stream, size_t target_count, char delimiter = ',',
+              bool has_header = false);
+
+  size_t feature_count() const;
+  size_t target_count() const;
+
+  void rewind();
+
+  /// \throw exception if a row has too many columns or an invalid value
+  size_t read(float* features, float* targets, size_t max_rows);
+
+private:
+  bool next_row(text_range& row);
+
+  line_reader _lines;
+  char _delimiter;
+  bool _has_header;
+  size_t _column_count;
+  size_t _target_count;
+  size_t _line_number;
+};
+}
+}
+
+#endif
@@ -1,9 +1,25 @@
-#include "csv_file.h"
+#include "vi/io/csv_file.h"
+#include "vi/io/csv_writer.h"
 
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <future>
 #include <sstream>
 #include <string>
 #include <vector>
 
+namespace {
+
+/// Stream bytes read at a time, split between the parser threads
+const size_t block_size = 1U << 24;
+
+/// \return end of the values on a line, excluding a carriage return
+const char* values_end(const char* line, const char* end) {
+  return end > line && *(end - 1) == '\r' ? end - 1 : end;
+}
+}
+
 namespace vi {
 namespace io {
 
@@ -20,57 +36,131 @@ void csv_file::load(vi::la::matrix& matrix, std::vector<std::string>& header) {
 
 void csv_file::load(vi::la::matrix& matrix, std::vector<std::string>* header) {
   _stream.exceptions(std::iostream::badbit);
-  std::vector<std::vector<float>> matrix_values;
-  size_t max_columns(0U);
-
-  bool first_line(true);
-  std::string line;
-  while (std::getline(_stream, line, '\n')) {
-    if (first_line && header) {
-      first_line = false;
-      parse_header(line, *header);
-      continue;
+  // the stream is read twice, once to size the matrix and once to fill it
+  std::stringstream buffered;
+  std::istream* source = &_stream;
+  if (_stream.tellg() == std::streampos(-1)) {
+    buffered << _stream.rdbuf();
+    buffered.clear();
+    source = &buffered;
+  }
+  line_reader lines(*source, block_size);
+
+  size_t first_line = 1U;
+  text_range line;
+  if (header && lines.next(line)) {
+    parse_header(text_range(line.first, values_end(line.first, line.second)), *header);
+    ++first_line;
+  }
+
+  size_t row_count = 0U;
+  size_t column_count = 0U;
+  text_range block;
+  while (lines.next_lines(block)) {
+    for (const chunk_shape& shape : measure_chunks(split_lines(block, parser_thread_count()))) {
+      row_count += shape.row_count;
+      column_count = std::max(column_count, shape.column_count);
     }
+  }
+  if (row_count == 0U || column_count == 0U) {
+    throw exception("CSV stream contains no values.");
+  }
 
-    std::vector<float> row;
-    parse_row(line, row);
-    max_columns = std::max(max_columns, row.size());
-    matrix_values.push_back(row);
+  vi::la::matrix loaded(matrix.owning_context(), row_count, column_count, 0.0f);
+  // copy device values to the host once, the parsers write disjoint rows
+  static_cast<void>(loaded[0U]);
+  lines.rewind();
+  if (header) {
+    lines.next(line);
+  }
+  size_t first_row = 0U;
+  while (lines.next_lines(block)) {
+    const std::vector<text_range> chunks = split_lines(block, parser_thread_count());
+    const std::vector<chunk_shape> shapes = measure_chunks(chunks);
+    std::vector<std::future<void>> parsers;
+    for (size_t i = 0U; i < chunks.size(); ++i) {
+      parsers.push_back(std::async(std::launch::async, &csv_file::parse_chunk, this,
+                                   std::cref(chunks[i]), std::ref(loaded), first_row,
+                                   first_line + first_row));
+      first_row += shapes[i].row_count;
+    }
+    // wait for all parsers before rethrowing the first failure
+    for (std::future<void>& parser : parsers) {
+      parser.wait();
+    }
+    for (std::future<void>& parser : parsers) {
+      parser.get();
+    }
   }
 
-  matrix = vi::la::matrix(matrix.owning_context(), matrix_values.size(), max_columns,
-                          make_buffer(matrix_values, max_columns));
+  matrix = loaded;
 }
 
-void csv_file::parse_header(const std::string& line, std::vector<std::string>& header) const {
-  std::istringstream row_stream(line);
-  std::string value;
-  while (std::getline(row_stream, value, _delimiter)) {
-    header.push_back(value);
+std::vector<csv_file::chunk_shape> csv_file::measure_chunks(
+    const std::vector<text_range>& chunks) const {
+  // starting a thread takes longer than measuring a small chunk
+  if (chunks.size() == 1U) {
+    return std::vector<chunk_shape>(1U, measure_chunk(chunks[0]));
+  }
+  std::vector<std::future<chunk_shape>> measurements;
+  for (const text_range& chunk : chunks) {
+    measurements.push_back(
+        std::async(std::launch::async, &csv_file::measure_chunk, this, std::cref(chunk)));
   }
+  std::vector<chunk_shape> shapes;
+  for (std::future<chunk_shape>& measurement : measurements) {
+    shapes.push_back(measurement.get());
+  }
+  return shapes;
 }
 
-void csv_file::parse_row(const std::string& line, std::vector<float>& row) const {
-  std::istringstream row_stream(line);
+void csv_file::parse_header(const text_range& line, std::vector<std::string>& header) const {
+  std::istringstream row_stream(std::string(line.first, line.second));
   std::string value;
   while (std::getline(row_stream, value, _delimiter)) {
-    row.push_back(std::stof(value));
+    header.push_back(value);
   }
 }
 
-std::shared_ptr<float> csv_file::make_buffer(const std::vector<std::vector<float>>& matrix_values,
-                                             size_t max_columns) const {
-  float* values = new float[matrix_values.size() * max_columns];
-  size_t offset = 0U;
-  for (auto row : matrix_values) {
-    for (size_t column = 0U; column < row.size(); ++column) {
-      values[offset + column] = row[column];
+csv_file::chunk_shape csv_file::measure_chunk(const text_range& chunk) const {
+  chunk_shape shape = {0U, 0U};
+  for (const char* line = chunk.first; line < chunk.second;) {
+    const char* end = line_end(line, chunk.second);
+    const char* last = values_end(line, end);
+
+    // a trailing delimiter does not start another value
+    size_t column_count = 0U;
+    for (const char* value = line; value < last; ++column_count) {
+      const void* delimiter = std::memchr(value, _delimiter, static_cast<size_t>(last - value));
+      value = delimiter ? static_cast<const char*>(delimiter) + 1 : last;
     }
 
-    offset += max_columns;
+    ++shape.row_count;
+    shape.column_count = std::max(shape.column_count, column_count);
+    line = end + 1;
   }
+  return shape;
+}
 
-  return std::shared_ptr<float>(values, [](float* p) { delete[] p; });
+void csv_file::parse_chunk(const text_range& chunk, vi::la::matrix& matrix, size_t first_row,
+                           size_t first_line) const {
+  size_t row = first_row;
+  for (const char* line = chunk.first; line < chunk.second; ++row) {
+    const char* end = line_end(line, chunk.second);
+    const char* last = values_end(line, end);
+    float* values = matrix[row];
+
+    for (const char* value = line; value < last; ++values) {
+      const void* delimiter = std::memchr(value, _delimiter, static_cast<size_t>(last - value));
+      const char* value_end = delimiter ? static_cast<const char*>(delimiter) : last;
+      if (!parse_float(value, value_end, *values)) {
+        throw exception("Invalid value '" + std::string(value, value_end) + "' on line " +
+                        std::to_string(first_line + row - first_row) + ".");
+      }
+      value = delimiter ? value_end + 1 : last;
+    }
+    line = end + 1;
+  }
 }
 
 void csv_file::store(const vi::la::matrix& matrix) { store(matrix, nullptr); }
@@ -80,30 +170,12 @@ void csv_file::store(const vi::la::matrix& matrix, std::vector<std::string>& hea
 }
 
 void csv_file::store(const vi::la::matrix& matrix, std::vector<std::string>* header) {
-  _stream.precision(17);
+  csv_writer writer(_stream, _delimiter, 0U);
   if (header) {
-    for (size_t i = 0U; i < header->size(); ++i) {
-      const std::string& column = header->at(i);
-      _stream << column;
-
-      if (i != header->size() - 1U) {
-        _stream << _delimiter;
-      }
-    }
-    _stream << "\n";
-  }
-
-  for (size_t row = 0U; row < matrix.row_count(); ++row) {
-    for (size_t column = 0U; column < matrix.column_count(); ++column) {
-      _stream << matrix[row][column];
-      if (column != matrix.column_count() - 1U) {
-        _stream << _delimiter;
-      }
-    }
-    _stream << "\n";
+    writer.write_header(*header);
   }
-
-  _stream.flush();
+  writer.append(matrix);
+  writer.flush();
 }
 }
 }
@@ -2,17 +2,33 @@
 #define __vinn__csv__file__
 
 #include <iostream>
+#include <stdexcept>
+#include <vi/io/text_parser.h>
 #include <vi/la/matrix.h>
 
 namespace vi {
 namespace io {
 
-/// Load matrices stored in CSV format
+/// Load and store matrices in CSV format
+/// The stream is read twice in large blocks of whole lines, once to count the
+/// rows and columns and once to parse the blocks straight into the matrix.
+/// Each block is split into chunks that are parsed concurrently, so memory use
+/// is bounded by the matrix and the block size. Streams that can not seek are
+/// read into memory first. Rows shorter than the longest row are padded with
+/// zeros. Matrices are stored through csv_writer.
 class csv_file {
 public:
+  class exception : public std::runtime_error {
+  public:
+    exception(const std::string& text) : runtime_error(text) {}
+  };
+
   csv_file(std::iostream& stream, char delimiter = ',');
   virtual ~csv_file();
 
+  /// A matrix can not have zero rows, so a stream that is empty or only holds a
+  /// header leaves the matrix unchanged and throws, the header is still read
+  /// \throw exception if the stream contains no rows or an invalid value
   void load(vi::la::matrix& matrix);
   void load(vi::la::matrix& matrix, std::vector<std::string>& header);
 
@@ -21,10 +37,17 @@ public:
 
 private:
   void load(vi::la::matrix& matrix, std::vector<std::string>* header);
-  void parse_header(const std::string& line, std::vector<std::string>& header) const;
-  void parse_row(const std::string& line, std::vector<float>& row) const;
-  std::shared_ptr<float> make_buffer(const std::vector<std::vector<float>>& matrix_values,
-                                     size_t max_columns) const;
+  struct chunk_shape {
+    size_t row_count;
+    size_t column_count;
+  };
+
+  void parse_header(const text_range& line, std::vector<std::string>& header) const;
+  /// Measure the chunks concurrently
+  std::vector<chunk_shape> measure_chunks(const std::vector<text_range>& chunks) const;
+  chunk_shape measure_chunk(const text_range& chunk) const;
+  void parse_chunk(const text_range& chunk, vi::la::matrix& matrix, size_t first_row,
+                   size_t first_line) const;
 
   void store(const vi::la::matrix& matrix, std::vector<std::string>* header);
 
@@ -0,0 +1,145 @@
+#include "vi/io/csv_writer.h"
+#include "vi/io/text_formatter.h"
+#include "vi/io/text_parser.h"
+
+#include <algorithm>
+#include <functional>
+#include <future>
+
+namespace {
+
+/// Buffered text written to the stream at once
+const size_t buffer_size = 1U << 20;
+
+/// Values formatted by each thread of a concurrent append
+const size_t min_values_per_thread = 1U << 16;
+}
+
+namespace vi {
+namespace io {
+
+csv_writer::csv_writer(std::ostream& stream, char delimiter, size_t thread_count)
+    : _stream(stream), _delimiter(delimiter),
+      _thread_count(thread_count == 0U ? parser_thread_count() : thread_count), _column_count(0U),
+      _row_count(0U) {
+  _buffer.reserve(buffer_size);
+}
+
+csv_writer::~csv_writer() {
+  try {
+    flush();
+  } catch (...) {
+  }
+}
+
+void csv_writer::write_header(const std::vector<std::string>& header) {
+  if (_row_count != 0U) {
+    throw exception("Header must be written before any rows.");
+  }
+  for (size_t i = 0U; i < header.size(); ++i) {
+    _buffer.insert(_buffer.end(), header[i].begin(), header[i].end());
+    if (i + 1U != header.size()) {
+      _buffer.push_back(_delimiter);
+    }
+  }
+  _buffer.push_back('\n');
+}
+
+void csv_writer::append(const vi::la::matrix& rows) {
+  if (_row_count != 0U && rows.column_count() != _column_count) {
+    throw vi::la::incompatible_dimensions("CSV rows must have " + std::to_string(_column_count) +
+                                          " columns.");
+  }
+  _column_count = rows.column_count();
+
+  const size_t row_count = rows.row_count();
+  const size_t chunk_count = std::max<size_t>(
+      1U, std::min(_thread_count, row_count * _column_count / min_values_per_thread));
+  if (chunk_count == 1U) {
+    format_rows(rows, 0U, row_count, _buffer);
+  } else {
+    // map device values on the host once, the formatters read disjoint rows
+    static_cast<void>(rows[0U]);
+    _chunks.resize(chunk_count);
+    std::vector<std::future<void>> formatting;
+    for (size_t i = 0U; i < chunk_count; ++i) {
+      _chunks[i].clear();
+      formatting.push_back(std::async(std::launch::async, &csv_writer::format_rows, this,
+                                      std::cref(rows), (row_count * i) / chunk_count,
+                                      (row_count * (i + 1U)) / chunk_count,
+                                      std::ref(_chunks[i])));
+    }
+    for (std::future<void>& chunk : formatting) {
+      chunk.get();
+    }
+    // keep the rows in order behind previously buffered text
+    write(_buffer);
+    _buffer.clear();
+    for (const std::vector<char>& chunk : _chunks) {
+      write(chunk);
+    }
+  }
+  _row_count += row_count;
+
+  if (_buffer.size() >= buffer_size) {
+    write(_buffer);
+    _buffer.clear();
+  }
+}
+
+void csv_writer::flush() {
+  write(_buffer);
+  _buffer.clear();
+  _stream.flush();
+  if (!_stream) {
+    throw exception("Failed to write CSV stream.");
+  }
+}
+
+size_t csv_writer::row_count() const { return _row_count; }
+
+void csv_writer::format_rows(const vi::la::matrix& rows, size_t first_row, size_t end_row,
+                             std::vector<char>& text) const {
+  // reserve the longest possible text and trim it afterwards
+  const size_t column_count = rows.column_count();
+  const size_t offset = text.size();
+  text.resize(offset + (end_row - first_row) * column_count * (max_float_length + 1U));
+  char* end = text.data() + offset;
+  for (size_t row = first_row; row < end_row; ++row) {
+    const float* values = rows[row];
+    for (size_t column = 0U; column < column_count; ++column) {
+      end = format_float(values[column], end);
+      *end++ = _delimiter;
+    }
+    // the last delimiter becomes the newline
+    *(end - 1) = '\n';
+  }
+  text.resize(static_cast<size_t>(end - text.data()));
+}
+
+void csv_writer::write(const std::vector<char>& text) {
+  if (text.empty()) {
+    return;
+  }
+  _stream.write(text.data(), static_cast<std::streamsize>(text.size()));
+  if (!_stream) {
+    throw exception("Failed to write CSV stream.");
+  }
+}
+
+size_t store_predictions(const vi::nn::network& network, vi::nn::dataset& dataset,
+                         vi::la::context& context, csv_writer& writer, size_t batch_size) {
+  const size_t feature_count = dataset.feature_count();
+  std::vector<float> features(batch_size * feature_count);
+  std::vector<float> targets(batch_size * dataset.target_count());
+
+  size_t row_count = 0U;
+  while (const size_t read_count = dataset.read(features.data(), targets.data(), batch_size)) {
+    const vi::la::matrix batch(context, features.data(), read_count, feature_count);
+    writer.append(network.forward(batch));
+    row_count += read_count;
+  }
+  return row_count;
+}
+}
+}
@@ -0,0 +1,75 @@
+#ifndef __vinn__csv_writer__
+#define __vinn__csv_writer__
+
+#include <vi/la/context.h>
+#include <vi/la/matrix.h>
+#include <vi/nn/dataset.h>
+#include <vi/nn/network.h>
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace vi {
+namespace io {
+
+/// Write matrices in CSV format with the shortest text that parses back to
+/// the same values. Rows are formatted into a buffer that is written to the
+/// stream in large blocks, so results can be appended batch by batch as they
+/// are computed without holding all of them in memory. Large appends can be
+/// formatted by several threads.
+class csv_writer {
+public:
+  class exception : public std::runtime_error {
+  public:
+    exception(const std::string& text) : runtime_error(text) {}
+  };
+
+  /// \param thread_count threads formatting large appends, 0 uses one per core
+  csv_writer(std::ostream& stream, char delimiter = ',', size_t thread_count = 1U);
+  /// Writes buffered rows, errors are ignored
+  ~csv_writer();
+
+  csv_writer(const csv_writer&) = delete;
+  csv_writer& operator=(const csv_writer&) = delete;
+
+  /// \throw exception if rows have already been appended
+  void write_header(const std::vector<std::string>& header);
+
+  /// Append the rows of a matrix
+  /// \throw vi::la::incompatible_dimensions if the column count differs from earlier rows
+  /// \throw exception if writing fails
+  void append(const vi::la::matrix& rows);
+
+  /// Write buffered rows to the stream and flush it
+  /// \throw exception if writing fails
+  void flush();
+
+  size_t row_count() const;
+
+private:
+  /// Append formatted rows [first_row, end_row) to text
+  void format_rows(const vi::la::matrix& rows, size_t first_row, size_t end_row,
+                   std::vector<char>& text) const;
+  void write(const std::vector<char>& text);
+
+  std::ostream& _stream;
+  char _delimiter;
+  size_t _thread_count;
+  size_t _column_count;
+  size_t _row_count;
+  std::vector<char> _buffer;
+  std::vector<std::vector<char>> _chunks;
+};
+
+/// Forward every example of a dataset through a network in batches and
+/// append the predictions to a writer
+/// \return number of predictions written
+size_t store_predictions(const vi::nn::network& network, vi::nn::dataset& dataset,
+                         vi::la::context& context, csv_writer& writer,
+                         size_t batch_size = 1024U);
+}
+}
+
+#endif
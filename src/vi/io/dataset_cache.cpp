@@ -0,0 +1,401 @@
+#include "vi/io/dataset_cache.h"
+#include "vi/io/checksum.h"
+#include "vi/io/mapped_file.h"
+#include "vi/io/text_parser.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <future>
+
+#ifdef VINN_HAVE_LZ4
+#include <lz4.h>
+#endif
+#ifdef VINN_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+const char magic[8] = {'V', 'I', 'N', 'N', 'D', 'S', 'C', '\0'};
+const uint32_t current_version = 1U;
+/// Reads back as a different value on a machine of the other endianness
+const uint32_t byte_order_mark = 0x01020304U;
+const uint32_t float32_values = 0U;
+
+/// Alignment of chunks and the chunk table within the file
+const size_t alignment = 64U;
+/// Space reserved for the header before the first chunk
+const size_t header_size = 128U;
+/// Values in a chunk when the number of rows is picked automatically
+const size_t default_chunk_size = 1U << 20;
+/// Largest input LZ4 accepts
+const size_t max_lz4_chunk_size = 0x7E000000U;
+const int zstd_level = 3;
+
+struct file_header {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint32_t value_type;
+  uint32_t compression;
+  uint64_t row_count;
+  uint64_t feature_count;
+  uint64_t target_count;
+  uint64_t rows_per_chunk;
+  uint64_t chunk_count;
+  uint64_t chunk_table_offset;
+  uint64_t chunk_table_checksum;
+};
+
+/// Words in each chunk table entry: offset, stored size and checksum
+const size_t chunk_entry_size = 3U;
+
+size_t padding(uint64_t offset) { return (alignment - offset % alignment) % alignment; }
+}
+
+namespace vi {
+namespace io {
+
+bool compression_available(vi::io::compression compression) {
+  switch (compression) {
+  case compression::none:
+    return true;
+  case compression::lz4:
+#ifdef VINN_HAVE_LZ4
+    return true;
+#else
+    return false;
+#endif
+  case compression::zstd:
+#ifdef VINN_HAVE_ZSTD
+    return true;
+#else
+    return false;
+#endif
+  }
+  return false;
+}
+
+dataset_cache_writer::dataset_cache_writer(const std::string& path, size_t feature_count,
+                                           size_t target_count, vi::io::compression compression,
+                                           size_t rows_per_chunk)
+    : _path(path), _feature_count(feature_count), _target_count(target_count),
+      _compression(compression), _rows_per_chunk(rows_per_chunk), _row_count(0U),
+      _closed(false) {
+  static_assert(sizeof(file_header) <= header_size, "Header must fit before the first chunk");
+  if (!compression_available(compression)) {
+    throw exception("Compression is not available in this build.");
+  }
+  if (feature_count == 0U || target_count == 0U) {
+    throw exception("Dataset cache needs at least one feature and target.");
+  }
+
+  const size_t row_size = (feature_count + target_count) * sizeof(float);
+  if (_rows_per_chunk == 0U) {
+    _rows_per_chunk = std::max<size_t>(1U, default_chunk_size / row_size);
+  }
+  if (compression == compression::lz4 && _rows_per_chunk * row_size > max_lz4_chunk_size) {
+    throw exception("Chunks are too large for LZ4 compression.");
+  }
+  _features.reserve(_rows_per_chunk * feature_count);
+  _targets.reserve(_rows_per_chunk * target_count);
+
+  _file.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+  // the header is written once the chunk table is known
+  const char header[header_size] = {};
+  _file.write(header, sizeof(header));
+  if (!_file) {
+    throw exception("Cannot create dataset cache '" + path + "'.");
+  }
+}
+
+dataset_cache_writer::~dataset_cache_writer() {
+  if (!_closed) {
+    try {
+      close();
+    } catch (...) {
+    }
+  }
+}
+
+void dataset_cache_writer::append(const vi::la::matrix& features, const vi::la::matrix& targets) {
+  if (features.column_count() != _feature_count || targets.column_count() != _target_count ||
+      features.row_count() != targets.row_count()) {
+    throw vi::la::incompatible_dimensions(
+        "Dataset cache expects " + std::to_string(_feature_count) + " features and " +
+        std::to_string(_target_count) + " targets for every row.");
+  }
+
+  for (size_t row = 0U; row < features.row_count(); ++row) {
+    _features.insert(_features.end(), features[row], features[row] + _feature_count);
+    _targets.insert(_targets.end(), targets[row], targets[row] + _target_count);
+    ++_row_count;
+    if (_features.size() == _rows_per_chunk * _feature_count) {
+      write_chunk();
+    }
+  }
+}
+
+void dataset_cache_writer::write_chunk() {
+  const size_t feature_bytes = _features.size() * sizeof(float);
+  const size_t target_bytes = _targets.size() * sizeof(float);
+  _chunk.resize(feature_bytes + target_bytes);
+  std::memcpy(_chunk.data(), _features.data(), feature_bytes);
+  std::memcpy(_chunk.data() + feature_bytes, _targets.data(), target_bytes);
+  _features.clear();
+  _targets.clear();
+
+  const char* stored = _chunk.data();
+  size_t stored_size = _chunk.size();
+  if (_compression == compression::lz4) {
+#ifdef VINN_HAVE_LZ4
+    _compressed.resize(static_cast<size_t>(LZ4_compressBound(static_cast<int>(_chunk.size()))));
+    const int compressed_size =
+        LZ4_compress_default(_chunk.data(), _compressed.data(), static_cast<int>(_chunk.size()),
+                             static_cast<int>(_compressed.size()));
+    if (compressed_size <= 0) {
+      throw exception("LZ4 compression failed.");
+    }
+    stored = _compressed.data();
+    stored_size = static_cast<size_t>(compressed_size);
+#endif
+  } else if (_compression == compression::zstd) {
+#ifdef VINN_HAVE_ZSTD
+    _compressed.resize(ZSTD_compressBound(_chunk.size()));
+    const size_t compressed_size = ZSTD_compress(_compressed.data(), _compressed.size(),
+                                                 _chunk.data(), _chunk.size(), zstd_level);
+    if (ZSTD_isError(compressed_size)) {
+      throw exception("Zstandard compression failed.");
+    }
+    stored = _compressed.data();
+    stored_size = compressed_size;
+#endif
+  }
+
+  const char zeros[alignment] = {};
+  _file.write(zeros, padding(static_cast<uint64_t>(_file.tellp())));
+  _chunk_table.push_back(static_cast<uint64_t>(_file.tellp()));
+  _chunk_table.push_back(stored_size);
+  _chunk_table.push_back(vi::io::checksum(stored, stored_size));
+  _file.write(stored, static_cast<std::streamsize>(stored_size));
+  if (!_file) {
+    throw exception("Cannot write dataset cache '" + _path + "'.");
+  }
+}
+
+void dataset_cache_writer::close() {
+  _closed = true;
+  if (!_features.empty()) {
+    write_chunk();
+  }
+  if (_row_count == 0U) {
+    _file.close();
+    throw exception("Dataset cache '" + _path + "' has no rows.");
+  }
+
+  const char zeros[alignment] = {};
+  _file.write(zeros, padding(static_cast<uint64_t>(_file.tellp())));
+  const size_t table_size = _chunk_table.size() * sizeof(uint64_t);
+
+  file_header header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, magic, sizeof(magic));
+  header.version = current_version;
+  header.byte_order = byte_order_mark;
+  header.value_type = float32_values;
+  header.compression = static_cast<uint32_t>(_compression);
+  header.row_count = _row_count;
+  header.feature_count = _feature_count;
+  header.target_count = _target_count;
+  header.rows_per_chunk = _rows_per_chunk;
+  header.chunk_count = _chunk_table.size() / chunk_entry_size;
+  header.chunk_table_offset = static_cast<uint64_t>(_file.tellp());
+  header.chunk_table_checksum = vi::io::checksum(_chunk_table.data(), table_size);
+
+  _file.write(reinterpret_cast<const char*>(_chunk_table.data()),
+              static_cast<std::streamsize>(table_size));
+  _file.seekp(0);
+  _file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  _file.close();
+  if (!_file) {
+    throw exception("Cannot write dataset cache '" + _path + "'.");
+  }
+}
+
+size_t dataset_cache_writer::row_count() const { return _row_count; }
+
+size_t dataset_cache_writer::rows_per_chunk() const { return _rows_per_chunk; }
+
+dataset_cache_reader::dataset_cache_reader(const std::string& path) : _path(path) {
+  try {
+    _mapping = std::make_shared<mapped_file>(path);
+  } catch (mapped_file::exception& e) {
+    throw exception(e.what());
+  }
+  if (_mapping->size() < header_size) {
+    throw exception("Dataset cache '" + path + "' is truncated.");
+  }
+
+  file_header header;
+  std::memcpy(&header, _mapping->data(), sizeof(header));
+  if (std::memcmp(header.magic, magic, sizeof(magic)) != 0) {
+    throw exception("'" + path + "' is not a dataset cache.");
+  }
+  if (header.version != current_version || header.byte_order != byte_order_mark ||
+      header.value_type != float32_values) {
+    throw exception("Dataset cache '" + path + "' has an unsupported version or byte order.");
+  }
+  if (header.compression > static_cast<uint32_t>(compression::zstd) ||
+      !compression_available(static_cast<vi::io::compression>(header.compression))) {
+    throw exception("Dataset cache '" + path + "' uses a compression unavailable in this build.");
+  }
+  if (header.row_count == 0U || header.feature_count == 0U || header.target_count == 0U ||
+      header.rows_per_chunk == 0U ||
+      header.chunk_count != (header.row_count + header.rows_per_chunk - 1U) /
+                                header.rows_per_chunk) {
+    throw exception("Dataset cache '" + path + "' has an invalid shape.");
+  }
+
+  const uint64_t file_size = _mapping->size();
+  const uint64_t table_size = header.chunk_count * chunk_entry_size * sizeof(uint64_t);
+  if (header.chunk_table_offset > file_size || table_size > file_size - header.chunk_table_offset) {
+    throw exception("Dataset cache '" + path + "' is truncated.");
+  }
+  const char* table = _mapping->data() + header.chunk_table_offset;
+  if (vi::io::checksum(table, table_size) != header.chunk_table_checksum) {
+    throw exception("Dataset cache '" + path +
+                    "' is corrupted, chunk table checksum does not match.");
+  }
+
+  _chunks.resize(header.chunk_count);
+  std::memcpy(_chunks.data(), table, table_size);
+  for (const chunk_entry& chunk : _chunks) {
+    if (chunk.offset < header_size || chunk.offset % alignment != 0U ||
+        chunk.offset > header.chunk_table_offset ||
+        chunk.stored_size > header.chunk_table_offset - chunk.offset) {
+      throw exception("Dataset cache '" + path + "' has an invalid chunk table.");
+    }
+  }
+
+  _row_count = header.row_count;
+  _feature_count = header.feature_count;
+  _target_count = header.target_count;
+  _compression = static_cast<vi::io::compression>(header.compression);
+  _rows_per_chunk = header.rows_per_chunk;
+}
+
+size_t dataset_cache_reader::row_count() const { return _row_count; }
+
+size_t dataset_cache_reader::feature_count() const { return _feature_count; }
+
+size_t dataset_cache_reader::target_count() const { return _target_count; }
+
+compression dataset_cache_reader::compression() const { return _compression; }
+
+size_t dataset_cache_reader::chunk_count() const { return _chunks.size(); }
+
+size_t dataset_cache_reader::chunk_first_row(size_t chunk_index) const {
+  return chunk_index * _rows_per_chunk;
+}
+
+size_t dataset_cache_reader::chunk_row_count(size_t chunk_index) const {
+  return std::min(_rows_per_chunk, _row_count - chunk_first_row(chunk_index));
+}
+
+const float* dataset_cache_reader::decode(size_t chunk_index, std::vector<char>& buffer) const {
+  const chunk_entry& chunk = _chunks.at(chunk_index);
+  const char* stored = _mapping->data() + chunk.offset;
+  const size_t stored_size = static_cast<size_t>(chunk.stored_size);
+  const size_t size = chunk_row_count(chunk_index) * (_feature_count + _target_count) *
+                      sizeof(float);
+  if (vi::io::checksum(stored, stored_size) != chunk.checksum) {
+    throw exception("Dataset cache '" + _path + "' is corrupted, chunk " +
+                    std::to_string(chunk_index) + " checksum does not match.");
+  }
+
+  bool decoded = false;
+  if (_compression == compression::none) {
+    // chunks are aligned, the values can be used in place
+    decoded = stored_size == size;
+    buffer.clear();
+  } else if (_compression == compression::lz4) {
+#ifdef VINN_HAVE_LZ4
+    buffer.resize(size);
+    const int decoded_size = LZ4_decompress_safe(stored, buffer.data(),
+                                                 static_cast<int>(stored_size),
+                                                 static_cast<int>(size));
+    decoded = decoded_size >= 0 && static_cast<size_t>(decoded_size) == size;
+#endif
+  } else if (_compression == compression::zstd) {
+#ifdef VINN_HAVE_ZSTD
+    buffer.resize(size);
+    const size_t decoded_size = ZSTD_decompress(buffer.data(), size, stored, stored_size);
+    decoded = !ZSTD_isError(decoded_size) && decoded_size == size;
+#endif
+  }
+  if (!decoded) {
+    throw exception("Dataset cache '" + _path + "' is corrupted, chunk " +
+                    std::to_string(chunk_index) + " cannot be decoded.");
+  }
+  return reinterpret_cast<const float*>(buffer.empty() ? stored : buffer.data());
+}
+
+void dataset_cache_reader::read_chunk(size_t chunk_index, vi::la::matrix& features,
+                                      vi::la::matrix& targets, size_t first_row) const {
+  const size_t row_count = chunk_row_count(chunk_index);
+  if (features.column_count() != _feature_count || targets.column_count() != _target_count ||
+      first_row + row_count > features.row_count() || first_row + row_count > targets.row_count()) {
+    throw vi::la::incompatible_dimensions("Chunk does not fit into features and targets.");
+  }
+
+  // rows of a matrix are stored consecutively
+  read_chunk(chunk_index, features[first_row], targets[first_row]);
+}
+
+void dataset_cache_reader::read_chunk(size_t chunk_index, float* features, float* targets) const {
+  const size_t row_count = chunk_row_count(chunk_index);
+  std::vector<char> buffer;
+  const float* values = decode(chunk_index, buffer);
+  std::memcpy(features, values, row_count * _feature_count * sizeof(float));
+  std::memcpy(targets, values + row_count * _feature_count,
+              row_count * _target_count * sizeof(float));
+}
+
+void dataset_cache_reader::release_chunk(size_t chunk_index) const {
+  const chunk_entry& chunk = _chunks.at(chunk_index);
+  _mapping->release(static_cast<size_t>(chunk.offset), static_cast<size_t>(chunk.stored_size));
+}
+
+std::pair<vi::la::matrix, vi::la::matrix>
+dataset_cache_reader::load(vi::la::context& context) const {
+  // uninitialized, every row is written by one of the chunks
+  vi::la::matrix features(context, static_cast<const float*>(nullptr), _row_count,
+                          _feature_count);
+  vi::la::matrix targets(context, static_cast<const float*>(nullptr), _row_count, _target_count);
+
+  // map device values on the host once, the readers write disjoint rows
+  static_cast<void>(features[0U]);
+  static_cast<void>(targets[0U]);
+
+  const size_t thread_count = std::min(parser_thread_count(), chunk_count());
+  auto read_chunks = [&](size_t thread_index) {
+    for (size_t chunk = thread_index; chunk < chunk_count(); chunk += thread_count) {
+      read_chunk(chunk, features, targets, chunk_first_row(chunk));
+    }
+  };
+  std::vector<std::future<void>> reading;
+  for (size_t i = 0U; i < thread_count; ++i) {
+    reading.push_back(std::async(std::launch::async, read_chunks, i));
+  }
+  // wait for all readers before rethrowing the first failure
+  for (std::future<void>& chunks : reading) {
+    chunks.wait();
+  }
+  for (std::future<void>& chunks : reading) {
+    chunks.get();
+  }
+  return std::make_pair(features, targets);
+}
+}
+}
@@ -0,0 +1,147 @@
+#ifndef __vinn__dataset_cache__
+#define __vinn__dataset_cache__
+
+#include <vi/la/context.h>
+#include <vi/la/matrix.h>
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace vi {
+namespace io {
+
+class mapped_file;
+
+/// Compression of dataset cache chunks
+enum class compression {
+  none,
+  /// Fast decoding, requires building with LZ4
+  lz4,
+  /// Higher ratio, requires building with Zstandard
+  zstd
+};
+
+/// \return true if the library was built with support for the compression
+bool compression_available(compression compression);
+
+/// Binary cache of a parsed dataset for repeated training runs.
+/// Rows are grouped into chunks, each chunk holds the features of its rows
+/// followed by their targets, optionally compressed, and starts at a 64 byte
+/// aligned offset. A chunk table at the end of the file records the offset,
+/// stored size and checksum of every chunk.
+class dataset_cache_writer {
+public:
+  class exception : public std::runtime_error {
+  public:
+    exception(const std::string& text) : runtime_error(text) {}
+  };
+
+  /// \param rows_per_chunk rows in each chunk, 0 picks chunks of about 1 MB
+  /// \throw exception if the compression is not available or the file cannot be created
+  dataset_cache_writer(const std::string& path, size_t feature_count, size_t target_count,
+                       vi::io::compression compression = vi::io::compression::none,
+                       size_t rows_per_chunk = 0U);
+  /// Closes the file if close() has not been called, errors are ignored
+  ~dataset_cache_writer();
+
+  dataset_cache_writer(const dataset_cache_writer&) = delete;
+  dataset_cache_writer& operator=(const dataset_cache_writer&) = delete;
+
+  /// Append rows, only complete chunks are kept in memory
+  /// \throw vi::la::incompatible_dimensions if the shapes do not match the cache
+  void append(const vi::la::matrix& features, const vi::la::matrix& targets);
+
+  /// Write the remaining rows and the chunk table
+  /// \throw exception if no rows were appended or writing fails
+  void close();
+
+  size_t row_count() const;
+  size_t rows_per_chunk() const;
+
+private:
+  void write_chunk();
+
+  const std::string _path;
+  std::ofstream _file;
+  size_t _feature_count;
+  size_t _target_count;
+  vi::io::compression _compression;
+  size_t _rows_per_chunk;
+  size_t _row_count;
+  bool _closed;
+
+  std::vector<float> _features;
+  std::vector<float> _targets;
+  std::vector<char> _chunk;
+  std::vector<char> _compressed;
+  std::vector<uint64_t> _chunk_table;
+};
+
+/// Memory mapped dataset cache written by dataset_cache_writer. Chunks are
+/// read and decoded on demand, so opening a cache only touches its header
+/// and chunk table.
+class dataset_cache_reader {
+public:
+  class exception : public std::runtime_error {
+  public:
+    exception(const std::string& text) : runtime_error(text) {}
+  };
+
+  /// \throw exception if the file is not a valid cache or uses an unavailable compression
+  dataset_cache_reader(const std::string& path);
+
+  size_t row_count() const;
+  size_t feature_count() const;
+  size_t target_count() const;
+  vi::io::compression compression() const;
+
+  size_t chunk_count() const;
+  /// Index of the first row in a chunk
+  size_t chunk_first_row(size_t chunk_index) const;
+  size_t chunk_row_count(size_t chunk_index) const;
+
+  /// Decode a chunk into consecutive rows of features and targets
+  /// \param first_row row of features and targets receiving the first row of the chunk
+  /// \throw exception if the chunk is corrupted
+  void read_chunk(size_t chunk_index, vi::la::matrix& features, vi::la::matrix& targets,
+                  size_t first_row = 0U) const;
+  /// Decode a chunk into row-major buffers with room for chunk_row_count() rows
+  /// \throw exception if the chunk is corrupted
+  void read_chunk(size_t chunk_index, float* features, float* targets) const;
+
+  /// Drop the mapped pages of a chunk that has been read, so that streaming
+  /// through a cache does not keep it resident
+  void release_chunk(size_t chunk_index) const;
+
+  /// Decode all chunks in parallel
+  /// \return features and targets
+  std::pair<vi::la::matrix, vi::la::matrix> load(vi::la::context& context) const;
+
+private:
+  struct chunk_entry {
+    uint64_t offset;
+    uint64_t stored_size;
+    uint64_t checksum;
+  };
+
+  /// \return values of a chunk, in place in the mapping or decoded into buffer
+  const float* decode(size_t chunk_index, std::vector<char>& buffer) const;
+
+  const std::string _path;
+  std::shared_ptr<mapped_file> _mapping;
+  size_t _row_count;
+  size_t _feature_count;
+  size_t _target_count;
+  vi::io::compression _compression;
+  size_t _rows_per_chunk;
+  std::vector<chunk_entry> _chunks;
+};
+}
+}
+
+#endif
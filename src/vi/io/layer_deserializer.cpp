@@ -1,4 +1,5 @@
 #include "layer_deserializer.h"
+#include "vi/io/activation_name.h"
 #include <memory>
 
 namespace vi {
@@ -8,16 +9,8 @@ layer_deserializer::layer_deserializer(vi::nn::layer& layer) : layer_(layer) {}
 
 void layer_deserializer::deserialize(const boost::property_tree::ptree& layer_node) {
   const std::string activation_name = layer_node.get<std::string>("activation_function");
-  std::shared_ptr<vi::nn::activation_function> activation;
-  if (activation_name == "sigmoid") {
-    activation.reset(new vi::nn::sigmoid_activation);
-  } else if (activation_name == "softmax") {
-    activation.reset(new vi::nn::softmax_activation);
-  } else if (activation_name == "tanh") {
-    activation.reset(new vi::nn::hyperbolic_tangent);
-  } else if (activation_name == "linear") {
-    activation.reset(new vi::nn::linear_activation);
-  } else {
+  std::shared_ptr<vi::nn::activation_function> activation = activation_for_name(activation_name);
+  if (!activation) {
     std::stringstream description;
     description << "invalid activation type: '" << activation_name << "'";
     throw deserializer::exception(description.str());
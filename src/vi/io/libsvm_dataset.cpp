@@ -0,0 +1,72 @@
+#include "vi/io/libsvm_dataset.h"
+
+#include <algorithm>
+
+namespace vi {
+namespace io {
+
+libsvm_dataset::libsvm_dataset(std::istream& stream, size_t feature_count, size_t target_count)
+    : _lines(stream), _feature_count(feature_count), _target_count(target_count) {
+  rewind();
+}
+
+size_t libsvm_dataset::feature_count() const { return _feature_count; }
+
+size_t libsvm_dataset::target_count() const { return _target_count; }
+
+void libsvm_dataset::rewind() { _lines.rewind(); }
+
+size_t libsvm_dataset::read(float* features, float* targets, size_t max_rows) {
+  size_t row_count = 0U;
+  text_range line;
+  while (row_count < max_rows && _lines.next(line)) {
+    text_range row;
+    if (trim_line(line.first, line.second, '#', row)) {
+      parse_row(row, features + row_count * _feature_count, targets + row_count * _target_count);
+      ++row_count;
+    }
+  }
+  return row_count;
+}
+
+void libsvm_dataset::parse_row(const text_range& row, float* features, float* targets) const {
+  std::fill(features, features + _feature_count, 0.0f);
+  std::fill(targets, targets + _target_count, 0.0f);
+
+  // comma separated labels
+  const char* labels_end = token_end(row.first, row.second);
+  size_t label = 0U;
+  for (const char* value = row.first;; ++label) {
+    const char* value_end = std::find(value, labels_end, ',');
+    float parsed = 0.0f;
+    if (!parse_float(value, value_end, parsed)) {
+      throw exception("Invalid label '" + std::string(value, value_end) + "'.");
+    }
+    if (label < _target_count) {
+      targets[label] = parsed;
+    }
+    if (value_end == labels_end) {
+      break;
+    }
+    value = value_end + 1;
+  }
+
+  // index:value pairs
+  for (const char* token = token_begin(labels_end, row.second); token < row.second;
+       token = token_begin(token, row.second)) {
+    const char* end_of_token = token_end(token, row.second);
+    const char* separator = std::find(token, end_of_token, ':');
+    uint32_t index = 0U;
+    float value = 0.0f;
+    if (separator == end_of_token || !parse_index(token, separator, index) ||
+        !parse_float(separator + 1, end_of_token, value)) {
+      throw exception("Invalid feature '" + std::string(token, end_of_token) + "'.");
+    }
+    if (index <= _feature_count) {
+      features[index - 1U] = value;
+    }
+    token = end_of_token;
+  }
+}
+}
+}
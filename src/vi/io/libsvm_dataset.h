@@ -0,0 +1,46 @@
+#ifndef __vinn__libsvm_dataset__
+#define __vinn__libsvm_dataset__
+
+#include <vi/io/text_parser.h>
+#include <vi/nn/dataset.h>
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace vi {
+namespace io {
+
+/// Stream examples from the libsvm format, features become dense rows.
+/// The stream is read in blocks as examples are requested, so the number of
+/// features has to be given up front instead of being found by a full pass.
+class libsvm_dataset : public vi::nn::dataset {
+public:
+  class exception : public std::runtime_error {
+  public:
+    exception(const std::string& text) : runtime_error(text) {}
+  };
+
+  /// \param feature_count features per example, larger indices are ignored
+  /// \param target_count labels per example, missing labels are 0 and extra ones ignored
+  libsvm_dataset(std::istream& stream, size_t feature_count, size_t target_count = 1U);
+
+  size_t feature_count() const;
+  size_t target_count() const;
+
+  void rewind();
+
+  /// \throw exception if a line has an invalid label or feature
+  size_t read(float* features, float* targets, size_t max_rows);
+
+private:
+  void parse_row(const text_range& row, float* features, float* targets) const;
+
+  line_reader _lines;
+  size_t _feature_count;
+  size_t _target_count;
+};
+}
+}
+
+#endif
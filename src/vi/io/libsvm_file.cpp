@@ -1,11 +1,25 @@
 #include "vi/io/libsvm_file.h"
 
-#include <fstream>
-#include <iostream>
-#include <sstream>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <future>
 #include <string>
 #include <vector>
-#include <cassert>
+
+namespace {
+
+/// Stream bytes read at a time, split between the parser threads
+const size_t block_size = 1U << 24;
+
+/// \return matrix of zeros, filled in place without a temporary copy of the values
+vi::la::matrix zeros(vi::la::context& context, size_t rows, size_t columns) {
+  const float* no_values = nullptr;
+  vi::la::matrix zeros(context, no_values, rows, columns);
+  std::fill_n(zeros[0U], rows * columns, 0.0f);
+  return zeros;
+}
+}
 
 namespace vi {
 namespace io {
@@ -14,107 +28,257 @@ libsvm_file::libsvm_file(std::iostream& stream) : _stream(stream) {}
 
 std::pair<vi::la::matrix, vi::la::matrix>
 libsvm_file::load_labels_and_features(vi::la::context& context, size_t max_feature_count) {
+  rewind();
+  line_reader lines(_stream, block_size);
+  const chunk_counts totals = count_stream(lines, max_feature_count == 0U);
+  const size_t feature_count =
+      max_feature_count != 0U ? max_feature_count : std::max<size_t>(totals.feature_count, 1U);
+
+  vi::la::matrix labels = zeros(context, totals.row_count, totals.largest_label_count);
+  vi::la::matrix features = zeros(context, totals.row_count, feature_count);
+  contents parsed;
+  parsed.label_values = labels[0U];
+  parsed.label_column_count = totals.largest_label_count;
+  parsed.feature_values = features[0U];
+  parsed.feature_column_count = feature_count;
+  lines.rewind();
+  parse_stream(lines, feature_count, parsed);
+  return std::make_pair(labels, features);
+}
+
+std::pair<vi::la::matrix, vi::la::sparse_matrix>
+libsvm_file::load_labels_and_sparse_features(vi::la::context& context,
+                                             size_t max_feature_count) {
+  rewind();
+  line_reader lines(_stream, block_size);
+  const chunk_counts totals = count_stream(lines, false);
+
+  vi::la::matrix labels = zeros(context, totals.row_count, totals.largest_label_count);
+  contents parsed;
+  parsed.label_values = labels[0U];
+  parsed.label_column_count = totals.largest_label_count;
+  parsed.feature_values = nullptr;
+  parsed.feature_column_count = 0U;
+  parsed.row_offsets.resize(totals.row_count + 1U);
+  parsed.column_indices.resize(totals.entry_count);
+  parsed.values.resize(totals.entry_count);
+  lines.rewind();
+  parse_stream(lines, max_feature_count, parsed);
+
+  const size_t feature_count =
+      max_feature_count != 0U ? max_feature_count : std::max<size_t>(parsed.feature_count, 1U);
+  vi::la::sparse_matrix features(totals.row_count, feature_count, std::move(parsed.row_offsets),
+                                 std::move(parsed.column_indices), std::move(parsed.values));
+  return std::make_pair(labels, std::move(features));
+}
+
+void libsvm_file::rewind() {
   _stream.exceptions(std::iostream::badbit);
+  _stream.clear();
   _stream.seekg(0U);
+}
 
-  size_t largest_feature_index(0U);
-  size_t largest_label_index(0U);
-  labels_and_features_vector rows =
-      parse_contents(largest_label_index, largest_feature_index, max_feature_count);
+libsvm_file::chunk_counts libsvm_file::count_stream(line_reader& lines,
+                                                    bool find_features) const {
+  chunk_counts totals = {0U, 0U, 0U, 0U};
+  text_range block;
+  while (lines.next_lines(block)) {
+    for (const chunk_counts& chunk :
+         count_chunks(split_lines(block, parser_thread_count()), find_features)) {
+      totals.row_count += chunk.row_count;
+      totals.entry_count += chunk.entry_count;
+      totals.largest_label_count = std::max(totals.largest_label_count, chunk.largest_label_count);
+      totals.feature_count = std::max(totals.feature_count, chunk.feature_count);
+    }
+  }
+  if (totals.row_count == 0U) {
+    throw exception("libsvm stream contains no rows.");
+  }
+  return totals;
+}
 
-  if (max_feature_count != 0U) {
-    largest_feature_index = max_feature_count - 1U;
+std::vector<libsvm_file::chunk_counts>
+libsvm_file::count_chunks(const std::vector<text_range>& chunks, bool find_features) const {
+  // starting a thread takes longer than counting a small chunk
+  if (chunks.size() == 1U) {
+    return std::vector<chunk_counts>(1U, count_chunk(chunks[0], find_features));
   }
-  size_t row_count = rows.size();
+  std::vector<std::future<chunk_counts>> counting;
+  for (const text_range& chunk : chunks) {
+    counting.push_back(std::async(std::launch::async, &libsvm_file::count_chunk, this,
+                                  std::cref(chunk), find_features));
+  }
+  std::vector<chunk_counts> counts;
+  for (std::future<chunk_counts>& chunk : counting) {
+    counts.push_back(chunk.get());
+  }
+  return counts;
+}
 
-  vi::la::matrix labels(context, row_count, largest_label_index + 1);
-  vi::la::matrix features(context, row_count, largest_feature_index + 1);
-  fill_from_sparse_data(rows, labels, features);
+libsvm_file::chunk_counts libsvm_file::count_chunk(const text_range& chunk,
+                                                   bool find_features) const {
+  chunk_counts counts = {0U, 0U, 0U, 0U};
+  for (const char* line = chunk.first; line < chunk.second;) {
+    const char* end = line_end(line, chunk.second);
+    text_range row;
+    if (trim_line(line, end, '#', row)) {
+      const char* labels_end = token_end(row.first, row.second);
+      const size_t label_count = 1U + std::count(row.first, labels_end, ',');
+      ++counts.row_count;
+      counts.largest_label_count = std::max(counts.largest_label_count, label_count);
+      counts.entry_count += std::count(labels_end, row.second, ':');
 
-  return std::make_pair(labels, features);
+      // invalid entries are reported by the parser
+      for (const char* token = token_begin(labels_end, row.second);
+           find_features && token < row.second; token = token_begin(token, row.second)) {
+        const char* end_of_token = token_end(token, row.second);
+        uint32_t index = 0U;
+        if (parse_index(token, std::find(token, end_of_token, ':'), index)) {
+          counts.feature_count = std::max<size_t>(counts.feature_count, index);
+        }
+        token = end_of_token;
+      }
+    }
+    line = end + 1;
+  }
+  return counts;
 }
 
-void libsvm_file::fill_from_sparse_data(labels_and_features_vector sparse_data,
-                                        vi::la::matrix& labels, vi::la::matrix& features) {
-  for (size_t m = 0U; m < sparse_data.size(); ++m) {
-    auto row = sparse_data[m];
-    for (size_t i = 0U; i < row.first.size(); ++i) {
-      labels[m][i] = row.first[i];
+void libsvm_file::parse_stream(line_reader& lines, size_t max_feature_count,
+                               contents& parsed) const {
+  // where the next chunk starts, entries by their upper bound
+  chunk_counts offsets = {0U, 0U, 0U, 0U};
+  size_t entry_count = 0U;
+  parsed.feature_count = 0U;
+  text_range block;
+  while (lines.next_lines(block)) {
+    const std::vector<text_range> chunks = split_lines(block, parser_thread_count());
+    const std::vector<chunk_counts> counts = count_chunks(chunks, false);
+    std::vector<chunk_counts> chunk_offsets;
+    for (const chunk_counts& chunk : counts) {
+      chunk_offsets.push_back(offsets);
+      offsets.row_count += chunk.row_count;
+      offsets.entry_count += chunk.entry_count;
     }
 
-    for (const sparse_entry& entry : row.second) {
-      size_t column = entry.first;
-      float value = entry.second;
-      features[m][column] = value;
+    std::vector<std::future<chunk_counts>> parsing;
+    for (size_t i = 0U; i < chunks.size(); ++i) {
+      parsing.push_back(std::async(std::launch::async, &libsvm_file::parse_chunk, this,
+                                   std::cref(chunks[i]), std::cref(chunk_offsets[i]),
+                                   max_feature_count, std::ref(parsed)));
+    }
+    // wait for all parsers before rethrowing the first failure
+    for (std::future<chunk_counts>& chunk : parsing) {
+      chunk.wait();
     }
-  }
-}
 
-libsvm_file::labels_and_features_vector
-libsvm_file::parse_contents(size_t& largest_label_index, size_t& largest_feature_index,
-                            const size_t max_feature_count) {
-  labels_and_features_vector rows;
-
-  std::string line;
-  while (std::getline(_stream, line, '\n')) {
-    size_t rows_largest_index(0U);
-    labels_and_features_row row = parse_row(line, rows_largest_index, max_feature_count);
-    largest_feature_index = std::max(largest_feature_index, rows_largest_index);
-    largest_label_index = std::max(largest_label_index, row.first.size() - 1);
-    rows.push_back(row);
+    // close the gaps left by entries beyond max_feature_count, dense features leave none
+    for (size_t i = 0U; i < chunks.size(); ++i) {
+      const chunk_counts chunk = parsing[i].get();
+      parsed.feature_count = std::max(parsed.feature_count, chunk.feature_count);
+      if (parsed.feature_values) {
+        continue;
+      }
+      const size_t gap = chunk_offsets[i].entry_count - entry_count;
+      if (gap != 0U) {
+        std::memmove(&parsed.column_indices[entry_count],
+                     &parsed.column_indices[chunk_offsets[i].entry_count],
+                     chunk.entry_count * sizeof(uint32_t));
+        std::memmove(&parsed.values[entry_count], &parsed.values[chunk_offsets[i].entry_count],
+                     chunk.entry_count * sizeof(float));
+        for (size_t row = 0U; row < chunk.row_count; ++row) {
+          parsed.row_offsets[chunk_offsets[i].row_count + row] -= gap;
+        }
+      }
+      entry_count += chunk.entry_count;
+    }
   }
 
-  return rows;
+  if (parsed.feature_values) {
+    return;
+  }
+  parsed.row_offsets.back() = entry_count;
+  if (entry_count != parsed.values.size()) {
+    parsed.column_indices.resize(entry_count);
+    parsed.column_indices.shrink_to_fit();
+    parsed.values.resize(entry_count);
+    parsed.values.shrink_to_fit();
+  }
 }
 
-libsvm_file::labels_and_features_row libsvm_file::parse_row(const std::string& line,
-                                                            size_t& largest_feature_index,
-                                                            const size_t max_feature_count) const {
-  // chop off trailing comments
-  std::string row;
-  std::istringstream line_stream(line);
-  std::getline(line_stream, row, '#');
-
-  std::istringstream row_stream(row);
-  std::string element;
-  labels_and_features_row labels_and_features;
-  bool label_section(true);
-  while (std::getline(row_stream, element, ' ')) {
-    if (label_section) {
-      std::istringstream label_stream(element);
-      std::string label_string;
-      while (std::getline(label_stream, label_string, ',')) {
-        float label = std::stof(label_string);
-        labels_and_features.first.push_back(label);
+libsvm_file::chunk_counts libsvm_file::parse_chunk(const text_range& chunk,
+                                                   const chunk_counts& offsets,
+                                                   size_t max_feature_count,
+                                                   contents& parsed) const {
+  size_t row = offsets.row_count;
+  size_t entry = offsets.entry_count;
+  chunk_counts counts = {0U, 0U, 0U, 0U};
+
+  for (const char* line = chunk.first; line < chunk.second;) {
+    const char* end = line_end(line, chunk.second);
+    text_range row_text;
+    if (!trim_line(line, end, '#', row_text)) {
+      line = end + 1;
+      continue;
+    }
+
+    // comma separated labels
+    float* labels = parsed.label_values + row * parsed.label_column_count;
+    const char* labels_end = token_end(row_text.first, row_text.second);
+    size_t label = 0U;
+    for (const char* value = row_text.first;; ++label) {
+      const char* value_end = std::find(value, labels_end, ',');
+      if (!parse_float(value, value_end, labels[label])) {
+        throw exception("Invalid label '" + std::string(value, value_end) + "'.");
       }
-      label_section = false;
-    } else {
-      std::istringstream value_stream(element);
-      std::string value_string;
-      bool is_index(true);
-      size_t index(0);
-      float value(0.0);
-
-      while (std::getline(value_stream, value_string, ':')) {
-        if (is_index) {
-          index = std::stoull(value_string) - 1;
-          is_index = false;
-        } else {
-          value = std::stof(value_string);
-        }
+      if (value_end == labels_end) {
+        ++label;
+        break;
       }
+      value = value_end + 1;
+    }
 
-      if (max_feature_count != 0U && index >= max_feature_count) {
+    // index:value pairs
+    float* features = parsed.feature_values
+                          ? parsed.feature_values + row * parsed.feature_column_count
+                          : nullptr;
+    if (!features) {
+      parsed.row_offsets[row] = entry;
+    }
+    for (const char* token = token_begin(labels_end, row_text.second); token < row_text.second;
+         token = token_begin(token, row_text.second)) {
+      const char* end_of_token = token_end(token, row_text.second);
+      const char* separator = std::find(token, end_of_token, ':');
+      uint32_t index = 0U;
+      float value = 0.0f;
+      if (separator == end_of_token || !parse_index(token, separator, index) ||
+          !parse_float(separator + 1, end_of_token, value)) {
+        throw exception("Invalid feature '" + std::string(token, end_of_token) + "'.");
+      }
+      token = end_of_token;
+
+      if (max_feature_count != 0U && index > max_feature_count) {
         // user limited number of features to load
         continue;
       }
-      largest_feature_index = std::max(largest_feature_index, index);
-      sparse_entry feature(index, value);
-      labels_and_features.second.push_back(feature);
+      if (features) {
+        features[index - 1U] = value;
+      } else {
+        parsed.column_indices[entry] = index - 1U;
+        parsed.values[entry] = value;
+        ++entry;
+      }
+      counts.feature_count = std::max<size_t>(counts.feature_count, index);
     }
+
+    counts.largest_label_count = std::max(counts.largest_label_count, label);
+    ++row;
+    line = end + 1;
   }
 
-  return labels_and_features;
+  counts.row_count = row - offsets.row_count;
+  counts.entry_count = entry - offsets.entry_count;
+  return counts;
 }
 }
 }
@@ -1,8 +1,11 @@
 #ifndef __vinn__libsvm__file__
 #define __vinn__libsvm__file__
 
+#include <vi/io/text_parser.h>
 #include <vi/la/matrix.h>
+#include <vi/la/sparse_matrix.h>
 #include <iostream>
+#include <stdexcept>
 #include <vector>
 
 namespace vi {
@@ -10,27 +13,67 @@ namespace io {
 
 /// Load sparse label and feature matrices stored in the libsvm format
 /// http://www.csie.ntu.edu.tw/~cjlin/libsvm/
+/// The stream is read twice in large blocks of whole lines, once to size the
+/// results and once to parse the blocks straight into them. Each block is split
+/// into chunks that are parsed concurrently. Dense features are written into
+/// the feature matrix directly, sparse ones into compressed sparse row arrays.
 class libsvm_file {
 public:
+  class exception : public std::runtime_error {
+  public:
+    exception(const std::string& text) : runtime_error(text) {}
+  };
+
   /// Construct with an input stream
   libsvm_file(std::iostream& stream);
 
-  /// Load labels and features
+  /// Load labels and features into dense matrices
+  /// \throw exception if the stream contains no rows or an invalid entry
   std::pair<vi::la::matrix, vi::la::matrix> load_labels_and_features(vi::la::context& context,
                                                                      size_t max_feature_count = 0U);
 
+  /// Load labels into a dense matrix and features into a sparse matrix, so
+  /// that memory use is proportional to the number of stored features
+  /// \throw exception if the stream contains no rows or an invalid entry
+  std::pair<vi::la::matrix, vi::la::sparse_matrix>
+  load_labels_and_sparse_features(vi::la::context& context, size_t max_feature_count = 0U);
+
 private:
-  typedef std::pair<size_t, float> sparse_entry;
-  typedef std::pair<std::vector<float>, std::vector<sparse_entry>> labels_and_features_row;
-  typedef std::vector<labels_and_features_row> labels_and_features_vector;
-
-  void fill_from_sparse_data(labels_and_features_vector sparse_data, vi::la::matrix& labels,
-                             vi::la::matrix& features);
-  labels_and_features_vector parse_contents(size_t& largest_label_index,
-                                            size_t& largest_feature_index,
-                                            const size_t max_feature_index);
-  labels_and_features_row parse_row(const std::string& line, size_t& largest_feature_index,
-                                    const size_t max_feature_index) const;
+  /// Sizes of a chunk, upper bounds for entries until the chunk is parsed
+  struct chunk_counts {
+    size_t row_count;
+    size_t entry_count;
+    size_t largest_label_count;
+    size_t feature_count;
+  };
+
+  /// Destination of the parsed rows. Features go into the dense values if they
+  /// are set and into the compressed sparse row arrays otherwise.
+  struct contents {
+    float* label_values;
+    size_t label_column_count;
+    float* feature_values;
+    size_t feature_column_count;
+    std::vector<size_t> row_offsets;
+    std::vector<uint32_t> column_indices;
+    std::vector<float> values;
+    /// Largest feature index parsed
+    size_t feature_count;
+  };
+
+  /// Rewind the stream, a previous load leaves it at its end
+  void rewind();
+  /// \param find_features find the largest feature index, which parsing finds otherwise
+  /// \throw exception if the stream contains no rows
+  chunk_counts count_stream(line_reader& lines, bool find_features) const;
+  /// Count the chunks concurrently
+  std::vector<chunk_counts> count_chunks(const std::vector<text_range>& chunks,
+                                         bool find_features) const;
+  chunk_counts count_chunk(const text_range& chunk, bool find_features) const;
+  /// Parse the stream into contents sized by count_stream
+  void parse_stream(line_reader& lines, size_t max_feature_count, contents& parsed) const;
+  chunk_counts parse_chunk(const text_range& chunk, const chunk_counts& offsets,
+                           size_t max_feature_count, contents& parsed) const;
 
   std::iostream& _stream;
 };
@@ -0,0 +1,62 @@
+#include "vi/io/mapped_file.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace vi {
+namespace io {
+
+mapped_file::mapped_file(const std::string& path) : _data(nullptr), _size(0U) {
+  const int descriptor = ::open(path.c_str(), O_RDONLY);
+  if (descriptor < 0) {
+    throw exception("Cannot open '" + path + "': " + std::strerror(errno) + ".");
+  }
+
+  struct stat status;
+  if (::fstat(descriptor, &status) != 0) {
+    const int error = errno;
+    ::close(descriptor);
+    throw exception("Cannot read size of '" + path + "': " + std::strerror(error) + ".");
+  }
+  _size = static_cast<size_t>(status.st_size);
+
+  if (_size != 0U) {
+    // writable private pages let adopted matrices be modified without touching the file
+    void* mapping = ::mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_PRIVATE, descriptor, 0);
+    if (mapping == MAP_FAILED) {
+      const int error = errno;
+      ::close(descriptor);
+      throw exception("Cannot map '" + path + "': " + std::strerror(error) + ".");
+    }
+    _data = static_cast<char*>(mapping);
+  }
+  // the mapping stays valid after the descriptor is closed
+  ::close(descriptor);
+}
+
+mapped_file::~mapped_file() {
+  if (_data) {
+    ::munmap(_data, _size);
+  }
+}
+
+char* mapped_file::data() const { return _data; }
+
+size_t mapped_file::size() const { return _size; }
+
+void mapped_file::release(size_t offset, size_t size) const {
+  // only whole pages inside the range can be dropped
+  const size_t page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+  const size_t begin = (offset + page_size - 1U) / page_size * page_size;
+  const size_t end = std::min(offset + size, _size) / page_size * page_size;
+  if (begin < end) {
+    ::madvise(_data + begin, end - begin, MADV_DONTNEED);
+  }
+}
+}
+}
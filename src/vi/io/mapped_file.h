@@ -0,0 +1,41 @@
+#ifndef __vinn__mapped_file__
+#define __vinn__mapped_file__
+
+#include <stdexcept>
+#include <string>
+
+namespace vi {
+namespace io {
+
+/// Private, copy-on-write memory mapping of a whole file. Pages are read from
+/// the file on first access and writes are never written back to it.
+class mapped_file {
+public:
+  class exception : public std::runtime_error {
+  public:
+    exception(const std::string& text) : runtime_error(text) {}
+  };
+
+  /// \throw exception if the file cannot be opened or mapped
+  mapped_file(const std::string& path);
+  ~mapped_file();
+
+  mapped_file(const mapped_file&) = delete;
+  mapped_file& operator=(const mapped_file&) = delete;
+
+  /// Start of the mapping, page aligned, nullptr for an empty file
+  char* data() const;
+  size_t size() const;
+
+  /// Drop the resident pages of a range, they are read from the file again on the next access.
+  /// Modified pages lose their modifications.
+  void release(size_t offset, size_t size) const;
+
+private:
+  char* _data;
+  size_t _size;
+};
+}
+}
+
+#endif
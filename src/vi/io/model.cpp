@@ -2,6 +2,7 @@
 #include "vi/io/csv_file.h"
 #include "vi/io/network_deserializer.h"
 #include "vi/io/network_serializer.h"
+#include "vi/io/weight_file.h"
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/fstream.hpp>
 #include <boost/property_tree/json_parser.hpp>
@@ -13,7 +14,8 @@ namespace vi {
 namespace io {
 model::model(const std::string& path) : path_(path) {}
 
-void model::load(vi::nn::network& network, vi::la::context& context) {
+void model::load(vi::nn::network& network, vi::la::context& context,
+                 weight_file::verification verify) {
   if (!fs::is_directory(model_dir_path())) {
     std::stringstream description;
     description << "Not a model directory: '" << model_dir_path() << "'";
@@ -30,24 +32,36 @@ void model::load(vi::nn::network& network, vi::la::context& context) {
     deserializer.deserialize(network_node, context);
 
     size_t layer_index = 0;
-    for (std::shared_ptr<vi::nn::layer> layer : network) {
-      fs::fstream file_stream(layer_path(layer_index).string(), std::ios::in);
-
-      vi::la::matrix weights(context, 1, 1);
-      vi::io::csv_file weight_file(file_stream);
-      weight_file.load(weights);
-      layer->weights(weights);
-
+    for (const std::shared_ptr<vi::nn::layer>& layer : network) {
+      layer->weights(load_weights(layer_index, context, verify));
       ++layer_index;
     }
   } catch (pt::ptree_bad_path& e) {
     std::stringstream description;
     description << "Invalid model description: '" << e.what() << "'";
     throw model::exception(description.str());
+  } catch (weight_file::exception& e) {
+    std::stringstream description;
+    description << "Invalid layer weights: '" << e.what() << "'";
+    throw model::exception(description.str());
+  }
+}
+
+vi::la::matrix model::load_weights(size_t layer_index, vi::la::context& context,
+                                   weight_file::verification verify) const {
+  const fs::path binary_path = layer_path(layer_index, weight_format::binary);
+  if (fs::exists(binary_path)) {
+    return weight_file(binary_path.string()).load(context, verify);
   }
+
+  fs::fstream file_stream(layer_path(layer_index, weight_format::csv).string(), std::ios::in);
+  vi::la::matrix weights(context, 1, 1);
+  vi::io::csv_file weight_file(file_stream);
+  weight_file.load(weights);
+  return weights;
 }
 
-void model::store(const vi::nn::network& network) {
+void model::store(const vi::nn::network& network, weight_format format) {
   if (fs::exists(model_dir_path())) {
     fs::remove_all(model_dir_path());
   }
@@ -64,11 +78,15 @@ void model::store(const vi::nn::network& network) {
 
   fs::create_directory(model_data_dir_path());
   size_t layer_index = 0U;
-  for (const std::shared_ptr<vi::nn::layer> layer : network) {
-    fs::fstream file_stream(layer_path(layer_index), std::ios::out | std::ios::trunc);
-
-    vi::io::csv_file weight_file(file_stream);
-    weight_file.store(layer->weights());
+  for (const std::shared_ptr<vi::nn::layer>& layer : network) {
+    const fs::path path = layer_path(layer_index, format);
+    if (format == weight_format::binary) {
+      weight_file(path.string()).store(layer->weights());
+    } else {
+      fs::fstream file_stream(path, std::ios::out | std::ios::trunc);
+      vi::io::csv_file weight_file(file_stream);
+      weight_file.store(layer->weights());
+    }
     ++layer_index;
   }
 }
@@ -81,9 +99,9 @@ boost::filesystem::path model::model_description_path() const {
 
 boost::filesystem::path model::model_data_dir_path() const { return model_dir_path() /= "data"; }
 
-boost::filesystem::path model::layer_path(size_t layer_index) const {
+boost::filesystem::path model::layer_path(size_t layer_index, weight_format format) const {
   std::stringstream file_name;
-  file_name << layer_index << ".csv";
+  file_name << layer_index << (format == weight_format::binary ? ".weights" : ".csv");
   return model_data_dir_path() /= file_name.str();
 }
 }
@@ -1,6 +1,7 @@
 #ifndef __vinn__model__
 #define __vinn__model__
 
+#include <vi/io/weight_file.h>
 #include <vi/la/context.h>
 #include <vi/nn/network.h>
 #include <string>
@@ -16,10 +17,22 @@ public:
     exception(const std::string& text) : runtime_error(text) {}
   };
 
+  /// Storage format of layer weights
+  enum class weight_format {
+    /// Memory mapped binary files, see weight_file
+    binary,
+    /// Comma separated text files for exporting to other tools
+    csv
+  };
+
   model(const std::string& path);
 
-  void load(vi::nn::network& network, vi::la::context& context);
-  void store(const vi::nn::network& network);
+  /// Layers stored in either format are loaded, binary weights are used in place
+  /// without copying where the context allows
+  /// \param verify checking the checksums of binary weights reads all of them
+  void load(vi::nn::network& network, vi::la::context& context,
+            weight_file::verification verify = weight_file::verification::header);
+  void store(const vi::nn::network& network, weight_format format = weight_format::binary);
 
 private:
   const std::string path_;
@@ -28,7 +41,9 @@ private:
   boost::filesystem::path model_description_path() const;
 
   boost::filesystem::path model_data_dir_path() const;
-  boost::filesystem::path layer_path(size_t layer_index) const;
+  boost::filesystem::path layer_path(size_t layer_index, weight_format format) const;
+  vi::la::matrix load_weights(size_t layer_index, vi::la::context& context,
+                              weight_file::verification verify) const;
 };
 }
 }
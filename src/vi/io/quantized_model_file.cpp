@@ -0,0 +1,192 @@
+#include "vi/io/quantized_model_file.h"
+#include "vi/io/activation_name.h"
+#include "vi/io/checksum.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace {
+
+const char magic[8] = {'V', 'I', 'N', 'N', 'Q', 'N', 'T', '\0'};
+const uint32_t current_version = 1U;
+/// Reads back as a different value on a machine of the other endianness
+const uint32_t byte_order_mark = 0x01020304U;
+/// Layer records start after the header
+const size_t data_offset = 64U;
+
+/// Fixed size part of a layer record
+struct layer_record {
+  uint64_t input_count;
+  uint64_t output_count;
+  float input_scale;
+  int32_t input_zero_point;
+  uint32_t activation_name_size;
+  uint32_t reserved;
+};
+
+template <typename T> void append(std::string& data, const T* values, size_t count) {
+  data.append(reinterpret_cast<const char*>(values), count * sizeof(T));
+}
+
+/// Reads values from the data of a file, throwing once it runs out
+class record_reader {
+public:
+  record_reader(const std::string& data, const std::string& path)
+      : _data(data), _path(path), _position(0U) {}
+
+  template <typename T> void read(T* values, size_t count) {
+    if (count > (_data.size() - _position) / sizeof(T)) {
+      throw vi::io::quantized_model_file::exception("Quantized model file '" + _path +
+                                                    "' is truncated.");
+    }
+    std::memcpy(values, _data.data() + _position, count * sizeof(T));
+    _position += count * sizeof(T);
+  }
+
+  bool finished() const { return _position == _data.size(); }
+
+private:
+  const std::string& _data;
+  const std::string& _path;
+  size_t _position;
+};
+}
+
+namespace vi {
+namespace io {
+
+quantized_model_file::quantized_model_file(const std::string& path) : _path(path) {
+  static_assert(sizeof(header) <= data_offset, "Header must fit before the layers");
+}
+
+vi::nn::quantized_network quantized_model_file::load() const {
+  std::ifstream file(_path, std::ios::in | std::ios::binary);
+  if (!file) {
+    throw exception("Cannot read quantized model file '" + _path + "'.");
+  }
+  const std::string contents((std::istreambuf_iterator<char>(file)),
+                             std::istreambuf_iterator<char>());
+  if (contents.size() < data_offset) {
+    throw exception("Quantized model file '" + _path + "' is truncated.");
+  }
+
+  header file_header;
+  std::memcpy(&file_header, contents.data(), sizeof(file_header));
+  validate(file_header, contents.size());
+  const std::string data = contents.substr(data_offset, file_header.data_size);
+  if (vi::io::checksum(data.data(), data.size()) != file_header.checksum) {
+    throw exception("Quantized model file '" + _path + "' is corrupted, checksum does not match.");
+  }
+
+  vi::nn::quantized_network network;
+  record_reader reader(data, _path);
+  for (uint64_t layer_index = 0U; layer_index < file_header.layer_count; ++layer_index) {
+    layer_record record;
+    reader.read(&record, 1U);
+    if (record.input_count == 0U || record.output_count == 0U ||
+        record.input_count > data.size() / record.output_count || !(record.input_scale > 0.0f) ||
+        record.input_zero_point < 0 ||
+        record.input_zero_point > vi::nn::quantization_parameters::maximum_value) {
+      throw exception("Quantized model file '" + _path + "' has an invalid layer.");
+    }
+
+    std::string name(record.activation_name_size, '\0');
+    reader.read(&name[0], name.size());
+
+    vi::nn::quantized_network::layer_parameters parameters;
+    parameters.input_parameters =
+        vi::nn::quantization_parameters(record.input_scale, record.input_zero_point);
+    parameters.input_count = record.input_count;
+    parameters.output_count = record.output_count;
+    parameters.weight_scales.resize(parameters.output_count);
+    parameters.biases.resize(parameters.output_count);
+    parameters.weights.resize(parameters.output_count * parameters.input_count);
+    reader.read(parameters.weight_scales.data(), parameters.weight_scales.size());
+    reader.read(parameters.biases.data(), parameters.biases.size());
+    reader.read(parameters.weights.data(), parameters.weights.size());
+    parameters.activation = activation_for_name(name);
+    if (!parameters.activation) {
+      throw exception("Quantized model file '" + _path + "' has invalid activation type '" +
+                      name + "'.");
+    }
+
+    try {
+      network.add(parameters);
+    } catch (vi::nn::invalid_configuration& e) {
+      throw exception("Quantized model file '" + _path + "' has an invalid layer: " + e.what());
+    }
+  }
+  if (!reader.finished()) {
+    throw exception("Quantized model file '" + _path + "' has trailing data.");
+  }
+  return network;
+}
+
+void quantized_model_file::validate(const header& file_header, size_t file_size) const {
+  if (std::memcmp(file_header.magic, magic, sizeof(magic)) != 0) {
+    throw exception("'" + _path + "' is not a quantized model file.");
+  }
+  if (file_header.version != current_version) {
+    throw exception("Quantized model file '" + _path + "' has unsupported version " +
+                    std::to_string(file_header.version) + ".");
+  }
+  if (file_header.byte_order != byte_order_mark) {
+    throw exception("Quantized model file '" + _path +
+                    "' was written with a different byte order.");
+  }
+  if (file_header.layer_count == 0U) {
+    throw exception("Quantized model file '" + _path + "' has no layers.");
+  }
+  if (file_header.data_size != file_size - data_offset) {
+    throw exception("Quantized model file '" + _path + "' is truncated.");
+  }
+}
+
+void quantized_model_file::store(const vi::nn::quantized_network& network) const {
+  std::string data;
+  for (size_t layer_index = 0U; layer_index < network.size(); ++layer_index) {
+    const vi::nn::quantized_network::layer_parameters parameters =
+        network.parameters(layer_index);
+    const std::string name = activation_name(*parameters.activation);
+    if (name.empty()) {
+      throw exception("Cannot store quantized model file '" + _path +
+                      "', a layer has an activation that can not be stored.");
+    }
+
+    layer_record record;
+    std::memset(&record, 0, sizeof(record));
+    record.input_count = parameters.input_count;
+    record.output_count = parameters.output_count;
+    record.input_scale = parameters.input_parameters.scale();
+    record.input_zero_point = parameters.input_parameters.zero_point();
+    record.activation_name_size = static_cast<uint32_t>(name.size());
+    append(data, &record, 1U);
+    append(data, name.data(), name.size());
+    append(data, parameters.weight_scales.data(), parameters.weight_scales.size());
+    append(data, parameters.biases.data(), parameters.biases.size());
+    append(data, parameters.weights.data(), parameters.weights.size());
+  }
+
+  header file_header;
+  std::memset(&file_header, 0, sizeof(file_header));
+  std::memcpy(file_header.magic, magic, sizeof(magic));
+  file_header.version = current_version;
+  file_header.byte_order = byte_order_mark;
+  file_header.layer_count = network.size();
+  file_header.data_size = data.size();
+  file_header.checksum = vi::io::checksum(data.data(), data.size());
+
+  char padded_header[data_offset] = {};
+  std::memcpy(padded_header, &file_header, sizeof(file_header));
+
+  std::ofstream file(_path, std::ios::out | std::ios::binary | std::ios::trunc);
+  file.write(padded_header, sizeof(padded_header));
+  file.write(data.data(), static_cast<std::streamsize>(data.size()));
+  file.close();
+  if (!file) {
+    throw exception("Cannot write quantized model file '" + _path + "'.");
+  }
+}
+}
+}
@@ -0,0 +1,50 @@
+#ifndef __vinn__quantized_model_file__
+#define __vinn__quantized_model_file__
+
+#include <vi/nn/quantized_network.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace vi {
+namespace io {
+
+/// Binary file holding an int8 network, so that a model is quantized once and
+/// deployed without the single precision weights or calibration data.
+/// A 64 byte header holding magic, version, byte order, layer count, data size
+/// and a checksum of the data is followed by one record per layer: input and
+/// output counts, input scale and zero point, activation name, weight scales,
+/// biases and the row-major 8-bit weights.
+class quantized_model_file {
+public:
+  class exception : public std::runtime_error {
+  public:
+    exception(const std::string& text) : runtime_error(text) {}
+  };
+
+  quantized_model_file(const std::string& path);
+
+  /// \throw exception if the file is truncated, corrupted or of an unsupported version
+  vi::nn::quantized_network load() const;
+  /// \throw exception if a layer has an activation that can not be stored
+  void store(const vi::nn::quantized_network& network) const;
+
+private:
+  struct header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t layer_count;
+    uint64_t data_size;
+    uint64_t checksum;
+  };
+
+  void validate(const header& header, size_t file_size) const;
+
+  const std::string _path;
+};
+}
+}
+
+#endif
@@ -0,0 +1,287 @@
+#include "vi/io/text_formatter.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+const int mantissa_bits = 23;
+const int exponent_bias = 127;
+const int pow5_inverse_bit_count = 59;
+const int pow5_bit_count = 61;
+
+/// floor(2^(pow5_bits(i) - 1 + pow5_inverse_bit_count) / 5^i) + 1
+const uint64_t pow5_inverse_split[31] = {
+    576460752303423489u, 461168601842738791u, 368934881474191033u, 295147905179352826u,
+    472236648286964522u, 377789318629571618u, 302231454903657294u, 483570327845851670u,
+    386856262276681336u, 309485009821345069u, 495176015714152110u, 396140812571321688u,
+    316912650057057351u, 507060240091291761u, 405648192073033409u, 324518553658426727u,
+    519229685853482763u, 415383748682786211u, 332306998946228969u, 531691198313966350u,
+    425352958651173080u, 340282366920938464u, 544451787073501542u, 435561429658801234u,
+    348449143727040987u, 557518629963265579u, 446014903970612463u, 356811923176489971u,
+    570899077082383953u, 456719261665907162u, 365375409332725730u,
+};
+
+/// The pow5_bit_count most significant bits of 5^i
+const uint64_t pow5_split[48] = {
+    1152921504606846976u, 1441151880758558720u, 1801439850948198400u, 2251799813685248000u,
+    1407374883553280000u, 1759218604441600000u, 2199023255552000000u, 1374389534720000000u,
+    1717986918400000000u, 2147483648000000000u, 1342177280000000000u, 1677721600000000000u,
+    2097152000000000000u, 1310720000000000000u, 1638400000000000000u, 2048000000000000000u,
+    1280000000000000000u, 1600000000000000000u, 2000000000000000000u, 1250000000000000000u,
+    1562500000000000000u, 1953125000000000000u, 1220703125000000000u, 1525878906250000000u,
+    1907348632812500000u, 1192092895507812500u, 1490116119384765625u, 1862645149230957031u,
+    1164153218269348144u, 1455191522836685180u, 1818989403545856475u, 2273736754432320594u,
+    1421085471520200371u, 1776356839400250464u, 2220446049250313080u, 1387778780781445675u,
+    1734723475976807094u, 2168404344971008868u, 1355252715606880542u, 1694065894508600678u,
+    2117582368135750847u, 1323488980084844279u, 1654361225106055349u, 2067951531382569187u,
+    1292469707114105741u, 1615587133892632177u, 2019483917365790221u, 1262177448353618888u,
+};
+
+/// Number of bits of 5^e, 1 for e == 0
+int32_t pow5_bits(int32_t e) { return static_cast<int32_t>((uint32_t(e) * 1217359U) >> 19) + 1; }
+
+/// floor(e * log10(2))
+uint32_t log10_pow2(int32_t e) { return (uint32_t(e) * 78913U) >> 18; }
+
+/// floor(e * log10(5))
+uint32_t log10_pow5(int32_t e) { return (uint32_t(e) * 732923U) >> 20; }
+
+bool multiple_of_power_of_5(uint32_t value, uint32_t p) {
+  uint32_t count = 0U;
+  while (value % 5U == 0U) {
+    value /= 5U;
+    ++count;
+  }
+  return count >= p;
+}
+
+bool multiple_of_power_of_2(uint32_t value, uint32_t p) {
+  return (value & ((1U << p) - 1U)) == 0U;
+}
+
+uint32_t multiply_shift(uint32_t m, uint64_t factor, int32_t shift) {
+  const uint64_t low = uint64_t(m) * uint32_t(factor);
+  const uint64_t high = uint64_t(m) * uint32_t(factor >> 32);
+  return static_cast<uint32_t>(((low >> 32) + high) >> (shift - 32));
+}
+
+/// Shortest decimal digits and exponent of a positive finite float
+void shortest_decimal(uint32_t ieee_mantissa, uint32_t ieee_exponent, uint32_t& digits,
+                      int32_t& exponent) {
+  int32_t e2;
+  uint32_t m2;
+  if (ieee_exponent == 0U) {
+    e2 = 1 - exponent_bias - mantissa_bits - 2;
+    m2 = ieee_mantissa;
+  } else {
+    e2 = static_cast<int32_t>(ieee_exponent) - exponent_bias - mantissa_bits - 2;
+    m2 = (1U << mantissa_bits) | ieee_mantissa;
+  }
+  const bool accept_bounds = (m2 & 1U) == 0U;
+
+  // the value and the halfway points to its neighbours, scaled by 4
+  const uint32_t mv = 4U * m2;
+  const uint32_t mp = 4U * m2 + 2U;
+  const uint32_t mm_shift = ieee_mantissa != 0U || ieee_exponent <= 1U;
+  const uint32_t mm = 4U * m2 - 1U - mm_shift;
+
+  uint32_t vr, vp, vm;
+  int32_t e10;
+  bool vm_trailing_zeros = false;
+  bool vr_trailing_zeros = false;
+  uint32_t last_removed_digit = 0U;
+  if (e2 >= 0) {
+    const uint32_t q = log10_pow2(e2);
+    e10 = static_cast<int32_t>(q);
+    const int32_t k = pow5_inverse_bit_count + pow5_bits(q) - 1;
+    const int32_t i = -e2 + static_cast<int32_t>(q) + k;
+    vr = multiply_shift(mv, pow5_inverse_split[q], i);
+    vp = multiply_shift(mp, pow5_inverse_split[q], i);
+    vm = multiply_shift(mm, pow5_inverse_split[q], i);
+    if (q != 0U && (vp - 1U) / 10U <= vm / 10U) {
+      // the loop below removes at most one digit, compute it directly
+      const int32_t l = pow5_inverse_bit_count + pow5_bits(q - 1U) - 1;
+      last_removed_digit =
+          multiply_shift(mv, pow5_inverse_split[q - 1U], -e2 + static_cast<int32_t>(q) - 1 + l) %
+          10U;
+    }
+    if (q <= 9U) {
+      // only one of mp, mv and mm can be a multiple of 5
+      if (mv % 5U == 0U) {
+        vr_trailing_zeros = multiple_of_power_of_5(mv, q);
+      } else if (accept_bounds) {
+        vm_trailing_zeros = multiple_of_power_of_5(mm, q);
+      } else {
+        vp -= multiple_of_power_of_5(mp, q);
+      }
+    }
+  } else {
+    const uint32_t q = log10_pow5(-e2);
+    e10 = static_cast<int32_t>(q) + e2;
+    const int32_t i = -e2 - static_cast<int32_t>(q);
+    const int32_t k = pow5_bits(i) - pow5_bit_count;
+    int32_t j = static_cast<int32_t>(q) - k;
+    vr = multiply_shift(mv, pow5_split[i], j);
+    vp = multiply_shift(mp, pow5_split[i], j);
+    vm = multiply_shift(mm, pow5_split[i], j);
+    if (q != 0U && (vp - 1U) / 10U <= vm / 10U) {
+      j = static_cast<int32_t>(q) - 1 - (pow5_bits(i + 1) - pow5_bit_count);
+      last_removed_digit = multiply_shift(mv, pow5_split[i + 1], j) % 10U;
+    }
+    if (q <= 1U) {
+      // mv has at least q trailing zero bits
+      vr_trailing_zeros = true;
+      if (accept_bounds) {
+        vm_trailing_zeros = mm_shift == 1U;
+      } else {
+        --vp;
+      }
+    } else if (q < 31U) {
+      vr_trailing_zeros = multiple_of_power_of_2(mv, q - 1U);
+    }
+  }
+
+  // remove digits while the interval still contains a shorter value
+  int32_t removed = 0;
+  if (vm_trailing_zeros || vr_trailing_zeros) {
+    while (vp / 10U > vm / 10U) {
+      vm_trailing_zeros &= vm % 10U == 0U;
+      vr_trailing_zeros &= last_removed_digit == 0U;
+      last_removed_digit = vr % 10U;
+      vr /= 10U;
+      vp /= 10U;
+      vm /= 10U;
+      ++removed;
+    }
+    if (vm_trailing_zeros) {
+      while (vm % 10U == 0U) {
+        vr_trailing_zeros &= last_removed_digit == 0U;
+        last_removed_digit = vr % 10U;
+        vr /= 10U;
+        vp /= 10U;
+        vm /= 10U;
+        ++removed;
+      }
+    }
+    if (vr_trailing_zeros && last_removed_digit == 5U && vr % 2U == 0U) {
+      // exactly halfway, round to even
+      last_removed_digit = 4U;
+    }
+    digits = vr + ((vr == vm && (!accept_bounds || !vm_trailing_zeros)) ||
+                   last_removed_digit >= 5U);
+  } else {
+    while (vp / 10U > vm / 10U) {
+      last_removed_digit = vr % 10U;
+      vr /= 10U;
+      vp /= 10U;
+      vm /= 10U;
+      ++removed;
+    }
+    digits = vr + (vr == vm || last_removed_digit >= 5U);
+  }
+  exponent = e10 + removed;
+}
+
+int digit_count(uint32_t value) {
+  int count = 1;
+  while (value >= 10U) {
+    value /= 10U;
+    ++count;
+  }
+  return count;
+}
+
+/// Write count digits of value ending at end
+void write_digits(uint32_t value, int count, char* end) {
+  for (int i = 0; i < count; ++i) {
+    *--end = static_cast<char>('0' + value % 10U);
+    value /= 10U;
+  }
+}
+
+char* write_exponent(int32_t exponent, char* text) {
+  *text++ = 'e';
+  if (exponent < 0) {
+    *text++ = '-';
+    exponent = -exponent;
+  }
+  const int count = digit_count(static_cast<uint32_t>(exponent));
+  write_digits(static_cast<uint32_t>(exponent), count, text + count);
+  return text + count;
+}
+}
+
+namespace vi {
+namespace io {
+
+char* format_float(float value, char* text) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  const bool negative = (bits >> 31) != 0U;
+  const uint32_t ieee_mantissa = bits & ((1U << mantissa_bits) - 1U);
+  const uint32_t ieee_exponent = (bits >> mantissa_bits) & 0xffU;
+
+  if (ieee_exponent == 0xffU) {
+    if (ieee_mantissa != 0U) {
+      std::memcpy(text, "nan", 3U);
+      return text + 3;
+    }
+    if (negative) {
+      *text++ = '-';
+    }
+    std::memcpy(text, "inf", 3U);
+    return text + 3;
+  }
+  if (negative) {
+    *text++ = '-';
+  }
+  if (ieee_exponent == 0U && ieee_mantissa == 0U) {
+    *text++ = '0';
+    return text;
+  }
+
+  uint32_t digits;
+  int32_t exponent;
+  shortest_decimal(ieee_mantissa, ieee_exponent, digits, exponent);
+  const int count = digit_count(digits);
+  // position of the decimal point relative to the first digit
+  const int point = count + exponent;
+
+  if (exponent >= 0 && point <= 9) {
+    // integer, e.g. 1200
+    write_digits(digits, count, text + count);
+    text += count;
+    std::memset(text, '0', static_cast<size_t>(exponent));
+    return text + exponent;
+  }
+  if (point > 0 && point <= 9) {
+    // e.g. 12.5
+    write_digits(digits, count, text + count + 1);
+    std::memmove(text, text + 1, static_cast<size_t>(point));
+    text[point] = '.';
+    return text + count + 1;
+  }
+  if (point > -5 && point <= 0) {
+    // e.g. 0.0125
+    text[0] = '0';
+    text[1] = '.';
+    std::memset(text + 2, '0', static_cast<size_t>(-point));
+    text += 2 - point;
+    write_digits(digits, count, text + count);
+    return text + count;
+  }
+
+  // e.g. 1.25e-7
+  write_digits(digits, count, text + count + 1);
+  text[0] = text[1];
+  if (count > 1) {
+    text[1] = '.';
+    text += count + 1;
+  } else {
+    text += 1;
+  }
+  return write_exponent(point - 1, text);
+}
+}
+}
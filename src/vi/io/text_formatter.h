@@ -0,0 +1,21 @@
+#ifndef __vinn__text_formatter__
+#define __vinn__text_formatter__
+
+#include <cstddef>
+
+namespace vi {
+namespace io {
+
+/// Longest text written by format_float, e.g. "-1.17549435e-38"
+const size_t max_float_length = 16U;
+
+/// Write the shortest decimal text that parses back to exactly the same
+/// float, following the Ryu algorithm. Values with a moderate exponent are
+/// written in fixed notation, the rest in scientific notation.
+/// \param text room for max_float_length characters, no terminator is written
+/// \return end of the written text
+char* format_float(float value, char* text);
+}
+}
+
+#endif
@@ -0,0 +1,295 @@
+#include "vi/io/text_parser.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+namespace {
+
+/// Powers of ten that are exactly representable as doubles
+const double exact_powers_of_ten[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                      1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                      1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+const int max_exact_exponent = 22;
+const uint64_t max_exact_mantissa = uint64_t(1) << 53;
+const int max_mantissa_digits = 19;
+
+bool is_blank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+bool parse_with_strtof(const char* begin, const char* end, float& value) {
+  const std::string text(begin, end);
+  char* parsed_end = nullptr;
+  errno = 0;
+  value = std::strtof(text.c_str(), &parsed_end);
+  if (parsed_end != text.c_str() + text.size()) {
+    return false;
+  }
+  // std::stof rejects values out of range
+  return errno != ERANGE;
+}
+
+/// Round a correctly rounded double to float. Rounding twice can only differ
+/// from rounding the decimal value once if the double lies exactly halfway
+/// between two floats, i.e. the 29 mantissa bits a float drops are 100...0.
+/// Exact values stay within the range of normal floats.
+bool round_to_float(double exact, float& value) {
+  uint64_t bits;
+  std::memcpy(&bits, &exact, sizeof(bits));
+  const uint64_t dropped_bits = bits & ((uint64_t(1) << 29) - 1U);
+  if (dropped_bits == (uint64_t(1) << 28)) {
+    return false;
+  }
+  value = static_cast<float>(exact);
+  return true;
+}
+}
+
+namespace vi {
+namespace io {
+
+std::vector<text_range> split_lines(const text_range& text, size_t max_chunks,
+                                    size_t min_chunk_size) {
+  const size_t size = static_cast<size_t>(text.second - text.first);
+  size_t chunk_count = std::max<size_t>(1U, std::min(max_chunks, size / min_chunk_size));
+
+  std::vector<text_range> chunks;
+  const char* begin = text.first;
+  for (size_t i = 1U; i < chunk_count && begin < text.second; ++i) {
+    const char* split = std::max(begin, text.first + (size * i) / chunk_count);
+    const char* end = line_end(split, text.second);
+    if (end != text.second) {
+      ++end;
+    }
+    chunks.push_back(text_range(begin, end));
+    begin = end;
+  }
+  if (begin < text.second || chunks.empty()) {
+    chunks.push_back(text_range(begin, text.second));
+  }
+  return chunks;
+}
+
+const char* line_end(const char* begin, const char* end) {
+  const void* newline = std::memchr(begin, '\n', static_cast<size_t>(end - begin));
+  return newline ? static_cast<const char*>(newline) : end;
+}
+
+bool parse_float(const char* begin, const char* end, float& value) {
+  while (begin < end && is_blank(*begin)) {
+    ++begin;
+  }
+  while (end > begin && is_blank(*(end - 1))) {
+    --end;
+  }
+
+  const char* p = begin;
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+')) {
+    negative = *p == '-';
+    ++p;
+  }
+
+  uint64_t mantissa = 0U;
+  int mantissa_digits = 0;
+  int exponent = 0;
+  bool has_digits = false;
+  for (; p < end && is_digit(*p); ++p) {
+    has_digits = true;
+    if (mantissa_digits < max_mantissa_digits) {
+      mantissa = mantissa * 10U + static_cast<uint64_t>(*p - '0');
+      mantissa_digits += mantissa != 0U ? 1 : 0;
+    } else {
+      ++exponent;
+      mantissa_digits = max_mantissa_digits + 1;
+    }
+  }
+  if (p < end && *p == '.') {
+    for (++p; p < end && is_digit(*p); ++p) {
+      has_digits = true;
+      if (mantissa_digits < max_mantissa_digits) {
+        mantissa = mantissa * 10U + static_cast<uint64_t>(*p - '0');
+        mantissa_digits += mantissa != 0U ? 1 : 0;
+        --exponent;
+      } else {
+        mantissa_digits = max_mantissa_digits + 1;
+      }
+    }
+  }
+  if (!has_digits) {
+    // infinity, nan and hexadecimal values
+    return begin < end && parse_with_strtof(begin, end, value);
+  }
+  if (p < end && (*p == 'e' || *p == 'E')) {
+    const char* exponent_start = ++p;
+    bool negative_exponent = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+      negative_exponent = *p == '-';
+      ++p;
+    }
+    int explicit_exponent = 0;
+    for (; p < end && is_digit(*p); ++p) {
+      explicit_exponent = std::min(explicit_exponent * 10 + (*p - '0'), 100000);
+    }
+    if (p == exponent_start || !is_digit(*(p - 1))) {
+      return false;
+    }
+    exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+  }
+  if (p != end) {
+    return false;
+  }
+
+  // digits beyond the mantissa and exponents without an exact power of ten
+  // need a full conversion
+  if (mantissa_digits > max_mantissa_digits || mantissa > max_exact_mantissa ||
+      exponent > max_exact_exponent || exponent < -max_exact_exponent) {
+    return parse_with_strtof(begin, end, value);
+  }
+
+  // an exact mantissa scaled by an exact power of ten is correctly rounded
+  double exact = static_cast<double>(mantissa);
+  exact = exponent < 0 ? exact / exact_powers_of_ten[-exponent]
+                       : exact * exact_powers_of_ten[exponent];
+  if (!round_to_float(negative ? -exact : exact, value)) {
+    return parse_with_strtof(begin, end, value);
+  }
+  return true;
+}
+
+bool trim_line(const char* begin, const char* end, char comment, text_range& contents) {
+  const void* comment_start = std::memchr(begin, comment, static_cast<size_t>(end - begin));
+  if (comment_start) {
+    end = static_cast<const char*>(comment_start);
+  }
+  begin = token_begin(begin, end);
+  while (end > begin && is_blank(*(end - 1))) {
+    --end;
+  }
+  contents = text_range(begin, end);
+  return begin < end;
+}
+
+const char* token_begin(const char* begin, const char* end) {
+  while (begin < end && is_blank(*begin)) {
+    ++begin;
+  }
+  return begin;
+}
+
+const char* token_end(const char* begin, const char* end) {
+  while (begin < end && !is_blank(*begin)) {
+    ++begin;
+  }
+  return begin;
+}
+
+bool parse_index(const char* begin, const char* end, uint32_t& index) {
+  if (begin == end || end - begin > 10) {
+    return false;
+  }
+  uint64_t parsed = 0U;
+  for (const char* p = begin; p < end; ++p) {
+    if (!is_digit(*p)) {
+      return false;
+    }
+    parsed = parsed * 10U + static_cast<uint64_t>(*p - '0');
+  }
+  if (parsed == 0U || parsed > UINT32_MAX) {
+    return false;
+  }
+  index = static_cast<uint32_t>(parsed);
+  return true;
+}
+
+size_t parser_thread_count() {
+  return std::max<size_t>(1U, std::thread::hardware_concurrency());
+}
+
+line_reader::line_reader(std::istream& stream, size_t block_size)
+    : _stream(stream), _start(stream.tellg()), _begin(0U), _end(0U), _end_of_stream(false) {
+  // a stream shorter than a block is read into a buffer of its size
+  if (_start != std::streampos(-1)) {
+    _stream.seekg(0, std::ios::end);
+    const std::streamoff remaining = _stream.tellg() - _start;
+    _stream.seekg(_start);
+    if (remaining >= 0) {
+      block_size = std::min(block_size, static_cast<size_t>(remaining) + 1U);
+    }
+  }
+  _buffer.resize(block_size);
+}
+
+bool line_reader::next(text_range& line) {
+  while (true) {
+    const char* begin = _buffer.data() + _begin;
+    const char* end = _buffer.data() + _end;
+    const char* newline = line_end(begin, end);
+    if (newline != end || (_end_of_stream && begin < end)) {
+      line = text_range(begin, newline);
+      _begin = static_cast<size_t>(newline - _buffer.data()) + (newline != end ? 1U : 0U);
+      return true;
+    }
+    if (!fill()) {
+      return false;
+    }
+  }
+}
+
+bool line_reader::next_lines(text_range& lines) {
+  while (true) {
+    const char* begin = _buffer.data() + _begin;
+    const char* end = _buffer.data() + _end;
+    const char* whole_lines_end = end;
+    while (whole_lines_end > begin && *(whole_lines_end - 1) != '\n') {
+      --whole_lines_end;
+    }
+    if (whole_lines_end > begin || (_end_of_stream && begin < end)) {
+      // the last line of the stream may have no newline
+      if (whole_lines_end == begin) {
+        whole_lines_end = end;
+      }
+      lines = text_range(begin, whole_lines_end);
+      _begin = static_cast<size_t>(whole_lines_end - _buffer.data());
+      return true;
+    }
+    if (!fill()) {
+      return false;
+    }
+  }
+}
+
+bool line_reader::fill() {
+  if (_end_of_stream) {
+    return false;
+  }
+  // keep the incomplete line and make room for at least one block
+  const size_t remaining = _end - _begin;
+  std::memmove(_buffer.data(), _buffer.data() + _begin, remaining);
+  _begin = 0U;
+  _end = remaining;
+  if (_buffer.size() - _end < _buffer.size() / 2U) {
+    _buffer.resize(_buffer.size() * 2U);
+  }
+
+  _stream.read(_buffer.data() + _end, static_cast<std::streamsize>(_buffer.size() - _end));
+  const size_t read_count = static_cast<size_t>(_stream.gcount());
+  _end += read_count;
+  _end_of_stream = !_stream;
+  return read_count > 0U || _end_of_stream;
+}
+
+void line_reader::rewind() {
+  _stream.clear();
+  _stream.seekg(_start);
+  _begin = 0U;
+  _end = 0U;
+  _end_of_stream = false;
+}
+}
+}
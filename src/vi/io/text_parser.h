@@ -0,0 +1,77 @@
+#ifndef __vinn__text_parser__
+#define __vinn__text_parser__
+
+#include <cstdint>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+namespace vi {
+namespace io {
+
+/// Range of characters [first, second)
+typedef std::pair<const char*, const char*> text_range;
+
+/// Split text into at most max_chunks ranges of whole lines, each at least
+/// min_chunk_size characters long except for the last one
+std::vector<text_range> split_lines(const text_range& text, size_t max_chunks,
+                                    size_t min_chunk_size = 1U << 20);
+
+/// \return end of the line starting at begin, either a newline or end
+const char* line_end(const char* begin, const char* end);
+
+/// Remove a trailing comment and surrounding blanks from a line
+/// \return false if nothing is left
+bool trim_line(const char* begin, const char* end, char comment, text_range& contents);
+
+/// \return first character that is not a space, tab or carriage return
+const char* token_begin(const char* begin, const char* end);
+
+/// \return end of the token starting at begin, the next blank or end
+const char* token_end(const char* begin, const char* end);
+
+/// Parse a one based index that fits into 32 bits
+/// \return false if the range does not contain exactly one valid index
+bool parse_index(const char* begin, const char* end, uint32_t& index);
+
+/// Parse a decimal floating point value, surrounding blanks are ignored.
+/// Common values are converted exactly without library calls, the rest
+/// fall back to strtof so results always match std::stof.
+/// \return false if the range does not contain exactly one valid value
+bool parse_float(const char* begin, const char* end, float& value);
+
+/// Number of worker threads to use for parsing
+size_t parser_thread_count();
+
+/// Reads a stream in large blocks and hands out one line or a block of whole
+/// lines at a time, memory use is bounded by the block size and the longest line
+class line_reader {
+public:
+  line_reader(std::istream& stream, size_t block_size = 1U << 22);
+
+  /// \param line receives the next line without its newline, valid until the next call
+  /// \return false at the end of the stream
+  bool next(text_range& line);
+
+  /// \param lines receives the whole lines read so far but not handed out yet,
+  ///        including their newlines, valid until the next call
+  /// \return false at the end of the stream
+  bool next_lines(text_range& lines);
+
+  /// Continue from where the stream was when the reader was created
+  void rewind();
+
+private:
+  bool fill();
+
+  std::istream& _stream;
+  std::streampos _start;
+  std::vector<char> _buffer;
+  size_t _begin;
+  size_t _end;
+  bool _end_of_stream;
+};
+}
+}
+
+#endif
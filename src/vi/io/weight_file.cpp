@@ -0,0 +1,112 @@
+#include "vi/io/weight_file.h"
+#include "vi/io/checksum.h"
+#include "vi/io/mapped_file.h"
+
+#include <cstring>
+#include <fstream>
+#include <memory>
+
+namespace {
+
+const char magic[8] = {'V', 'I', 'N', 'N', 'W', 'G', 'T', '\0'};
+const uint32_t current_version = 1U;
+/// Reads back as a different value on a machine of the other endianness
+const uint32_t byte_order_mark = 0x01020304U;
+const uint32_t float32_values = 0U;
+}
+
+namespace vi {
+namespace io {
+
+const size_t weight_file::value_alignment;
+
+weight_file::weight_file(const std::string& path) : _path(path) {
+  static_assert(sizeof(header) <= value_alignment, "Header must fit before the values");
+}
+
+vi::la::matrix weight_file::load(vi::la::context& context, verification verify) const {
+  std::shared_ptr<mapped_file> mapping;
+  try {
+    mapping = std::make_shared<mapped_file>(_path);
+  } catch (mapped_file::exception& e) {
+    throw exception(e.what());
+  }
+  if (mapping->size() < sizeof(header)) {
+    throw exception("Weight file '" + _path + "' is truncated.");
+  }
+
+  header file_header;
+  std::memcpy(&file_header, mapping->data(), sizeof(file_header));
+  validate(file_header, mapping->size());
+
+  float* values = reinterpret_cast<float*>(mapping->data() + file_header.data_offset);
+  if (verify == verification::checksum &&
+      vi::io::checksum(values, file_header.data_size) != file_header.checksum) {
+    throw exception("Weight file '" + _path + "' is corrupted, checksum does not match.");
+  }
+
+  // the values share ownership of the mapping
+  std::shared_ptr<float> mapped_values(mapping, values);
+  return vi::la::matrix::adopt(context, file_header.row_count, file_header.column_count,
+                               mapped_values);
+}
+
+void weight_file::validate(const header& file_header, size_t file_size) const {
+  if (std::memcmp(file_header.magic, magic, sizeof(magic)) != 0) {
+    throw exception("'" + _path + "' is not a weight file.");
+  }
+  if (file_header.version != current_version) {
+    throw exception("Weight file '" + _path + "' has unsupported version " +
+                    std::to_string(file_header.version) + ".");
+  }
+  if (file_header.byte_order != byte_order_mark) {
+    throw exception("Weight file '" + _path + "' was written with a different byte order.");
+  }
+  if (file_header.value_type != float32_values) {
+    throw exception("Weight file '" + _path + "' has unsupported value type " +
+                    std::to_string(file_header.value_type) + ".");
+  }
+  if (file_header.row_count == 0U || file_header.column_count == 0U ||
+      file_header.column_count > UINT64_MAX / sizeof(float) / file_header.row_count ||
+      file_header.data_size != file_header.row_count * file_header.column_count * sizeof(float)) {
+    throw exception("Weight file '" + _path + "' has an invalid shape.");
+  }
+  if (file_header.data_offset < sizeof(header) ||
+      file_header.data_offset % value_alignment != 0U) {
+    throw exception("Weight file '" + _path + "' has misaligned values.");
+  }
+  if (file_header.data_offset > file_size ||
+      file_header.data_size > file_size - file_header.data_offset) {
+    throw exception("Weight file '" + _path + "' is truncated.");
+  }
+}
+
+void weight_file::store(const vi::la::matrix& weights) const {
+  const size_t data_size = weights.row_count() * weights.column_count() * sizeof(float);
+  const float* values = weights[0];
+
+  header file_header;
+  std::memset(&file_header, 0, sizeof(file_header));
+  std::memcpy(file_header.magic, magic, sizeof(magic));
+  file_header.version = current_version;
+  file_header.byte_order = byte_order_mark;
+  file_header.value_type = float32_values;
+  file_header.row_count = weights.row_count();
+  file_header.column_count = weights.column_count();
+  file_header.data_offset = value_alignment;
+  file_header.data_size = data_size;
+  file_header.checksum = vi::io::checksum(values, data_size);
+
+  char padded_header[value_alignment] = {};
+  std::memcpy(padded_header, &file_header, sizeof(file_header));
+
+  std::ofstream file(_path, std::ios::out | std::ios::binary | std::ios::trunc);
+  file.write(padded_header, sizeof(padded_header));
+  file.write(reinterpret_cast<const char*>(values), static_cast<std::streamsize>(data_size));
+  file.close();
+  if (!file) {
+    throw exception("Cannot write weight file '" + _path + "'.");
+  }
+}
+}
+}
@@ -0,0 +1,67 @@
+#ifndef __vinn__weight_file__
+#define __vinn__weight_file__
+
+#include <vi/la/context.h>
+#include <vi/la/matrix.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace vi {
+namespace io {
+
+/// Binary matrix file that can be memory mapped and used without parsing.
+/// A 64 byte header holding magic, version, byte order, element type, shape,
+/// data offset, data size and a checksum of the data is followed by the
+/// row-major values, which start at a multiple of value_alignment.
+class weight_file {
+public:
+  class exception : public std::runtime_error {
+  public:
+    exception(const std::string& text) : runtime_error(text) {}
+  };
+
+  /// Alignment of the values within the file
+  static const size_t value_alignment = 64U;
+
+  /// What load checks before using the values
+  enum class verification {
+    /// Header and file size only, pages of values are read when first used
+    header,
+    /// Also the checksum of the values, which reads every page of the file
+    checksum
+  };
+
+  weight_file(const std::string& path);
+
+  /// Map the file and adopt its values without copying where the context allows.
+  /// The values are private copy-on-write pages, modifying the matrix leaves the file intact.
+  /// \throw exception if the file is truncated, of an unsupported version or, when
+  ///        verifying the checksum, corrupted
+  vi::la::matrix load(vi::la::context& context,
+                      verification verify = verification::header) const;
+  void store(const vi::la::matrix& weights) const;
+
+private:
+  struct header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t value_type;
+    uint32_t reserved;
+    uint64_t row_count;
+    uint64_t column_count;
+    uint64_t data_offset;
+    uint64_t data_size;
+    uint64_t checksum;
+  };
+
+  void validate(const header& header, size_t file_size) const;
+
+  const std::string _path;
+};
+}
+}
+
+#endif
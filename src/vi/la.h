@@ -1,11 +1,19 @@
 #ifndef __vinn__la__
 #define __vinn__la__
 
+#include <vi/la/autotuner.h>
 #include <vi/la/context.h>
 #include <vi/la/matrix.h>
+#include <vi/la/matrix_implementation.h>
+#include <vi/la/precision.h>
+#include <vi/la/profiler.h>
+#include <vi/la/sparse_matrix.h>
+#include <vi/la/thread_cache.h>
+#include <vi/la/tuning_profile.h>
 
 #include <vi/la/cpu/cpu_context.h>
 #include <vi/la/cpu/cpu_matrix.h>
+#include <vi/la/cpu/int8_multiply.h>
 
 #include <vi/la/opencl/build_result.h>
 #include <vi/la/opencl/disk_source_loader.h>
@@ -17,4 +25,8 @@
 #include <vi/la/opencl/source.h>
 #include <vi/la/opencl/source_loader.h>
 
+#include <vi/la/scheduling/cost_model.h>
+#include <vi/la/scheduling/scheduling_context.h>
+#include <vi/la/scheduling/scheduling_matrix.h>
+
 #endif
@@ -0,0 +1,148 @@
+#include "vi/la/autotuner.h"
+
+#include "vi/la/cpu/cpu_context.h"
+#include "vi/la/matrix.h"
+#include "vi/la/opencl/opencl_context.h"
+#include "vi/la/sparse_matrix.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <ostream>
+
+namespace {
+
+typedef std::chrono::steady_clock timer;
+typedef vi::la::tuning_profile::parameters parameters;
+
+/// Timed runs per candidate after a warm-up run, the fastest counts
+const size_t timed_runs = 3U;
+
+double seconds(const std::function<void()>& run) {
+  const timer::time_point start = timer::now();
+  run();
+  return std::chrono::duration<double>(timer::now() - start).count();
+}
+
+std::vector<parameters> host_multiply_candidates() {
+  std::vector<parameters> candidates;
+  for (size_t block_size : {0U, 32U, 64U, 128U}) {
+    for (size_t thread_grain : {0U, 1U << 14, 1U << 16, 1U << 18}) {
+      candidates.push_back({block_size, thread_grain, 0U, 0U});
+    }
+  }
+  return candidates;
+}
+
+std::vector<parameters> host_sparse_multiply_candidates() {
+  std::vector<parameters> candidates;
+  for (size_t thread_grain : {1U << 12, 1U << 14, 1U << 16, 1U << 18}) {
+    candidates.push_back({0U, thread_grain, 0U, 0U});
+  }
+  return candidates;
+}
+
+std::vector<parameters> device_candidates() {
+  std::vector<parameters> candidates;
+  for (size_t edge : {0U, 1U, 4U, 8U, 16U}) {
+    candidates.push_back({0U, 0U, edge, edge});
+  }
+  return candidates;
+}
+
+/// Square sparse matrix with about one percent of the values set, every row non-empty
+vi::la::sparse_matrix sparse_operand(size_t size) {
+  const size_t row_non_zero_count = std::max<size_t>(1U, size / 100U);
+  std::vector<size_t> row_offsets(1U, 0U);
+  std::vector<uint32_t> column_indices;
+  std::vector<float> values;
+  for (size_t row = 0U; row < size; ++row) {
+    for (size_t i = 0U; i < row_non_zero_count; ++i) {
+      column_indices.push_back(static_cast<uint32_t>((row + i * size / row_non_zero_count) % size));
+      values.push_back(1.0f);
+    }
+    std::sort(column_indices.end() - row_non_zero_count, column_indices.end());
+    row_offsets.push_back(column_indices.size());
+  }
+  return vi::la::sparse_matrix(size, size, row_offsets, column_indices, values);
+}
+}
+
+namespace vi {
+namespace la {
+
+autotuner::autotuner(const std::vector<size_t>& sizes, std::ostream* log)
+    : _sizes(sizes), _log(log) {}
+
+void autotuner::tune(cpu_context& context, tuning_profile& profile) const {
+  for (size_t size : _sizes) {
+    matrix operand_1(context, size, size, 1.0f);
+    matrix operand_2(context, size, size, 1.0f);
+    matrix product(context, size, size);
+    tune(context, profile, "host", "multiply", size, host_multiply_candidates(),
+         [&]() { context.multiply(product, operand_1, operand_2); });
+
+    const sparse_matrix sparse = sparse_operand(size);
+    tune(context, profile, "host", "sparse_multiply", size, host_sparse_multiply_candidates(),
+         [&]() { context.multiply(product, sparse, operand_2); });
+  }
+  context.set_tuning_profile(std::make_shared<tuning_profile>(profile));
+}
+
+void autotuner::tune(opencl_context& context, tuning_profile& profile) const {
+  const std::vector<std::string> devices = context.tuned_devices();
+  const std::vector<double> weights = context.device_weights();
+  for (size_t device_index = 0U; device_index < devices.size(); ++device_index) {
+    // only the tuned device computes
+    std::vector<double> device_only(devices.size(), 0.0);
+    device_only[device_index] = 1.0;
+    context.set_device_weights(device_only);
+
+    for (size_t size : _sizes) {
+      matrix operand_1(context, size, size, 1.0f);
+      matrix operand_2(context, size, size, 1.0f);
+      matrix result(context, size, size);
+      tune(context, profile, devices[device_index], "multiply", size, device_candidates(),
+           [&]() { context.multiply(result, operand_1, operand_2); });
+      tune(context, profile, devices[device_index], "elementwise", size, device_candidates(),
+           [&]() { context.add(result, operand_1, operand_2); });
+    }
+  }
+  context.set_device_weights(weights);
+  context.set_tuning_profile(std::make_shared<tuning_profile>(profile));
+}
+
+void autotuner::tune(context& context, tuning_profile& profile, const std::string& device,
+                     const std::string& operation, size_t size,
+                     const std::vector<tuning_profile::parameters>& candidates,
+                     const std::function<void()>& run) const {
+  const size_t bucket = tuning_profile::bucket(size);
+  double fastest_seconds = std::numeric_limits<double>::max();
+  parameters fastest = candidates.front();
+  for (const parameters& candidate : candidates) {
+    std::shared_ptr<tuning_profile> trial = std::make_shared<tuning_profile>(profile);
+    trial->set(device, operation, bucket, candidate);
+    context.set_tuning_profile(trial);
+
+    run();
+    double best = std::numeric_limits<double>::max();
+    for (size_t i = 0U; i < timed_runs; ++i) {
+      best = std::min(best, seconds(run));
+    }
+    if (best < fastest_seconds) {
+      fastest_seconds = best;
+      fastest = candidate;
+    }
+  }
+  profile.set(device, operation, bucket, fastest);
+
+  if (_log != nullptr) {
+    *_log << device << " " << operation << " " << size << "x" << size
+          << ": block_size=" << fastest.block_size << " thread_grain=" << fastest.thread_grain
+          << " workgroup=" << fastest.workgroup_rows << "x" << fastest.workgroup_columns << " "
+          << fastest_seconds * 1e3 << " ms" << std::endl;
+  }
+}
+}
+}
@@ -0,0 +1,47 @@
+#ifndef __vinn__autotuner__
+#define __vinn__autotuner__
+
+#include <vi/la/tuning_profile.h>
+
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace vi {
+namespace la {
+
+class context;
+class cpu_context;
+class opencl_context;
+
+/// Times the candidate parameters of the tuned operations of a context on
+/// square operands and keeps the fastest per shape bucket in a tuning profile.
+class autotuner {
+public:
+  /// \param sizes edges of the operands the operations are timed on
+  /// \param log a line per tuned operation and size is written to it if not null
+  explicit autotuner(const std::vector<size_t>& sizes = {64U, 256U, 512U},
+                     std::ostream* log = nullptr);
+
+  /// Tune the block size and thread grain of host products into profile,
+  /// the context uses the profile afterwards
+  void tune(cpu_context& context, tuning_profile& profile) const;
+  /// Tune the work-group sizes of device products and elementwise operations
+  /// into profile on every device, the context uses the profile afterwards
+  void tune(opencl_context& context, tuning_profile& profile) const;
+
+private:
+  /// Time run with every candidate on the device and store the fastest
+  void tune(context& context, tuning_profile& profile, const std::string& device,
+            const std::string& operation, size_t size,
+            const std::vector<tuning_profile::parameters>& candidates,
+            const std::function<void()>& run) const;
+
+  std::vector<size_t> _sizes;
+  std::ostream* _log;
+};
+}
+}
+
+#endif
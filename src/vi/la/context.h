@@ -1,13 +1,26 @@
 #ifndef __vinn__context__
 #define __vinn__context__
 
+#include <vi/la/precision.h>
+
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace vi {
 namespace la {
 
 class matrix;
 class matrix_implementation;
+class profiler;
+class sparse_matrix;
+class tuning_profile;
+
+/// Bytes copied between host memory and a device
+struct transfer_statistics {
+  size_t bytes_to_device;
+  size_t bytes_to_host;
+};
 
 /// Interface that compute contexes must conform to
 class context {
@@ -19,6 +32,13 @@ public:
   virtual void multiply_elementwise(matrix& product, const matrix& operand_1,
                                     const matrix& operand_2) = 0;
 
+  /// product = operand_1 * operand_2 for a sparse operand_1
+  virtual void multiply(matrix& product, const sparse_matrix& operand_1,
+                        const matrix& operand_2) = 0;
+  /// product = transpose(operand_1) * operand_2 for a sparse operand_1
+  virtual void transpose_multiply(matrix& product, const sparse_matrix& operand_1,
+                                  const matrix& operand_2) = 0;
+
   virtual void add(matrix& sum, const matrix& operand_1, const float operand_2) = 0;
   virtual void add(matrix& sum, const matrix& operand_1, const matrix& operand_2) = 0;
   virtual void subtract(matrix& difference, const matrix& operand_1, const matrix& operand_2) = 0;
@@ -38,6 +58,15 @@ public:
   virtual matrix sum_columns(const matrix& matrix) = 0;
   virtual void log(matrix& result, const matrix& original) = 0;
 
+  /// Column of the largest value in every row, the first one on ties
+  /// \param indices operand.row_count() x 1 matrix receiving the columns
+  virtual void row_argmax(matrix& indices, const matrix& operand) = 0;
+
+  /// The k largest values of every row in descending order, lower columns first on ties
+  /// \param indices operand.row_count() x k matrix receiving the columns
+  /// \param values operand.row_count() x k matrix receiving the values
+  virtual void row_top_k(matrix& indices, matrix& values, const matrix& operand) = 0;
+
   virtual void sub_matrix(matrix& target, const matrix& source, size_t start_row, size_t end_row,
                           size_t start_column, size_t end_column) = 0;
 
@@ -46,6 +75,40 @@ public:
 
   virtual std::shared_ptr<vi::la::matrix_implementation>
   implement_matrix(size_t rows, size_t columns, const float* initial_values) = 0;
+  /// Implement a matrix on top of existing host values, contexts that cannot use
+  /// host memory directly copy them
+  /// \param values row-major values, kept alive as long as the implementation uses them
+  virtual std::shared_ptr<vi::la::matrix_implementation>
+  adopt_matrix(size_t rows, size_t columns, std::shared_ptr<float> values) = 0;
+
+  /// Precision used to store matrix multiplication operands
+  virtual vi::la::precision storage_precision() const = 0;
+
+  /// \return bytes copied since the context was constructed, none for contexts
+  ///         computing in host memory
+  virtual transfer_statistics transfers() const { return {0U, 0U}; }
+
+  /// Record every operation in the profiler, nullptr stops recording. Set it
+  /// while no operations are running.
+  virtual void set_profiler(std::shared_ptr<vi::la::profiler> profiler) { _profiler = profiler; }
+  std::shared_ptr<vi::la::profiler> attached_profiler() const { return _profiler; }
+
+  /// Pick operation parameters from the profile, contexts without one use fixed
+  /// defaults. The profile vinn_autotune stores is
+  /// tuning_profile::load(tuning_profile::default_path()). Set it while no
+  /// operations are running.
+  virtual void set_tuning_profile(std::shared_ptr<const vi::la::tuning_profile> profile) {
+    _tuning_profile = profile;
+  }
+  std::shared_ptr<const vi::la::tuning_profile> attached_tuning_profile() const {
+    return _tuning_profile;
+  }
+  /// \return names of the devices of the context in tuning profiles
+  virtual std::vector<std::string> tuned_devices() const { return {}; }
+
+protected:
+  std::shared_ptr<vi::la::profiler> _profiler;
+  std::shared_ptr<const vi::la::tuning_profile> _tuning_profile;
 };
 }
 }
@@ -1,43 +1,279 @@
 #include "vi/la/cpu/cpu_context.h"
 #include "vi/la/cpu/cpu_matrix.h"
+#include "vi/la/cpu/row_selection.h"
 #include "vi/la/matrix.h"
+#include "vi/la/profiler.h"
+#include "vi/la/sparse_matrix.h"
+#include "vi/la/tuning_profile.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <cstring>
 #include <memory>
 #include <cfenv>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 using std::cout;
 using std::endl;
 
+namespace {
+
+typedef uint16_t (*encoder)(float);
+
+encoder encoder_for(vi::la::precision storage_precision) {
+  if (storage_precision == vi::la::precision::half) {
+    return vi::la::to_half;
+  }
+  return vi::la::to_bfloat16;
+}
+
+/// half precision values are decoded through a lookup table covering all 2^16 values
+const std::vector<float>& half_table() {
+  static const std::vector<float> table = [] {
+    std::vector<float> values(1U << 16);
+    for (size_t i = 0U; i < values.size(); ++i) {
+      values[i] = vi::la::from_half(static_cast<uint16_t>(i));
+    }
+    return values;
+  }();
+  return table;
+}
+
+/// product_row += value * row for a row stored in bfloat16, the loop vectorizes
+void add_bfloat16_row(float* product_row, float value, const uint16_t* row, size_t length) {
+  for (size_t n = 0U; n < length; ++n) {
+    const uint32_t bits = static_cast<uint32_t>(row[n]) << 16;
+    float decoded;
+    std::memcpy(&decoded, &bits, sizeof(decoded));
+    product_row[n] += value * decoded;
+  }
+}
+
+/// product_row += value * row for a row stored in half precision
+void add_half_row(float* product_row, float value, const uint16_t* row, size_t length) {
+  const float* table = half_table().data();
+  for (size_t n = 0U; n < length; ++n) {
+    product_row[n] += value * table[row[n]];
+  }
+}
+
+/// Untuned products are computed in whole rows on the calling thread
+const vi::la::tuning_profile::parameters multiply_defaults = {0U, 0U, 0U, 0U};
+/// Untuned sparse products start a thread per 2^16 multiply-adds
+const vi::la::tuning_profile::parameters sparse_multiply_defaults = {0U, 1U << 16, 0U, 0U};
+
+/// Call body(begin, end) for disjoint ranges covering [0, count) on up to one
+/// thread per core, the calling thread processes the first range
+/// \param grain multiply-adds a thread is started for at least, zero runs body
+///        on the calling thread only
+template <typename F> void parallel_ranges(size_t count, size_t work, size_t grain, F body) {
+  const size_t hardware_threads = std::max<size_t>(1U, std::thread::hardware_concurrency());
+  const size_t work_threads = grain == 0U ? 1U : std::max<size_t>(1U, work / grain);
+  const size_t thread_count = std::min(std::min(hardware_threads, count), work_threads);
+  if (thread_count <= 1U) {
+    body(0U, count);
+    return;
+  }
+
+  std::vector<std::thread> threads;
+  for (size_t t = 1U; t < thread_count; ++t) {
+    threads.push_back(
+        std::thread(body, (count * t) / thread_count, (count * (t + 1U)) / thread_count));
+  }
+  body(0U, count / thread_count);
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
+/// Rows [begin, end) of product = operand_1 * operand_2 in blocks of block_size
+/// inner and product columns, so that a block of operand_2 stays in the cache
+/// while the rows use it. Every product value adds its terms in the same order
+/// whatever the block size.
+void multiply_rows(float* product, const float* operand_1, const float* operand_2,
+                   size_t inner_count, size_t column_count, size_t begin, size_t end,
+                   size_t block_size) {
+  const size_t inner_block = block_size == 0U ? inner_count : block_size;
+  const size_t column_block = block_size == 0U ? column_count : block_size;
+  std::fill(product + begin * column_count, product + end * column_count, 0.0f);
+  for (size_t first_inner = 0U; first_inner < inner_count; first_inner += inner_block) {
+    const size_t last_inner = std::min(inner_count, first_inner + inner_block);
+    for (size_t first_column = 0U; first_column < column_count; first_column += column_block) {
+      const size_t last_column = std::min(column_count, first_column + column_block);
+      for (size_t m = begin; m < end; ++m) {
+        float* product_row = product + m * column_count;
+        for (size_t j = first_inner; j < last_inner; ++j) {
+          const float value = operand_1[m * inner_count + j];
+          const float* operand_row = operand_2 + j * column_count;
+          for (size_t n = first_column; n < last_column; ++n) {
+            product_row[n] += value * operand_row[n];
+          }
+        }
+      }
+    }
+  }
+}
+}
+
 namespace vi {
 namespace la {
 
+cpu_context::cpu_context(vi::la::precision storage_precision)
+    : _storage_precision(storage_precision) {}
+
 std::shared_ptr<vi::la::matrix_implementation>
 cpu_context::implement_matrix(size_t rows, size_t columns, const float* initial_values) {
   matrix_implementation* impl = new cpu::matrix(*this, rows, columns, initial_values);
   return std::shared_ptr<matrix_implementation>(impl);
 }
 
-void cpu_context::multiply(matrix& product, const matrix& operand_1, const matrix& operand_2) {
-  cpu::matrix* product_impl = dynamic_cast<cpu::matrix*>(product.implementation());
-  cpu::matrix* operand_1_impl = dynamic_cast<cpu::matrix*>(operand_1.implementation());
-  cpu::matrix* operand_2_impl = dynamic_cast<cpu::matrix*>(operand_2.implementation());
+std::shared_ptr<vi::la::matrix_implementation>
+cpu_context::adopt_matrix(size_t rows, size_t columns, std::shared_ptr<float> values) {
+  matrix_implementation* impl = new cpu::matrix(*this, rows, columns, values);
+  return std::shared_ptr<matrix_implementation>(impl);
+}
 
-  for (size_t m = 0U; m < product.row_count(); ++m) {
-    for (size_t n = 0U; n < product.column_count(); ++n) {
-      float value(0.0);
-      for (size_t j = 0U; j < operand_1.column_count(); ++j) {
-        value += operand_1_impl->get()[m * operand_1.column_count() + j] *
-                 operand_2_impl->get()[j * operand_2.column_count() + n];
-      }
-      product_impl->get()[m * product.column_count() + n] = value;
-    }
+void cpu_context::multiply(matrix& product, const matrix& operand_1, const matrix& operand_2) {
+  profiler::scope profile(_profiler, "multiply", product, {&operand_1, &operand_2},
+                          2.0 * operand_1.column_count());
+  if (_storage_precision != precision::single) {
+    multiply_reduced_precision(product, operand_1, operand_2);
+    return;
   }
+
+  float* product_buffer = dynamic_cast<cpu::matrix*>(product.implementation())->get();
+  const float* operand_1_buffer = dynamic_cast<cpu::matrix*>(operand_1.implementation())->get();
+  const float* operand_2_buffer = dynamic_cast<cpu::matrix*>(operand_2.implementation())->get();
+  const size_t inner_count = operand_1.column_count();
+  const size_t column_count = product.column_count();
+  const tuning_profile::parameters tuned =
+      tuning("multiply", std::max(std::max(product.row_count(), column_count), inner_count),
+             multiply_defaults);
+
+  // threads own disjoint product rows
+  parallel_ranges(product.row_count(), product.row_count() * column_count * inner_count,
+                  tuned.thread_grain, [&](size_t begin, size_t end) {
+                    multiply_rows(product_buffer, operand_1_buffer, operand_2_buffer,
+                                  inner_count, column_count, begin, end, tuned.block_size);
+                  });
+}
+
+void cpu_context::multiply(matrix& product, const sparse_matrix& operand_1,
+                           const matrix& operand_2) {
+  profiler::scope profile(_profiler, "sparse_multiply", product, {&operand_2},
+                          2.0 * operand_1.non_zero_count() / operand_1.row_count());
+  profile.add_bytes(operand_1.stored_bytes());
+  float* product_buffer = dynamic_cast<cpu::matrix*>(product.implementation())->get();
+  const float* operand_2_buffer = dynamic_cast<cpu::matrix*>(operand_2.implementation())->get();
+  const size_t column_count = product.column_count();
+  const std::vector<size_t>& row_offsets = operand_1.row_offsets();
+  const std::vector<uint32_t>& column_indices = operand_1.column_indices();
+  const std::vector<float>& values = operand_1.values();
+
+  const size_t grain =
+      tuning("sparse_multiply", std::max(operand_1.row_count(), operand_1.column_count()),
+             sparse_multiply_defaults)
+          .thread_grain;
+
+  // every product row accumulates scaled operand_2 rows, threads own disjoint product rows
+  parallel_ranges(product.row_count(), operand_1.non_zero_count() * column_count, grain,
+                  [&](size_t begin, size_t end) {
+                    for (size_t m = begin; m < end; ++m) {
+                      float* product_row = product_buffer + m * column_count;
+                      std::fill(product_row, product_row + column_count, 0.0f);
+                      for (size_t i = row_offsets[m]; i < row_offsets[m + 1U]; ++i) {
+                        const float value = values[i];
+                        const float* operand_row =
+                            operand_2_buffer + column_indices[i] * column_count;
+                        for (size_t n = 0U; n < column_count; ++n) {
+                          product_row[n] += value * operand_row[n];
+                        }
+                      }
+                    }
+                  });
+}
+
+void cpu_context::transpose_multiply(matrix& product, const sparse_matrix& operand_1,
+                                     const matrix& operand_2) {
+  profiler::scope profile(_profiler, "sparse_transpose_multiply", product, {&operand_2},
+                          2.0 * operand_1.non_zero_count() / operand_1.column_count());
+  profile.add_bytes(operand_1.stored_bytes());
+  float* product_buffer = dynamic_cast<cpu::matrix*>(product.implementation())->get();
+  const float* operand_2_buffer = dynamic_cast<cpu::matrix*>(operand_2.implementation())->get();
+  const size_t column_count = product.column_count();
+  const std::vector<size_t>& row_offsets = operand_1.row_offsets();
+  const std::vector<uint32_t>& column_indices = operand_1.column_indices();
+  const std::vector<float>& values = operand_1.values();
+  std::fill(product_buffer, product_buffer + product.row_count() * column_count, 0.0f);
+
+  // entries of row m scatter operand_2 row m into the product rows of their columns,
+  // threads own disjoint product columns so that the scatter needs no synchronization
+  const size_t grain =
+      tuning("sparse_multiply", std::max(operand_1.row_count(), operand_1.column_count()),
+             sparse_multiply_defaults)
+          .thread_grain;
+  parallel_ranges(column_count, operand_1.non_zero_count() * column_count, grain,
+                  [&](size_t begin, size_t end) {
+                    for (size_t m = 0U; m < operand_1.row_count(); ++m) {
+                      const float* operand_row = operand_2_buffer + m * column_count;
+                      for (size_t i = row_offsets[m]; i < row_offsets[m + 1U]; ++i) {
+                        const float value = values[i];
+                        float* product_row = product_buffer + column_indices[i] * column_count;
+                        for (size_t n = begin; n < end; ++n) {
+                          product_row[n] += value * operand_row[n];
+                        }
+                      }
+                    }
+                  });
+}
+
+void cpu_context::multiply_reduced_precision(matrix& product, const matrix& operand_1,
+                                             const matrix& operand_2) {
+  float* product_buffer = dynamic_cast<cpu::matrix*>(product.implementation())->get();
+  const float* operand_1_buffer =
+      dynamic_cast<cpu::matrix*>(operand_1.implementation())->read_only_data();
+  // operand_2 stays packed in its matrix between products
+  const uint16_t* packed_2 = dynamic_cast<cpu::matrix*>(operand_2.implementation())
+                                 ->packed_values(_storage_precision);
+  const size_t inner_count = operand_1.column_count();
+  const size_t column_count = product.column_count();
+  const encoder encode = encoder_for(_storage_precision);
+  const bool half = _storage_precision == precision::half;
+  const tuning_profile::parameters tuned =
+      tuning("multiply", std::max(std::max(product.row_count(), column_count), inner_count),
+             multiply_defaults);
+
+  // threads own disjoint product rows, operand_1 values are rounded to storage precision
+  // as they are read. A product row is read only after the operand_1 row, so the product
+  // may overwrite operand_1.
+  parallel_ranges(product.row_count(), product.row_count() * column_count * inner_count,
+                  tuned.thread_grain, [&](size_t begin, size_t end) {
+                    std::vector<float> row(inner_count);
+                    for (size_t m = begin; m < end; ++m) {
+                      for (size_t j = 0U; j < inner_count; ++j) {
+                        const uint16_t packed = encode(operand_1_buffer[m * inner_count + j]);
+                        row[j] = half ? from_half(packed) : from_bfloat16(packed);
+                      }
+
+                      float* product_row = product_buffer + m * column_count;
+                      std::fill(product_row, product_row + column_count, 0.0f);
+                      for (size_t j = 0U; j < inner_count; ++j) {
+                        const uint16_t* packed_row = packed_2 + j * column_count;
+                        if (half) {
+                          add_half_row(product_row, row[j], packed_row, column_count);
+                        } else {
+                          add_bfloat16_row(product_row, row[j], packed_row, column_count);
+                        }
+                      }
+                    }
+                  });
 }
 
 void cpu_context::multiply(matrix& product, const matrix& operand_1, const float operand_2) {
+  profiler::scope profile(_profiler, "scalar_multiply", product, {&operand_1}, 1.0);
   cpu::matrix* product_impl = dynamic_cast<cpu::matrix*>(product.implementation());
   cpu::matrix* operand_1_impl = dynamic_cast<cpu::matrix*>(operand_1.implementation());
 
@@ -51,6 +287,8 @@ void cpu_context::multiply(matrix& product, const matrix& operand_1, const float
 
 void cpu_context::multiply_elementwise(matrix& product, const matrix& operand_1,
                                        const matrix& operand_2) {
+  profiler::scope profile(_profiler, "multiply_elementwise", product, {&operand_1, &operand_2},
+                          1.0);
   cpu::matrix* product_impl = dynamic_cast<cpu::matrix*>(product.implementation());
   cpu::matrix* operand_1_impl = dynamic_cast<cpu::matrix*>(operand_1.implementation());
   cpu::matrix* operand_2_impl = dynamic_cast<cpu::matrix*>(operand_2.implementation());
@@ -65,6 +303,7 @@ void cpu_context::multiply_elementwise(matrix& product, const matrix& operand_1,
 }
 
 void cpu_context::add(matrix& sum, const matrix& operand_1, const float operand_2) {
+  profiler::scope profile(_profiler, "scalar_add", sum, {&operand_1}, 1.0);
   cpu::matrix* sum_impl = dynamic_cast<cpu::matrix*>(sum.implementation());
   cpu::matrix* operand_1_impl = dynamic_cast<cpu::matrix*>(operand_1.implementation());
 
@@ -77,6 +316,7 @@ void cpu_context::add(matrix& sum, const matrix& operand_1, const float operand_
 }
 
 void cpu_context::add(matrix& sum, const matrix& operand_1, const matrix& operand_2) {
+  profiler::scope profile(_profiler, "add", sum, {&operand_1, &operand_2}, 1.0);
   cpu::matrix* sum_impl = dynamic_cast<cpu::matrix*>(sum.implementation());
   cpu::matrix* operand_1_impl = dynamic_cast<cpu::matrix*>(operand_1.implementation());
   cpu::matrix* operand_2_impl = dynamic_cast<cpu::matrix*>(operand_2.implementation());
@@ -91,6 +331,7 @@ void cpu_context::add(matrix& sum, const matrix& operand_1, const matrix& operan
 }
 
 void cpu_context::subtract(matrix& difference, const matrix& operand_1, const matrix& operand_2) {
+  profiler::scope profile(_profiler, "subtract", difference, {&operand_1, &operand_2}, 1.0);
   cpu::matrix* difference_impl = dynamic_cast<cpu::matrix*>(difference.implementation());
   cpu::matrix* operand_1_impl = dynamic_cast<cpu::matrix*>(operand_1.implementation());
   cpu::matrix* operand_2_impl = dynamic_cast<cpu::matrix*>(operand_2.implementation());
@@ -105,6 +346,7 @@ void cpu_context::subtract(matrix& difference, const matrix& operand_1, const ma
 }
 
 void cpu_context::sigmoid(matrix& operand) {
+  profiler::scope profile(_profiler, "sigmoid", operand, {&operand}, 3.0);
   cpu::matrix* impl = dynamic_cast<cpu::matrix*>(operand.implementation());
   float* b = impl->raw_data();
   for (size_t m = 0U; m < operand.row_count(); ++m) {
@@ -117,6 +359,7 @@ void cpu_context::sigmoid(matrix& operand) {
 }
 
 void cpu_context::sigmoid_gradient(matrix& gradient, const matrix& operand) {
+  profiler::scope profile(_profiler, "sigmoid_gradient", gradient, {&operand}, 5.0);
   cpu::matrix* gradient_impl = dynamic_cast<cpu::matrix*>(gradient.implementation());
   cpu::matrix* operand_impl = dynamic_cast<cpu::matrix*>(operand.implementation());
 
@@ -130,6 +373,7 @@ void cpu_context::sigmoid_gradient(matrix& gradient, const matrix& operand) {
 }
 
 void cpu_context::hyperbolic_tangent(matrix& operand) {
+  profiler::scope profile(_profiler, "hyperbolic_tangent", operand, {&operand}, 1.0);
   cpu::matrix* operand_impl = dynamic_cast<cpu::matrix*>(operand.implementation());
 
   for (size_t m = 0U; m < operand.row_count(); ++m) {
@@ -142,6 +386,7 @@ void cpu_context::hyperbolic_tangent(matrix& operand) {
 }
 
 void cpu_context::hyperbolic_tangent_gradient(matrix& gradient, const matrix& operand) {
+  profiler::scope profile(_profiler, "hyperbolic_tangent_gradient", gradient, {&operand}, 3.0);
   cpu::matrix* gradient_impl = dynamic_cast<cpu::matrix*>(gradient.implementation());
   cpu::matrix* operand_impl = dynamic_cast<cpu::matrix*>(operand.implementation());
 
@@ -154,6 +399,7 @@ void cpu_context::hyperbolic_tangent_gradient(matrix& gradient, const matrix& op
 }
 
 void cpu_context::softmax(matrix& operand) {
+  profiler::scope profile(_profiler, "softmax", operand, {&operand}, 3.0);
   cpu::matrix* impl = dynamic_cast<cpu::matrix*>(operand.implementation());
   float* buffer = impl->get();
   for (size_t m = 0U; m < operand.row_count(); ++m) {
@@ -172,6 +418,7 @@ void cpu_context::softmax(matrix& operand) {
 }
 
 void cpu_context::merge(matrix& merged, const matrix& operand_1, const matrix& operand_2) {
+  profiler::scope profile(_profiler, "merge", merged, {&operand_1, &operand_2}, 0.0);
   cpu::matrix* merged_impl = dynamic_cast<cpu::matrix*>(merged.implementation());
   float* merged_buffer = merged_impl->get();
   cpu::matrix* operand_1_impl = dynamic_cast<cpu::matrix*>(operand_1.implementation());
@@ -193,6 +440,7 @@ void cpu_context::merge(matrix& merged, const matrix& operand_1, const matrix& o
 }
 
 void cpu_context::transpose(matrix& transposed, const matrix& original) {
+  profiler::scope profile(_profiler, "transpose", transposed, {&original}, 0.0);
   cpu::matrix* transposed_impl = dynamic_cast<cpu::matrix*>(transposed.implementation());
   float* transposed_buffer = transposed_impl->get();
   cpu::matrix* original_impl = dynamic_cast<cpu::matrix*>(original.implementation());
@@ -207,6 +455,7 @@ void cpu_context::transpose(matrix& transposed, const matrix& original) {
 }
 
 matrix cpu_context::sum_rows(const matrix& original) {
+  profiler::scope profile(_profiler, "sum_rows", original, {}, 1.0);
   vi::la::matrix sums(*this, 1U, original.column_count(), 0.0);
   cpu::matrix* original_impl = dynamic_cast<cpu::matrix*>(original.implementation());
   cpu::matrix* sums_impl = dynamic_cast<cpu::matrix*>(sums.implementation());
@@ -221,6 +470,7 @@ matrix cpu_context::sum_rows(const matrix& original) {
 }
 
 matrix cpu_context::sum_columns(const matrix& original) {
+  profiler::scope profile(_profiler, "sum_columns", original, {}, 1.0);
   vi::la::matrix sums(*this, original.row_count(), 1U, 0.0);
   cpu::matrix* original_impl = dynamic_cast<cpu::matrix*>(original.implementation());
   cpu::matrix* sums_impl = dynamic_cast<cpu::matrix*>(sums.implementation());
@@ -234,6 +484,7 @@ matrix cpu_context::sum_columns(const matrix& original) {
 }
 
 void cpu_context::log(matrix& result, const matrix& original) {
+  profiler::scope profile(_profiler, "log", result, {&original}, 1.0);
   cpu::matrix* result_impl = dynamic_cast<cpu::matrix*>(result.implementation());
   cpu::matrix* original_impl = dynamic_cast<cpu::matrix*>(original.implementation());
 
@@ -245,8 +496,29 @@ void cpu_context::log(matrix& result, const matrix& original) {
   }
 }
 
+void cpu_context::row_argmax(matrix& indices, const matrix& operand) {
+  profiler::scope profile(_profiler, "row_argmax", operand, {}, 1.0);
+  assert(indices.row_count() == operand.row_count() && indices.column_count() == 1U);
+  cpu::matrix* indices_impl = dynamic_cast<cpu::matrix*>(indices.implementation());
+  cpu::matrix* operand_impl = dynamic_cast<cpu::matrix*>(operand.implementation());
+  cpu::row_argmax(indices_impl->get(), operand_impl->get(), operand.row_count(),
+                  operand.column_count());
+}
+
+void cpu_context::row_top_k(matrix& indices, matrix& values, const matrix& operand) {
+  profiler::scope profile(_profiler, "row_top_k", operand, {}, 1.0);
+  assert(indices.row_count() == operand.row_count() && indices.size() == values.size() &&
+         indices.column_count() <= operand.column_count());
+  cpu::matrix* indices_impl = dynamic_cast<cpu::matrix*>(indices.implementation());
+  cpu::matrix* values_impl = dynamic_cast<cpu::matrix*>(values.implementation());
+  cpu::matrix* operand_impl = dynamic_cast<cpu::matrix*>(operand.implementation());
+  cpu::row_top_k(indices_impl->get(), values_impl->get(), operand_impl->get(),
+                 operand.row_count(), operand.column_count(), indices.column_count());
+}
+
 void cpu_context::sub_matrix(matrix& target, const matrix& original, size_t start_row,
                              size_t end_row, size_t start_column, size_t end_column) {
+  profiler::scope profile(_profiler, "sub_matrix", target, {&target}, 0.0);
   cpu::matrix* target_impl = dynamic_cast<cpu::matrix*>(target.implementation());
   cpu::matrix* original_impl = dynamic_cast<cpu::matrix*>(original.implementation());
 
@@ -263,6 +535,8 @@ void cpu_context::sub_matrix(matrix& target, const matrix& original, size_t star
 
 void cpu_context::convolve_2d(matrix& result, const matrix& mask, const matrix& original,
                               size_t channels) {
+  profiler::scope profile(_profiler, "convolve_2d", result, {&original, &mask},
+                          2.0 * mask.row_count() * mask.column_count());
   size_t mask_width = mask.column_count();
   size_t mask_height = mask.row_count();
 
@@ -304,5 +578,19 @@ void cpu_context::convolve_2d(matrix& result, const matrix& mask, const matrix&
     }
   }
 }
+
+std::vector<std::string> cpu_context::tuned_devices() const { return {"host"}; }
+
+tuning_profile::parameters
+cpu_context::tuning(const char* operation, size_t largest_dimension,
+                    const tuning_profile::parameters& defaults) const {
+  if (!_tuning_profile) {
+    return defaults;
+  }
+  return _tuning_profile->find("host", operation, tuning_profile::bucket(largest_dimension),
+                               defaults);
+}
+
+vi::la::precision cpu_context::storage_precision() const { return _storage_precision; }
 }
 }
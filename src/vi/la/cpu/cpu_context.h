@@ -2,20 +2,37 @@
 #define __mlcl__cpu_context__
 
 #include <vi/la/context.h>
+#include <vi/la/tuning_profile.h>
 
 namespace vi {
 namespace la {
 
-/// CPU/C++ based reference implementation of linear algebra operations
+/// CPU/C++ based reference implementation of linear algebra operations.
+/// The context holds no mutable state, so operations may be called
+/// concurrently from several threads as long as they do not write to the
+/// same matrices.
 class cpu_context : public context {
 public:
+  /// \param storage_precision precision of matrix multiplication operands,
+  ///        products are accumulated in single precision
+  cpu_context(vi::la::precision storage_precision = vi::la::precision::single);
+
   std::shared_ptr<vi::la::matrix_implementation> implement_matrix(size_t rows, size_t columns,
                                                                   const float* initial_values);
+  /// Values are used in place without copying
+  std::shared_ptr<vi::la::matrix_implementation> adopt_matrix(size_t rows, size_t columns,
+                                                              std::shared_ptr<float> values);
 
   void multiply(matrix& product, const matrix& operand_1, const matrix& operand_2);
   void multiply(matrix& product, const matrix& operand_1, const float operand_2);
   void multiply_elementwise(matrix& product, const matrix& operand_1, const matrix& operand_2);
 
+  /// Rows of the product are computed on multiple threads
+  void multiply(matrix& product, const sparse_matrix& operand_1, const matrix& operand_2);
+  /// Columns of the product are computed on multiple threads
+  void transpose_multiply(matrix& product, const sparse_matrix& operand_1,
+                          const matrix& operand_2);
+
   void add(matrix& sum, const matrix& operand_1, const float operand_2);
   void add(matrix& sum, const matrix& operand_1, const matrix& operand_2);
   void subtract(matrix& difference, const matrix& operand_1, const matrix& operand_2);
@@ -32,11 +49,28 @@ public:
   matrix sum_rows(const matrix& operand);
   matrix sum_columns(const matrix& matrix);
   void log(matrix& result, const matrix& original);
+  void row_argmax(matrix& indices, const matrix& operand);
+  void row_top_k(matrix& indices, matrix& values, const matrix& operand);
 
   void sub_matrix(matrix& target, const matrix& original, size_t start_row, size_t end_row,
                   size_t start_column, size_t end_column);
 
   void convolve_2d(matrix& result, const matrix& mask, const matrix& original, size_t channels);
+
+  vi::la::precision storage_precision() const;
+
+  /// Products are computed in blocks of the tuned size on threads of the tuned grain
+  std::vector<std::string> tuned_devices() const;
+
+private:
+  /// \return parameters of the operation from the tuning profile, defaults without one
+  tuning_profile::parameters tuning(const char* operation, size_t largest_dimension,
+                                    const tuning_profile::parameters& defaults) const;
+
+  void multiply_reduced_precision(matrix& product, const matrix& operand_1,
+                                  const matrix& operand_2);
+
+  vi::la::precision _storage_precision;
 };
 }
 }
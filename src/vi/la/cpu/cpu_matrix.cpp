@@ -7,7 +7,8 @@ namespace la {
 namespace cpu {
 
 matrix::matrix(cpu_context& context, size_t rows, size_t columns, const float* initial_values)
-    : _context(context), _row_count(rows), _column_count(columns) {
+    : matrix_implementation(rows * columns * sizeof(float)), _context(context), _row_count(rows),
+      _column_count(columns), _packed_precision(precision::single), _packed_current(false) {
   size_t value_count = rows * columns;
   assert(value_count > 0);
   float* values = new float[value_count];
@@ -17,7 +18,18 @@ matrix::matrix(cpu_context& context, size_t rows, size_t columns, const float* i
   _buffer = values;
 }
 
-matrix::~matrix() { delete[] _buffer; }
+matrix::matrix(cpu_context& context, size_t rows, size_t columns, std::shared_ptr<float> values)
+    : _context(context), _row_count(rows), _column_count(columns), _buffer(values.get()),
+      _adopted_values(values), _packed_precision(precision::single), _packed_current(false) {
+  assert(rows * columns > 0);
+  assert(_buffer);
+}
+
+matrix::~matrix() {
+  if (!_adopted_values) {
+    delete[] _buffer;
+  }
+}
 
 size_t matrix::row_count() const { return _row_count; }
 
@@ -25,9 +37,37 @@ size_t matrix::column_count() const { return _column_count; }
 
 vi::la::context& matrix::owning_context() const { return _context; }
 
-float* matrix::raw_data() { return _buffer; }
+float* matrix::raw_data() {
+  _packed_current = false;
+  return _buffer;
+}
+
+const float* matrix::read_only_data() { return _buffer; }
 
-float* matrix::get() { return _buffer; }
+float* matrix::get() {
+  _packed_current = false;
+  return _buffer;
+}
+
+const uint16_t* matrix::packed_values(precision storage_precision) {
+  assert(storage_precision != precision::single);
+  std::lock_guard<std::mutex> lock(_packed_mutex);
+  if (_packed_current && _packed_precision == storage_precision) {
+    return _packed_values.data();
+  }
+
+  if (_packed_values.empty()) {
+    _packed_values.resize(_row_count * _column_count);
+    count_allocation(_packed_values.size() * sizeof(uint16_t));
+  }
+  uint16_t (*encode)(float) = storage_precision == precision::half ? to_half : to_bfloat16;
+  for (size_t i = 0U; i < _packed_values.size(); ++i) {
+    _packed_values[i] = encode(_buffer[i]);
+  }
+  _packed_precision = storage_precision;
+  _packed_current = true;
+  return _packed_values.data();
+}
 }
 }
 }
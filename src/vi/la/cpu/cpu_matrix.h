@@ -3,6 +3,12 @@
 
 #include <vi/la/cpu/cpu_context.h>
 #include <vi/la/matrix_implementation.h>
+#include <vi/la/precision.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace vi {
 namespace la {
@@ -12,6 +18,8 @@ namespace cpu {
 class matrix : public vi::la::matrix_implementation {
 public:
   matrix(cpu_context& context, size_t rows, size_t columns, const float* initial_values);
+  /// Use values in place, the matrix shares their ownership
+  matrix(cpu_context& context, size_t rows, size_t columns, std::shared_ptr<float> values);
   virtual ~matrix();
 
   size_t row_count() const;
@@ -20,14 +28,29 @@ public:
   virtual vi::la::context& owning_context() const;
 
   virtual float* raw_data();
+  virtual const float* read_only_data();
 
+  /// \return values for reading and writing
   float* get();
 
+  /// \return row-major values rounded to storage_precision. The copy is made
+  ///         again only when the values have been accessed for writing since,
+  ///         so that weights are packed once for as many products as they take
+  ///         part in. Several threads may use it at once.
+  const uint16_t* packed_values(precision storage_precision);
+
 private:
   cpu_context& _context;
   size_t _row_count;
   size_t _column_count;
   float* _buffer;
+  std::shared_ptr<float> _adopted_values;
+  /// Guards the packed copy
+  std::mutex _packed_mutex;
+  std::vector<uint16_t> _packed_values;
+  precision _packed_precision;
+  /// The packed copy holds the current values
+  bool _packed_current;
 };
 }
 }
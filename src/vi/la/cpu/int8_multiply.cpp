@@ -0,0 +1,190 @@
+#include "vi/la/cpu/int8_multiply.h"
+
+#include <cassert>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define VINN_X86_INT8_KERNELS 1
+#include <immintrin.h>
+#endif
+
+#if defined(VINN_X86_INT8_KERNELS) &&                                                              \
+    ((defined(__clang__) && __clang_major__ >= 12) || (!defined(__clang__) && __GNUC__ >= 11))
+#define VINN_AVX_VNNI_KERNELS 1
+#endif
+
+namespace {
+
+void multiply_scalar(int32_t* product, const uint8_t* operand_1, const int8_t* operand_2,
+                     size_t m, size_t n, size_t k) {
+  for (size_t i = 0U; i < m; ++i) {
+    const uint8_t* row = operand_1 + i * k;
+    for (size_t j = 0U; j < n; ++j) {
+      const int8_t* column = operand_2 + j * k;
+      int32_t sum(0);
+      for (size_t l = 0U; l < k; ++l) {
+        sum += static_cast<int32_t>(row[l]) * static_cast<int32_t>(column[l]);
+      }
+      product[i * n + j] = sum;
+    }
+  }
+}
+
+#if defined(VINN_X86_INT8_KERNELS)
+
+__attribute__((target("avx2"))) inline int32_t horizontal_sum(__m256i values) {
+  __m128i sum =
+      _mm_add_epi32(_mm256_castsi256_si128(values), _mm256_extracti128_si256(values, 1));
+  sum = _mm_hadd_epi32(sum, sum);
+  sum = _mm_hadd_epi32(sum, sum);
+  return _mm_cvtsi128_si32(sum);
+}
+
+/// Bytes are widened to 16 bits and vpmaddwd adds the products of adjacent pairs in 32 bits.
+/// vpmaddubsw would save the widening, but its 16-bit pair sums saturate for unsigned values
+/// above 127.
+__attribute__((target("avx2"))) inline __m256i dot_accumulate_avx2(__m256i sum, __m256i row,
+                                                                   __m256i column) {
+  const __m256i row_low = _mm256_cvtepu8_epi16(_mm256_castsi256_si128(row));
+  const __m256i row_high = _mm256_cvtepu8_epi16(_mm256_extracti128_si256(row, 1));
+  const __m256i column_low = _mm256_cvtepi8_epi16(_mm256_castsi256_si128(column));
+  const __m256i column_high = _mm256_cvtepi8_epi16(_mm256_extracti128_si256(column, 1));
+  sum = _mm256_add_epi32(sum, _mm256_madd_epi16(row_low, column_low));
+  return _mm256_add_epi32(sum, _mm256_madd_epi16(row_high, column_high));
+}
+
+/// Define a kernel for an instruction set that multiplies each row with four
+/// output columns at a time, which share every load of the row, and with the
+/// remaining columns one at a time. accumulate(sum, row_block, column_block)
+/// adds the products of int8_block_size byte pairs to the 32-bit sums.
+#define VINN_INT8_KERNEL(name, target_options, accumulate)                                         \
+  template <size_t column_count>                                                                   \
+  __attribute__((target(target_options))) inline void name##_columns(                              \
+      int32_t* product, const uint8_t* row, const int8_t* columns, size_t k) {                     \
+    __m256i sums[column_count];                                                                    \
+    for (size_t c = 0U; c < column_count; ++c) {                                                   \
+      sums[c] = _mm256_setzero_si256();                                                            \
+    }                                                                                              \
+    for (size_t l = 0U; l < k; l += vi::la::cpu::int8_block_size) {                               \
+      const __m256i row_block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + l));     \
+      for (size_t c = 0U; c < column_count; ++c) {                                                 \
+        const __m256i column_block =                                                               \
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(columns + c * k + l));             \
+        sums[c] = accumulate(sums[c], row_block, column_block);                                    \
+      }                                                                                            \
+    }                                                                                              \
+    for (size_t c = 0U; c < column_count; ++c) {                                                   \
+      product[c] = horizontal_sum(sums[c]);                                                        \
+    }                                                                                              \
+  }                                                                                                \
+                                                                                                   \
+  __attribute__((target(target_options))) void name(int32_t* product, const uint8_t* operand_1,    \
+                                                    const int8_t* operand_2, size_t m, size_t n,   \
+                                                    size_t k) {                                    \
+    for (size_t i = 0U; i < m; ++i) {                                                              \
+      const uint8_t* row = operand_1 + i * k;                                                      \
+      size_t j = 0U;                                                                               \
+      for (; j + 4U <= n; j += 4U) {                                                               \
+        name##_columns<4U>(product + i * n + j, row, operand_2 + j * k, k);                        \
+      }                                                                                            \
+      for (; j < n; ++j) {                                                                         \
+        name##_columns<1U>(product + i * n + j, row, operand_2 + j * k, k);                        \
+      }                                                                                            \
+    }                                                                                              \
+  }
+
+VINN_INT8_KERNEL(multiply_avx2, "avx2", dot_accumulate_avx2)
+// vpdpbusd multiplies and accumulates groups of four byte pairs in 32 bits
+VINN_INT8_KERNEL(multiply_avx512_vnni, "avx2,avx512vnni,avx512vl", _mm256_dpbusd_epi32)
+#if defined(VINN_AVX_VNNI_KERNELS)
+VINN_INT8_KERNEL(multiply_avx_vnni, "avx2,avxvnni", _mm256_dpbusd_avx_epi32)
+#endif
+
+#endif
+}
+
+namespace vi {
+namespace la {
+namespace cpu {
+
+bool int8_instruction_set_supported(int8_instruction_set instruction_set) {
+#if defined(VINN_X86_INT8_KERNELS)
+  __builtin_cpu_init();
+  switch (instruction_set) {
+  case int8_instruction_set::scalar:
+    return true;
+  case int8_instruction_set::avx2:
+    return __builtin_cpu_supports("avx2");
+  case int8_instruction_set::avx_vnni:
+#if defined(VINN_AVX_VNNI_KERNELS)
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("avxvnni");
+#else
+    return false;
+#endif
+  case int8_instruction_set::avx512_vnni:
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("avx512vnni") &&
+           __builtin_cpu_supports("avx512vl");
+  }
+  return false;
+#else
+  return instruction_set == int8_instruction_set::scalar;
+#endif
+}
+
+int8_instruction_set detect_int8_instruction_set() {
+  static const int8_instruction_set detected = [] {
+    const int8_instruction_set preferred[] = {int8_instruction_set::avx512_vnni,
+                                              int8_instruction_set::avx_vnni,
+                                              int8_instruction_set::avx2};
+    for (int8_instruction_set instruction_set : preferred) {
+      if (int8_instruction_set_supported(instruction_set)) {
+        return instruction_set;
+      }
+    }
+    return int8_instruction_set::scalar;
+  }();
+  return detected;
+}
+
+const char* int8_instruction_set_name(int8_instruction_set instruction_set) {
+  switch (instruction_set) {
+  case int8_instruction_set::avx2:
+    return "avx2";
+  case int8_instruction_set::avx_vnni:
+    return "avx_vnni";
+  case int8_instruction_set::avx512_vnni:
+    return "avx512_vnni";
+  case int8_instruction_set::scalar:
+    break;
+  }
+  return "scalar";
+}
+
+void multiply_u8s8(int32_t* product, const uint8_t* operand_1, const int8_t* operand_2, size_t m,
+                   size_t n, size_t k, int8_instruction_set instruction_set) {
+  assert(k % int8_block_size == 0U);
+  // never execute instructions the CPU does not have
+  if (!int8_instruction_set_supported(instruction_set)) {
+    instruction_set = detect_int8_instruction_set();
+  }
+
+  switch (instruction_set) {
+#if defined(VINN_X86_INT8_KERNELS)
+  case int8_instruction_set::avx2:
+    multiply_avx2(product, operand_1, operand_2, m, n, k);
+    return;
+  case int8_instruction_set::avx512_vnni:
+    multiply_avx512_vnni(product, operand_1, operand_2, m, n, k);
+    return;
+#if defined(VINN_AVX_VNNI_KERNELS)
+  case int8_instruction_set::avx_vnni:
+    multiply_avx_vnni(product, operand_1, operand_2, m, n, k);
+    return;
+#endif
+#endif
+  default:
+    multiply_scalar(product, operand_1, operand_2, m, n, k);
+  }
+}
+}
+}
+}
@@ -0,0 +1,38 @@
+#ifndef __vinn__int8_multiply__
+#define __vinn__int8_multiply__
+
+#include <cstddef>
+#include <cstdint>
+
+namespace vi {
+namespace la {
+namespace cpu {
+
+/// Instruction sets used for 8-bit integer dot products
+enum class int8_instruction_set { scalar, avx2, avx_vnni, avx512_vnni };
+
+/// \return true if the executing CPU and the compiler support the instruction set
+bool int8_instruction_set_supported(int8_instruction_set instruction_set);
+
+/// \return fastest instruction set supported by the executing CPU
+int8_instruction_set detect_int8_instruction_set();
+
+/// \return human readable name of the given instruction set
+const char* int8_instruction_set_name(int8_instruction_set instruction_set);
+
+/// Inner dimensions passed to multiply_u8s8 must be a multiple of this
+const size_t int8_block_size = 32U;
+
+/// Multiply unsigned 8-bit rows with signed 8-bit rows, accumulating in 32 bits:
+///   product[i * n + j] = sum over l of operand_1[i * k + l] * operand_2[j * k + l]
+/// Unsigned values use the full range [0, 255], signed values are within [-127, 127].
+/// \param m number of rows in operand_1
+/// \param n number of rows in operand_2
+/// \param k row length of both operands, a multiple of int8_block_size
+void multiply_u8s8(int32_t* product, const uint8_t* operand_1, const int8_t* operand_2, size_t m,
+                   size_t n, size_t k, int8_instruction_set instruction_set);
+}
+}
+}
+
+#endif
@@ -0,0 +1,241 @@
+#include "vi/la/cpu/row_selection.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define VINN_X86_SELECTION_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+/// NaN orders below every other value, as it does in candidate_key
+bool beats(float value, float best) { return value > best || (best != best && value == value); }
+
+/// Values that neither beats the other, lower columns win these ties
+bool ties(float value, float best) { return value == best || (value != value && best != best); }
+
+size_t argmax_scalar(const float* values, size_t columns) {
+  size_t best = 0U;
+  for (size_t column = 1U; column < columns; ++column) {
+    if (beats(values[column], values[best])) {
+      best = column;
+    }
+  }
+  return best;
+}
+
+/// Candidate packed into a key that orders like its value, larger values
+/// and lower columns first. NaN orders below every other value.
+uint64_t candidate_key(float value, size_t column) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  const uint32_t ordered = value != value ? 0U : (bits >> 31U ? ~bits : bits | 0x80000000U);
+  return static_cast<uint64_t>(ordered) << 32U | (0xffffffffU - static_cast<uint32_t>(column));
+}
+
+float candidate_value(uint64_t key) {
+  const uint32_t ordered = static_cast<uint32_t>(key >> 32U);
+  const uint32_t bits = ordered & 0x80000000U ? ordered & 0x7fffffffU : ~ordered;
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+size_t candidate_column(uint64_t key) {
+  return 0xffffffffU - static_cast<uint32_t>(key & 0xffffffffU);
+}
+
+/// Best k candidates of a row. Candidates beating the k-th best value found
+/// so far are appended to a buffer, which is cut back to the best k with a
+/// linear time selection whenever it fills up.
+class top_candidates {
+public:
+  explicit top_candidates(size_t k) : _k(k), _capacity(2U * k + 16U), _threshold(0.0f) {
+    _keys.reserve(_capacity);
+  }
+
+  void clear() { _keys.clear(); }
+
+  /// the first k columns have been offered and a threshold is known
+  bool full() const { return _keys.size() >= _k; }
+
+  /// value a column has to exceed to be one of the best k
+  float threshold() const { return _threshold; }
+
+  /// Columns are offered in increasing order, so a later column only
+  /// beats the k-th best candidate when its value is strictly larger.
+  void offer(float value, size_t column) {
+    if (!full()) {
+      _keys.push_back(candidate_key(value, column));
+      if (full()) {
+        update_threshold(*std::min_element(_keys.begin(), _keys.end()));
+      }
+    } else if (value > _threshold) {
+      _keys.push_back(candidate_key(value, column));
+      if (_keys.size() == _capacity) {
+        std::nth_element(_keys.begin(), _keys.begin() + (_k - 1U), _keys.end(),
+                         std::greater<uint64_t>());
+        _keys.resize(_k);
+        update_threshold(_keys.back());
+      }
+    }
+  }
+
+  void store(float* indices, float* values) {
+    const size_t count = std::min(_k, _keys.size());
+    std::nth_element(_keys.begin(), _keys.begin() + (count - 1U), _keys.end(),
+                     std::greater<uint64_t>());
+    std::sort(_keys.begin(), _keys.begin() + count, std::greater<uint64_t>());
+    for (size_t i = 0U; i < count; ++i) {
+      values[i] = candidate_value(_keys[i]);
+      indices[i] = static_cast<float>(candidate_column(_keys[i]));
+    }
+  }
+
+private:
+  void update_threshold(uint64_t worst) {
+    // any value beats a NaN
+    const float value = candidate_value(worst);
+    _threshold = value == value ? value : -std::numeric_limits<float>::infinity();
+  }
+
+  size_t _k;
+  size_t _capacity;
+  float _threshold;
+  std::vector<uint64_t> _keys;
+};
+
+void top_k_scalar(top_candidates& best, const float* values, size_t columns) {
+  for (size_t column = 0U; column < columns; ++column) {
+    best.offer(values[column], column);
+  }
+}
+
+#if defined(VINN_X86_SELECTION_KERNELS)
+
+bool avx2_supported() {
+  static const bool supported = [] {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+  }();
+  return supported;
+}
+
+/// Every lane keeps the first largest value of its columns, the lanes are
+/// reduced preferring lower columns on ties
+__attribute__((target("avx2"))) size_t argmax_avx2(const float* values, size_t columns) {
+  __m256 best = _mm256_loadu_ps(values);
+  __m256i best_columns = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  __m256i current_columns = best_columns;
+  const __m256i step = _mm256_set1_epi32(8);
+  size_t column = 8U;
+  for (; column + 8U <= columns; column += 8U) {
+    const __m256 current = _mm256_loadu_ps(values + column);
+    current_columns = _mm256_add_epi32(current_columns, step);
+    // a number also replaces a NaN, which no ordered comparison can
+    const __m256 greater = _mm256_or_ps(
+        _mm256_cmp_ps(current, best, _CMP_GT_OQ),
+        _mm256_and_ps(_mm256_cmp_ps(best, best, _CMP_UNORD_Q),
+                      _mm256_cmp_ps(current, current, _CMP_ORD_Q)));
+    best = _mm256_blendv_ps(best, current, greater);
+    best_columns = _mm256_blendv_epi8(best_columns, current_columns, _mm256_castps_si256(greater));
+  }
+
+  float lane_values[8];
+  int32_t lane_columns[8];
+  _mm256_storeu_ps(lane_values, best);
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(lane_columns), best_columns);
+  size_t best_lane = 0U;
+  for (size_t lane = 1U; lane < 8U; ++lane) {
+    if (beats(lane_values[lane], lane_values[best_lane]) ||
+        (ties(lane_values[lane], lane_values[best_lane]) &&
+         lane_columns[lane] < lane_columns[best_lane])) {
+      best_lane = lane;
+    }
+  }
+
+  size_t best_column = static_cast<size_t>(lane_columns[best_lane]);
+  for (; column < columns; ++column) {
+    if (beats(values[column], values[best_column])) {
+      best_column = column;
+    }
+  }
+  return best_column;
+}
+
+/// Once the heap is full most blocks of eight columns hold nothing larger
+/// than its threshold and are skipped after a single comparison.
+__attribute__((target("avx2"))) void top_k_avx2(top_candidates& best, const float* values,
+                                                size_t columns) {
+  size_t column = 0U;
+  for (; column < columns && !best.full(); ++column) {
+    best.offer(values[column], column);
+  }
+  for (; column + 8U <= columns; column += 8U) {
+    const __m256 block = _mm256_loadu_ps(values + column);
+    const __m256 greater = _mm256_cmp_ps(block, _mm256_set1_ps(best.threshold()), _CMP_GT_OQ);
+    int mask = _mm256_movemask_ps(greater);
+    while (mask != 0) {
+      const int lane = __builtin_ctz(mask);
+      best.offer(values[column + lane], column + lane);
+      mask &= mask - 1;
+    }
+  }
+  for (; column < columns; ++column) {
+    best.offer(values[column], column);
+  }
+}
+
+#endif
+}
+
+namespace vi {
+namespace la {
+namespace cpu {
+
+void row_argmax(float* indices, const float* values, size_t rows, size_t columns) {
+#if defined(VINN_X86_SELECTION_KERNELS)
+  if (columns >= 16U && avx2_supported()) {
+    for (size_t row = 0U; row < rows; ++row) {
+      indices[row] = static_cast<float>(argmax_avx2(values + row * columns, columns));
+    }
+    return;
+  }
+#endif
+  for (size_t row = 0U; row < rows; ++row) {
+    indices[row] = static_cast<float>(argmax_scalar(values + row * columns, columns));
+  }
+}
+
+void row_top_k(float* indices, float* top_values, const float* values, size_t rows,
+               size_t columns, size_t k) {
+  if (k == 0U) {
+    return;
+  }
+  top_candidates best(k);
+#if defined(VINN_X86_SELECTION_KERNELS)
+  const bool vectorized = columns >= 16U && avx2_supported();
+#endif
+  for (size_t row = 0U; row < rows; ++row) {
+    best.clear();
+#if defined(VINN_X86_SELECTION_KERNELS)
+    if (vectorized) {
+      top_k_avx2(best, values + row * columns, columns);
+    } else {
+      top_k_scalar(best, values + row * columns, columns);
+    }
+#else
+    top_k_scalar(best, values + row * columns, columns);
+#endif
+    best.store(indices + row * k, top_values + row * k);
+  }
+}
+}
+}
+}
@@ -0,0 +1,29 @@
+#ifndef __vinn__row_selection__
+#define __vinn__row_selection__
+
+#include <cstddef>
+
+namespace vi {
+namespace la {
+namespace cpu {
+
+/// Find the column of the largest value in every row, the first one on ties.
+/// NaN orders below every other value, as it does for row_top_k.
+/// Rows are scanned eight columns at a time with AVX2 where available.
+/// \param indices receives a column index for each of the rows
+/// \param values row-major rows x columns values
+void row_argmax(float* indices, const float* values, size_t rows, size_t columns);
+
+/// Find the k largest values of every row in descending order, lower columns
+/// first on ties and NaN last. AVX2 skips blocks of eight columns that can not beat the
+/// k-th best value found so far.
+/// \param indices receives k column indices for each of the rows
+/// \param top_values receives the k values for each of the rows
+/// \param values row-major rows x columns values, k must not exceed columns
+void row_top_k(float* indices, float* top_values, const float* values, size_t rows,
+               size_t columns, size_t k);
+}
+}
+}
+
+#endif
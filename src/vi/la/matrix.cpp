@@ -9,6 +9,12 @@
 namespace vi {
 namespace la {
 
+namespace {
+/// Results every element of which an operation writes are not initialized,
+/// so nothing has to be copied to a device to create them
+const float* const uninitialized = nullptr;
+}
+
 matrix::matrix() {}
 
 matrix::matrix(std::shared_ptr<vi::la::matrix_implementation> implementation)
@@ -72,6 +78,14 @@ matrix::matrix(vi::la::context& context, const float* values, size_t rows,
   _implementation = context.implement_matrix(rows, columns, values);
 }
 
+matrix matrix::adopt(vi::la::context& context, size_t rows, size_t columns,
+                     std::shared_ptr<float> values) throw(incompatible_dimensions) {
+  if (rows == 0U || columns == 0U) {
+    throw incompatible_dimensions("Matrix cannot have have 0 rows or columns");
+  }
+  return matrix(context.adopt_matrix(rows, columns, values));
+}
+
 matrix matrix::clone() const { return sub_matrix(0u, row_count() - 1U, 0U, column_count() - 1U); }
 
 matrix matrix::operator*(matrix const& other) const throw(incompatible_dimensions) {
@@ -79,13 +93,13 @@ matrix matrix::operator*(matrix const& other) const throw(incompatible_dimension
     throw incompatible_dimensions(*this, other, "*");
   }
 
-  matrix product(owning_context(), row_count(), other.column_count());
+  matrix product(owning_context(), uninitialized, row_count(), other.column_count());
   _implementation->owning_context().multiply(product, *this, other);
   return product;
 }
 
 matrix matrix::operator*(float const other) const {
-  matrix product(owning_context(), row_count(), column_count());
+  matrix product(owning_context(), uninitialized, row_count(), column_count());
   owning_context().multiply(product, *this, other);
   return product;
 }
@@ -94,7 +108,7 @@ matrix matrix::elementwise_product(const matrix& other) const throw(incompatible
   if (row_count() != other.row_count() || column_count() != other.column_count()) {
     throw incompatible_dimensions(*this, other, ".*");
   }
-  matrix product(owning_context(), row_count(), column_count());
+  matrix product(owning_context(), uninitialized, row_count(), column_count());
   owning_context().multiply_elementwise(product, *this, other);
   return product;
 }
@@ -106,13 +120,13 @@ matrix matrix::operator+(const matrix& other) const throw(incompatible_dimension
     throw vi::la::incompatible_dimensions(*this, other, "+");
   }
 
-  vi::la::matrix sum(other.owning_context(), row_count(), column_count());
+  vi::la::matrix sum(other.owning_context(), uninitialized, row_count(), column_count());
   owning_context().add(sum, *this, other);
   return sum;
 }
 
 matrix matrix::operator+(const float other) const {
-  vi::la::matrix sum(owning_context(), row_count(), column_count());
+  vi::la::matrix sum(owning_context(), uninitialized, row_count(), column_count());
   owning_context().add(sum, *this, other);
   return sum;
 }
@@ -122,13 +136,14 @@ matrix matrix::operator-(const matrix& other) const throw(incompatible_dimension
     throw vi::la::incompatible_dimensions(*this, other, "-");
   }
 
-  vi::la::matrix difference(other.owning_context(), row_count(), column_count());
+  vi::la::matrix difference(other.owning_context(), uninitialized, row_count(),
+                              column_count());
   owning_context().subtract(difference, *this, other);
   return difference;
 }
 
 matrix matrix::operator-(const float other) const {
-  vi::la::matrix difference(owning_context(), row_count(), column_count());
+  vi::la::matrix difference(owning_context(), uninitialized, row_count(), column_count());
   owning_context().add(difference, *this, -1.0 * other);
   return difference;
 }
@@ -153,6 +168,8 @@ float* matrix::operator[](size_t row_index) const throw(std::out_of_range) {
   return &buffer[row_index * column_count()];
 }
 
+const float* matrix::values() const { return _implementation->read_only_data(); }
+
 matrix matrix::columns(size_t start_column, size_t end_column) const throw(std::out_of_range) {
   return sub_matrix(0, row_count() - 1, start_column, end_column);
 }
@@ -247,9 +264,10 @@ incompatible_dimensions::incompatible_operands_message(const matrix& a, const ma
 }
 
 std::ostream& operator<<(std::ostream& os, const vi::la::matrix& matrix) {
+  const float* values = matrix.values();
   for (size_t m = 0U; m < matrix.row_count(); ++m) {
     for (size_t n = 0U; n < matrix.column_count(); ++n) {
-      os << matrix[m][n] << "\t";
+      os << values[m * matrix.column_count() + n] << "\t";
     }
     os << "\n";
   }
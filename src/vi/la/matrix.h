@@ -35,6 +35,11 @@ public:
   matrix(context& context, const float* values, size_t rows,
          size_t columns) throw(incompatible_dimensions);
 
+  /// Matrix on top of existing row-major values, used in place without copying
+  /// where the context allows
+  static matrix adopt(context& context, size_t rows, size_t columns,
+                      std::shared_ptr<float> values) throw(incompatible_dimensions);
+
   matrix clone() const;
 
   matrix operator*(const matrix& other) const throw(incompatible_dimensions);
@@ -50,6 +55,9 @@ public:
 
   matrix operator<<(const matrix& other) const throw(incompatible_dimensions);
   float* operator[](size_t row_index) const throw(std::out_of_range);
+  /// \return row-major values for reading only, unlike operator[] they are not
+  ///         copied back to the device the matrix lives on
+  const float* values() const;
 
   matrix columns(size_t start_column, size_t end_column) const throw(std::out_of_range);
   matrix column(size_t column_index) const throw(std::out_of_range);
@@ -72,6 +80,7 @@ public:
 private:
   friend class cpu_context;
   friend class opencl_context;
+  friend class scheduling_context;
   friend std::ostream& operator<<(std::ostream&, const vi::la::matrix&);
 
   matrix(std::shared_ptr<vi::la::matrix_implementation> implementation);
@@ -0,0 +1,75 @@
+#include "vi/la/matrix_implementation.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <set>
+
+namespace {
+
+std::atomic<size_t> allocation_count(0U);
+std::atomic<size_t> live_bytes(0U);
+
+/// Trackers whose peaks allocations raise, the count is read without the lock
+std::atomic<size_t> tracker_count(0U);
+std::mutex trackers_mutex;
+std::set<vi::la::allocation_tracker*> trackers;
+}
+
+namespace vi {
+namespace la {
+
+allocation_tracker::allocation_tracker() {
+  std::lock_guard<std::mutex> lock(trackers_mutex);
+  trackers.insert(this);
+  ++tracker_count;
+  _first_allocation_count = allocation_count.load();
+  _peak_bytes = live_bytes.load();
+}
+
+allocation_tracker::~allocation_tracker() {
+  std::lock_guard<std::mutex> lock(trackers_mutex);
+  trackers.erase(this);
+  --tracker_count;
+}
+
+void allocation_tracker::restart() {
+  std::lock_guard<std::mutex> lock(trackers_mutex);
+  _first_allocation_count = allocation_count.load();
+  _peak_bytes = live_bytes.load();
+}
+
+allocation_statistics allocation_tracker::statistics() const {
+  std::lock_guard<std::mutex> lock(trackers_mutex);
+  return {allocation_count.load() - _first_allocation_count, live_bytes.load(), _peak_bytes};
+}
+
+void allocation_tracker::raise_peak(size_t bytes) { _peak_bytes = std::max(_peak_bytes, bytes); }
+
+matrix_implementation::matrix_implementation(size_t allocated_bytes) : _allocated_bytes(0U) {
+  count_allocation(allocated_bytes);
+}
+
+matrix_implementation::~matrix_implementation() {
+  live_bytes.fetch_sub(_allocated_bytes, std::memory_order_relaxed);
+}
+
+const float* matrix_implementation::read_only_data() { return raw_data(); }
+
+void matrix_implementation::count_allocation(size_t allocated_bytes) {
+  if (allocated_bytes == 0U) {
+    return;
+  }
+  _allocated_bytes += allocated_bytes;
+  allocation_count.fetch_add(1U, std::memory_order_relaxed);
+  const size_t live =
+      live_bytes.fetch_add(allocated_bytes, std::memory_order_relaxed) + allocated_bytes;
+  if (tracker_count.load(std::memory_order_relaxed) > 0U) {
+    std::lock_guard<std::mutex> lock(trackers_mutex);
+    for (allocation_tracker* tracker : trackers) {
+      tracker->raise_peak(live);
+    }
+  }
+}
+}
+}
@@ -8,15 +8,65 @@ namespace la {
 
 class context;
 
+/// Memory allocated for the values of matrices of every context
+struct allocation_statistics {
+  size_t allocation_count;
+  size_t live_bytes;
+  size_t peak_bytes;
+};
+
+/// Measures the matrix memory allocated while it is active. The counts are
+/// global: matrices of every context and thread are counted, including those
+/// of concurrent trainers. Each tracker keeps its own peak, so trackers do not
+/// restart each other's measurements. The peak is updated only while a tracker
+/// exists, otherwise an allocation costs two relaxed atomic additions.
+class allocation_tracker {
+public:
+  allocation_tracker();
+  ~allocation_tracker();
+  allocation_tracker(const allocation_tracker&) = delete;
+  allocation_tracker& operator=(const allocation_tracker&) = delete;
+
+  /// Count allocations and the peak from now on
+  void restart();
+  /// \return allocations since the tracker was created or restarted, bytes
+  ///         live now and the most bytes live at once since then
+  allocation_statistics statistics() const;
+
+private:
+  friend class matrix_implementation;
+  /// Raise the peak, called with the registry of trackers locked
+  void raise_peak(size_t live_bytes);
+
+  size_t _first_allocation_count;
+  size_t _peak_bytes;
+};
+
 /// Interface that context specific matrices must conform to
 class matrix_implementation {
 public:
+  virtual ~matrix_implementation();
+
   virtual size_t row_count() const = 0;
   virtual size_t column_count() const = 0;
 
   virtual vi::la::context& owning_context() const = 0;
 
   virtual float* raw_data() = 0;
+  /// \return values the caller only reads, contexts that keep values on a device
+  ///         do not copy them back for it
+  virtual const float* read_only_data();
+
+protected:
+  /// \param allocated_bytes memory allocated for the values, zero when values are
+  ///        used in place or belong to other matrices
+  explicit matrix_implementation(size_t allocated_bytes = 0U);
+
+  /// Count memory allocated later for the matrix, released with the matrix
+  void count_allocation(size_t allocated_bytes);
+
+private:
+  size_t _allocated_bytes;
 };
 }
 }
@@ -5,6 +5,8 @@ namespace vi {
 namespace la {
 namespace opencl {
 
+build_result::build_result() : _success(false), _cached(false) {}
+
 bool build_result::success() const { return _success; }
 
 void build_result::set_success(bool success) { _success = success; }
@@ -16,6 +18,10 @@ void build_result::set_program(cl::Program& program) { _program.reset(new cl::Pr
 std::string build_result::log() const { return _log; }
 
 void build_result::set_log(const std::string& log) { _log = log; }
+
+bool build_result::cached() const { return _cached; }
+
+void build_result::set_cached(bool cached) { _cached = cached; }
 }
 }
 }
@@ -15,6 +15,8 @@ namespace opencl {
 /// Build product of opencl::builder
 class build_result {
 public:
+  build_result();
+
   bool success() const;
   void set_success(bool success);
 
@@ -24,9 +26,14 @@ public:
   std::string log() const;
   void set_log(const std::string& log);
 
+  /// true if the program was created from cached binaries instead of source
+  bool cached() const;
+  void set_cached(bool cached);
+
 private:
   std::unique_ptr<cl::Program> _program;
   bool _success;
+  bool _cached;
   std::string _log;
 };
 }
@@ -22,6 +22,70 @@ __kernel void matrix_multiply(__global real_t * product, __global real_t * opera
   product[(matrix_row * z + matrix_column)] = inner_product;
 }
 
+float load_bfloat16(__global const ushort * values, size_t index) {
+  return as_float(((uint)values[index]) << 16);
+}
+
+ushort round_to_bfloat16(float value) {
+  uint bits = as_uint(value);
+  if ((bits & 0x7fffffff) > 0x7f800000) {
+    return (ushort)((bits >> 16) | 0x0040);
+  }
+  uint rounding = 0x7fff + ((bits >> 16) & 1);
+  return (ushort)((bits + rounding) >> 16);
+}
+
+__kernel void matrix_pack_half(__global half * packed, __global real_t * original,
+                               size_t m, size_t n) {
+  size_t row = get_global_id(0);
+  size_t col = get_global_id(1);
+
+  vstore_half_rte((float)original[row * n + col], row * n + col, packed);
+}
+
+__kernel void matrix_pack_bfloat16(__global ushort * packed, __global real_t * original,
+                                   size_t m, size_t n) {
+  size_t row = get_global_id(0);
+  size_t col = get_global_id(1);
+
+  packed[row * n + col] = round_to_bfloat16((float)original[row * n + col]);
+}
+
+float round_to_half(float value) {
+  ushort bits;
+  vstore_half_rte(value, 0, (half *)&bits);
+  return vload_half(0, (half *)&bits);
+}
+
+__kernel void matrix_multiply_half(__global real_t * product, __global real_t * operand_1, __global half * operand_2,
+                                   size_t m, size_t n, size_t z) {
+  // operand_2 is stored in half precision, operand_1 is rounded as it is read,
+  // products accumulate in single precision
+  size_t row    = get_global_id(0);
+  size_t column = get_global_id(1);
+
+  float inner_product = 0.0f;
+  for (size_t l = 0; l < n; ++l) {
+    inner_product += round_to_half((float)operand_1[row * n + l]) * vload_half(column + l * z, operand_2);
+  }
+  product[row * z + column] = inner_product;
+}
+
+__kernel void matrix_multiply_bfloat16(__global real_t * product, __global real_t * operand_1, __global ushort * operand_2,
+                                       size_t m, size_t n, size_t z) {
+  // operand_2 is stored in bfloat16, operand_1 is rounded as it is read,
+  // products accumulate in single precision
+  size_t row    = get_global_id(0);
+  size_t column = get_global_id(1);
+
+  float inner_product = 0.0f;
+  for (size_t l = 0; l < n; ++l) {
+    float value = as_float(((uint)round_to_bfloat16((float)operand_1[row * n + l])) << 16);
+    inner_product += value * load_bfloat16(operand_2, column + l * z);
+  }
+  product[row * z + column] = inner_product;
+}
+
 __kernel void matrix_scalar_multiply(__global real_t * product, __global real_t * operand_1, real_t operand_2,
                                    size_t m, size_t n) {
   size_t row = get_global_id(0);
@@ -40,6 +104,44 @@ __kernel void matrix_elementwise_multiply(__global real_t * product, __global re
   product[row * n + col] = value;
 }
 
+__kernel void sparse_matrix_multiply(__global real_t * product, __global const ulong * row_offsets,
+                                     __global const uint * column_indices, __global const real_t * values,
+                                     __global real_t * operand_2, size_t n) {
+  // operand_1: m x k in compressed sparse row format
+  // operand_2: k x n
+  // product:   m x n
+  size_t row    = get_global_id(0);
+  size_t column = get_global_id(1);
+
+  real_t inner_product = 0.0;
+  for (ulong i = row_offsets[row]; i < row_offsets[row + 1]; ++i) {
+    inner_product += values[i] * operand_2[column_indices[i] * n + column];
+  }
+  product[row * n + column] = inner_product;
+}
+
+__kernel void sparse_transpose_matrix_multiply(__global real_t * product, __global const ulong * row_offsets,
+                                               __global const uint * column_indices,
+                                               __global const real_t * values, __global real_t * operand_2,
+                                               size_t m, size_t k, size_t n) {
+  // operand_1: m x k in compressed sparse row format, multiplied transposed
+  // operand_2: m x n
+  // product:   k x n
+  // every work item owns a column of the product, so the rows of operand_1 are
+  // accumulated in order without atomic updates
+  size_t column = get_global_id(0);
+
+  for (size_t row = 0; row < k; ++row) {
+    product[row * n + column] = 0.0;
+  }
+  for (size_t row = 0; row < m; ++row) {
+    real_t factor = operand_2[row * n + column];
+    for (ulong i = row_offsets[row]; i < row_offsets[row + 1]; ++i) {
+      product[column_indices[i] * n + column] += values[i] * factor;
+    }
+  }
+}
+
 __kernel void scalar_add(__global real_t * sum, __global real_t * operand_1, real_t operand_2,
                        size_t m, size_t n) {
   size_t row = get_global_id(0);
@@ -116,3 +218,114 @@ __kernel void matrix_log(__global real_t * logged, __global real_t * original, s
   logged[row * columns + col] = log(value);
 }
 
+// NaN orders below every other value, lower columns win ties
+bool argmax_precedes(real_t value, uint column, real_t best, uint best_column) {
+  if (isnan(value) != isnan(best)) {
+    return isnan(best);
+  }
+  return value > best || ((value == best || isnan(value)) && column < best_column);
+}
+
+// one work-group per row, the group size must be a power of two
+__kernel void matrix_row_argmax(__global real_t * indices, __global real_t * original, size_t rows,
+                                size_t columns, __local real_t * best_values,
+                                __local uint * best_columns) {
+  size_t row = get_group_id(0);
+  size_t lane = get_local_id(0);
+  size_t lanes = get_local_size(0);
+  __global real_t * values = original + row * columns;
+
+  // every lane keeps the first largest value of its columns, lanes without
+  // columns hold a NaN past the last column that every column precedes
+  real_t best = NAN;
+  uint best_column = (uint)columns;
+  for (size_t col = lane; col < columns; col += lanes) {
+    if (argmax_precedes(values[col], (uint)col, best, best_column)) {
+      best = values[col];
+      best_column = (uint)col;
+    }
+  }
+  best_values[lane] = best;
+  best_columns[lane] = best_column;
+  barrier(CLK_LOCAL_MEM_FENCE);
+
+  // lower columns win ties
+  for (size_t stride = lanes / 2; stride > 0; stride /= 2) {
+    if (lane < stride) {
+      real_t other = best_values[lane + stride];
+      uint other_column = best_columns[lane + stride];
+      if (argmax_precedes(other, other_column, best_values[lane], best_columns[lane])) {
+        best_values[lane] = other;
+        best_columns[lane] = other_column;
+      }
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+  }
+
+  if (lane == 0) {
+    indices[row] = (real_t)best_columns[0];
+  }
+}
+
+__kernel void matrix_row_top_k(__global real_t * indices, __global real_t * top_values,
+                               __global real_t * original, size_t rows, size_t columns, uint k,
+                               __global real_t * lane_values, __global uint * lane_columns,
+                               __local real_t * head_values, __local uint * head_columns,
+                               __local uint * head_lanes) {
+  size_t row = get_group_id(0);
+  size_t lane = get_local_id(0);
+  size_t lanes = get_local_size(0);
+  __global real_t * values = original + row * columns;
+  __global real_t * best_values = lane_values + (row * lanes + lane) * k;
+  __global uint * best_columns = lane_columns + (row * lanes + lane) * k;
+
+  // every lane keeps a sorted list of the best k values of its columns, a
+  // later column only displaces values it is strictly larger than
+  uint count = 0;
+  for (size_t col = lane; col < columns; col += lanes) {
+    real_t value = values[col];
+    if (count < k || value > best_values[k - 1]) {
+      uint position = count < k ? count++ : k - 1;
+      while (position > 0 && best_values[position - 1] < value) {
+        best_values[position] = best_values[position - 1];
+        best_columns[position] = best_columns[position - 1];
+        --position;
+      }
+      best_values[position] = value;
+      best_columns[position] = (uint)col;
+    }
+  }
+
+  // merge the lists, every round the best head among the lanes is taken
+  uint taken = 0;
+  for (uint rank = 0; rank < k; ++rank) {
+    head_values[lane] = taken < count ? best_values[taken] : -INFINITY;
+    head_columns[lane] = taken < count ? best_columns[taken] : (uint)columns;
+    head_lanes[lane] = (uint)lane;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (size_t stride = lanes / 2; stride > 0; stride /= 2) {
+      if (lane < stride) {
+        real_t other = head_values[lane + stride];
+        uint other_column = head_columns[lane + stride];
+        if (other > head_values[lane] ||
+            (other == head_values[lane] && other_column < head_columns[lane])) {
+          head_values[lane] = other;
+          head_columns[lane] = other_column;
+          head_lanes[lane] = head_lanes[lane + stride];
+        }
+      }
+      barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    if (lane == 0) {
+      indices[row * k + rank] = (real_t)head_columns[0];
+      top_values[row * k + rank] = head_values[0];
+    }
+    if (lane == head_lanes[0]) {
+      ++taken;
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+  }
+}
+
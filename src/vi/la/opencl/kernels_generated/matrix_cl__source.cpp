@@ -5,56 +5,160 @@ namespace la {
 namespace opencl_generated {
 void matrix_cl__source(const char** name, const char** data, size_t& length) {
   *name = "matrix.cl";
-  *data =
-      "#if defined(DOUBLE_SUPPORT_AVAILABLE)\n#pragma OPENCL EXTENSION cl_khr_fp64 : "
-      "enable\ntypedef double real_t;\n#else\ntypedef float real_t;\n#endif\n\n__kernel void "
-      "matrix_multiply(__global real_t * product, __global real_t * operand_1, __global real_t * "
-      "operand_2,\n                              size_t m, size_t n, size_t z) {\n  // operand_1: "
-      "m x n\n  // operand_2: n x z\n  // product:   m x z\n  size_t row    = get_global_id(0);\n  "
-      "size_t column = get_global_id(1);\n  size_t matrix_column = column;\n  size_t matrix_row = "
-      "row;\n\n  real_t inner_product = 0.0;\n  for (size_t l = 0; l < n; ++l) {\n    "
-      "inner_product += operand_1[(matrix_row * n + l)] * operand_2[(matrix_column + l * z)];\n  "
-      "}\n  product[(matrix_row * z + matrix_column)] = inner_product;\n}\n\n__kernel void "
-      "matrix_scalar_multiply(__global real_t * product, __global real_t * operand_1, real_t "
-      "operand_2,\n                                   size_t m, size_t n) {\n  size_t row = "
-      "get_global_id(0);\n  size_t col = get_global_id(1);\n\n  real_t value = operand_2 * "
-      "operand_1[row * n + col];\n  product[row * n + col] = value;\n}\n\n__kernel void "
-      "matrix_elementwise_multiply(__global real_t * product, __global real_t * operand_1, "
-      "__global real_t * operand_2,\n                                        size_t m, size_t n) "
-      "{\n  size_t row = get_global_id(0);\n  size_t col = get_global_id(1);\n\n  real_t value = "
-      "operand_1[row * n + col] * operand_2[row * n + col];\n  product[row * n + col] = "
-      "value;\n}\n\n__kernel void scalar_add(__global real_t * sum, __global real_t * operand_1, "
-      "real_t operand_2,\n                       size_t m, size_t n) {\n  size_t row = "
-      "get_global_id(0);\n  size_t col = get_global_id(1);\n\n  real_t value = operand_1[row * n + "
-      "col] + operand_2;\n  sum[row * n + col] = value;\n}\n\n__kernel void matrix_add(__global "
-      "real_t * sum, __global real_t * operand_1, __global real_t * operand_2,\n                   "
-      "         size_t m, size_t n) {\n  size_t row = get_global_id(0);\n  size_t col = "
-      "get_global_id(1);\n\n  real_t value = operand_1[row * n + col] + operand_2[row * n + "
-      "col];\n  sum[row * n + col] = value;\n}\n\n__kernel void matrix_subtract(__global real_t * "
-      "difference, __global real_t * operand_1, __global real_t * operand_2,\n                     "
-      "                   size_t m, size_t n) {\n  size_t row = get_global_id(0);\n  size_t col = "
-      "get_global_id(1);\n\n  real_t value = operand_1[row * n + col] - operand_2[row * n + "
-      "col];\n  difference[row * n + col] = value;\n}\n\n__kernel void matrix_merge(__global "
-      "real_t * merged, __global real_t * operand_1, __global real_t * operand_2,\n                "
-      "         size_t rows, size_t operand_1_columns, size_t operand_2_columns) {\n  size_t row   "
-      " = get_global_id(0U);\n\n  size_t merged_columns = operand_1_columns + "
-      "operand_2_columns;\n\n  for (size_t i = 0U; i < operand_1_columns; ++i) {\n    merged[row * "
-      "merged_columns + i] = operand_1[row * operand_1_columns + i];\n  }\n\n  for (size_t i = 0U; "
-      "i < operand_2_columns; ++i) {\n    merged[row * merged_columns + operand_1_columns + i] = "
-      "operand_2[row * operand_2_columns + i];\n  }\n}\n\n__kernel void matrix_transpose(__global "
-      "real_t * transposed, __global real_t * original,\n                             size_t "
-      "original_rows, size_t original_columns) {\n  size_t row    = get_global_id(0U);\n  size_t "
-      "column = get_global_id(1U);\n\n  transposed[column * original_rows + row] = original[row * "
-      "original_columns + column];\n}\n\n__kernel void sum_rows(__global real_t * summed, __global "
-      "real_t * original, size_t rows, size_t columns) {\n  size_t col = get_global_id(1);\n\n  "
-      "real_t sum = 0.0;\n  for (size_t row = 0U; row < rows; ++row) {\n    sum += original[row * "
-      "columns + col];\n  }\n  summed[col] = sum;\n}\n\n__kernel void sum_columns(__global real_t "
-      "* summed, __global real_t * original, size_t rows, size_t columns) {\n  size_t row = "
-      "get_global_id(0);\n\n  for (size_t col = 0U; col < columns; ++col) {\n    summed[row] += "
-      "original[row * columns + col];\n  }\n}\n\n__kernel void matrix_log(__global real_t * "
-      "logged, __global real_t * original, size_t rows, size_t columns) {\n  size_t row = "
-      "get_global_id(0);\n  size_t col = get_global_id(1);\n\n  real_t value = original[row * "
-      "columns + col];\n  logged[row * columns + col] = log(value);\n}\n\n";
+  *data = "#if defined(DOUBLE_SUPPORT_AVAILABLE)\n#pragma OPENCL EXTENSION cl_khr_fp64 : "
+          "enable\ntypedef double real_t;\n#else\ntypedef float real_t;\n#endif\n\n__kernel void "
+          "matrix_multiply(__global real_t * product, __global real_t * operand_1, __global real_t "
+          "* operand_2,\n                              size_t m, size_t n, size_t z) {\n  // "
+          "operand_1: m x n\n  // operand_2: n x z\n  // product:   m x z\n  size_t row    = "
+          "get_global_id(0);\n  size_t column = get_global_id(1);\n  size_t matrix_column = "
+          "column;\n  size_t matrix_row = row;\n\n  real_t inner_product = 0.0;\n  for (size_t l = "
+          "0; l < n; ++l) {\n    inner_product += operand_1[(matrix_row * n + l)] * "
+          "operand_2[(matrix_column + l * z)];\n  }\n  product[(matrix_row * z + matrix_column)] = "
+          "inner_product;\n}\n\nfloat load_bfloat16(__global const ushort * values, size_t index) "
+          "{\n  return as_float(((uint)values[index]) << 16);\n}\n\nushort round_to_bfloat16(float "
+          "value) {\n  uint bits = as_uint(value);\n  if ((bits & 0x7fffffff) > 0x7f800000) {\n    "
+          "return (ushort)((bits >> 16) | 0x0040);\n  }\n  uint rounding = 0x7fff + ((bits >> 16) "
+          "& 1);\n  return (ushort)((bits + rounding) >> 16);\n}\n\n__kernel void "
+          "matrix_pack_half(__global half * packed, __global real_t * original,\n                  "
+          "             size_t m, size_t n) {\n  size_t row = get_global_id(0);\n  size_t col = "
+          "get_global_id(1);\n\n  vstore_half_rte((float)original[row * n + col], row * n + col, "
+          "packed);\n}\n\n__kernel void matrix_pack_bfloat16(__global ushort * packed, __global "
+          "real_t * original,\n                                   size_t m, size_t n) {\n  size_t "
+          "row = get_global_id(0);\n  size_t col = get_global_id(1);\n\n  packed[row * n + col] = "
+          "round_to_bfloat16((float)original[row * n + col]);\n}\n\nfloat round_to_half(float "
+          "value) {\n  ushort bits;\n  vstore_half_rte(value, 0, (half *)&bits);\n  return "
+          "vload_half(0, (half *)&bits);\n}\n\n__kernel void matrix_multiply_half(__global real_t "
+          "* product, __global real_t * operand_1, __global half * operand_2,\n                    "
+          "               size_t m, size_t n, size_t z) {\n  // operand_2 is stored in half "
+          "precision, operand_1 is rounded as it is read,\n  // products accumulate in single "
+          "precision\n  size_t row    = get_global_id(0);\n  size_t column = get_global_id(1);\n\n "
+          " float inner_product = 0.0f;\n  for (size_t l = 0; l < n; ++l) {\n    inner_product += "
+          "round_to_half((float)operand_1[row * n + l]) * vload_half(column + l * z, operand_2);\n "
+          " }\n  product[row * z + column] = inner_product;\n}\n\n__kernel void "
+          "matrix_multiply_bfloat16(__global real_t * product, __global real_t * operand_1, "
+          "__global ushort * operand_2,\n                                       size_t m, size_t "
+          "n, size_t z) {\n  // operand_2 is stored in bfloat16, operand_1 is rounded as it is "
+          "read,\n  // products accumulate in single precision\n  size_t row    = "
+          "get_global_id(0);\n  size_t column = get_global_id(1);\n\n  float inner_product = "
+          "0.0f;\n  for (size_t l = 0; l < n; ++l) {\n    float value = "
+          "as_float(((uint)round_to_bfloat16((float)operand_1[row * n + l])) << 16);\n    "
+          "inner_product += value * load_bfloat16(operand_2, column + l * z);\n  }\n  product[row "
+          "* z + column] = inner_product;\n}\n\n__kernel void matrix_scalar_multiply(__global "
+          "real_t * product, __global real_t * operand_1, real_t operand_2,\n                      "
+          "             size_t m, size_t n) {\n  size_t row = get_global_id(0);\n  size_t col = "
+          "get_global_id(1);\n\n  real_t value = operand_2 * operand_1[row * n + col];\n  "
+          "product[row * n + col] = value;\n}\n\n__kernel void "
+          "matrix_elementwise_multiply(__global real_t * product, __global real_t * operand_1, "
+          "__global real_t * operand_2,\n                                        size_t m, size_t "
+          "n) {\n  size_t row = get_global_id(0);\n  size_t col = get_global_id(1);\n\n  real_t "
+          "value = operand_1[row * n + col] * operand_2[row * n + col];\n  product[row * n + col] "
+          "= value;\n}\n\n__kernel void sparse_matrix_multiply(__global real_t * product, __global "
+          "const ulong * row_offsets,\n                                     __global const uint * "
+          "column_indices, __global const real_t * values,\n                                     "
+          "__global real_t * operand_2, size_t n) {\n  // operand_1: m x k in compressed sparse "
+          "row format\n  // operand_2: k x n\n  // product:   m x n\n  size_t row    = "
+          "get_global_id(0);\n  size_t column = get_global_id(1);\n\n  real_t inner_product = "
+          "0.0;\n  for (ulong i = row_offsets[row]; i < row_offsets[row + 1]; ++i) {\n    "
+          "inner_product += values[i] * operand_2[column_indices[i] * n + column];\n  }\n  "
+          "product[row * n + column] = inner_product;\n}\n\n__kernel void "
+          "sparse_transpose_matrix_multiply(__global real_t * product, __global const ulong * "
+          "row_offsets,\n                                               __global const uint * "
+          "column_indices,\n                                               __global const real_t * "
+          "values, __global real_t * operand_2,\n                                               "
+          "size_t m, size_t k, size_t n) {\n  // operand_1: m x k in compressed sparse row format, "
+          "multiplied transposed\n  // operand_2: m x n\n  // product:   k x n\n  // every work "
+          "item owns a column of the product, so the rows of operand_1 are\n  // accumulated in "
+          "order without atomic updates\n  size_t column = get_global_id(0);\n\n  for (size_t row "
+          "= 0; row < k; ++row) {\n    product[row * n + column] = 0.0;\n  }\n  for (size_t row = "
+          "0; row < m; ++row) {\n    real_t factor = operand_2[row * n + column];\n    for (ulong "
+          "i = row_offsets[row]; i < row_offsets[row + 1]; ++i) {\n      product[column_indices[i] "
+          "* n + column] += values[i] * factor;\n    }\n  }\n}\n\n__kernel void "
+          "scalar_add(__global real_t * sum, __global real_t * operand_1, real_t operand_2,\n      "
+          "                 size_t m, size_t n) {\n  size_t row = get_global_id(0);\n  size_t col "
+          "= get_global_id(1);\n\n  real_t value = operand_1[row * n + col] + operand_2;\n  "
+          "sum[row * n + col] = value;\n}\n\n__kernel void matrix_add(__global real_t * sum, "
+          "__global real_t * operand_1, __global real_t * operand_2,\n                            "
+          "size_t m, size_t n) {\n  size_t row = get_global_id(0);\n  size_t col = "
+          "get_global_id(1);\n\n  real_t value = operand_1[row * n + col] + operand_2[row * n + "
+          "col];\n  sum[row * n + col] = value;\n}\n\n__kernel void matrix_subtract(__global "
+          "real_t * difference, __global real_t * operand_1, __global real_t * operand_2,\n        "
+          "                                size_t m, size_t n) {\n  size_t row = "
+          "get_global_id(0);\n  size_t col = get_global_id(1);\n\n  real_t value = operand_1[row * "
+          "n + col] - operand_2[row * n + col];\n  difference[row * n + col] = "
+          "value;\n}\n\n__kernel void matrix_merge(__global real_t * merged, __global real_t * "
+          "operand_1, __global real_t * operand_2,\n                         size_t rows, size_t "
+          "operand_1_columns, size_t operand_2_columns) {\n  size_t row    = "
+          "get_global_id(0U);\n\n  size_t merged_columns = operand_1_columns + "
+          "operand_2_columns;\n\n  for (size_t i = 0U; i < operand_1_columns; ++i) {\n    "
+          "merged[row * merged_columns + i] = operand_1[row * operand_1_columns + i];\n  }\n\n  "
+          "for (size_t i = 0U; i < operand_2_columns; ++i) {\n    merged[row * merged_columns + "
+          "operand_1_columns + i] = operand_2[row * operand_2_columns + i];\n  }\n}\n\n__kernel "
+          "void matrix_transpose(__global real_t * transposed, __global real_t * original,\n       "
+          "                      size_t original_rows, size_t original_columns) {\n  size_t row    "
+          "= get_global_id(0U);\n  size_t column = get_global_id(1U);\n\n  transposed[column * "
+          "original_rows + row] = original[row * original_columns + column];\n}\n\n__kernel void "
+          "sum_rows(__global real_t * summed, __global real_t * original, size_t rows, size_t "
+          "columns) {\n  size_t col = get_global_id(1);\n\n  real_t sum = 0.0;\n  for (size_t row "
+          "= 0U; row < rows; ++row) {\n    sum += original[row * columns + col];\n  }\n  "
+          "summed[col] = sum;\n}\n\n__kernel void sum_columns(__global real_t * summed, __global "
+          "real_t * original, size_t rows, size_t columns) {\n  size_t row = get_global_id(0);\n\n "
+          " for (size_t col = 0U; col < columns; ++col) {\n    summed[row] += original[row * "
+          "columns + col];\n  }\n}\n\n__kernel void matrix_log(__global real_t * logged, __global "
+          "real_t * original, size_t rows, size_t columns) {\n  size_t row = get_global_id(0);\n  "
+          "size_t col = get_global_id(1);\n\n  real_t value = original[row * columns + col];\n  "
+          "logged[row * columns + col] = log(value);\n}\n\n// NaN orders below every other value, "
+          "lower columns win ties\nbool argmax_precedes(real_t value, uint column, real_t best, "
+          "uint best_column) {\n  if (isnan(value) != isnan(best)) {\n    return isnan(best);\n  "
+          "}\n  return value > best || ((value == best || isnan(value)) && column < "
+          "best_column);\n}\n\n// one work-group per row, the group size must be a power of "
+          "two\n__kernel void matrix_row_argmax(__global real_t * indices, __global real_t * "
+          "original, size_t rows,\n                                size_t columns, __local real_t "
+          "* best_values,\n                                __local uint * best_columns) {\n  "
+          "size_t row = get_group_id(0);\n  size_t lane = get_local_id(0);\n  size_t lanes = "
+          "get_local_size(0);\n  __global real_t * values = original + row * columns;\n\n  // "
+          "every lane keeps the first largest value of its columns, lanes without\n  // columns "
+          "hold a NaN past the last column that every column precedes\n  real_t best = NAN;\n  "
+          "uint best_column = (uint)columns;\n  for (size_t col = lane; col < columns; col += "
+          "lanes) {\n    if (argmax_precedes(values[col], (uint)col, best, best_column)) {\n      "
+          "best = values[col];\n      best_column = (uint)col;\n    }\n  }\n  best_values[lane] = "
+          "best;\n  best_columns[lane] = best_column;\n  barrier(CLK_LOCAL_MEM_FENCE);\n\n  // "
+          "lower columns win ties\n  for (size_t stride = lanes / 2; stride > 0; stride /= 2) {\n  "
+          "  if (lane < stride) {\n      real_t other = best_values[lane + stride];\n      uint "
+          "other_column = best_columns[lane + stride];\n      if (argmax_precedes(other, "
+          "other_column, best_values[lane], best_columns[lane])) {\n        best_values[lane] = "
+          "other;\n        best_columns[lane] = other_column;\n      }\n    }\n    "
+          "barrier(CLK_LOCAL_MEM_FENCE);\n  }\n\n  if (lane == 0) {\n    indices[row] = "
+          "(real_t)best_columns[0];\n  }\n}\n\n__kernel void matrix_row_top_k(__global real_t * "
+          "indices, __global real_t * top_values,\n                               __global real_t "
+          "* original, size_t rows, size_t columns, uint k,\n                               "
+          "__global real_t * lane_values, __global uint * lane_columns,\n                          "
+          "     __local real_t * head_values, __local uint * head_columns,\n                       "
+          "        __local uint * head_lanes) {\n  size_t row = get_group_id(0);\n  size_t lane = "
+          "get_local_id(0);\n  size_t lanes = get_local_size(0);\n  __global real_t * values = "
+          "original + row * columns;\n  __global real_t * best_values = lane_values + (row * lanes "
+          "+ lane) * k;\n  __global uint * best_columns = lane_columns + (row * lanes + lane) * "
+          "k;\n\n  // every lane keeps a sorted list of the best k values of its columns, a\n  // "
+          "later column only displaces values it is strictly larger than\n  uint count = 0;\n  for "
+          "(size_t col = lane; col < columns; col += lanes) {\n    real_t value = values[col];\n   "
+          " if (count < k || value > best_values[k - 1]) {\n      uint position = count < k ? "
+          "count++ : k - 1;\n      while (position > 0 && best_values[position - 1] < value) {\n   "
+          "     best_values[position] = best_values[position - 1];\n        best_columns[position] "
+          "= best_columns[position - 1];\n        --position;\n      }\n      "
+          "best_values[position] = value;\n      best_columns[position] = (uint)col;\n    }\n  "
+          "}\n\n  // merge the lists, every round the best head among the lanes is taken\n  uint "
+          "taken = 0;\n  for (uint rank = 0; rank < k; ++rank) {\n    head_values[lane] = taken < "
+          "count ? best_values[taken] : -INFINITY;\n    head_columns[lane] = taken < count ? "
+          "best_columns[taken] : (uint)columns;\n    head_lanes[lane] = (uint)lane;\n    "
+          "barrier(CLK_LOCAL_MEM_FENCE);\n\n    for (size_t stride = lanes / 2; stride > 0; stride "
+          "/= 2) {\n      if (lane < stride) {\n        real_t other = head_values[lane + "
+          "stride];\n        uint other_column = head_columns[lane + stride];\n        if (other > "
+          "head_values[lane] ||\n            (other == head_values[lane] && other_column < "
+          "head_columns[lane])) {\n          head_values[lane] = other;\n          "
+          "head_columns[lane] = other_column;\n          head_lanes[lane] = head_lanes[lane + "
+          "stride];\n        }\n      }\n      barrier(CLK_LOCAL_MEM_FENCE);\n    }\n\n    if "
+          "(lane == 0) {\n      indices[row * k + rank] = (real_t)head_columns[0];\n      "
+          "top_values[row * k + rank] = head_values[0];\n    }\n    if (lane == head_lanes[0]) {\n "
+          "     ++taken;\n    }\n    barrier(CLK_LOCAL_MEM_FENCE);\n  }\n}\n\n";
   length = std::strlen(*data) + 1U;
   return;
 }
@@ -6,6 +6,19 @@
 #include <iterator>
 #include <sstream>
 #include <stdexcept>
+#include <utility>
+
+namespace {
+
+/// Program sources in build order, without null terminations
+std::string concatenate(const std::list<vi::la::opencl::source>& sources) {
+  std::string text;
+  for (const auto& source : sources) {
+    text.append(source.data(), source.length() - 1U);
+  }
+  return text;
+}
+}
 
 namespace vi {
 namespace la {
@@ -31,26 +44,66 @@ void builder::add_build_options(const std::vector<std::string>& options) {
 }
 
 bool builder::can_build(cl::Context& context) const {
-  if (!compiler_available(context)) {
+  std::vector<cl::Device> devices = context.getInfo<CL_CONTEXT_DEVICES>();
+  for (const cl::Device& device : devices) {
+    if (!can_build(device)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool builder::can_build(const cl::Device& device) const {
+  if (!compiler_available(device)) {
     return false;
   }
-  if (!supports_all_required_extensions(context)) {
+  if (!supports_all_required_extensions(device)) {
     return false;
   }
   return true;
 }
 
 build_result builder::build(cl::Context& context) {
-  build_result result;
-  result.set_success(false);
+  if (!can_build(context)) {
+    build_result result;
+    result.set_log("build context does not support all required features");
+    return result;
+  }
+  return build_from_source(context, load_sources());
+}
 
+build_result builder::build(cl::Context& context, const program_cache& cache) {
   if (!can_build(context)) {
+    build_result result;
     result.set_log("build context does not support all required features");
     return result;
   }
 
   // list owns and frees the source memory
   std::list<source> loaded_sources = load_sources();
+  const std::string sources = concatenate(loaded_sources);
+  const std::string options = combine_build_options();
+  std::vector<std::string> descriptions;
+  for (const cl::Device& device : context.getInfo<CL_CONTEXT_DEVICES>()) {
+    descriptions.push_back(program_cache::describe(device, sources, options));
+  }
+
+  build_result result;
+  if (build_from_binaries(context, descriptions, cache, result)) {
+    return result;
+  }
+  result = build_from_source(context, loaded_sources);
+  if (result.success()) {
+    store_binaries(result.program(), sources, cache);
+  }
+  return result;
+}
+
+build_result builder::build_from_source(cl::Context& context,
+                                        const std::list<source>& loaded_sources) const {
+  build_result result;
+  result.set_success(false);
+
   cl::Program::Sources sources;
   for (const auto& source : loaded_sources) {
     // source lenght should not include null termination
@@ -82,6 +135,63 @@ build_result builder::build(cl::Context& context) {
   return result;
 }
 
+bool builder::build_from_binaries(cl::Context& context,
+                                  const std::vector<std::string>& descriptions,
+                                  const program_cache& cache, build_result& result) const {
+  std::vector<cl::Device> devices = context.getInfo<CL_CONTEXT_DEVICES>();
+  std::vector<std::vector<unsigned char>> binaries(devices.size());
+  cl::Program::Binaries program_binaries;
+  for (size_t device_index = 0; device_index < devices.size(); ++device_index) {
+    if (!cache.load(descriptions[device_index], binaries[device_index])) {
+      return false;
+    }
+    program_binaries.push_back(
+        std::make_pair(binaries[device_index].data(), binaries[device_index].size()));
+  }
+
+  try {
+    cl::Program program(context, devices, program_binaries);
+    program.build(devices, combine_build_options().c_str());
+    result.set_program(program);
+  } catch (cl::Error&) {
+    // binaries the driver rejects are built from source and replaced
+    return false;
+  }
+  result.set_success(true);
+  result.set_cached(true);
+  result.set_log("Build succeeded from cached binaries\n");
+  return true;
+}
+
+void builder::store_binaries(cl::Program& program, const std::string& sources,
+                             const program_cache& cache) const {
+  std::vector<cl::Device> devices = program.getInfo<CL_PROGRAM_DEVICES>();
+  std::vector<size_t> sizes(devices.size());
+  if (clGetProgramInfo(program(), CL_PROGRAM_BINARY_SIZES, sizes.size() * sizeof(size_t),
+                       sizes.data(), nullptr) != CL_SUCCESS) {
+    return;
+  }
+
+  std::vector<std::vector<unsigned char>> binaries(devices.size());
+  std::vector<unsigned char*> binary_pointers;
+  for (size_t device_index = 0; device_index < devices.size(); ++device_index) {
+    binaries[device_index].resize(sizes[device_index]);
+    binary_pointers.push_back(sizes[device_index] != 0U ? binaries[device_index].data()
+                                                        : nullptr);
+  }
+  if (clGetProgramInfo(program(), CL_PROGRAM_BINARIES,
+                       binary_pointers.size() * sizeof(unsigned char*), binary_pointers.data(),
+                       nullptr) != CL_SUCCESS) {
+    return;
+  }
+
+  const std::string options = combine_build_options();
+  for (size_t device_index = 0; device_index < devices.size(); ++device_index) {
+    cache.store(program_cache::describe(devices[device_index], sources, options),
+                binaries[device_index]);
+  }
+}
+
 std::list<source> builder::load_sources() const {
   std::list<source> sources;
   for (const auto& path : _source_paths) {
@@ -98,37 +208,22 @@ std::string builder::combine_build_options() const {
   return options;
 }
 
-bool builder::compiler_available(cl::Context& context) const {
-  std::vector<cl::Device> devices = context.getInfo<CL_CONTEXT_DEVICES>();
-  for (cl::Device& device : devices) {
-    cl_bool available = device.getInfo<CL_DEVICE_COMPILER_AVAILABLE>();
-    if (!available) {
-      return false;
-    }
-  }
-  return true;
+bool builder::compiler_available(const cl::Device& device) const {
+  return device.getInfo<CL_DEVICE_COMPILER_AVAILABLE>() == CL_TRUE;
 }
 
-bool builder::supports_all_required_extensions(cl::Context& context) const {
-  std::vector<cl::Device> devices = context.getInfo<CL_CONTEXT_DEVICES>();
-
-  for (cl::Device& device : devices) {
-    std::string extensions_string = device.getInfo<CL_DEVICE_EXTENSIONS>();
-    std::istringstream iss(extensions_string);
-    std::set<std::string> available_extensions;
-    std::copy(std::istream_iterator<std::string>(iss), std::istream_iterator<std::string>(),
-              std::inserter(available_extensions, available_extensions.begin()));
-
-    std::set<std::string> matching_extensions;
-    std::set_intersection(available_extensions.begin(), available_extensions.end(),
-                          _required_extensions.begin(), _required_extensions.end(),
-                          std::inserter(matching_extensions, matching_extensions.begin()));
-    if (matching_extensions != _required_extensions) {
-      return false;
-    }
-  }
-
-  return true;
+bool builder::supports_all_required_extensions(const cl::Device& device) const {
+  std::string extensions_string = device.getInfo<CL_DEVICE_EXTENSIONS>();
+  std::istringstream iss(extensions_string);
+  std::set<std::string> available_extensions;
+  std::copy(std::istream_iterator<std::string>(iss), std::istream_iterator<std::string>(),
+            std::inserter(available_extensions, available_extensions.begin()));
+
+  std::set<std::string> matching_extensions;
+  std::set_intersection(available_extensions.begin(), available_extensions.end(),
+                        _required_extensions.begin(), _required_extensions.end(),
+                        std::inserter(matching_extensions, matching_extensions.begin()));
+  return matching_extensions == _required_extensions;
 }
 }
 }
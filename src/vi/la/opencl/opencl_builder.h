@@ -2,6 +2,7 @@
 #define __vinn__opencl_builder__
 
 #include <vi/la/opencl/build_result.h>
+#include <vi/la/opencl/program_cache.h>
 #include <vi/la/opencl/source.h>
 #include <vi/la/opencl/source_loader.h>
 
@@ -11,6 +12,7 @@
 
 namespace cl {
 class Context;
+class Device;
 }
 
 namespace vi {
@@ -29,14 +31,25 @@ public:
 
   /// return build result containing the opencl program on success
   build_result build(cl::Context& context);
+  /// Create the program from binaries cached for every device of the context,
+  /// or build it from source and cache the binaries if any of them is missing
+  build_result build(cl::Context& context, const program_cache& cache);
+
   bool can_build(cl::Context& context) const;
+  /// Checks a single device without creating a context for it
+  bool can_build(const cl::Device& device) const;
 
 private:
   std::list<source> load_sources() const;
   std::string combine_build_options() const;
-
-  bool compiler_available(cl::Context& context) const;
-  bool supports_all_required_extensions(cl::Context& context) const;
+  build_result build_from_source(cl::Context& context, const std::list<source>& sources) const;
+  bool build_from_binaries(cl::Context& context, const std::vector<std::string>& descriptions,
+                           const program_cache& cache, build_result& result) const;
+  void store_binaries(cl::Program& program, const std::string& sources,
+                      const program_cache& cache) const;
+
+  bool compiler_available(const cl::Device& device) const;
+  bool supports_all_required_extensions(const cl::Device& device) const;
 
   source_loader& _loader;
   std::set<std::string> _required_extensions;
@@ -6,26 +6,318 @@
 #include "vi/la/opencl/opencl_builder.h"
 #include "vi/la/opencl/opencl_matrix.h"
 #include "vi/la/opencl/kernels_generated/generated_opencl_sources.h"
+#include "vi/la/profiler.h"
+#include "vi/la/sparse_matrix.h"
+#include "vi/la/thread_cache.h"
+#include "vi/la/tuning_profile.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <CL/cl.hpp>
 #include <cmath>
+#include <limits>
+#include <list>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+/// Device buffer initialized from host memory, empty data gets a placeholder buffer
+cl::Buffer read_only_buffer(cl::Context& context, const void* data, size_t size) {
+  if (size == 0U) {
+    return cl::Buffer(context, CL_MEM_READ_ONLY, sizeof(cl_float));
+  }
+  return cl::Buffer(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, size,
+                    const_cast<void*>(data));
+}
+
+/// Largest power of two a row reduction kernel can run with, up to 64 lanes per row
+size_t row_group_size(const cl::Kernel& kernel, const cl::Device& device) {
+  const size_t max_group_size = kernel.getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(device);
+  size_t group_size = 64U;
+  while (group_size > max_group_size) {
+    group_size /= 2U;
+  }
+  return group_size;
+}
+
+/// Operations with less work than this run on a single device, splitting them
+/// costs more in launches and synchronization than it saves
+const size_t split_work_threshold = 1U << 20U;
+
+size_t greatest_common_divisor(size_t a, size_t b) {
+  while (b != 0U) {
+    const size_t remainder = a % b;
+    a = b;
+    b = remainder;
+  }
+  return a;
+}
+
+size_t least_common_multiple(size_t a, size_t b) { return a / greatest_common_divisor(a, b) * b; }
+
+/// Device parameters without a tuning profile: the driver chooses the work-group size
+const vi::la::tuning_profile::parameters device_defaults = {0U, 0U, 0U, 0U};
+}
 
 namespace vi {
 namespace la {
 
-opencl_context::opencl_context(const std::vector<cl_device_id>& device_ids) {
+/// Kernels and a command queue used by a single thread. Kernel arguments are
+/// set before every launch, so kernel objects can not be shared.
+struct opencl_context::kernel_set {
+  kernel_set(const cl::Context& context, const cl::Device& device, const cl::Program& program,
+             precision storage_precision)
+      : device(device), device_name(device.getInfo<CL_DEVICE_NAME>().c_str()),
+        queue(context, device, CL_QUEUE_PROFILING_ENABLE), profiling(false),
+        matrix_multiply(program, "matrix_multiply"),
+        matrix_pack(program, storage_precision == precision::half ? "matrix_pack_half"
+                                                                  : "matrix_pack_bfloat16"),
+        matrix_multiply_reduced_precision(program, storage_precision == precision::half
+                                                       ? "matrix_multiply_half"
+                                                       : "matrix_multiply_bfloat16"),
+        matrix_scalar_multiply(program, "matrix_scalar_multiply"),
+        matrix_elementwise_multiply(program, "matrix_elementwise_multiply"),
+        sparse_matrix_multiply(program, "sparse_matrix_multiply"),
+        sparse_transpose_matrix_multiply(program, "sparse_transpose_matrix_multiply"),
+        matrix_add(program, "matrix_add"), scalar_add(program, "scalar_add"),
+        matrix_subtract(program, "matrix_subtract"), matrix_sigmoid(program, "matrix_sigmoid"),
+        sigmoid_gradient(program, "matrix_sigmoid_gradient"),
+        hyperbolic_tangent(program, "matrix_hyperbolic_tangent"),
+        hyperbolic_tangent_gradient(program, "matrix_hyperbolic_tangent_gradient"),
+        matrix_softmax_exp(program, "matrix_softmax_exp"),
+        matrix_softmax_normalize(program, "matrix_softmax_normalize"),
+        matrix_merge(program, "matrix_merge"), matrix_transpose(program, "matrix_transpose"),
+        sum_rows(program, "sum_rows"), sum_columns(program, "sum_columns"),
+        log(program, "matrix_log"), row_argmax(program, "matrix_row_argmax"),
+        row_top_k(program, "matrix_row_top_k"), convolve_2d(program, "matrix_convolve_2d"),
+        top_k_lane_capacity(0U) {}
+
+  /// \return event to record a launch in while an operation is profiled, otherwise none
+  cl::Event* event() {
+    if (!profiling) {
+      return nullptr;
+    }
+    events.emplace_back();
+    return &events.back();
+  }
+
+  /// \return tuned work-group size of a kernel over rows x columns work items, the
+  ///         driver chooses when the tuned size does not divide them or is too large
+  cl::NDRange local_size(const tuning_profile* profile, const char* operation,
+                         const cl::Kernel& kernel, size_t rows, size_t columns) const {
+    const tuning_profile::parameters tuned =
+        profile == nullptr ? device_defaults
+                           : profile->find(device_name, operation,
+                                           tuning_profile::bucket(std::max(rows, columns)),
+                                           device_defaults);
+    const size_t group_size = tuned.workgroup_rows * tuned.workgroup_columns;
+    if (group_size == 0U || rows % tuned.workgroup_rows != 0U ||
+        columns % tuned.workgroup_columns != 0U ||
+        group_size > kernel.getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(device)) {
+      return cl::NullRange;
+    }
+    return cl::NDRange(tuned.workgroup_rows, tuned.workgroup_columns);
+  }
+
+  /// Grow the row top-k lane scratch to hold lane_count values and columns
+  void reserve_top_k_lanes(const cl::Context& context, size_t lane_count) {
+    if (lane_count <= top_k_lane_capacity) {
+      return;
+    }
+    top_k_lane_values = cl::Buffer(context, CL_MEM_READ_WRITE, lane_count * sizeof(cl_float));
+    top_k_lane_columns = cl::Buffer(context, CL_MEM_READ_WRITE, lane_count * sizeof(cl_uint));
+    top_k_lane_capacity = lane_count;
+  }
+
+  cl::Device device;
+  /// Name of the device in tuning profiles
+  std::string device_name;
+  cl::CommandQueue queue;
+  bool profiling;
+  std::vector<cl::Event> events;
+
+  cl::Kernel matrix_multiply;
+  cl::Kernel matrix_pack;
+  cl::Kernel matrix_multiply_reduced_precision;
+  cl::Kernel matrix_scalar_multiply;
+  cl::Kernel matrix_elementwise_multiply;
+  cl::Kernel sparse_matrix_multiply;
+  cl::Kernel sparse_transpose_matrix_multiply;
+
+  cl::Kernel matrix_add;
+  cl::Kernel scalar_add;
+  cl::Kernel matrix_subtract;
+
+  cl::Kernel matrix_sigmoid;
+  cl::Kernel sigmoid_gradient;
+  cl::Kernel hyperbolic_tangent;
+  cl::Kernel hyperbolic_tangent_gradient;
+  cl::Kernel matrix_softmax_exp;
+  cl::Kernel matrix_softmax_normalize;
+
+  cl::Kernel matrix_merge;
+  cl::Kernel matrix_transpose;
+
+  cl::Kernel sum_rows;
+  cl::Kernel sum_columns;
+  cl::Kernel log;
+  cl::Kernel row_argmax;
+  cl::Kernel row_top_k;
+
+  cl::Kernel convolve_2d;
+
+  /// Row top-k scratch, kept between launches as the largest one so far
+  cl::Buffer top_k_lane_values;
+  cl::Buffer top_k_lane_columns;
+  size_t top_k_lane_capacity;
+};
+
+/// Rows of the matrices an operation is split by, computed on one device
+struct opencl_context::row_block {
+  row_block(kernel_set& kernels, size_t first_row, size_t row_count)
+      : kernels(kernels), first_row(first_row), row_count(row_count) {}
+
+  /// \return the block rows of a result, all of it if the block covers every row
+  const cl::Buffer& rows_of(matrix& result) {
+    opencl::matrix* values = dynamic_cast<opencl::matrix*>(result.implementation());
+    return rows_of(result, *values->write_buffer());
+  }
+
+  /// \return the block rows of an operand the kernel only reads
+  const cl::Buffer& rows_of(const matrix& operand) {
+    opencl::matrix* values = dynamic_cast<opencl::matrix*>(operand.implementation());
+    return rows_of(operand, *values->read_buffer());
+  }
+
+  kernel_set& kernels;
+  const size_t first_row;
+  const size_t row_count;
+
+private:
+  const cl::Buffer& rows_of(const matrix& operand, cl::Buffer& buffer) {
+    if (first_row == 0U && row_count == operand.row_count()) {
+      return buffer;
+    }
+    // a result that is also an operand gets a single sub-buffer, overlapping
+    // sub-buffers of one buffer passed to a kernel are undefined behaviour
+    for (const std::pair<cl_mem, cl::Buffer>& sub_buffer : sub_buffers) {
+      if (sub_buffer.first == buffer()) {
+        return sub_buffer.second;
+      }
+    }
+    // the kernels write straight into the rows of the result, nothing is gathered
+    const size_t row_size = operand.column_count() * sizeof(cl_float);
+    cl_buffer_region region = {first_row * row_size, row_count * row_size};
+    sub_buffers.push_back(std::make_pair(
+        buffer(),
+        buffer.createSubBuffer(CL_MEM_READ_WRITE, CL_BUFFER_CREATE_TYPE_REGION, &region)));
+    return sub_buffers.back().second;
+  }
+
+  /// Sub-buffers of the block rows by the buffer they are part of
+  std::list<std::pair<cl_mem, cl::Buffer>> sub_buffers;
+};
+
+/// Times an operation on the host and the kernels it launches on the devices
+class opencl_context::operation_profile {
+public:
+  operation_profile(opencl_context& context, const char* name, const matrix& shaped,
+                    std::initializer_list<const matrix*> operands, double flops_per_element)
+      : _scope(context._profiler, name, shaped, operands, flops_per_element) {
+    if (!_scope.active()) {
+      return;
+    }
+    for (size_t device_index = 0U; device_index < context.device_count(); ++device_index) {
+      _kernel_sets.push_back(&context.thread_kernels(device_index));
+      _kernel_sets.back()->profiling = true;
+    }
+  }
+
+  void add_bytes(double bytes) { _scope.add_bytes(bytes); }
+
+  /// Operations wait for their kernels, so the events are complete when it ends
+  ~operation_profile() {
+    for (kernel_set* kernels : _kernel_sets) {
+      for (cl::Event& event : kernels->events) {
+        const cl_ulong start = event.getProfilingInfo<CL_PROFILING_COMMAND_START>();
+        const cl_ulong end = event.getProfilingInfo<CL_PROFILING_COMMAND_END>();
+        _scope.add_device_seconds(static_cast<double>(end - start) * 1e-9);
+      }
+      kernels->events.clear();
+      kernels->profiling = false;
+    }
+  }
+
+private:
+  profiler::scope _scope;
+  std::vector<kernel_set*> _kernel_sets;
+};
+
+class opencl_context::private_members {
+public:
+  std::vector<cl::Device> devices;
+  /// Sub-buffers have to start at a multiple of it on every device
+  size_t sub_buffer_alignment;
+  cl::Program program;
+
+  std::mutex device_weights_mutex;
+  std::vector<double> device_weights;
+
+  /// Kernel sets of every thread, one per device, created on first use
+  thread_cache<std::vector<std::unique_ptr<kernel_set>>> kernel_sets;
+  /// Maps matrix values to the host for all threads, command queues are thread safe
+  cl::CommandQueue host_queue;
+
+  std::atomic<size_t> bytes_to_device;
+  std::atomic<size_t> bytes_to_host;
+
+  /// Identifies the device copies of sparse matrices made by this context
+  uint64_t id;
+};
+
+/// Compressed sparse row arrays of a sparse matrix on the devices of a context
+struct opencl_context::sparse_buffers : public sparse_matrix::device_copy {
+  cl::Buffer row_offsets;
+  cl::Buffer column_indices;
+  cl::Buffer values;
+};
+
+opencl_context::opencl_context(const std::vector<cl_device_id>& device_ids,
+                               vi::la::precision storage_precision,
+                               const std::string& program_cache_directory)
+    : _members(new private_members), _storage_precision(storage_precision) {
+  static std::atomic<uint64_t> last_id(0U);
+  _members->bytes_to_device = 0U;
+  _members->bytes_to_host = 0U;
+  _members->id = ++last_id;
   std::vector<cl::Device> devices;
   for (cl_device_id device_id : device_ids) {
     devices.push_back(cl::Device(device_id));
   }
   _context = new cl::Context(devices);
-  _command_queue = new cl::CommandQueue(*_context, devices[0]);
-  load_kernels();
+  _members->devices = devices;
+  _members->host_queue = cl::CommandQueue(*_context, devices[0]);
+  _members->sub_buffer_alignment = 1U;
+  for (cl::Device& device : devices) {
+    const size_t alignment = device.getInfo<CL_DEVICE_MEM_BASE_ADDR_ALIGN>() / 8U;
+    _members->sub_buffer_alignment =
+        least_common_multiple(_members->sub_buffer_alignment, std::max<size_t>(alignment, 1U));
+  }
+  load_kernels(program_cache_directory);
+
+  _members->device_weights.assign(devices.size(), 1.0);
+  if (devices.size() > 1U) {
+    measure_device_weights();
+  }
 }
 
 opencl_context::~opencl_context() {
-  delete _command_queue;
+  _members.reset();
   delete _context;
 }
 
@@ -46,8 +338,7 @@ std::vector<cl_device_id> opencl_context::supported_devices(cl_device_type devic
     std::vector<cl::Device> available_devices;
     platform.getDevices(device_type, &available_devices);
     for (cl::Device& device : available_devices) {
-      cl::Context context({device});
-      if (builder.can_build(context)) {
+      if (builder.can_build(device)) {
         supported_devices.push_back(device());
       }
     }
@@ -56,7 +347,7 @@ std::vector<cl_device_id> opencl_context::supported_devices(cl_device_type devic
   return supported_devices;
 }
 
-void opencl_context::load_kernels() {
+void opencl_context::load_kernels(const std::string& program_cache_directory) {
 #if CONFIGURATION == Debug
   const std::string program_dir(std::string(SRCROOT) + "/src/vi/la/opencl/kernels");
   opencl::disk_source_loader loader(program_dir);
@@ -67,37 +358,158 @@ void opencl_context::load_kernels() {
   // builder.add_build_options({"-DDOUBLE_SUPPORT_AVAILABLE"});
   builder.add_source_paths({"matrix.cl", "activation_functions.cl", "convolution.cl"});
   builder.add_extension_requirements({"cl_khr_fp64"});
-  opencl::build_result result = builder.build(*_context);
+  opencl::program_cache cache(program_cache_directory);
+  opencl::build_result result = builder.build(*_context, cache);
   if (!result.success()) {
     throw std::runtime_error(result.log());
   }
 
-  cl::Program program = result.program();
-  _matrix_multiply_kernel = new cl::Kernel(program, "matrix_multiply");
-  _matrix_scalar_multiply = new cl::Kernel(program, "matrix_scalar_multiply");
-  _matrix_elementwise_multiply = new cl::Kernel(program, "matrix_elementwise_multiply");
-  _matrix_add = new cl::Kernel(program, "matrix_add");
-  _scalar_add = new cl::Kernel(program, "scalar_add");
-  _matrix_subtract = new cl::Kernel(program, "matrix_subtract");
-  _matrix_merge_kernel = new cl::Kernel(program, "matrix_merge");
-  _matrix_transpose_kernel = new cl::Kernel(program, "matrix_transpose");
-  _sum_rows = new cl::Kernel(program, "sum_rows");
-  _sum_columns = new cl::Kernel(program, "sum_columns");
-  _log = new cl::Kernel(program, "matrix_log");
-
-  _matrix_sigmoid_kernel = new cl::Kernel(program, "matrix_sigmoid");
-  _sigmoid_gradient = new cl::Kernel(program, "matrix_sigmoid_gradient");
-  _hyperbolic_tangent = new cl::Kernel(program, "matrix_hyperbolic_tangent");
-  _hyperbolic_tangent_gradient = new cl::Kernel(program, "matrix_hyperbolic_tangent_gradient");
-  _matrix_softmax_exp_kernel = new cl::Kernel(program, "matrix_softmax_exp");
-  _matrix_softmax_normalize_kernel = new cl::Kernel(program, "matrix_softmax_normalize");
-
-  _convolve_2d = new cl::Kernel(program, "matrix_convolve_2d");
+  _members->program = result.program();
+  // create the kernels of the constructing thread eagerly to surface errors early
+  thread_kernels();
+}
+
+opencl_context::kernel_set& opencl_context::thread_kernels(size_t device_index) {
+  std::vector<std::unique_ptr<kernel_set>>& device_kernels = _members->kernel_sets.local([&]() {
+    return std::unique_ptr<std::vector<std::unique_ptr<kernel_set>>>(
+        new std::vector<std::unique_ptr<kernel_set>>(_members->devices.size()));
+  });
+  std::unique_ptr<kernel_set>& kernels = device_kernels[device_index];
+  if (!kernels) {
+    kernels.reset(new kernel_set(*_context, _members->devices[device_index], _members->program,
+                                 _storage_precision));
+  }
+  return *kernels;
+}
+
+void opencl_context::for_row_blocks(const std::vector<const matrix*>& blocked, size_t work,
+                                    const std::function<void(row_block&)>& enqueue) {
+  const size_t rows = blocked[0]->row_count();
+  const std::vector<double> weights = device_weights();
+  if (weights.size() < 2U || work < split_work_threshold) {
+    row_block block(thread_kernels(), 0U, rows);
+    enqueue(block);
+    block.kernels.queue.finish();
+    return;
+  }
+
+  // blocks start at rows that are aligned in every blocked matrix
+  size_t granularity = 1U;
+  for (const matrix* operand : blocked) {
+    const size_t alignment = _members->sub_buffer_alignment;
+    const size_t row_size = operand->column_count() * sizeof(cl_float);
+    const size_t rows_per_alignment = alignment / greatest_common_divisor(alignment, row_size);
+    granularity = least_common_multiple(granularity, rows_per_alignment);
+  }
+
+  const double total_weight = std::accumulate(weights.begin(), weights.end(), 0.0);
+  std::vector<row_block> blocks;
+  double weight = 0.0;
+  size_t first_row = 0U;
+  for (size_t device_index = 0U; device_index < weights.size(); ++device_index) {
+    weight += weights[device_index];
+    size_t end_row = rows;
+    if (device_index + 1U < weights.size()) {
+      const double share = rows * weight / total_weight / granularity;
+      end_row = std::min(static_cast<size_t>(std::llround(share)) * granularity, rows);
+      end_row = std::max(end_row, first_row);
+    }
+    if (end_row > first_row) {
+      blocks.emplace_back(thread_kernels(device_index), first_row, end_row - first_row);
+    }
+    first_row = end_row;
+  }
+
+  // the devices run their blocks side by side
+  for (row_block& block : blocks) {
+    enqueue(block);
+  }
+  for (row_block& block : blocks) {
+    block.kernels.queue.finish();
+  }
+}
+
+void opencl_context::measure_device_weights() {
+  const size_t size = 128U;
+  const std::vector<float> values(size * size, 1.0f);
+  cl::Buffer operand = read_only_buffer(*_context, values.data(), values.size() * sizeof(float));
+  cl::Buffer product(*_context, CL_MEM_READ_WRITE, values.size() * sizeof(float));
+
+  std::vector<double> weights;
+  for (size_t device_index = 0U; device_index < _members->devices.size(); ++device_index) {
+    kernel_set& kernels = thread_kernels(device_index);
+    kernels.matrix_multiply.setArg(0, product);
+    kernels.matrix_multiply.setArg(1, operand);
+    kernels.matrix_multiply.setArg(2, operand);
+    kernels.matrix_multiply.setArg(3, size);
+    kernels.matrix_multiply.setArg(4, size);
+    kernels.matrix_multiply.setArg(5, size);
+
+    // the first run is a warm-up, the fastest of the rest counts
+    double fastest = std::numeric_limits<double>::max();
+    for (size_t run = 0U; run < 4U; ++run) {
+      const auto start = std::chrono::steady_clock::now();
+      kernels.queue.enqueueNDRangeKernel(kernels.matrix_multiply, cl::NDRange(0U, 0U),
+                                         cl::NDRange(size, size), cl::NullRange);
+      kernels.queue.finish();
+      const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      if (run > 0U) {
+        fastest = std::min(fastest, elapsed.count());
+      }
+    }
+    weights.push_back(1.0 / std::max(fastest, 1e-9));
+  }
+  set_device_weights(weights);
+}
+
+size_t opencl_context::device_count() const { return _members->devices.size(); }
+
+std::vector<double> opencl_context::device_weights() const {
+  std::lock_guard<std::mutex> lock(_members->device_weights_mutex);
+  return _members->device_weights;
+}
+
+void opencl_context::set_device_weights(const std::vector<double>& weights) {
+  if (weights.size() != _members->devices.size()) {
+    throw std::invalid_argument("expected a weight per device");
+  }
+  double total_weight = 0.0;
+  for (double weight : weights) {
+    if (!(weight >= 0.0)) {
+      throw std::invalid_argument("device weights must not be negative");
+    }
+    total_weight += weight;
+  }
+  if (!(total_weight > 0.0) || std::isinf(total_weight)) {
+    throw std::invalid_argument("device weights must have a finite positive sum");
+  }
+
+  std::lock_guard<std::mutex> lock(_members->device_weights_mutex);
+  _members->device_weights = weights;
+}
+
+transfer_statistics opencl_context::transfers() const {
+  return {_members->bytes_to_device, _members->bytes_to_host};
+}
+
+void opencl_context::transferred(size_t bytes_to_device, size_t bytes_to_host) {
+  _members->bytes_to_device += bytes_to_device;
+  _members->bytes_to_host += bytes_to_host;
+}
+
+vi::la::precision opencl_context::storage_precision() const { return _storage_precision; }
+
+std::vector<std::string> opencl_context::tuned_devices() const {
+  std::vector<std::string> names;
+  for (const cl::Device& device : _members->devices) {
+    names.push_back(device.getInfo<CL_DEVICE_NAME>().c_str());
+  }
+  return names;
 }
 
 cl::Context& opencl_context::context() { return *_context; }
 
-cl::CommandQueue& opencl_context::command_queue() { return *_command_queue; }
+cl::CommandQueue& opencl_context::command_queue() { return _members->host_queue; }
 
 std::shared_ptr<vi::la::matrix_implementation>
 opencl_context::implement_matrix(size_t rows, size_t columns, const float* initial_values) {
@@ -105,283 +517,508 @@ opencl_context::implement_matrix(size_t rows, size_t columns, const float* initi
       new opencl::matrix(*this, rows, columns, initial_values));
 }
 
+std::shared_ptr<vi::la::matrix_implementation>
+opencl_context::adopt_matrix(size_t rows, size_t columns, std::shared_ptr<float> values) {
+  return implement_matrix(rows, columns, values.get());
+}
+
 void opencl_context::multiply(matrix& product, const matrix& operand_1, const matrix& operand_2) {
-  opencl::matrix* product_impl = (opencl::matrix*)(product.implementation());
-  opencl::matrix* operand_1_impl = (opencl::matrix*)(operand_1.implementation());
+  operation_profile profile(*this, "multiply", product, {&operand_1, &operand_2},
+                            2.0 * operand_1.column_count());
+  if (_storage_precision != precision::single) {
+    multiply_reduced_precision(product, operand_1, operand_2);
+    return;
+  }
+
   opencl::matrix* operand_2_impl = (opencl::matrix*)(operand_2.implementation());
+  const size_t work = product.row_count() * product.column_count() * operand_2.row_count();
+
+  // every device multiplies a block of operand_1 rows with all of operand_2
+  for_row_blocks({&product, &operand_1}, work, [&](row_block& block) {
+    cl::Kernel& kernel = block.kernels.matrix_multiply;
+    kernel.setArg(0, block.rows_of(product));
+    kernel.setArg(1, block.rows_of(operand_1));
+    kernel.setArg(2, *operand_2_impl->read_buffer());
+
+    // operand_1: m x n
+    // operand_2: n x k
+    // product:   m x k
+
+    kernel.setArg(3, block.row_count);
+    kernel.setArg(4, operand_2.row_count());
+    kernel.setArg(5, operand_2.column_count());
+
+    cl::NDRange offset(0U, 0U);
+    cl::NDRange workgroup_size = block.kernels.local_size(
+        _tuning_profile.get(), "multiply", kernel, block.row_count, product.column_count());
+    cl::NDRange size(block.row_count, product.column_count());
+
+    block.kernels.queue.enqueueNDRangeKernel(kernel, offset, size, workgroup_size, nullptr,
+                                             block.kernels.event());
+  });
+}
 
-  _matrix_multiply_kernel->setArg(0, *product_impl->get());
-  _matrix_multiply_kernel->setArg(1, *operand_1_impl->get());
-  _matrix_multiply_kernel->setArg(2, *operand_2_impl->get());
+void opencl_context::multiply_reduced_precision(matrix& product, const matrix& operand_1,
+                                                const matrix& operand_2) {
+  if (product.implementation() == operand_1.implementation()) {
+    // work items would read operand_1 values other work items have overwritten
+    multiply_reduced_precision(product, operand_1.clone(), operand_2);
+    return;
+  }
 
-  // operand_1: m x n
-  // operand_2: n x k
-  // product:   m x k
+  kernel_set& kernels = thread_kernels();
+  opencl::matrix* product_impl = dynamic_cast<opencl::matrix*>(product.implementation());
+  opencl::matrix* operand_1_impl = dynamic_cast<opencl::matrix*>(operand_1.implementation());
+  opencl::matrix* operand_2_impl = dynamic_cast<opencl::matrix*>(operand_2.implementation());
 
-  _matrix_multiply_kernel->setArg(3, operand_1.row_count());
-  _matrix_multiply_kernel->setArg(4, operand_2.row_count());
-  _matrix_multiply_kernel->setArg(5, operand_2.column_count());
+  // operand_2 is rounded to storage precision on the device and kept packed until it is
+  // written again, so that weights are packed once for as many products as they take part
+  // in. operand_1 changes with every product and is rounded as the kernel reads it.
+  cl::Buffer* packed_operand_2 =
+      operand_2_impl->packed_buffer([&](cl::Buffer& packed, cl::Buffer& values) {
+        kernels.matrix_pack.setArg(0, packed);
+        kernels.matrix_pack.setArg(1, values);
+        kernels.matrix_pack.setArg(2, operand_2.row_count());
+        kernels.matrix_pack.setArg(3, operand_2.column_count());
+
+        cl::NDRange offset(0U, 0U);
+        cl::NDRange size(operand_2.row_count(), operand_2.column_count());
+        kernels.queue.enqueueNDRangeKernel(kernels.matrix_pack, offset, size, cl::NullRange,
+                                           nullptr, kernels.event());
+        // products on the queues of other threads may use the packed values next
+        kernels.queue.finish();
+      });
+
+  kernels.matrix_multiply_reduced_precision.setArg(0, *product_impl->write_buffer());
+  kernels.matrix_multiply_reduced_precision.setArg(1, *operand_1_impl->read_buffer());
+  kernels.matrix_multiply_reduced_precision.setArg(2, *packed_operand_2);
+  kernels.matrix_multiply_reduced_precision.setArg(3, operand_1.row_count());
+  kernels.matrix_multiply_reduced_precision.setArg(4, operand_2.row_count());
+  kernels.matrix_multiply_reduced_precision.setArg(5, operand_2.column_count());
 
   cl::NDRange offset(0U, 0U);
-  cl::NDRange workgroup_size(1U, 1U);
   cl::NDRange size(product.row_count(), product.column_count());
-
-  _command_queue->enqueueNDRangeKernel(*_matrix_multiply_kernel, offset, size, workgroup_size);
-  _command_queue->finish();
+  kernels.queue.enqueueNDRangeKernel(kernels.matrix_multiply_reduced_precision, offset, size,
+                                     cl::NullRange, nullptr, kernels.event());
+  kernels.queue.finish();
 }
 
 void opencl_context::multiply(matrix& product, const matrix& operand_1, const float operand_2) {
-  opencl::matrix* product_impl = dynamic_cast<opencl::matrix*>(product.implementation());
-  opencl::matrix* operand_1_impl = dynamic_cast<opencl::matrix*>(operand_1.implementation());
-
-  _matrix_scalar_multiply->setArg(0, *product_impl->get());
-  _matrix_scalar_multiply->setArg(1, *operand_1_impl->get());
-  _matrix_scalar_multiply->setArg(2, operand_2);
-  _matrix_scalar_multiply->setArg(3, product.row_count());
-  _matrix_scalar_multiply->setArg(4, product.column_count());
-
-  cl::NDRange offset(0U, 0U);
-  cl::NDRange size(product.row_count(), product.column_count());
-  _command_queue->enqueueNDRangeKernel(*_matrix_scalar_multiply, offset, size);
-  _command_queue->finish();
+  operation_profile profile(*this, "scalar_multiply", product, {&operand_1}, 1.0);
+  const size_t work = product.row_count() * product.column_count();
+  for_row_blocks({&product, &operand_1}, work, [&](row_block& block) {
+    cl::Kernel& kernel = block.kernels.matrix_scalar_multiply;
+    kernel.setArg(0, block.rows_of(product));
+    kernel.setArg(1, block.rows_of(operand_1));
+    kernel.setArg(2, operand_2);
+    kernel.setArg(3, block.row_count);
+    kernel.setArg(4, product.column_count());
+
+    cl::NDRange offset(0U, 0U);
+    cl::NDRange size(block.row_count, product.column_count());
+    block.kernels.queue.enqueueNDRangeKernel(kernel, offset, size, cl::NullRange, nullptr,
+                                             block.kernels.event());
+  });
 }
 
 void opencl_context::multiply_elementwise(matrix& product, const matrix& operand_1,
                                           const matrix& operand_2) {
+  operation_profile profile(*this, "multiply_elementwise", product, {&operand_1, &operand_2}, 1.0);
+  const size_t work = product.row_count() * product.column_count();
+  for_row_blocks({&product, &operand_1, &operand_2}, work, [&](row_block& block) {
+    cl::Kernel& kernel = block.kernels.matrix_elementwise_multiply;
+    kernel.setArg(0, block.rows_of(product));
+    kernel.setArg(1, block.rows_of(operand_1));
+    kernel.setArg(2, block.rows_of(operand_2));
+    kernel.setArg(3, block.row_count);
+    kernel.setArg(4, product.column_count());
+
+    cl::NDRange offset(0U, 0U);
+    cl::NDRange workgroup_size = block.kernels.local_size(
+        _tuning_profile.get(), "elementwise", kernel, block.row_count, product.column_count());
+    cl::NDRange size(block.row_count, product.column_count());
+    block.kernels.queue.enqueueNDRangeKernel(kernel, offset, size, workgroup_size, nullptr,
+                                             block.kernels.event());
+  });
+}
+
+void opencl_context::multiply(matrix& product, const sparse_matrix& operand_1,
+                              const matrix& operand_2) {
+  operation_profile profile(*this, "sparse_multiply", product, {&operand_2},
+                            2.0 * operand_1.non_zero_count() / operand_1.row_count());
+  profile.add_bytes(operand_1.stored_bytes());
+  kernel_set& kernels = thread_kernels();
   opencl::matrix* product_impl = dynamic_cast<opencl::matrix*>(product.implementation());
-  opencl::matrix* operand_1_impl = dynamic_cast<opencl::matrix*>(operand_1.implementation());
   opencl::matrix* operand_2_impl = dynamic_cast<opencl::matrix*>(operand_2.implementation());
+  const sparse_buffers& operand_1_buffers = device_buffers(operand_1);
 
-  _matrix_elementwise_multiply->setArg(0, *product_impl->get());
-  _matrix_elementwise_multiply->setArg(1, *operand_1_impl->get());
-  _matrix_elementwise_multiply->setArg(2, *operand_2_impl->get());
-  _matrix_elementwise_multiply->setArg(3, product.row_count());
-  _matrix_elementwise_multiply->setArg(4, product.column_count());
+  kernels.sparse_matrix_multiply.setArg(0, *product_impl->write_buffer());
+  kernels.sparse_matrix_multiply.setArg(1, operand_1_buffers.row_offsets);
+  kernels.sparse_matrix_multiply.setArg(2, operand_1_buffers.column_indices);
+  kernels.sparse_matrix_multiply.setArg(3, operand_1_buffers.values);
+  kernels.sparse_matrix_multiply.setArg(4, *operand_2_impl->read_buffer());
+  kernels.sparse_matrix_multiply.setArg(5, product.column_count());
 
   cl::NDRange offset(0U, 0U);
-  cl::NDRange workgroup_size(1U, 1U);
   cl::NDRange size(product.row_count(), product.column_count());
 
-  _command_queue->enqueueNDRangeKernel(*_matrix_elementwise_multiply, offset, size, workgroup_size);
-  _command_queue->finish();
+  kernels.queue.enqueueNDRangeKernel(kernels.sparse_matrix_multiply, offset, size, cl::NullRange,
+                                     nullptr, kernels.event());
+  kernels.queue.finish();
 }
 
-void opencl_context::add(matrix& sum, const matrix& operand_1, const float operand_2) {
-  opencl::matrix* sum_impl = dynamic_cast<opencl::matrix*>(sum.implementation());
-  opencl::matrix* operand_1_impl = dynamic_cast<opencl::matrix*>(operand_1.implementation());
-
-  _scalar_add->setArg(0, *sum_impl->get());
-  _scalar_add->setArg(1, *operand_1_impl->get());
-  _scalar_add->setArg(2, operand_2);
-  _scalar_add->setArg(3, sum.row_count());
-  _scalar_add->setArg(4, sum.column_count());
+void opencl_context::transpose_multiply(matrix& product, const sparse_matrix& operand_1,
+                                        const matrix& operand_2) {
+  operation_profile profile(*this, "sparse_transpose_multiply", product, {&operand_2},
+                            2.0 * operand_1.non_zero_count() / operand_1.column_count());
+  profile.add_bytes(operand_1.stored_bytes());
+  kernel_set& kernels = thread_kernels();
+  opencl::matrix* product_impl = dynamic_cast<opencl::matrix*>(product.implementation());
+  opencl::matrix* operand_2_impl = dynamic_cast<opencl::matrix*>(operand_2.implementation());
+  const sparse_buffers& operand_1_buffers = device_buffers(operand_1);
+
+  cl::Kernel& kernel = kernels.sparse_transpose_matrix_multiply;
+  kernel.setArg(0, *product_impl->write_buffer());
+  kernel.setArg(1, operand_1_buffers.row_offsets);
+  kernel.setArg(2, operand_1_buffers.column_indices);
+  kernel.setArg(3, operand_1_buffers.values);
+  kernel.setArg(4, *operand_2_impl->read_buffer());
+  kernel.setArg(5, operand_1.row_count());
+  kernel.setArg(6, operand_1.column_count());
+  kernel.setArg(7, product.column_count());
+
+  cl::NDRange offset(0U);
+  cl::NDRange size(product.column_count());
+  kernels.queue.enqueueNDRangeKernel(kernel, offset, size, cl::NullRange, nullptr,
+                                     kernels.event());
+  kernels.queue.finish();
+}
 
-  cl::NDRange offset(0U, 0U);
-  cl::NDRange workgroup_size(1U, 1U);
-  cl::NDRange size(sum.row_count(), sum.column_count());
+const opencl_context::sparse_buffers& opencl_context::device_buffers(const sparse_matrix& matrix) {
+  const sparse_matrix::device_copy& copy = matrix.device_copy_for(_members->id, [&]() {
+    std::unique_ptr<sparse_buffers> buffers(new sparse_buffers);
+    const std::vector<cl_ulong> row_offsets(matrix.row_offsets().begin(),
+                                            matrix.row_offsets().end());
+    buffers->row_offsets = read_only_buffer(*_context, row_offsets.data(),
+                                            row_offsets.size() * sizeof(cl_ulong));
+    buffers->column_indices = read_only_buffer(*_context, matrix.column_indices().data(),
+                                               matrix.non_zero_count() * sizeof(cl_uint));
+    buffers->values = read_only_buffer(*_context, matrix.values().data(),
+                                       matrix.non_zero_count() * sizeof(cl_float));
+    transferred(matrix.stored_bytes(), 0U);
+    return std::unique_ptr<sparse_matrix::device_copy>(std::move(buffers));
+  });
+  return static_cast<const sparse_buffers&>(copy);
+}
 
-  _command_queue->enqueueNDRangeKernel(*_scalar_add, offset, size, workgroup_size);
-  _command_queue->finish();
+void opencl_context::add(matrix& sum, const matrix& operand_1, const float operand_2) {
+  operation_profile profile(*this, "scalar_add", sum, {&operand_1}, 1.0);
+  const size_t work = sum.row_count() * sum.column_count();
+  for_row_blocks({&sum, &operand_1}, work, [&](row_block& block) {
+    cl::Kernel& kernel = block.kernels.scalar_add;
+    kernel.setArg(0, block.rows_of(sum));
+    kernel.setArg(1, block.rows_of(operand_1));
+    kernel.setArg(2, operand_2);
+    kernel.setArg(3, block.row_count);
+    kernel.setArg(4, sum.column_count());
+
+    cl::NDRange offset(0U, 0U);
+    cl::NDRange workgroup_size = block.kernels.local_size(
+        _tuning_profile.get(), "elementwise", kernel, block.row_count, sum.column_count());
+    cl::NDRange size(block.row_count, sum.column_count());
+    block.kernels.queue.enqueueNDRangeKernel(kernel, offset, size, workgroup_size, nullptr,
+                                             block.kernels.event());
+  });
 }
 
 void opencl_context::add(matrix& sum, const matrix& operand_1, const matrix& operand_2) {
-  opencl::matrix* sum_impl = dynamic_cast<opencl::matrix*>(sum.implementation());
-  opencl::matrix* operand_1_impl = dynamic_cast<opencl::matrix*>(operand_1.implementation());
-  opencl::matrix* operand_2_impl = dynamic_cast<opencl::matrix*>(operand_2.implementation());
-
-  _matrix_add->setArg(0, *sum_impl->get());
-  _matrix_add->setArg(1, *operand_1_impl->get());
-  _matrix_add->setArg(2, *operand_2_impl->get());
-  _matrix_add->setArg(3, sum.row_count());
-  _matrix_add->setArg(4, sum.column_count());
-
-  cl::NDRange offset(0U, 0U);
-  cl::NDRange workgroup_size(1U, 1U);
-  cl::NDRange size(sum.row_count(), sum.column_count());
-
-  _command_queue->enqueueNDRangeKernel(*_matrix_add, offset, size, workgroup_size);
-  _command_queue->finish();
+  operation_profile profile(*this, "add", sum, {&operand_1, &operand_2}, 1.0);
+  const size_t work = sum.row_count() * sum.column_count();
+  for_row_blocks({&sum, &operand_1, &operand_2}, work, [&](row_block& block) {
+    cl::Kernel& kernel = block.kernels.matrix_add;
+    kernel.setArg(0, block.rows_of(sum));
+    kernel.setArg(1, block.rows_of(operand_1));
+    kernel.setArg(2, block.rows_of(operand_2));
+    kernel.setArg(3, block.row_count);
+    kernel.setArg(4, sum.column_count());
+
+    cl::NDRange offset(0U, 0U);
+    cl::NDRange workgroup_size = block.kernels.local_size(
+        _tuning_profile.get(), "elementwise", kernel, block.row_count, sum.column_count());
+    cl::NDRange size(block.row_count, sum.column_count());
+    block.kernels.queue.enqueueNDRangeKernel(kernel, offset, size, workgroup_size, nullptr,
+                                             block.kernels.event());
+  });
 }
 
 void opencl_context::subtract(matrix& difference, const matrix& operand_1,
                               const matrix& operand_2) {
-  opencl::matrix* difference_impl = dynamic_cast<opencl::matrix*>(difference.implementation());
-  opencl::matrix* operand_1_impl = dynamic_cast<opencl::matrix*>(operand_1.implementation());
-  opencl::matrix* operand_2_impl = dynamic_cast<opencl::matrix*>(operand_2.implementation());
-
-  _matrix_subtract->setArg(0, *difference_impl->get());
-  _matrix_subtract->setArg(1, *operand_1_impl->get());
-  _matrix_subtract->setArg(2, *operand_2_impl->get());
-  _matrix_subtract->setArg(3, difference.row_count());
-  _matrix_subtract->setArg(4, difference.column_count());
-
-  cl::NDRange offset(0U, 0U);
-  cl::NDRange workgroup_size(1U, 1U);
-  cl::NDRange size(difference.row_count(), difference.column_count());
-
-  _command_queue->enqueueNDRangeKernel(*_matrix_subtract, offset, size, workgroup_size);
-  _command_queue->finish();
+  operation_profile profile(*this, "subtract", difference, {&operand_1, &operand_2}, 1.0);
+  const size_t work = difference.row_count() * difference.column_count();
+  for_row_blocks({&difference, &operand_1, &operand_2}, work, [&](row_block& block) {
+    cl::Kernel& kernel = block.kernels.matrix_subtract;
+    kernel.setArg(0, block.rows_of(difference));
+    kernel.setArg(1, block.rows_of(operand_1));
+    kernel.setArg(2, block.rows_of(operand_2));
+    kernel.setArg(3, block.row_count);
+    kernel.setArg(4, difference.column_count());
+
+    cl::NDRange offset(0U, 0U);
+    cl::NDRange workgroup_size = block.kernels.local_size(
+        _tuning_profile.get(), "elementwise", kernel, block.row_count, difference.column_count());
+    cl::NDRange size(block.row_count, difference.column_count());
+    block.kernels.queue.enqueueNDRangeKernel(kernel, offset, size, workgroup_size, nullptr,
+                                             block.kernels.event());
+  });
 }
 
 void opencl_context::sigmoid(matrix& operand) {
-  opencl::matrix* impl = (opencl::matrix*)operand.implementation();
-  _matrix_sigmoid_kernel->setArg(0, *impl->get());
-  _matrix_sigmoid_kernel->setArg(1, operand.row_count());
-  _matrix_sigmoid_kernel->setArg(2, operand.column_count());
-
-  cl::NDRange offset(0U, 0U);
-  cl::NDRange size(operand.row_count(), operand.column_count());
-  _command_queue->enqueueNDRangeKernel(*_matrix_sigmoid_kernel, offset, size);
-  _command_queue->finish();
+  operation_profile profile(*this, "sigmoid", operand, {&operand}, 3.0);
+  const size_t work = operand.row_count() * operand.column_count();
+  for_row_blocks({&operand}, work, [&](row_block& block) {
+    cl::Kernel& kernel = block.kernels.matrix_sigmoid;
+    kernel.setArg(0, block.rows_of(operand));
+    kernel.setArg(1, block.row_count);
+    kernel.setArg(2, operand.column_count());
+
+    cl::NDRange offset(0U, 0U);
+    cl::NDRange size(block.row_count, operand.column_count());
+    block.kernels.queue.enqueueNDRangeKernel(kernel, offset, size, cl::NullRange, nullptr,
+                                             block.kernels.event());
+  });
 }
 
 void opencl_context::sigmoid_gradient(matrix& gradient, const matrix& operand) {
-  opencl::matrix* gradient_impl = dynamic_cast<opencl::matrix*>(gradient.implementation());
-  opencl::matrix* operand_impl = dynamic_cast<opencl::matrix*>(operand.implementation());
-
-  _sigmoid_gradient->setArg(0, *gradient_impl->get());
-  _sigmoid_gradient->setArg(1, *operand_impl->get());
-  _sigmoid_gradient->setArg(2, operand.row_count());
-  _sigmoid_gradient->setArg(3, operand.column_count());
-
-  cl::NDRange offset(0U, 0U);
-  cl::NDRange size(operand.row_count(), operand.column_count());
-  _command_queue->enqueueNDRangeKernel(*_sigmoid_gradient, offset, size);
-  _command_queue->finish();
+  operation_profile profile(*this, "sigmoid_gradient", gradient, {&operand}, 5.0);
+  const size_t work = operand.row_count() * operand.column_count();
+  for_row_blocks({&gradient, &operand}, work, [&](row_block& block) {
+    cl::Kernel& kernel = block.kernels.sigmoid_gradient;
+    kernel.setArg(0, block.rows_of(gradient));
+    kernel.setArg(1, block.rows_of(operand));
+    kernel.setArg(2, block.row_count);
+    kernel.setArg(3, operand.column_count());
+
+    cl::NDRange offset(0U, 0U);
+    cl::NDRange size(block.row_count, operand.column_count());
+    block.kernels.queue.enqueueNDRangeKernel(kernel, offset, size, cl::NullRange, nullptr,
+                                             block.kernels.event());
+  });
 }
 
 void opencl_context::hyperbolic_tangent(matrix& operand) {
-  opencl::matrix* operand_impl = dynamic_cast<opencl::matrix*>(operand.implementation());
-
-  _hyperbolic_tangent->setArg(0, *operand_impl->get());
-  _hyperbolic_tangent->setArg(1, operand.row_count());
-  _hyperbolic_tangent->setArg(2, operand.column_count());
-
-  cl::NDRange offset(0U, 0U);
-  cl::NDRange size(operand.row_count(), operand.column_count());
-  _command_queue->enqueueNDRangeKernel(*_hyperbolic_tangent, offset, size);
-  _command_queue->finish();
+  operation_profile profile(*this, "hyperbolic_tangent", operand, {&operand}, 1.0);
+  const size_t work = operand.row_count() * operand.column_count();
+  for_row_blocks({&operand}, work, [&](row_block& block) {
+    cl::Kernel& kernel = block.kernels.hyperbolic_tangent;
+    kernel.setArg(0, block.rows_of(operand));
+    kernel.setArg(1, block.row_count);
+    kernel.setArg(2, operand.column_count());
+
+    cl::NDRange offset(0U, 0U);
+    cl::NDRange size(block.row_count, operand.column_count());
+    block.kernels.queue.enqueueNDRangeKernel(kernel, offset, size, cl::NullRange, nullptr,
+                                             block.kernels.event());
+  });
 }
 
 void opencl_context::hyperbolic_tangent_gradient(matrix& gradient, const matrix& operand) {
-  opencl::matrix* gradient_impl = dynamic_cast<opencl::matrix*>(gradient.implementation());
-  opencl::matrix* operand_impl = dynamic_cast<opencl::matrix*>(operand.implementation());
-
-  _hyperbolic_tangent_gradient->setArg(0, *gradient_impl->get());
-  _hyperbolic_tangent_gradient->setArg(1, *operand_impl->get());
-  _hyperbolic_tangent_gradient->setArg(2, operand.row_count());
-  _hyperbolic_tangent_gradient->setArg(3, operand.column_count());
-
-  cl::NDRange offset(0U, 0U);
-  cl::NDRange size(operand.row_count(), operand.column_count());
-  _command_queue->enqueueNDRangeKernel(*_hyperbolic_tangent_gradient, offset, size);
-  _command_queue->finish();
+  operation_profile profile(*this, "hyperbolic_tangent_gradient", gradient, {&operand}, 3.0);
+  const size_t work = operand.row_count() * operand.column_count();
+  for_row_blocks({&gradient, &operand}, work, [&](row_block& block) {
+    cl::Kernel& kernel = block.kernels.hyperbolic_tangent_gradient;
+    kernel.setArg(0, block.rows_of(gradient));
+    kernel.setArg(1, block.rows_of(operand));
+    kernel.setArg(2, block.row_count);
+    kernel.setArg(3, operand.column_count());
+
+    cl::NDRange offset(0U, 0U);
+    cl::NDRange size(block.row_count, operand.column_count());
+    block.kernels.queue.enqueueNDRangeKernel(kernel, offset, size, cl::NullRange, nullptr,
+                                             block.kernels.event());
+  });
 }
 
 void opencl_context::softmax(matrix& operand) {
+  operation_profile profile(*this, "softmax", operand, {&operand}, 3.0);
+  kernel_set& kernels = thread_kernels();
   opencl::matrix* impl = (opencl::matrix*)operand.implementation();
-  _matrix_softmax_exp_kernel->setArg(0, *impl->get());
-  _matrix_softmax_exp_kernel->setArg(1, operand.row_count());
-  _matrix_softmax_exp_kernel->setArg(2, operand.column_count());
+  kernels.matrix_softmax_exp.setArg(0, *impl->write_buffer());
+  kernels.matrix_softmax_exp.setArg(1, operand.row_count());
+  kernels.matrix_softmax_exp.setArg(2, operand.column_count());
 
   cl::NDRange offset(0U, 0U);
   cl::NDRange exp_size(operand.row_count(), operand.column_count());
-  _command_queue->enqueueNDRangeKernel(*_matrix_softmax_exp_kernel, offset, exp_size);
+  kernels.queue.enqueueNDRangeKernel(kernels.matrix_softmax_exp, offset, exp_size, cl::NullRange,
+                                     nullptr, kernels.event());
 
-  _matrix_softmax_normalize_kernel->setArg(0U, *impl->get());
-  _matrix_softmax_normalize_kernel->setArg(1U, operand.row_count());
-  _matrix_softmax_normalize_kernel->setArg(2U, operand.column_count());
+  kernels.matrix_softmax_normalize.setArg(0U, *impl->write_buffer());
+  kernels.matrix_softmax_normalize.setArg(1U, operand.row_count());
+  kernels.matrix_softmax_normalize.setArg(2U, operand.column_count());
 
   cl::NDRange normalize_size(operand.row_count(), 1);
-  _command_queue->enqueueNDRangeKernel(*_matrix_softmax_normalize_kernel, offset, normalize_size);
+  kernels.queue.enqueueNDRangeKernel(kernels.matrix_softmax_normalize, offset, normalize_size,
+                                     cl::NullRange, nullptr, kernels.event());
 
-  _command_queue->finish();
+  kernels.queue.finish();
 }
 
 void opencl_context::merge(matrix& merged, const matrix& operand_1, const matrix& operand_2) {
+  operation_profile profile(*this, "merge", merged, {&operand_1, &operand_2}, 0.0);
+  kernel_set& kernels = thread_kernels();
   opencl::matrix* merged_impl = dynamic_cast<opencl::matrix*>(merged.implementation());
   opencl::matrix* operand_1_impl = dynamic_cast<opencl::matrix*>(operand_1.implementation());
   opencl::matrix* operand_2_impl = dynamic_cast<opencl::matrix*>(operand_2.implementation());
 
-  _matrix_merge_kernel->setArg(0U, *merged_impl->get());
-  _matrix_merge_kernel->setArg(1U, *operand_1_impl->get());
-  _matrix_merge_kernel->setArg(2U, *operand_2_impl->get());
-  _matrix_merge_kernel->setArg(3U, merged.row_count());
-  _matrix_merge_kernel->setArg(4U, operand_1.column_count());
-  _matrix_merge_kernel->setArg(5U, operand_2.column_count());
+  kernels.matrix_merge.setArg(0U, *merged_impl->write_buffer());
+  kernels.matrix_merge.setArg(1U, *operand_1_impl->read_buffer());
+  kernels.matrix_merge.setArg(2U, *operand_2_impl->read_buffer());
+  kernels.matrix_merge.setArg(3U, merged.row_count());
+  kernels.matrix_merge.setArg(4U, operand_1.column_count());
+  kernels.matrix_merge.setArg(5U, operand_2.column_count());
 
   cl::NDRange offset(0U, 0U);
   cl::NDRange size(merged.row_count(), 1U);
-  _command_queue->enqueueNDRangeKernel(*_matrix_merge_kernel, offset, size);
-  _command_queue->finish();
+  kernels.queue.enqueueNDRangeKernel(kernels.matrix_merge, offset, size, cl::NullRange, nullptr,
+                                     kernels.event());
+  kernels.queue.finish();
 }
 
 void opencl_context::transpose(matrix& transposed, const matrix& original) {
+  operation_profile profile(*this, "transpose", transposed, {&original}, 0.0);
+  kernel_set& kernels = thread_kernels();
   opencl::matrix* transposed_impl = dynamic_cast<opencl::matrix*>(transposed.implementation());
   opencl::matrix* original_impl = dynamic_cast<opencl::matrix*>(original.implementation());
 
-  _matrix_transpose_kernel->setArg(0U, *transposed_impl->get());
-  _matrix_transpose_kernel->setArg(1U, *original_impl->get());
-  _matrix_transpose_kernel->setArg(2U, original.row_count());
-  _matrix_transpose_kernel->setArg(3U, original.column_count());
+  kernels.matrix_transpose.setArg(0U, *transposed_impl->write_buffer());
+  kernels.matrix_transpose.setArg(1U, *original_impl->read_buffer());
+  kernels.matrix_transpose.setArg(2U, original.row_count());
+  kernels.matrix_transpose.setArg(3U, original.column_count());
 
   cl::NDRange offset(0U, 0U);
   cl::NDRange size(transposed.column_count(), transposed.row_count());
-  _command_queue->enqueueNDRangeKernel(*_matrix_transpose_kernel, offset, size);
-  _command_queue->finish();
+  kernels.queue.enqueueNDRangeKernel(kernels.matrix_transpose, offset, size, cl::NullRange, nullptr,
+                                     kernels.event());
+  kernels.queue.finish();
 }
 
 matrix opencl_context::sum_rows(const matrix& original) {
+  operation_profile profile(*this, "sum_rows", original, {}, 1.0);
+  kernel_set& kernels = thread_kernels();
   vi::la::matrix sums(*this, 1U, original.column_count(), 0.0);
   opencl::matrix* sum_impl = dynamic_cast<opencl::matrix*>(sums.implementation());
   opencl::matrix* original_imp = dynamic_cast<opencl::matrix*>(original.implementation());
 
-  _sum_rows->setArg(0U, *sum_impl->get());
-  _sum_rows->setArg(1U, *original_imp->get());
-  _sum_rows->setArg(2U, original.row_count());
-  _sum_rows->setArg(3U, original.column_count());
+  kernels.sum_rows.setArg(0U, *sum_impl->write_buffer());
+  kernels.sum_rows.setArg(1U, *original_imp->read_buffer());
+  kernels.sum_rows.setArg(2U, original.row_count());
+  kernels.sum_rows.setArg(3U, original.column_count());
 
   cl::NDRange offset(0U, 0U);
   cl::NDRange size(1, sums.column_count());
-  _command_queue->enqueueNDRangeKernel(*_sum_rows, offset, size);
-  _command_queue->finish();
+  kernels.queue.enqueueNDRangeKernel(kernels.sum_rows, offset, size, cl::NullRange, nullptr,
+                                     kernels.event());
+  kernels.queue.finish();
   return sums;
 }
 
 matrix opencl_context::sum_columns(const matrix& original) {
+  operation_profile profile(*this, "sum_columns", original, {}, 1.0);
+  kernel_set& kernels = thread_kernels();
   vi::la::matrix sums(*this, original.row_count(), 1U, 0.0);
   opencl::matrix* sum_impl = dynamic_cast<opencl::matrix*>(sums.implementation());
   opencl::matrix* original_imp = dynamic_cast<opencl::matrix*>(original.implementation());
 
-  _sum_columns->setArg(0U, *sum_impl->get());
-  _sum_columns->setArg(1U, *original_imp->get());
-  _sum_columns->setArg(2U, original.row_count());
-  _sum_columns->setArg(3U, original.column_count());
+  kernels.sum_columns.setArg(0U, *sum_impl->write_buffer());
+  kernels.sum_columns.setArg(1U, *original_imp->read_buffer());
+  kernels.sum_columns.setArg(2U, original.row_count());
+  kernels.sum_columns.setArg(3U, original.column_count());
 
   cl::NDRange offset(0U, 0U);
   cl::NDRange size(sums.row_count(), 1);
-  _command_queue->enqueueNDRangeKernel(*_sum_columns, offset, size);
-  _command_queue->finish();
+  kernels.queue.enqueueNDRangeKernel(kernels.sum_columns, offset, size, cl::NullRange, nullptr,
+                                     kernels.event());
+  kernels.queue.finish();
   return sums;
 }
 
 void opencl_context::log(matrix& result, const matrix& original) {
-  opencl::matrix* result_impl = dynamic_cast<opencl::matrix*>(result.implementation());
-  opencl::matrix* original_imp = dynamic_cast<opencl::matrix*>(original.implementation());
+  operation_profile profile(*this, "log", result, {&original}, 1.0);
+  const size_t work = result.row_count() * result.column_count();
+  for_row_blocks({&result, &original}, work, [&](row_block& block) {
+    cl::Kernel& kernel = block.kernels.log;
+    kernel.setArg(0, block.rows_of(result));
+    kernel.setArg(1, block.rows_of(original));
+    kernel.setArg(2, block.row_count);
+    kernel.setArg(3, result.column_count());
+
+    cl::NDRange offset(0U, 0U);
+    cl::NDRange size(block.row_count, result.column_count());
+    block.kernels.queue.enqueueNDRangeKernel(kernel, offset, size, cl::NullRange, nullptr,
+                                             block.kernels.event());
+  });
+}
 
-  _log->setArg(0U, *result_impl->get());
-  _log->setArg(1U, *original_imp->get());
-  _log->setArg(2U, result.row_count());
-  _log->setArg(3U, result.column_count());
+void opencl_context::row_argmax(matrix& indices, const matrix& operand) {
+  operation_profile profile(*this, "row_argmax", operand, {}, 1.0);
+  kernel_set& kernels = thread_kernels();
+  opencl::matrix* indices_impl = dynamic_cast<opencl::matrix*>(indices.implementation());
+  opencl::matrix* operand_impl = dynamic_cast<opencl::matrix*>(operand.implementation());
 
-  cl::NDRange offset(0U, 0U);
-  cl::NDRange size(result.row_count(), result.column_count());
-  _command_queue->enqueueNDRangeKernel(*_log, offset, size);
-  _command_queue->finish();
+  const size_t group_size = row_group_size(kernels.row_argmax, kernels.device);
+  kernels.row_argmax.setArg(0U, *indices_impl->write_buffer());
+  kernels.row_argmax.setArg(1U, *operand_impl->read_buffer());
+  kernels.row_argmax.setArg(2U, operand.row_count());
+  kernels.row_argmax.setArg(3U, operand.column_count());
+  kernels.row_argmax.setArg(4U, cl::__local(group_size * sizeof(cl_float)));
+  kernels.row_argmax.setArg(5U, cl::__local(group_size * sizeof(cl_uint)));
+
+  cl::NDRange offset(0U);
+  cl::NDRange size(operand.row_count() * group_size);
+  cl::NDRange group(group_size);
+  kernels.queue.enqueueNDRangeKernel(kernels.row_argmax, offset, size, group, nullptr,
+                                     kernels.event());
+  kernels.queue.finish();
+}
+
+void opencl_context::row_top_k(matrix& indices, matrix& values, const matrix& operand) {
+  operation_profile profile(*this, "row_top_k", operand, {}, 1.0);
+  kernel_set& kernels = thread_kernels();
+  opencl::matrix* indices_impl = dynamic_cast<opencl::matrix*>(indices.implementation());
+  opencl::matrix* values_impl = dynamic_cast<opencl::matrix*>(values.implementation());
+  opencl::matrix* operand_impl = dynamic_cast<opencl::matrix*>(operand.implementation());
+  const size_t k = indices.column_count();
+  if (k == 0U || operand.row_count() == 0U) {
+    return;
+  }
+
+  // every lane of a row keeps its own sorted k best values until they are merged
+  const size_t group_size = row_group_size(kernels.row_top_k, kernels.device);
+  kernels.reserve_top_k_lanes(*_context, operand.row_count() * group_size * k);
+
+  kernels.row_top_k.setArg(0U, *indices_impl->write_buffer());
+  kernels.row_top_k.setArg(1U, *values_impl->write_buffer());
+  kernels.row_top_k.setArg(2U, *operand_impl->read_buffer());
+  kernels.row_top_k.setArg(3U, operand.row_count());
+  kernels.row_top_k.setArg(4U, operand.column_count());
+  kernels.row_top_k.setArg(5U, static_cast<cl_uint>(k));
+  kernels.row_top_k.setArg(6U, kernels.top_k_lane_values);
+  kernels.row_top_k.setArg(7U, kernels.top_k_lane_columns);
+  kernels.row_top_k.setArg(8U, cl::__local(group_size * sizeof(cl_float)));
+  kernels.row_top_k.setArg(9U, cl::__local(group_size * sizeof(cl_uint)));
+  kernels.row_top_k.setArg(10U, cl::__local(group_size * sizeof(cl_uint)));
+
+  cl::NDRange offset(0U);
+  cl::NDRange size(operand.row_count() * group_size);
+  cl::NDRange group(group_size);
+  kernels.queue.enqueueNDRangeKernel(kernels.row_top_k, offset, size, group, nullptr,
+                                     kernels.event());
+  kernels.queue.finish();
 }
 
 void opencl_context::sub_matrix(matrix& target, const matrix& original, size_t start_row,
                                 size_t end_row, size_t start_column, size_t end_column) {
+  operation_profile profile(*this, "sub_matrix", target, {&target}, 0.0);
+  kernel_set& kernels = thread_kernels();
   opencl::matrix* target_impl = dynamic_cast<opencl::matrix*>(target.implementation());
   opencl::matrix* original_imp = dynamic_cast<opencl::matrix*>(original.implementation());
 
@@ -402,15 +1039,19 @@ void opencl_context::sub_matrix(matrix& target, const matrix& original, size_t s
   region[1] = sub_rows;
   region[2] = 1;
 
-  cl_int error = _command_queue->enqueueCopyBufferRect(
-      *original_imp->get(), *target_impl->get(), source_origin, destination_origin, region,
-      original.column_count() * sizeof(float), 0U, target.column_count() * sizeof(float), 0U);
+  cl_int error = kernels.queue.enqueueCopyBufferRect(
+      *original_imp->read_buffer(), *target_impl->write_buffer(), source_origin, destination_origin,
+      region, original.column_count() * sizeof(float), 0U, target.column_count() * sizeof(float),
+      0U, nullptr, kernels.event());
   assert(error == CL_SUCCESS);
-  _command_queue->finish();
+  kernels.queue.finish();
 }
 
 void opencl_context::convolve_2d(matrix& result, const matrix& mask, const matrix& original,
                                  size_t channels) {
+  operation_profile profile(*this, "convolve_2d", result, {&original, &mask},
+                            2.0 * mask.row_count() * mask.column_count());
+  kernel_set& kernels = thread_kernels();
   opencl::matrix* result_impl = dynamic_cast<opencl::matrix*>(result.implementation());
   opencl::matrix* mask_impl = dynamic_cast<opencl::matrix*>(mask.implementation());
   opencl::matrix* original_impl = dynamic_cast<opencl::matrix*>(original.implementation());
@@ -430,21 +1071,22 @@ void opencl_context::convolve_2d(matrix& result, const matrix& mask, const matri
   //            auto devices = _context.getInfo<CL_CONTEXT_DEVICES>();
   //            for (auto & device : devices) {
   //                const cl_kernel_work_group_info workgroup_size =
-  //                _convolve_2d->getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(device);
+  //                kernels.convolve_2d.getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(device);
   //                std::cout << "workgroup size: " << workgroup_size <<
   //                std::endl;
   //            }
-  _convolve_2d->setArg(0U, *result_impl->get());
-  _convolve_2d->setArg(1U, *original_impl->get());
-  _convolve_2d->setArg(2U, original.row_count());
-  _convolve_2d->setArg(3U, original.column_count());
-  _convolve_2d->setArg(4U, channels);
-  _convolve_2d->setArg(5U, *mask_impl->get());
-  _convolve_2d->setArg(6U, mask.row_count());
-  _convolve_2d->setArg(7U, mask.column_count());
-  _convolve_2d->setArg(8U, cl::__local(INPUT_TILE_HEIGHT * INPUT_TILE_WIDTH * sizeof(cl_float)));
-  _convolve_2d->setArg(9U, OUTPUT_TILE_HEIGHT);
-  _convolve_2d->setArg(10U, OUTPUT_TILE_WIDTH);
+  kernels.convolve_2d.setArg(0U, *result_impl->write_buffer());
+  kernels.convolve_2d.setArg(1U, *original_impl->read_buffer());
+  kernels.convolve_2d.setArg(2U, original.row_count());
+  kernels.convolve_2d.setArg(3U, original.column_count());
+  kernels.convolve_2d.setArg(4U, channels);
+  kernels.convolve_2d.setArg(5U, *mask_impl->read_buffer());
+  kernels.convolve_2d.setArg(6U, mask.row_count());
+  kernels.convolve_2d.setArg(7U, mask.column_count());
+  kernels.convolve_2d.setArg(8U,
+                             cl::__local(INPUT_TILE_HEIGHT * INPUT_TILE_WIDTH * sizeof(cl_float)));
+  kernels.convolve_2d.setArg(9U, OUTPUT_TILE_HEIGHT);
+  kernels.convolve_2d.setArg(10U, OUTPUT_TILE_WIDTH);
   const size_t data_width = original.column_count();
   const size_t data_height = original.row_count();
 
@@ -455,8 +1097,9 @@ void opencl_context::convolve_2d(matrix& result, const matrix& mask, const matri
   cl::NDRange items(vertical_groups * INPUT_TILE_HEIGHT, horizontal_groups * INPUT_TILE_WIDTH);
   cl::NDRange items_per_group(INPUT_TILE_HEIGHT, INPUT_TILE_WIDTH);
 
-  _command_queue->enqueueNDRangeKernel(*_convolve_2d, offset, items, items_per_group);
-  _command_queue->finish();
+  kernels.queue.enqueueNDRangeKernel(kernels.convolve_2d, offset, items, items_per_group, nullptr,
+                                     kernels.event());
+  kernels.queue.finish();
 }
 }
 }
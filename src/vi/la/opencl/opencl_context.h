@@ -2,7 +2,10 @@
 #define __mlcl__opencl_context__
 
 #include <vi/la/context.h>
+#include <vi/la/opencl/program_cache.h>
+#include <functional>
 #include <memory>
+#include <string>
 #include <vector>
 
 #ifdef __APPLE__
@@ -14,27 +17,59 @@
 namespace cl {
 class Context;
 class CommandQueue;
-class Kernel;
 }
 
 namespace vi {
 namespace la {
 
+namespace opencl {
+class matrix;
+}
+
+/// OpenCL based implementation of linear algebra operations.
+/// Every thread using the context gets its own command queue and kernel
+/// instances, so operations may be called concurrently from several threads
+/// as long as they do not write to the same matrices. They are released when
+/// the thread exits or the context is destroyed.
+/// When given several devices, large matrix products and elementwise operations
+/// are split into blocks of rows that the devices compute side by side. Blocks
+/// are sized by the relative throughput of the devices, measured when the
+/// context is constructed.
+/// Matrices stay on the device between operations, their values are copied to
+/// the host only when read there after a kernel has written them.
 class opencl_context : public context {
 public:
-  opencl_context(const std::vector<cl_device_id>& device_ids);
+  /// \param storage_precision precision of matrix multiplication operands,
+  ///        products are accumulated in single precision
+  /// \param program_cache_directory compiled kernels are cached in the directory
+  ///        to skip compiling them on later constructions, empty disables the cache
+  opencl_context(const std::vector<cl_device_id>& device_ids,
+                 vi::la::precision storage_precision = vi::la::precision::single,
+                 const std::string& program_cache_directory =
+                     opencl::program_cache::default_directory());
   virtual ~opencl_context();
 
+  /// Devices the kernels can be built for
   static std::vector<cl_device_id>
   supported_devices(cl_device_type device_type = CL_DEVICE_TYPE_ALL);
 
   std::shared_ptr<vi::la::matrix_implementation> implement_matrix(size_t rows, size_t columns,
                                                                   const float* initial_values);
+  /// Values are copied into a new buffer
+  std::shared_ptr<vi::la::matrix_implementation> adopt_matrix(size_t rows, size_t columns,
+                                                              std::shared_ptr<float> values);
 
   void multiply(matrix& product, const matrix& operand_1, const matrix& operand_2);
   void multiply(matrix& product, const matrix& operand_1, const float operand_2);
   void multiply_elementwise(matrix& product, const matrix& operand_1, const matrix& operand_2);
 
+  /// The sparse operand is copied to the devices on first use and kept with it
+  void multiply(matrix& product, const sparse_matrix& operand_1, const matrix& operand_2);
+  /// Multiplies with the device copy of the sparse operand without transposing it,
+  /// a work item accumulates each column of the product
+  void transpose_multiply(matrix& product, const sparse_matrix& operand_1,
+                          const matrix& operand_2);
+
   void add(matrix& sum, const matrix& operand_1, const float operand_2);
   void add(matrix& sum, const matrix& operand_1, const matrix& operand_2);
   void subtract(matrix& difference, const matrix& operand_1, const matrix& operand_2);
@@ -51,46 +86,62 @@ public:
   matrix sum_rows(const matrix& original);
   matrix sum_columns(const matrix& original);
   void log(matrix& result, const matrix& original);
+  void row_argmax(matrix& indices, const matrix& operand);
+  void row_top_k(matrix& indices, matrix& values, const matrix& operand);
 
   void sub_matrix(matrix& target, const matrix& original, size_t start_row, size_t end_row,
                   size_t start_column, size_t end_column);
 
   void convolve_2d(matrix& result, const matrix& mask, const matrix& original, size_t channels);
 
-  cl::Context& context();
-  cl::CommandQueue& command_queue();
+  vi::la::precision storage_precision() const;
 
-private:
-  void load_kernels();
+  /// Products and elementwise operations run in work-groups of the tuned size
+  /// \return names of the devices, in the order of the device ids
+  std::vector<std::string> tuned_devices() const;
 
-  class private_members;
+  cl::Context& context();
 
-  cl::Context* _context;
-  cl::CommandQueue* _command_queue;
+  /// \return command queue on the first device that copies matrix values to and from
+  ///         the host, shared by all threads
+  cl::CommandQueue& command_queue();
 
-  cl::Kernel* _matrix_multiply_kernel;
-  cl::Kernel* _matrix_scalar_multiply;
-  cl::Kernel* _matrix_elementwise_multiply;
+  size_t device_count() const;
+  /// \return share of the rows of split operations each device computes
+  std::vector<double> device_weights() const;
+  /// Weights are relative, a device with weight zero is left idle
+  /// \throw std::invalid_argument if there is no weight per device or all are zero
+  void set_device_weights(const std::vector<double>& weights);
 
-  cl::Kernel* _matrix_add;
-  cl::Kernel* _scalar_add;
-  cl::Kernel* _matrix_subtract;
+  /// \return bytes copied between the host and the devices since the context was constructed
+  transfer_statistics transfers() const;
 
-  cl::Kernel* _matrix_sigmoid_kernel;
-  cl::Kernel* _sigmoid_gradient;
-  cl::Kernel* _hyperbolic_tangent;
-  cl::Kernel* _hyperbolic_tangent_gradient;
-  cl::Kernel* _matrix_softmax_exp_kernel;
-  cl::Kernel* _matrix_softmax_normalize_kernel;
+private:
+  friend class opencl::matrix;
+  struct kernel_set;
+  struct row_block;
+  struct sparse_buffers;
+  class operation_profile;
+  class private_members;
 
-  cl::Kernel* _matrix_merge_kernel;
-  cl::Kernel* _matrix_transpose_kernel;
+  void load_kernels(const std::string& program_cache_directory);
+  kernel_set& thread_kernels(size_t device_index = 0U);
+  /// Enqueue an operation for every block of rows, then wait for all devices
+  /// \param blocked matrices split by rows, the first is the result
+  /// \param work number of operations, small operations run on the first device only
+  void for_row_blocks(const std::vector<const matrix*>& blocked, size_t work,
+                      const std::function<void(row_block&)>& enqueue);
+  void measure_device_weights();
+  void transferred(size_t bytes_to_device, size_t bytes_to_host);
+  /// \return device copy of a sparse matrix, copied on first use
+  const sparse_buffers& device_buffers(const sparse_matrix& matrix);
+  void multiply_reduced_precision(matrix& product, const matrix& operand_1,
+                                  const matrix& operand_2);
 
-  cl::Kernel* _sum_rows;
-  cl::Kernel* _sum_columns;
-  cl::Kernel* _log;
+  cl::Context* _context;
+  std::unique_ptr<private_members> _members;
 
-  cl::Kernel* _convolve_2d;
+  vi::la::precision _storage_precision;
 };
 }
 }
@@ -7,22 +7,25 @@ namespace la {
 namespace opencl {
 
 matrix::matrix(opencl_context& context, size_t rows, size_t columns, const float* initial_values)
-    : _context(context), _row_count(rows), _column_count(columns), _host_buffer(nullptr) {
+    : matrix_implementation(rows * columns * sizeof(cl_float)), _context(context),
+      _row_count(rows), _column_count(columns), _host_buffer(nullptr),
+      _host_current(initial_values == nullptr), _host_written(false), _packed_buffer(nullptr),
+      _packed_current(false) {
   size_t value_count = rows * columns;
   if (initial_values) {
     _device_buffer = new cl::Buffer(context.context(), CL_MEM_COPY_HOST_PTR | CL_MEM_READ_WRITE,
                                     value_count * sizeof(cl_float), (void*)initial_values);
+    _context.transferred(value_count * sizeof(cl_float), 0U);
   } else {
-    _device_buffer = new cl::Buffer(context.context(), CL_MEM_ALLOC_HOST_PTR | CL_MEM_READ_WRITE,
+    // uninitialized values need not be copied to the host
+    _device_buffer = new cl::Buffer(context.context(), CL_MEM_READ_WRITE,
                                     value_count * sizeof(cl_float), nullptr);
   }
-
-  _host_buffer = static_cast<float*>(context.command_queue().enqueueMapBuffer(
-      *_device_buffer, CL_TRUE, CL_MAP_READ | CL_MAP_WRITE, 0U, value_count * sizeof(cl_float)));
 }
 
 matrix::~matrix() {
-  _context.command_queue().enqueueUnmapMemObject(*_device_buffer, static_cast<void*>(_host_buffer));
+  delete[] _host_buffer;
+  delete _packed_buffer;
   delete _device_buffer;
 }
 
@@ -32,11 +35,75 @@ size_t matrix::column_count() const { return _column_count; }
 
 vi::la::context& matrix::owning_context() const { return _context; }
 
-float* matrix::raw_data() { return _host_buffer; }
+float* matrix::raw_data() {
+  std::lock_guard<std::mutex> lock(_host_mutex);
+  download();
+  // the host values may be written until the next kernel uses the buffer
+  _host_written = true;
+  _packed_current = false;
+  return _host_buffer;
+}
 
-cl::Buffer* matrix::get() { return _device_buffer; }
+const float* matrix::read_only_data() {
+  std::lock_guard<std::mutex> lock(_host_mutex);
+  download();
+  return _host_buffer;
+}
+
+cl::Buffer* matrix::read_buffer() {
+  std::lock_guard<std::mutex> lock(_host_mutex);
+  upload();
+  return _device_buffer;
+}
+
+cl::Buffer* matrix::write_buffer() {
+  std::lock_guard<std::mutex> lock(_host_mutex);
+  upload();
+  _host_current = false;
+  _packed_current = false;
+  return _device_buffer;
+}
+
+cl::Buffer* matrix::packed_buffer(const packer& pack) {
+  std::lock_guard<std::mutex> lock(_host_mutex);
+  upload();
+  if (!_packed_buffer) {
+    _packed_buffer =
+        new cl::Buffer(_context.context(), CL_MEM_READ_WRITE,
+                       value_count() * bytes_per_element(_context.storage_precision()), nullptr);
+    count_allocation(value_count() * bytes_per_element(_context.storage_precision()));
+  }
+  if (!_packed_current) {
+    pack(*_packed_buffer, *_device_buffer);
+    _packed_current = true;
+  }
+  return _packed_buffer;
+}
 
 size_t matrix::value_count() const { return _row_count * _column_count; }
+
+void matrix::download() {
+  if (!_host_buffer) {
+    _host_buffer = new float[value_count()];
+  }
+  if (_host_current) {
+    return;
+  }
+  _context.command_queue().enqueueReadBuffer(*_device_buffer, CL_TRUE, 0U,
+                                             value_count() * sizeof(cl_float), _host_buffer);
+  _context.transferred(0U, value_count() * sizeof(cl_float));
+  _host_current = true;
+}
+
+void matrix::upload() {
+  if (!_host_written) {
+    return;
+  }
+  _context.command_queue().enqueueWriteBuffer(*_device_buffer, CL_TRUE, 0U,
+                                              value_count() * sizeof(cl_float), _host_buffer);
+  _context.transferred(value_count() * sizeof(cl_float), 0U);
+  _host_written = false;
+}
 }
 }
 }
@@ -4,6 +4,9 @@
 #include <vi/la/opencl/opencl_context.h>
 #include <vi/la/matrix_implementation.h>
 
+#include <functional>
+#include <mutex>
+
 namespace cl {
 class Buffer;
 }
@@ -12,9 +15,20 @@ namespace vi {
 namespace la {
 namespace opencl {
 
-/// Matrix implementation for OpenCL context
+/// Matrix implementation for OpenCL context.
+/// Values live in a device buffer. Host values are allocated on the first host
+/// access and kept for the lifetime of the matrix, so pointers to them stay
+/// valid. They are brought up to date when they are accessed, so rows are read
+/// again through the matrix after a kernel has written it. Values are copied to
+/// the host only if a kernel has written the buffer since, and back to the device
+/// only if they were accessed for writing since.
+/// Copies are guarded by a lock. Access the values before threads write disjoint
+/// rows, so that the threads do not wait for the first copy.
 class matrix : public vi::la::matrix_implementation {
 public:
+  /// Fills the packed buffer from the values buffer
+  typedef std::function<void(cl::Buffer& packed, cl::Buffer& values)> packer;
+
   matrix(opencl_context& context, size_t rows, size_t columns, const float* initial_values);
   virtual ~matrix();
 
@@ -24,16 +38,41 @@ public:
   virtual vi::la::context& owning_context() const;
 
   virtual float* raw_data();
+  virtual const float* read_only_data();
 
-  cl::Buffer* get();
+  /// \return buffer for a kernel that only reads the values
+  cl::Buffer* read_buffer();
+  /// \return buffer for a kernel that writes the values
+  cl::Buffer* write_buffer();
+  /// \return buffer of the values rounded to the storage precision of the context,
+  ///         pack fills it from the values only when they have been written since
+  ///         the last call. The buffer is kept for the lifetime of the matrix.
+  cl::Buffer* packed_buffer(const packer& pack);
 
 private:
   size_t value_count() const;
+  /// Copy the values to the host unless they are current there,
+  /// called with the host buffer lock held
+  void download();
+  /// Copy the values to the device if they were accessed for writing since the last copy,
+  /// called with the host buffer lock held
+  void upload();
+
   opencl_context& _context;
   size_t _row_count;
   size_t _column_count;
   cl::Buffer* _device_buffer;
+  /// Guards the host values and which copies are current
+  std::mutex _host_mutex;
   float* _host_buffer;
+  /// The host values are the same as the device buffer
+  bool _host_current;
+  /// The host values may have been written since they were copied to the device
+  bool _host_written;
+  /// Values in storage precision, guarded by the host buffer lock
+  cl::Buffer* _packed_buffer;
+  /// The packed buffer holds the current values
+  bool _packed_current;
 };
 }
 }
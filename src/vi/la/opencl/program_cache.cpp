@@ -0,0 +1,167 @@
+#include "vi/la/opencl/program_cache.h"
+#include "vi/io/checksum.h"
+
+#include <boost/filesystem.hpp>
+#include <CL/cl.hpp>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+const char magic[8] = {'V', 'I', 'N', 'N', 'C', 'L', 'B', '\0'};
+const uint32_t current_version = 1U;
+/// Reads back as a different value on a machine of the other endianness
+const uint32_t byte_order_mark = 0x01020304U;
+
+struct header {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t description_size;
+  uint64_t binary_size;
+  uint64_t checksum;
+};
+
+std::string hexadecimal(uint64_t value) {
+  std::ostringstream text;
+  text << std::hex << std::setw(16) << std::setfill('0') << value;
+  return text.str();
+}
+}
+
+namespace vi {
+namespace la {
+namespace opencl {
+
+program_cache::program_cache(const std::string& directory) : _directory(directory) {}
+
+std::string program_cache::default_directory() {
+  const char* directory = std::getenv("VINN_OPENCL_CACHE");
+  if (directory != nullptr) {
+    return directory;
+  }
+  const char* cache_home = std::getenv("XDG_CACHE_HOME");
+  if (cache_home != nullptr && *cache_home != '\0') {
+    return (fs::path(cache_home) / "vinn" / "opencl").string();
+  }
+  const char* home = std::getenv("HOME");
+  if (home != nullptr && *home != '\0') {
+    return (fs::path(home) / ".cache" / "vinn" / "opencl").string();
+  }
+  return std::string();
+}
+
+std::string program_cache::describe(const cl::Device& device, const std::string& sources,
+                                    const std::string& options) {
+  cl::Platform platform(device.getInfo<CL_DEVICE_PLATFORM>());
+  std::ostringstream description;
+  description << "platform: " << platform.getInfo<CL_PLATFORM_NAME>() << " "
+              << platform.getInfo<CL_PLATFORM_VERSION>() << "\n";
+  description << "device: " << device.getInfo<CL_DEVICE_VENDOR>() << " "
+              << device.getInfo<CL_DEVICE_NAME>() << " " << device.getInfo<CL_DEVICE_VERSION>()
+              << "\n";
+  description << "driver: " << device.getInfo<CL_DRIVER_VERSION>() << "\n";
+  description << "options: " << options << "\n";
+  description << "sources: " << sources.size() << " bytes, "
+              << hexadecimal(vi::io::checksum(sources.data(), sources.size())) << "\n";
+  return description.str();
+}
+
+bool program_cache::load(const std::string& description,
+                         std::vector<unsigned char>& binary) const {
+  if (_directory.empty()) {
+    return false;
+  }
+  std::ifstream file(entry_path(description), std::ios::in | std::ios::binary);
+  header entry_header;
+  if (!file.read(reinterpret_cast<char*>(&entry_header), sizeof(entry_header))) {
+    return false;
+  }
+  if (std::memcmp(entry_header.magic, magic, sizeof(magic)) != 0 ||
+      entry_header.version != current_version || entry_header.byte_order != byte_order_mark ||
+      entry_header.description_size != description.size() || entry_header.binary_size == 0U) {
+    return false;
+  }
+
+  // checksum collisions of the file name are told apart by the full description
+  std::string stored_description(description.size(), '\0');
+  if (!file.read(&stored_description[0], static_cast<std::streamsize>(description.size())) ||
+      stored_description != description) {
+    return false;
+  }
+
+  // a corrupted size must not allocate more than the file holds
+  const std::streamoff binary_offset = file.tellg();
+  file.seekg(0, std::ios::end);
+  if (!file || static_cast<uint64_t>(file.tellg() - binary_offset) != entry_header.binary_size) {
+    return false;
+  }
+  file.seekg(binary_offset);
+
+  std::vector<unsigned char> stored_binary(entry_header.binary_size);
+  if (!file.read(reinterpret_cast<char*>(stored_binary.data()),
+                 static_cast<std::streamsize>(stored_binary.size())) ||
+      vi::io::checksum(stored_binary.data(), stored_binary.size()) != entry_header.checksum) {
+    return false;
+  }
+  binary.swap(stored_binary);
+  return true;
+}
+
+void program_cache::store(const std::string& description,
+                          const std::vector<unsigned char>& binary) const {
+  if (_directory.empty() || binary.empty()) {
+    return;
+  }
+
+  header entry_header;
+  std::memset(&entry_header, 0, sizeof(entry_header));
+  std::memcpy(entry_header.magic, magic, sizeof(magic));
+  entry_header.version = current_version;
+  entry_header.byte_order = byte_order_mark;
+  entry_header.description_size = description.size();
+  entry_header.binary_size = binary.size();
+  entry_header.checksum = vi::io::checksum(binary.data(), binary.size());
+
+  try {
+    fs::create_directories(_directory);
+    // processes starting at the same time may store the same entry, each
+    // writes its own file and replaces the entry with it in a single step
+    const fs::path path(entry_path(description));
+    const fs::path temporary_path(path.string() + fs::unique_path(".%%%%%%%%").string());
+    std::ofstream file(temporary_path.string(),
+                       std::ios::out | std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&entry_header), sizeof(entry_header));
+    file.write(description.data(), static_cast<std::streamsize>(description.size()));
+    file.write(reinterpret_cast<const char*>(binary.data()),
+               static_cast<std::streamsize>(binary.size()));
+    file.close();
+
+    boost::system::error_code error;
+    if (file) {
+      fs::rename(temporary_path, path, error);
+    }
+    if (!file || error) {
+      fs::remove(temporary_path, error);
+    }
+  } catch (fs::filesystem_error&) {
+    // a cache that can not be written only costs compile time
+  }
+}
+
+const std::string& program_cache::directory() const { return _directory; }
+
+std::string program_cache::entry_path(const std::string& description) const {
+  const std::string name =
+      hexadecimal(vi::io::checksum(description.data(), description.size())) + ".bin";
+  return (fs::path(_directory) / name).string();
+}
+}
+}
+}
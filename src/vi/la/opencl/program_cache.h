@@ -0,0 +1,50 @@
+#ifndef __vinn__program_cache__
+#define __vinn__program_cache__
+
+#include <string>
+#include <vector>
+
+namespace cl {
+class Device;
+}
+
+namespace vi {
+namespace la {
+namespace opencl {
+
+/// On-disk cache of compiled OpenCL program binaries.
+/// An entry is stored per device under a description of everything the binary
+/// depends on: the device, its driver version, the program sources and the
+/// build options. Any change leads to a different description, so stale
+/// binaries are never loaded and the program is compiled from source instead.
+/// The cache only speeds up startup, failures to read or write it are ignored.
+class program_cache {
+public:
+  /// \param directory location of the cache entries, created when first storing one
+  explicit program_cache(const std::string& directory);
+
+  /// $VINN_OPENCL_CACHE if set, otherwise vinn/opencl under $XDG_CACHE_HOME or
+  /// $HOME/.cache. Empty if none of the variables are set.
+  static std::string default_directory();
+
+  /// Describe a program binary built for a device
+  /// \param sources concatenated program sources
+  static std::string describe(const cl::Device& device, const std::string& sources,
+                              const std::string& options);
+
+  /// \return false if no intact binary is cached under the description
+  bool load(const std::string& description, std::vector<unsigned char>& binary) const;
+  void store(const std::string& description, const std::vector<unsigned char>& binary) const;
+
+  const std::string& directory() const;
+
+private:
+  std::string entry_path(const std::string& description) const;
+
+  std::string _directory;
+};
+}
+}
+}
+
+#endif
@@ -0,0 +1,123 @@
+#include "vi/la/precision.h"
+
+#include <cstring>
+
+namespace {
+
+uint32_t float_bits(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+float bits_to_float(uint32_t bits) {
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+}
+
+namespace vi {
+namespace la {
+
+size_t bytes_per_element(precision storage_precision) {
+  switch (storage_precision) {
+  case precision::bfloat16:
+  case precision::half:
+    return sizeof(uint16_t);
+  case precision::single:
+    break;
+  }
+  return sizeof(float);
+}
+
+const char* precision_name(precision storage_precision) {
+  switch (storage_precision) {
+  case precision::bfloat16:
+    return "bfloat16";
+  case precision::half:
+    return "half";
+  case precision::single:
+    break;
+  }
+  return "single";
+}
+
+uint16_t to_bfloat16(float value) {
+  const uint32_t bits = float_bits(value);
+  if ((bits & 0x7fffffffU) > 0x7f800000U) {
+    // keep NaNs quiet instead of rounding them into infinities
+    return static_cast<uint16_t>((bits >> 16) | 0x0040U);
+  }
+  // round to nearest, ties to even
+  const uint32_t rounding = 0x7fffU + ((bits >> 16) & 1U);
+  return static_cast<uint16_t>((bits + rounding) >> 16);
+}
+
+float from_bfloat16(uint16_t value) { return bits_to_float(static_cast<uint32_t>(value) << 16); }
+
+uint16_t to_half(float value) {
+  const uint32_t bits = float_bits(value);
+  const uint32_t sign = (bits >> 16) & 0x8000U;
+  const uint32_t magnitude = bits & 0x7fffffffU;
+
+  if (magnitude > 0x7f800000U) {
+    return static_cast<uint16_t>(sign | 0x7e00U);
+  }
+  // 65520 and above round to infinity
+  if (magnitude >= 0x477ff000U) {
+    return static_cast<uint16_t>(sign | 0x7c00U);
+  }
+  // half of the smallest subnormal and below round to zero
+  if (magnitude <= 0x33000000U) {
+    return static_cast<uint16_t>(sign);
+  }
+
+  if (magnitude < 0x38800000U) {
+    // subnormal half precision result
+    const uint32_t exponent = magnitude >> 23;
+    const uint32_t mantissa = (magnitude & 0x7fffffU) | 0x800000U;
+    const uint32_t shift = 126U - exponent;
+    uint32_t result = mantissa >> shift;
+    const uint32_t remainder = mantissa & ((1U << shift) - 1U);
+    const uint32_t halfway = 1U << (shift - 1U);
+    if (remainder > halfway || (remainder == halfway && (result & 1U))) {
+      ++result;
+    }
+    return static_cast<uint16_t>(sign | result);
+  }
+
+  // rebias the exponent from 127 to 15 and round the mantissa to 10 bits
+  uint32_t result = (magnitude - 0x38000000U) >> 13;
+  const uint32_t remainder = magnitude & 0x1fffU;
+  if (remainder > 0x1000U || (remainder == 0x1000U && (result & 1U))) {
+    ++result;
+  }
+  return static_cast<uint16_t>(sign | result);
+}
+
+float from_half(uint16_t value) {
+  const uint32_t sign = static_cast<uint32_t>(value & 0x8000U) << 16;
+  uint32_t exponent = (value >> 10) & 0x1fU;
+  uint32_t mantissa = value & 0x3ffU;
+
+  if (exponent == 0x1fU) {
+    return bits_to_float(sign | 0x7f800000U | (mantissa << 13));
+  }
+  if (exponent == 0U) {
+    if (mantissa == 0U) {
+      return bits_to_float(sign);
+    }
+    // normalize subnormal values
+    exponent = 113U;
+    while ((mantissa & 0x400U) == 0U) {
+      mantissa <<= 1;
+      --exponent;
+    }
+    mantissa &= 0x3ffU;
+    return bits_to_float(sign | (exponent << 23) | (mantissa << 13));
+  }
+  return bits_to_float(sign | ((exponent + 112U) << 23) | (mantissa << 13));
+}
+}
+}
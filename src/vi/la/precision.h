@@ -0,0 +1,30 @@
+#ifndef __vinn__precision__
+#define __vinn__precision__
+
+#include <cstddef>
+#include <cstdint>
+
+namespace vi {
+namespace la {
+
+/// Storage precision used for matrix multiplication operands. Products are
+/// always accumulated in single precision.
+enum class precision { single, bfloat16, half };
+
+/// \return number of bytes needed to store an element in the given precision
+size_t bytes_per_element(precision storage_precision);
+
+/// \return human readable name of the given precision
+const char* precision_name(precision storage_precision);
+
+/// Round a single precision value to the nearest bfloat16 value
+uint16_t to_bfloat16(float value);
+float from_bfloat16(uint16_t value);
+
+/// Round a single precision value to the nearest IEEE 754 half precision value
+uint16_t to_half(float value);
+float from_half(uint16_t value);
+}
+}
+
+#endif
@@ -0,0 +1,166 @@
+#include "vi/la/profiler.h"
+#include "vi/la/matrix.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+
+namespace vi {
+namespace la {
+
+profiler::scope::scope(const std::shared_ptr<vi::la::profiler>& profiler, const char* name,
+                       const matrix& shaped, std::initializer_list<const matrix*> operands,
+                       double flops_per_element)
+    : _profiler(profiler.get()) {
+  if (!_profiler) {
+    return;
+  }
+  const double elements = static_cast<double>(shaped.row_count() * shaped.column_count());
+  _event.name = name;
+  _event.rows = shaped.row_count();
+  _event.columns = shaped.column_count();
+  _event.flops = flops_per_element * elements;
+  _event.bytes = elements * sizeof(float);
+  for (const matrix* operand : operands) {
+    _event.bytes +=
+        static_cast<double>(operand->row_count() * operand->column_count()) * sizeof(float);
+  }
+  _event.device_seconds = 0.0;
+  _start = std::chrono::steady_clock::now();
+}
+
+profiler::scope::~scope() {
+  if (!_profiler) {
+    return;
+  }
+  const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+  _event.start_seconds = _profiler->seconds_since_start(_start);
+  _event.wall_seconds = std::chrono::duration<double>(end - _start).count();
+  _profiler->record(_event);
+}
+
+void profiler::scope::add_device_seconds(double seconds) { _event.device_seconds += seconds; }
+
+void profiler::scope::add_bytes(double bytes) { _event.bytes += bytes; }
+
+profiler::profiler() : _start(std::chrono::steady_clock::now()), _ceilings{0.0, 0.0} {}
+
+void profiler::record(const event& recorded) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _events.push_back(recorded);
+  const std::thread::id thread = std::this_thread::get_id();
+  if (_threads.find(thread) == _threads.end()) {
+    const size_t thread_number = _threads.size();
+    _threads[thread] = thread_number;
+  }
+  _events.back().thread = _threads[thread];
+}
+
+void profiler::clear() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _events.clear();
+}
+
+std::vector<profiler::event> profiler::events() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _events;
+}
+
+std::vector<profiler::summary> profiler::summaries() const {
+  std::map<std::string, summary> by_name;
+  for (const event& recorded : events()) {
+    summary& operation = by_name[recorded.name];
+    operation.name = recorded.name;
+    operation.calls += 1U;
+    operation.wall_seconds += recorded.wall_seconds;
+    operation.device_seconds += recorded.device_seconds;
+    operation.flops += recorded.flops;
+    operation.bytes += recorded.bytes;
+  }
+
+  std::vector<summary> summaries;
+  for (const auto& operation : by_name) {
+    summaries.push_back(operation.second);
+  }
+  std::stable_sort(summaries.begin(), summaries.end(),
+                   [](const summary& first, const summary& second) {
+                     return first.wall_seconds > second.wall_seconds;
+                   });
+  return summaries;
+}
+
+void profiler::set_ceilings(const ceilings& device) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _ceilings = device;
+}
+
+double profiler::roofline_fraction(const summary& operation) const {
+  ceilings device;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    device = _ceilings;
+  }
+  const double seconds =
+      operation.device_seconds > 0.0 ? operation.device_seconds : operation.wall_seconds;
+  if (device.flops_per_second <= 0.0 || device.bytes_per_second <= 0.0 || seconds <= 0.0) {
+    return 0.0;
+  }
+  // an operation is bound by whichever of its arithmetic and its memory traffic takes longer
+  const double bound_seconds = std::max(operation.flops / device.flops_per_second,
+                                        operation.bytes / device.bytes_per_second);
+  return bound_seconds / seconds;
+}
+
+void profiler::write_trace(std::ostream& stream) const {
+  const std::vector<event> recorded = events();
+  const std::ios_base::fmtflags flags = stream.flags();
+  const std::streamsize precision = stream.precision();
+  stream << "{\"traceEvents\":[";
+  for (size_t i = 0U; i < recorded.size(); ++i) {
+    const event& operation = recorded[i];
+    stream << (i == 0U ? "\n" : ",\n") << std::fixed << std::setprecision(3) << "{\"name\":\""
+           << operation.name << "\",\"cat\":\"la\",\"ph\":\"X\",\"pid\":0,\"tid\":"
+           << operation.thread << ",\"ts\":" << operation.start_seconds * 1e6
+           << ",\"dur\":" << operation.wall_seconds * 1e6 << ",\"args\":{\"rows\":"
+           << operation.rows << ",\"columns\":" << operation.columns
+           << ",\"flops\":" << std::setprecision(0) << operation.flops
+           << ",\"bytes\":" << operation.bytes << ",\"device_us\":" << std::setprecision(3)
+           << operation.device_seconds * 1e6 << "}}";
+  }
+  stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+  stream.flags(flags);
+  stream.precision(precision);
+}
+
+void profiler::write_report(std::ostream& stream) const {
+  const std::ios_base::fmtflags flags = stream.flags();
+  const std::streamsize precision = stream.precision();
+  stream << std::left << std::setw(28) << "operation" << std::right << std::setw(10) << "calls"
+         << std::setw(12) << "wall ms" << std::setw(12) << "device ms" << std::setw(12)
+         << "mean us" << std::setw(10) << "GFLOP/s" << std::setw(10) << "GB/s" << std::setw(10)
+         << "FLOP/B" << std::setw(10) << "% roof" << std::endl;
+  stream << std::fixed;
+  for (const summary& operation : summaries()) {
+    const double seconds =
+        operation.device_seconds > 0.0 ? operation.device_seconds : operation.wall_seconds;
+    const double per_second = seconds > 0.0 ? 1e-9 / seconds : 0.0;
+    stream << std::left << std::setw(28) << operation.name << std::right << std::setw(10)
+           << operation.calls << std::setprecision(3) << std::setw(12)
+           << operation.wall_seconds * 1e3 << std::setw(12) << operation.device_seconds * 1e3
+           << std::setprecision(1) << std::setw(12)
+           << operation.wall_seconds * 1e6 / operation.calls << std::setprecision(2)
+           << std::setw(10) << operation.flops * per_second << std::setw(10)
+           << operation.bytes * per_second << std::setw(10)
+           << (operation.bytes > 0.0 ? operation.flops / operation.bytes : 0.0)
+           << std::setprecision(1) << std::setw(10) << roofline_fraction(operation) * 100.0
+           << std::endl;
+  }
+  stream.flags(flags);
+  stream.precision(precision);
+}
+
+double profiler::seconds_since_start(std::chrono::steady_clock::time_point time) const {
+  return std::chrono::duration<double>(time - _start).count();
+}
+}
+}
@@ -0,0 +1,119 @@
+#ifndef __vinn__profiler__
+#define __vinn__profiler__
+
+#include <chrono>
+#include <cstddef>
+#include <initializer_list>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace vi {
+namespace la {
+
+class matrix;
+
+/// Records the operations of the contexts it is attached to, see
+/// context::set_profiler. Contexts without a profiler record nothing.
+/// Operations may be recorded concurrently from several threads.
+class profiler {
+public:
+  /// A single call of an operation
+  struct event {
+    std::string name;
+    /// Shape of the result or of the operand the operation is shaped by
+    size_t rows;
+    size_t columns;
+    double flops;
+    /// Bytes of the operands read and of the result written
+    double bytes;
+    /// Seconds since the profiler was created
+    double start_seconds;
+    double wall_seconds;
+    /// Seconds the kernels of the operation ran on devices, zero on the host
+    double device_seconds;
+    /// Small number identifying the recording thread
+    size_t thread;
+  };
+
+  /// All calls of an operation
+  struct summary {
+    std::string name;
+    size_t calls;
+    double wall_seconds;
+    double device_seconds;
+    double flops;
+    double bytes;
+  };
+
+  /// Arithmetic throughput and memory bandwidth a device reaches, bounding the
+  /// operations by the roofline model
+  struct ceilings {
+    double flops_per_second;
+    double bytes_per_second;
+  };
+
+  /// Times an operation from construction to destruction, does nothing without a
+  /// profiler so contexts can create one for every operation
+  class scope {
+  public:
+    /// \param shaped result of the operation or the operand it is shaped by
+    /// \param operands matrices the operation reads, counted with shaped as bytes moved
+    /// \param flops_per_element operations per element of shaped
+    scope(const std::shared_ptr<vi::la::profiler>& profiler, const char* name,
+          const matrix& shaped, std::initializer_list<const matrix*> operands,
+          double flops_per_element);
+    ~scope();
+
+    bool active() const { return _profiler != nullptr; }
+    void add_device_seconds(double seconds);
+    /// Count bytes read besides the dense matrices, such as sparse operands
+    void add_bytes(double bytes);
+
+  private:
+    scope(const scope&) = delete;
+    scope& operator=(const scope&) = delete;
+
+    vi::la::profiler* _profiler;
+    event _event;
+    std::chrono::steady_clock::time_point _start;
+  };
+
+  profiler();
+
+  void record(const event& recorded);
+  void clear();
+
+  std::vector<event> events() const;
+  /// \return calls aggregated by operation, the longest total wall time first
+  std::vector<summary> summaries() const;
+
+  /// Compare the operations with the roofline of the given ceilings
+  void set_ceilings(const ceilings& device);
+  /// \return seconds the roofline bound allows for the calls divided by the seconds
+  ///         they took, zero without ceilings
+  double roofline_fraction(const summary& operation) const;
+
+  /// Write the events in the Chrome trace event format, viewable in chrome://tracing
+  void write_trace(std::ostream& stream) const;
+  /// Write a table of the summaries, with the arithmetic intensity and the
+  /// percentage of the roofline bound reached once ceilings are set
+  void write_report(std::ostream& stream) const;
+
+private:
+  double seconds_since_start(std::chrono::steady_clock::time_point time) const;
+
+  const std::chrono::steady_clock::time_point _start;
+  mutable std::mutex _mutex;
+  std::vector<event> _events;
+  ceilings _ceilings;
+  std::map<std::thread::id, size_t> _threads;
+};
+}
+}
+
+#endif
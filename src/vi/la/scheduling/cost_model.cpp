@@ -0,0 +1,160 @@
+#include "vi/la/scheduling/cost_model.h"
+
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+namespace {
+
+/// Weight of the samples recorded so far when adding one
+const double decay = 0.98;
+
+const char* const format_name = "vinn-cost-model";
+const int format_version = 1;
+
+const char* const backend_names[] = {"host", "device"};
+const char* const operation_names[] = {"multiply",      "sparse_multiply", "elementwise",
+                                       "transcendental", "row_reduction",   "copy",
+                                       "convolution"};
+
+/// Launch overhead and time per unit of work assumed before any samples
+const double default_overheads[] = {0.0, 20e-6};
+const double default_seconds_per_work[] = {1e-9, 1e-10};
+const double default_transfer_overhead = 10e-6;
+const double default_seconds_per_byte = 1e-10;
+}
+
+namespace vi {
+namespace la {
+namespace scheduling {
+
+cost_model::fit::fit()
+    : count(0.0), work(0.0), seconds(0.0), work_squared(0.0), work_seconds(0.0) {}
+
+void cost_model::fit::add(double sample_work, double sample_seconds) {
+  count = count * decay + 1.0;
+  work = work * decay + sample_work;
+  seconds = seconds * decay + sample_seconds;
+  work_squared = work_squared * decay + sample_work * sample_work;
+  work_seconds = work_seconds * decay + sample_work * sample_seconds;
+}
+
+double cost_model::fit::predict(double predicted_work, double default_overhead,
+                                double default_seconds_per_work) const {
+  if (count == 0.0) {
+    return default_overhead + default_seconds_per_work * predicted_work;
+  }
+
+  const double denominator = count * work_squared - work * work;
+  if (denominator > 1e-9 * count * work_squared) {
+    const double seconds_per_work = (count * work_seconds - work * seconds) / denominator;
+    const double overhead = (seconds - seconds_per_work * work) / count;
+    if (seconds_per_work >= 0.0 && overhead >= 0.0) {
+      return overhead + seconds_per_work * predicted_work;
+    }
+  }
+  // samples of a single size only tell the time per unit of work
+  if (work_squared > 0.0) {
+    return work_seconds / work_squared * predicted_work;
+  }
+  return seconds / count;
+}
+
+cost_model::cost_model() {}
+
+double cost_model::predict(backend where, operation kind, double work) const {
+  const size_t index = static_cast<size_t>(where);
+  return operation_fit(where, kind)
+      .predict(work, default_overheads[index], default_seconds_per_work[index]);
+}
+
+double cost_model::predict_transfer(size_t bytes) const {
+  return _transfer.predict(static_cast<double>(bytes), default_transfer_overhead,
+                           default_seconds_per_byte);
+}
+
+void cost_model::record(backend where, operation kind, double work, double seconds) {
+  operation_fit(where, kind).add(work, seconds);
+}
+
+void cost_model::record_transfer(size_t bytes, double seconds) {
+  _transfer.add(static_cast<double>(bytes), seconds);
+}
+
+bool cost_model::empty() const {
+  for (const fit& operation : _operations) {
+    if (operation.count != 0.0) {
+      return false;
+    }
+  }
+  return _transfer.count == 0.0;
+}
+
+void cost_model::save(std::ostream& output) const {
+  std::ostringstream text;
+  text << std::setprecision(std::numeric_limits<double>::max_digits10);
+  text << format_name << " " << format_version << "\n";
+  const auto write_fit = [&text](const fit& samples) {
+    text << " " << samples.count << " " << samples.work << " " << samples.seconds << " "
+         << samples.work_squared << " " << samples.work_seconds << "\n";
+  };
+  text << "transfer";
+  write_fit(_transfer);
+  for (size_t where = 0U; where < 2U; ++where) {
+    for (size_t kind = 0U; kind < operation_count; ++kind) {
+      text << backend_names[where] << " " << operation_names[kind];
+      write_fit(operation_fit(static_cast<backend>(where), static_cast<operation>(kind)));
+    }
+  }
+  output << text.str();
+}
+
+cost_model cost_model::load(std::istream& input) {
+  std::string name;
+  int version = 0;
+  if (!(input >> name >> version) || name != format_name || version != format_version) {
+    throw exception("Not a cost model.");
+  }
+
+  cost_model model;
+  const auto read_fit = [&input](fit& samples) {
+    if (!(input >> samples.count >> samples.work >> samples.seconds >> samples.work_squared >>
+          samples.work_seconds)) {
+      throw exception("Truncated cost model.");
+    }
+  };
+  std::string first;
+  while (input >> first) {
+    if (first == "transfer") {
+      read_fit(model._transfer);
+      continue;
+    }
+
+    std::string second;
+    input >> second;
+    size_t where = 0U;
+    while (where < 2U && first != backend_names[where]) {
+      ++where;
+    }
+    size_t kind = 0U;
+    while (kind < operation_count && second != operation_names[kind]) {
+      ++kind;
+    }
+    if (where == 2U || kind == operation_count) {
+      throw exception("Unknown cost model entry: " + first + " " + second);
+    }
+    read_fit(model.operation_fit(static_cast<backend>(where), static_cast<operation>(kind)));
+  }
+  return model;
+}
+
+cost_model::fit& cost_model::operation_fit(backend where, operation kind) {
+  return _operations[static_cast<size_t>(where) * operation_count + static_cast<size_t>(kind)];
+}
+
+const cost_model::fit& cost_model::operation_fit(backend where, operation kind) const {
+  return _operations[static_cast<size_t>(where) * operation_count + static_cast<size_t>(kind)];
+}
+}
+}
+}
@@ -0,0 +1,89 @@
+#ifndef __vinn__cost_model__
+#define __vinn__cost_model__
+
+#include <array>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace vi {
+namespace la {
+namespace scheduling {
+
+/// Backends of a scheduling_context
+enum class backend { host, device };
+
+/// Classes of operations with a similar cost per unit of work
+enum class operation {
+  /// dense products, work is multiply-adds
+  multiply,
+  /// sparse products, work is multiply-adds of non-zero values
+  sparse_multiply,
+  /// arithmetic on every element, work is elements
+  elementwise,
+  /// activation functions and logarithms, work is elements
+  transcendental,
+  /// softmax, sums, argmax and top-k, work is elements
+  row_reduction,
+  /// merge, transpose and sub-matrices, work is elements
+  copy,
+  /// work is result elements times mask elements
+  convolution
+};
+
+/// Predicts the time operations take on every backend and the time to copy
+/// matrices between the backends. Every prediction is a linear fit of time
+/// over work, updated online from measured samples. Older samples are
+/// gradually forgotten, so the model follows changes in load.
+class cost_model {
+public:
+  class exception : public std::runtime_error {
+  public:
+    exception(const std::string& text) : runtime_error(text) {}
+  };
+
+  cost_model();
+
+  /// \return predicted seconds, defaults favor the device for large work until samples exist
+  double predict(backend where, operation kind, double work) const;
+  /// \return predicted seconds to copy a matrix between the backends
+  double predict_transfer(size_t bytes) const;
+
+  void record(backend where, operation kind, double work, double seconds);
+  void record_transfer(size_t bytes, double seconds);
+
+  /// true until the first sample is recorded
+  bool empty() const;
+
+  void save(std::ostream& output) const;
+  /// \throw exception if the input is not a saved cost model
+  static cost_model load(std::istream& input);
+
+private:
+  /// Least squares fit of seconds = overhead + seconds_per_work * work
+  struct fit {
+    fit();
+    void add(double work, double seconds);
+    double predict(double work, double default_overhead, double default_seconds_per_work) const;
+
+    double count;
+    double work;
+    double seconds;
+    double work_squared;
+    double work_seconds;
+  };
+
+  static const size_t operation_count = 7U;
+
+  fit& operation_fit(backend where, operation kind);
+  const fit& operation_fit(backend where, operation kind) const;
+
+  std::array<fit, 2U * operation_count> _operations;
+  fit _transfer;
+};
+}
+}
+}
+
+#endif
@@ -0,0 +1,550 @@
+#include "vi/la/scheduling/scheduling_context.h"
+#include "vi/la/matrix.h"
+#include "vi/la/scheduling/scheduling_matrix.h"
+#include "vi/la/sparse_matrix.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <limits>
+#include <stdexcept>
+
+using vi::la::scheduling::backend;
+using vi::la::scheduling::operation;
+
+namespace {
+
+/// Products with less work are not worth splitting between host and device
+const double minimum_split_work = 1 << 22;
+/// Fractions of the product rows considered for the device
+const size_t split_steps = 8U;
+
+double elements(const vi::la::matrix& values) {
+  return static_cast<double>(values.row_count()) * values.column_count();
+}
+
+/// Bytes the device context copies for a sparse operand, which it keeps after the first product
+size_t device_bytes(const vi::la::sparse_matrix& operand) {
+  if (operand.device_copy_count() != 0U) {
+    return 0U;
+  }
+  return operand.non_zero_count() * 2U * sizeof(float) +
+         operand.row_offsets().size() * sizeof(uint64_t);
+}
+
+double seconds_since(const std::chrono::steady_clock::time_point& start) {
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+/// Host matrix using rows of another host matrix in place
+vi::la::matrix rows_in_place(vi::la::cpu_context& host, const vi::la::matrix& values,
+                             size_t first_row, size_t row_count) {
+  // the view does not own the values, they outlive it
+  std::shared_ptr<float> rows(values[first_row], [](float*) {});
+  return vi::la::matrix::adopt(host, row_count, values.column_count(), rows);
+}
+}
+
+namespace vi {
+namespace la {
+
+scheduling_context::scheduling_context(cpu_context& host, context& device,
+                                       const scheduling::cost_model& model)
+    : _host(host), _device(device), _model(model), _statistics{0U, 0U, 0U, 0U} {
+  if (host.storage_precision() != device.storage_precision()) {
+    throw std::invalid_argument("Host and device must use the same storage precision.");
+  }
+  if (_model.empty()) {
+    calibrate();
+  }
+}
+
+std::shared_ptr<vi::la::matrix_implementation>
+scheduling_context::implement_matrix(size_t rows, size_t columns, const float* initial_values) {
+  return std::make_shared<scheduling::matrix>(*this, backend::host,
+                                              matrix(_host, initial_values, rows, columns));
+}
+
+std::shared_ptr<vi::la::matrix_implementation>
+scheduling_context::adopt_matrix(size_t rows, size_t columns, std::shared_ptr<float> values) {
+  return std::make_shared<scheduling::matrix>(*this, backend::host,
+                                              matrix::adopt(_host, rows, columns, values));
+}
+
+void scheduling_context::multiply(matrix& product, const matrix& operand_1,
+                                  const matrix& operand_2) {
+  const double work = elements(product) * operand_2.row_count();
+  const size_t rows = device_rows(product, operand_1, operand_2);
+  const auto run = [&](context& backend_context, backend where) {
+    backend_context.multiply(scheduled(product).write(where), scheduled(operand_1).read(where),
+                             scheduled(operand_2).read(where));
+  };
+
+  if (rows == 0U) {
+    run_on(backend::host, operation::multiply, work, {&operand_1, &operand_2}, run);
+  } else if (rows == product.row_count()) {
+    run_on(backend::device, operation::multiply, work, {&operand_1, &operand_2}, run);
+  } else {
+    split_multiply(product, operand_1, operand_2, rows);
+  }
+}
+
+void scheduling_context::multiply(matrix& product, const matrix& operand_1,
+                                  const float operand_2) {
+  dispatch(operation::elementwise, elements(product), {&operand_1},
+           [&](context& backend_context, backend where) {
+             backend_context.multiply(scheduled(product).write(where),
+                                      scheduled(operand_1).read(where), operand_2);
+           });
+}
+
+void scheduling_context::multiply_elementwise(matrix& product, const matrix& operand_1,
+                                              const matrix& operand_2) {
+  dispatch(operation::elementwise, elements(product), {&operand_1, &operand_2},
+           [&](context& backend_context, backend where) {
+             backend_context.multiply_elementwise(scheduled(product).write(where),
+                                                  scheduled(operand_1).read(where),
+                                                  scheduled(operand_2).read(where));
+           });
+}
+
+void scheduling_context::multiply(matrix& product, const sparse_matrix& operand_1,
+                                  const matrix& operand_2) {
+  dispatch(operation::sparse_multiply,
+           static_cast<double>(operand_1.non_zero_count()) * product.column_count(), {&operand_2},
+           [&](context& backend_context, backend where) {
+             backend_context.multiply(scheduled(product).write(where), operand_1,
+                                      scheduled(operand_2).read(where));
+           },
+           device_bytes(operand_1));
+}
+
+void scheduling_context::transpose_multiply(matrix& product, const sparse_matrix& operand_1,
+                                            const matrix& operand_2) {
+  dispatch(operation::sparse_multiply,
+           static_cast<double>(operand_1.non_zero_count()) * product.column_count(), {&operand_2},
+           [&](context& backend_context, backend where) {
+             backend_context.transpose_multiply(scheduled(product).write(where), operand_1,
+                                                scheduled(operand_2).read(where));
+           },
+           device_bytes(operand_1));
+}
+
+void scheduling_context::add(matrix& sum, const matrix& operand_1, const float operand_2) {
+  dispatch(operation::elementwise, elements(sum), {&operand_1},
+           [&](context& backend_context, backend where) {
+             backend_context.add(scheduled(sum).write(where), scheduled(operand_1).read(where),
+                                 operand_2);
+           });
+}
+
+void scheduling_context::add(matrix& sum, const matrix& operand_1, const matrix& operand_2) {
+  dispatch(operation::elementwise, elements(sum), {&operand_1, &operand_2},
+           [&](context& backend_context, backend where) {
+             backend_context.add(scheduled(sum).write(where), scheduled(operand_1).read(where),
+                                 scheduled(operand_2).read(where));
+           });
+}
+
+void scheduling_context::subtract(matrix& difference, const matrix& operand_1,
+                                  const matrix& operand_2) {
+  dispatch(operation::elementwise, elements(difference), {&operand_1, &operand_2},
+           [&](context& backend_context, backend where) {
+             backend_context.subtract(scheduled(difference).write(where),
+                                      scheduled(operand_1).read(where),
+                                      scheduled(operand_2).read(where));
+           });
+}
+
+void scheduling_context::sigmoid(matrix& operand) {
+  dispatch(operation::transcendental, elements(operand), {&operand},
+           [&](context& backend_context, backend where) {
+             backend_context.sigmoid(scheduled(operand).write(where));
+           });
+}
+
+void scheduling_context::sigmoid_gradient(matrix& gradient, const matrix& operand) {
+  dispatch(operation::transcendental, elements(operand), {&operand},
+           [&](context& backend_context, backend where) {
+             backend_context.sigmoid_gradient(scheduled(gradient).write(where),
+                                              scheduled(operand).read(where));
+           });
+}
+
+void scheduling_context::hyperbolic_tangent(matrix& operand) {
+  dispatch(operation::transcendental, elements(operand), {&operand},
+           [&](context& backend_context, backend where) {
+             backend_context.hyperbolic_tangent(scheduled(operand).write(where));
+           });
+}
+
+void scheduling_context::hyperbolic_tangent_gradient(matrix& gradient, const matrix& operand) {
+  dispatch(operation::transcendental, elements(operand), {&operand},
+           [&](context& backend_context, backend where) {
+             backend_context.hyperbolic_tangent_gradient(scheduled(gradient).write(where),
+                                                         scheduled(operand).read(where));
+           });
+}
+
+void scheduling_context::softmax(matrix& operand) {
+  dispatch(operation::row_reduction, elements(operand), {&operand},
+           [&](context& backend_context, backend where) {
+             backend_context.softmax(scheduled(operand).write(where));
+           });
+}
+
+void scheduling_context::merge(matrix& merged, const matrix& operand_1, const matrix& operand_2) {
+  dispatch(operation::copy, elements(merged), {&operand_1, &operand_2},
+           [&](context& backend_context, backend where) {
+             backend_context.merge(scheduled(merged).write(where),
+                                   scheduled(operand_1).read(where),
+                                   scheduled(operand_2).read(where));
+           });
+}
+
+void scheduling_context::transpose(matrix& transposed, const matrix& original) {
+  dispatch(operation::copy, elements(original), {&original},
+           [&](context& backend_context, backend where) {
+             backend_context.transpose(scheduled(transposed).write(where),
+                                       scheduled(original).read(where));
+           });
+}
+
+matrix scheduling_context::sum_rows(const matrix& original) {
+  matrix sums;
+  dispatch(operation::row_reduction, elements(original), {&original},
+           [&](context& backend_context, backend where) {
+             sums = wrap(where, backend_context.sum_rows(scheduled(original).read(where)));
+           });
+  return sums;
+}
+
+matrix scheduling_context::sum_columns(const matrix& original) {
+  matrix sums;
+  dispatch(operation::row_reduction, elements(original), {&original},
+           [&](context& backend_context, backend where) {
+             sums = wrap(where, backend_context.sum_columns(scheduled(original).read(where)));
+           });
+  return sums;
+}
+
+void scheduling_context::log(matrix& result, const matrix& original) {
+  dispatch(operation::transcendental, elements(original), {&original},
+           [&](context& backend_context, backend where) {
+             backend_context.log(scheduled(result).write(where), scheduled(original).read(where));
+           });
+}
+
+void scheduling_context::row_argmax(matrix& indices, const matrix& operand) {
+  dispatch(operation::row_reduction, elements(operand), {&operand},
+           [&](context& backend_context, backend where) {
+             backend_context.row_argmax(scheduled(indices).write(where),
+                                        scheduled(operand).read(where));
+           });
+}
+
+void scheduling_context::row_top_k(matrix& indices, matrix& values, const matrix& operand) {
+  dispatch(operation::row_reduction, elements(operand), {&operand},
+           [&](context& backend_context, backend where) {
+             backend_context.row_top_k(scheduled(indices).write(where),
+                                       scheduled(values).write(where),
+                                       scheduled(operand).read(where));
+           });
+}
+
+void scheduling_context::sub_matrix(matrix& target, const matrix& original, size_t start_row,
+                                    size_t end_row, size_t start_column, size_t end_column) {
+  dispatch(operation::copy, elements(target), {&original},
+           [&](context& backend_context, backend where) {
+             backend_context.sub_matrix(scheduled(target).write(where),
+                                        scheduled(original).read(where), start_row, end_row,
+                                        start_column, end_column);
+           });
+}
+
+void scheduling_context::convolve_2d(matrix& result, const matrix& mask, const matrix& original,
+                                     size_t channels) {
+  dispatch(operation::convolution, elements(result) * elements(mask), {&mask, &original},
+           [&](context& backend_context, backend where) {
+             backend_context.convolve_2d(scheduled(result).write(where),
+                                         scheduled(mask).read(where),
+                                         scheduled(original).read(where), channels);
+           });
+}
+
+vi::la::precision scheduling_context::storage_precision() const {
+  return _host.storage_precision();
+}
+
+transfer_statistics scheduling_context::transfers() const { return _device.transfers(); }
+
+void scheduling_context::set_profiler(std::shared_ptr<vi::la::profiler> profiler) {
+  context::set_profiler(profiler);
+  _host.set_profiler(profiler);
+  _device.set_profiler(profiler);
+}
+
+void scheduling_context::set_tuning_profile(std::shared_ptr<const vi::la::tuning_profile> profile) {
+  context::set_tuning_profile(profile);
+  _host.set_tuning_profile(profile);
+  _device.set_tuning_profile(profile);
+}
+
+std::vector<std::string> scheduling_context::tuned_devices() const {
+  std::vector<std::string> devices = _host.tuned_devices();
+  for (const std::string& device : _device.tuned_devices()) {
+    devices.push_back(device);
+  }
+  return devices;
+}
+
+void scheduling_context::calibrate() {
+  // the first run of every operation is a warm-up, the second is recorded
+  const auto measure = [this](backend where, operation kind, double work,
+                              const std::function<void()>& run) {
+    run();
+    const auto start = std::chrono::steady_clock::now();
+    run();
+    record(where, kind, work, seconds_since(start));
+  };
+
+  for (backend where : {backend::host, backend::device}) {
+    context& backend_context = this->backend_context(where);
+    for (size_t size : {64U, 256U}) {
+      matrix operand_1(backend_context, size, size, 0.5f);
+      matrix operand_2(backend_context, size, size, 0.25f);
+      matrix result(backend_context, size, size, 0.0f);
+      const double work = elements(result);
+
+      measure(where, operation::multiply, work * size,
+              [&] { backend_context.multiply(result, operand_1, operand_2); });
+      measure(where, operation::elementwise, work,
+              [&] { backend_context.add(result, operand_1, operand_2); });
+      measure(where, operation::transcendental, work,
+              [&] { backend_context.sigmoid_gradient(result, operand_1); });
+      measure(where, operation::row_reduction, work,
+              [&] { backend_context.softmax(result); });
+      measure(where, operation::copy, work,
+              [&] { backend_context.transpose(result, operand_1); });
+    }
+  }
+
+  // copies between the backends are timed the way scheduled matrices make them: a
+  // device matrix is created from host values, and device values are read on the host
+  for (size_t size : {256U, 1024U}) {
+    matrix host_values(_host, size, size, 0.5f);
+    const size_t bytes = size * size * sizeof(float);
+    {
+      matrix warm_up(_device, host_values[0], size, size);
+      std::memcpy(host_values[0], warm_up.values(), bytes);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    matrix device_values(_device, host_values[0], size, size);
+    const double upload_seconds = seconds_since(start);
+    start = std::chrono::steady_clock::now();
+    std::memcpy(host_values[0], device_values.values(), bytes);
+    const double download_seconds = seconds_since(start);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _model.record_transfer(bytes, upload_seconds);
+    _model.record_transfer(bytes, download_seconds);
+  }
+}
+
+scheduling::cost_model scheduling_context::model() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _model;
+}
+
+scheduling_context::statistics scheduling_context::counters() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _statistics;
+}
+
+context& scheduling_context::backend_context(backend where) {
+  if (where == backend::host) {
+    return _host;
+  }
+  return _device;
+}
+
+void scheduling_context::dispatch(operation kind, double work,
+                                  std::initializer_list<const matrix*> inputs,
+                                  const operation_function& run, size_t device_bytes) {
+  backend where = backend::host;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const double host_seconds =
+        _model.predict(backend::host, kind, work) + copy_seconds(backend::host, inputs);
+    double device_seconds =
+        _model.predict(backend::device, kind, work) + copy_seconds(backend::device, inputs);
+    if (device_bytes != 0U) {
+      device_seconds += _model.predict_transfer(device_bytes);
+    }
+    if (device_seconds < host_seconds) {
+      where = backend::device;
+    }
+  }
+  run_on(where, kind, work, inputs, run);
+}
+
+void scheduling_context::run_on(backend where, operation kind, double work,
+                                std::initializer_list<const matrix*> inputs,
+                                const operation_function& run) {
+  // copies are timed on their own, so the operation time does not include them
+  for (const matrix* input : inputs) {
+    scheduled(*input).read(where);
+  }
+  const auto start = std::chrono::steady_clock::now();
+  run(backend_context(where), where);
+  record(where, kind, work, seconds_since(start));
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (where == backend::host) {
+    ++_statistics.host_operations;
+  } else {
+    ++_statistics.device_operations;
+  }
+}
+
+double scheduling_context::copy_seconds(backend where,
+                                        std::initializer_list<const matrix*> inputs) const {
+  double seconds = 0.0;
+  for (const matrix* input : inputs) {
+    const scheduling::matrix& values = scheduled(*input);
+    if (!values.current_on(where)) {
+      seconds += _model.predict_transfer(values.size_in_bytes());
+    }
+  }
+  return seconds;
+}
+
+size_t scheduling_context::device_rows(const matrix& product, const matrix& operand_1,
+                                       const matrix& operand_2) const {
+  const size_t rows = product.row_count();
+  const double row_work = static_cast<double>(product.column_count()) * operand_2.row_count();
+  const scheduling::matrix& first = scheduled(operand_1);
+  const scheduling::matrix& second = scheduled(operand_2);
+  const size_t first_row_bytes = operand_1.column_count() * sizeof(float);
+  const size_t product_row_bytes = product.column_count() * sizeof(float);
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  const auto transfer = [this](bool current, size_t bytes) {
+    return current ? 0.0 : _model.predict_transfer(bytes);
+  };
+
+  size_t best_rows = 0U;
+  double best_seconds = std::numeric_limits<double>::max();
+  for (size_t step = 0U; step <= split_steps; ++step) {
+    const size_t device_rows = rows * step / split_steps;
+    const bool split = device_rows != 0U && device_rows != rows;
+    if ((step != 0U && step != split_steps) && (!split || rows * row_work < minimum_split_work)) {
+      continue;
+    }
+
+    double host_seconds = 0.0;
+    if (device_rows != rows) {
+      host_seconds = _model.predict(backend::host, operation::multiply,
+                                    (rows - device_rows) * row_work) +
+                     transfer(first.current_on(backend::host), first.size_in_bytes()) +
+                     transfer(second.current_on(backend::host), second.size_in_bytes());
+    }
+    double device_seconds = 0.0;
+    if (device_rows != 0U) {
+      device_seconds =
+          _model.predict(backend::device, operation::multiply, device_rows * row_work) +
+          transfer(second.current_on(backend::device), second.size_in_bytes());
+      if (!split) {
+        device_seconds += transfer(first.current_on(backend::device), first.size_in_bytes());
+      } else if (first.current_on(backend::device)) {
+        const double copied_values = static_cast<double>(device_rows) * operand_1.column_count();
+        device_seconds += _model.predict(backend::device, operation::copy, copied_values);
+      } else {
+        device_seconds += _model.predict_transfer(device_rows * first_row_bytes);
+      }
+      if (split) {
+        // device rows of the product are copied into the host copy
+        device_seconds += _model.predict_transfer(device_rows * product_row_bytes);
+      }
+    }
+
+    const double seconds = std::max(host_seconds, device_seconds);
+    if (seconds < best_seconds) {
+      best_seconds = seconds;
+      best_rows = device_rows;
+    }
+  }
+  return best_rows;
+}
+
+void scheduling_context::split_multiply(matrix& product, const matrix& operand_1,
+                                        const matrix& operand_2, size_t device_rows) {
+  const size_t host_rows = product.row_count() - device_rows;
+  const double row_work = static_cast<double>(product.column_count()) * operand_2.row_count();
+  scheduling::matrix& first = scheduled(operand_1);
+  const matrix* first_device = first.current_on(backend::device) ? &first.read(backend::device)
+                                                                 : nullptr;
+  const matrix& first_host = first.read(backend::host);
+  const matrix& second_host = scheduled(operand_2).read(backend::host);
+  const matrix& second_device = scheduled(operand_2).read(backend::device);
+  matrix& product_host = scheduled(product).write(backend::host);
+
+  // the host computes the last rows in place while the device computes the first ones
+  std::future<void> host_part = std::async(std::launch::async, [&] {
+    matrix product_rows = rows_in_place(_host, product_host, device_rows, host_rows);
+    const matrix first_rows = rows_in_place(_host, first_host, device_rows, host_rows);
+    const auto start = std::chrono::steady_clock::now();
+    _host.multiply(product_rows, first_rows, second_host);
+    record(backend::host, operation::multiply, host_rows * row_work, seconds_since(start));
+  });
+
+  const float* no_values = nullptr;
+  matrix first_rows;
+  if (first_device != nullptr) {
+    first_rows = matrix(_device, no_values, device_rows, operand_1.column_count());
+    _device.sub_matrix(first_rows, *first_device, 0U, device_rows - 1U, 0U,
+                       operand_1.column_count() - 1U);
+  } else {
+    const auto start = std::chrono::steady_clock::now();
+    first_rows = matrix(_device, first_host[0], device_rows, operand_1.column_count());
+    copied(device_rows * operand_1.column_count() * sizeof(float), seconds_since(start));
+  }
+
+  matrix product_rows(_device, no_values, device_rows, product.column_count());
+  auto start = std::chrono::steady_clock::now();
+  _device.multiply(product_rows, first_rows, second_device);
+  record(backend::device, operation::multiply, device_rows * row_work, seconds_since(start));
+
+  const size_t product_bytes = device_rows * product.column_count() * sizeof(float);
+  start = std::chrono::steady_clock::now();
+  std::memcpy(product_host[0], product_rows.values(), product_bytes);
+  copied(product_bytes, seconds_since(start));
+
+  host_part.get();
+  std::lock_guard<std::mutex> lock(_mutex);
+  ++_statistics.split_operations;
+}
+
+void scheduling_context::copied(size_t bytes, double seconds) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _model.record_transfer(bytes, seconds);
+  _statistics.copied_bytes += bytes;
+}
+
+void scheduling_context::record(backend where, operation kind, double work, double seconds) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _model.record(where, kind, work, seconds);
+}
+
+matrix scheduling_context::wrap(backend where, const matrix& values) {
+  return matrix(std::make_shared<scheduling::matrix>(*this, where, values));
+}
+
+scheduling::matrix& scheduling_context::scheduled(const matrix& operand) {
+  return *dynamic_cast<scheduling::matrix*>(operand.implementation());
+}
+}
+}
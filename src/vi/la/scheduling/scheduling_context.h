@@ -0,0 +1,139 @@
+#ifndef __vinn__scheduling_context__
+#define __vinn__scheduling_context__
+
+#include <vi/la/context.h>
+#include <vi/la/cpu/cpu_context.h>
+#include <vi/la/scheduling/cost_model.h>
+
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+
+namespace vi {
+namespace la {
+
+namespace scheduling {
+class matrix;
+}
+
+/// Runs every operation on the host or on a device context, whichever the
+/// cost model predicts to finish first including the time to copy operands
+/// between them. Large matrix products are split by rows and computed on both
+/// at the same time. Measured times of every operation and copy update the
+/// model as the context is used.
+/// Operations may be called concurrently from several threads as long as they
+/// do not use the same matrices.
+class scheduling_context : public context {
+public:
+  /// Counts of scheduled operations
+  struct statistics {
+    size_t host_operations;
+    size_t device_operations;
+    size_t split_operations;
+    size_t copied_bytes;
+  };
+
+  /// \param device context with the same storage precision as the host, usually an
+  ///        opencl_context
+  /// \param model predictions to start from, an empty model is calibrated first
+  /// \throw std::invalid_argument if the storage precisions differ
+  scheduling_context(cpu_context& host, context& device,
+                     const scheduling::cost_model& model = scheduling::cost_model());
+
+  /// Matrices are created on the host
+  std::shared_ptr<vi::la::matrix_implementation> implement_matrix(size_t rows, size_t columns,
+                                                                  const float* initial_values);
+  /// Values are used in place on the host without copying
+  std::shared_ptr<vi::la::matrix_implementation> adopt_matrix(size_t rows, size_t columns,
+                                                              std::shared_ptr<float> values);
+
+  /// Large products are split between the host and the device
+  void multiply(matrix& product, const matrix& operand_1, const matrix& operand_2);
+  void multiply(matrix& product, const matrix& operand_1, const float operand_2);
+  void multiply_elementwise(matrix& product, const matrix& operand_1, const matrix& operand_2);
+
+  void multiply(matrix& product, const sparse_matrix& operand_1, const matrix& operand_2);
+  void transpose_multiply(matrix& product, const sparse_matrix& operand_1,
+                          const matrix& operand_2);
+
+  void add(matrix& sum, const matrix& operand_1, const float operand_2);
+  void add(matrix& sum, const matrix& operand_1, const matrix& operand_2);
+  void subtract(matrix& difference, const matrix& operand_1, const matrix& operand_2);
+
+  void sigmoid(matrix& operand);
+  void sigmoid_gradient(matrix& gradient, const matrix& operand);
+  void hyperbolic_tangent(matrix& operand);
+  void hyperbolic_tangent_gradient(matrix& gradient, const matrix& operand);
+  void softmax(matrix& operand);
+
+  void merge(matrix& merged, const matrix& operand_1, const matrix& operand_2);
+  void transpose(matrix& transposed, const matrix& original);
+
+  matrix sum_rows(const matrix& original);
+  matrix sum_columns(const matrix& original);
+  void log(matrix& result, const matrix& original);
+  void row_argmax(matrix& indices, const matrix& operand);
+  void row_top_k(matrix& indices, matrix& values, const matrix& operand);
+
+  void sub_matrix(matrix& target, const matrix& original, size_t start_row, size_t end_row,
+                  size_t start_column, size_t end_column);
+
+  void convolve_2d(matrix& result, const matrix& mask, const matrix& original, size_t channels);
+
+  vi::la::precision storage_precision() const;
+  /// Copies made by the device context, which every copy to or from the device goes through
+  transfer_statistics transfers() const;
+
+  /// Operations are recorded by the host and the device context that run them
+  void set_profiler(std::shared_ptr<vi::la::profiler> profiler);
+  /// The host and the device context pick their parameters from the profile
+  void set_tuning_profile(std::shared_ptr<const vi::la::tuning_profile> profile);
+  std::vector<std::string> tuned_devices() const;
+
+  /// Time every class of operations on both backends and copies between them
+  void calibrate();
+
+  /// \return copy of the model, e.g. to save it and start later contexts from it
+  scheduling::cost_model model() const;
+  statistics counters() const;
+
+  context& backend_context(scheduling::backend where);
+
+private:
+  friend class scheduling::matrix;
+
+  typedef std::function<void(context&, scheduling::backend)> operation_function;
+
+  /// Run an operation on the backend predicted to finish it first
+  /// \param inputs matrices the operation reads, copied to the backend before it runs
+  /// \param device_bytes bytes copied to the device by the device context itself
+  void dispatch(scheduling::operation kind, double work,
+                std::initializer_list<const matrix*> inputs, const operation_function& run,
+                size_t device_bytes = 0U);
+  void run_on(scheduling::backend where, scheduling::operation kind, double work,
+              std::initializer_list<const matrix*> inputs, const operation_function& run);
+  /// Predicted seconds to copy the inputs that are stale on the backend
+  double copy_seconds(scheduling::backend where, std::initializer_list<const matrix*> inputs) const;
+  /// \return product rows to compute on the device, the rest are computed on the host
+  size_t device_rows(const matrix& product, const matrix& operand_1,
+                     const matrix& operand_2) const;
+  void split_multiply(matrix& product, const matrix& operand_1, const matrix& operand_2,
+                      size_t device_rows);
+  void copied(size_t bytes, double seconds);
+  void record(scheduling::backend where, scheduling::operation kind, double work,
+              double seconds);
+
+  matrix wrap(scheduling::backend where, const matrix& values);
+  static scheduling::matrix& scheduled(const matrix& operand);
+
+  cpu_context& _host;
+  context& _device;
+
+  mutable std::mutex _mutex;
+  scheduling::cost_model _model;
+  statistics _statistics;
+};
+}
+}
+
+#endif
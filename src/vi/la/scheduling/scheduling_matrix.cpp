@@ -0,0 +1,124 @@
+#include "vi/la/scheduling/scheduling_matrix.h"
+#include "vi/la/scheduling/scheduling_context.h"
+
+#include <cassert>
+#include <chrono>
+#include <cstring>
+
+namespace vi {
+namespace la {
+namespace scheduling {
+
+matrix::matrix(scheduling_context& context, backend where, const vi::la::matrix& values)
+    : _context(context), _row_count(values.row_count()), _column_count(values.column_count()),
+      _allocated{false, false}, _current{false, false} {
+  const size_t index = static_cast<size_t>(where);
+  _copies[index] = values;
+  _allocated[index] = true;
+  _current[index] = true;
+}
+
+size_t matrix::row_count() const { return _row_count; }
+
+size_t matrix::column_count() const { return _column_count; }
+
+vi::la::context& matrix::owning_context() const { return _context; }
+
+float* matrix::raw_data() {
+  double copy_seconds = -1.0;
+  float* values = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(_copies_mutex);
+    const size_t index = static_cast<size_t>(backend::host);
+    // the device copy is stale only once it may have been written through the pointer
+    read_locked(backend::host, copy_seconds);
+    write_locked(backend::host);
+    values = _copies[index][0];
+  }
+  record_copy(copy_seconds);
+  return values;
+}
+
+const float* matrix::read_only_data() {
+  double copy_seconds = -1.0;
+  const float* values = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(_copies_mutex);
+    values = read_locked(backend::host, copy_seconds).values();
+  }
+  record_copy(copy_seconds);
+  return values;
+}
+
+const vi::la::matrix& matrix::read(backend where) {
+  double copy_seconds = -1.0;
+  const vi::la::matrix* values = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(_copies_mutex);
+    values = &read_locked(where, copy_seconds);
+  }
+  record_copy(copy_seconds);
+  return *values;
+}
+
+vi::la::matrix& matrix::write(backend where) {
+  std::lock_guard<std::mutex> lock(_copies_mutex);
+  return write_locked(where);
+}
+
+const vi::la::matrix& matrix::read_locked(backend where, double& copy_seconds) {
+  const size_t index = static_cast<size_t>(where);
+  if (_current[index]) {
+    return _copies[index];
+  }
+
+  // one of the copies is always current. Reading device values on the host
+  // blocks until they are there, and a device copy is created from the host
+  // values, so both directions are timed including the actual transfer.
+  const size_t other = 1U - index;
+  assert(_current[other]);
+  const auto start = std::chrono::steady_clock::now();
+  const float* values = _copies[other].values();
+  if (_allocated[index] && where == backend::host) {
+    std::memcpy(_copies[index][0], values, size_in_bytes());
+  } else {
+    _copies[index] =
+        vi::la::matrix(_context.backend_context(where), values, _row_count, _column_count);
+    _allocated[index] = true;
+  }
+  _current[index] = true;
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  copy_seconds = elapsed.count();
+  return _copies[index];
+}
+
+void matrix::record_copy(double copy_seconds) {
+  // the context lock is taken after the copies lock is released, operations
+  // hold the context lock while they look up which copies are current
+  if (copy_seconds >= 0.0) {
+    _context.copied(size_in_bytes(), copy_seconds);
+  }
+}
+
+vi::la::matrix& matrix::write_locked(backend where) {
+  const size_t index = static_cast<size_t>(where);
+  if (!_allocated[index]) {
+    const float* no_values = nullptr;
+    _copies[index] =
+        vi::la::matrix(_context.backend_context(where), no_values, _row_count, _column_count);
+    _allocated[index] = true;
+  }
+  _current[index] = true;
+  _current[1U - index] = false;
+  return _copies[index];
+}
+
+bool matrix::current_on(backend where) const {
+  std::lock_guard<std::mutex> lock(_copies_mutex);
+  return _current[static_cast<size_t>(where)];
+}
+
+size_t matrix::size_in_bytes() const { return _row_count * _column_count * sizeof(float); }
+}
+}
+}
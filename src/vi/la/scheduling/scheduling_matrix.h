@@ -0,0 +1,65 @@
+#ifndef __vinn__scheduling_matrix__
+#define __vinn__scheduling_matrix__
+
+#include <vi/la/matrix.h>
+#include <vi/la/matrix_implementation.h>
+#include <vi/la/scheduling/cost_model.h>
+
+#include <mutex>
+
+namespace vi {
+namespace la {
+
+class scheduling_context;
+
+namespace scheduling {
+
+/// Matrix implementation for scheduling context. Values are kept on the
+/// backends that last used them. Copies are made when an operation needs the
+/// values on a backend whose copy is stale. Copies are allocated and marked
+/// current under a lock, so operations may read the matrix from several threads.
+class matrix : public vi::la::matrix_implementation {
+public:
+  /// \param values current values on a backend of the context
+  matrix(scheduling_context& context, backend where, const vi::la::matrix& values);
+
+  virtual size_t row_count() const;
+  virtual size_t column_count() const;
+
+  virtual vi::la::context& owning_context() const;
+
+  /// The values may be written through the pointer, so the device copy becomes stale
+  virtual float* raw_data();
+  /// Reading the values on the host leaves the device copy current
+  virtual const float* read_only_data();
+
+  /// \return values on the backend, copied there if its copy is stale
+  const vi::la::matrix& read(backend where);
+  /// \return copy on the backend to overwrite, every other copy becomes stale
+  vi::la::matrix& write(backend where);
+
+  bool current_on(backend where) const;
+  size_t size_in_bytes() const;
+
+private:
+  /// \param copy_seconds set to the time taken to copy the values, left alone if current
+  const vi::la::matrix& read_locked(backend where, double& copy_seconds);
+  /// Report a copy to the context unless copy_seconds is negative, called without the
+  /// copies lock held
+  void record_copy(double copy_seconds);
+  vi::la::matrix& write_locked(backend where);
+
+  scheduling_context& _context;
+  size_t _row_count;
+  size_t _column_count;
+  /// Guards the copies being allocated and which of them are current
+  mutable std::mutex _copies_mutex;
+  vi::la::matrix _copies[2];
+  bool _allocated[2];
+  bool _current[2];
+};
+}
+}
+}
+
+#endif
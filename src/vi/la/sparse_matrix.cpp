@@ -0,0 +1,145 @@
+#include "vi/la/sparse_matrix.h"
+
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace vi {
+namespace la {
+
+/// Copies of every context that used the matrix, made and looked up under the lock
+struct sparse_matrix::device_copies {
+  std::mutex mutex;
+  std::vector<std::pair<uint64_t, std::unique_ptr<device_copy>>> copies;
+};
+
+sparse_matrix::device_copy::~device_copy() {}
+
+sparse_matrix::sparse_matrix()
+    : _row_count(0U), _column_count(0U), _row_offsets(1U, 0U),
+      _device_copies(std::make_shared<device_copies>()) {}
+
+sparse_matrix::sparse_matrix(size_t row_count, size_t column_count,
+                             std::vector<size_t> row_offsets,
+                             std::vector<uint32_t> column_indices, std::vector<float> values)
+    : _row_count(row_count), _column_count(column_count), _row_offsets(std::move(row_offsets)),
+      _column_indices(std::move(column_indices)), _values(std::move(values)),
+      _device_copies(std::make_shared<device_copies>()) {
+  if (_row_offsets.size() != _row_count + 1U || _row_offsets.front() != 0U ||
+      _row_offsets.back() != _values.size() || _column_indices.size() != _values.size()) {
+    throw incompatible_dimensions("Row offsets do not describe " + std::to_string(_row_count) +
+                                  " rows of " + std::to_string(_values.size()) + " values.");
+  }
+  for (size_t m = 0U; m < _row_count; ++m) {
+    if (_row_offsets[m] > _row_offsets[m + 1U]) {
+      throw incompatible_dimensions("Row offsets must not decrease.");
+    }
+  }
+  for (uint32_t column : _column_indices) {
+    if (column >= _column_count) {
+      throw incompatible_dimensions("Column index " + std::to_string(column) +
+                                    " out of range for " + std::to_string(_column_count) +
+                                    " columns.");
+    }
+  }
+}
+
+size_t sparse_matrix::row_count() const { return _row_count; }
+
+size_t sparse_matrix::column_count() const { return _column_count; }
+
+size_t sparse_matrix::non_zero_count() const { return _values.size(); }
+
+size_t sparse_matrix::stored_bytes() const {
+  return _values.size() * sizeof(float) + _column_indices.size() * sizeof(uint32_t) +
+         _row_offsets.size() * sizeof(size_t);
+}
+
+const std::vector<size_t>& sparse_matrix::row_offsets() const { return _row_offsets; }
+
+const std::vector<uint32_t>& sparse_matrix::column_indices() const { return _column_indices; }
+
+const std::vector<float>& sparse_matrix::values() const { return _values; }
+
+matrix sparse_matrix::operator*(const matrix& other) const {
+  if (_column_count != other.row_count()) {
+    throw incompatible_dimensions("Sparse matrix has " + std::to_string(_column_count) +
+                                  " columns, operand has " + std::to_string(other.row_count()) +
+                                  " rows.");
+  }
+  const float* uninitialized = nullptr;
+  matrix product(other.owning_context(), uninitialized, _row_count, other.column_count());
+  other.owning_context().multiply(product, *this, other);
+  return product;
+}
+
+matrix sparse_matrix::transpose_multiply(const matrix& other) const {
+  if (_row_count != other.row_count()) {
+    throw incompatible_dimensions("Sparse matrix has " + std::to_string(_row_count) +
+                                  " rows, operand has " + std::to_string(other.row_count()) +
+                                  " rows.");
+  }
+  const float* uninitialized = nullptr;
+  matrix product(other.owning_context(), uninitialized, _column_count, other.column_count());
+  other.owning_context().transpose_multiply(product, *this, other);
+  return product;
+}
+
+sparse_matrix sparse_matrix::transpose() const {
+  if (_row_count > UINT32_MAX) {
+    throw incompatible_dimensions("Rows of a sparse matrix with " + std::to_string(_row_count) +
+                                  " rows cannot be stored as column indices.");
+  }
+
+  // counting sort of the entries by column keeps rows sorted within every column
+  std::vector<size_t> offsets(_column_count + 1U, 0U);
+  for (uint32_t column : _column_indices) {
+    ++offsets[column + 1U];
+  }
+  for (size_t n = 0U; n < _column_count; ++n) {
+    offsets[n + 1U] += offsets[n];
+  }
+
+  std::vector<size_t> next(offsets.begin(), offsets.end() - 1);
+  std::vector<uint32_t> rows(_values.size());
+  std::vector<float> values(_values.size());
+  for (size_t m = 0U; m < _row_count; ++m) {
+    for (size_t i = _row_offsets[m]; i < _row_offsets[m + 1U]; ++i) {
+      const size_t position = next[_column_indices[i]]++;
+      rows[position] = static_cast<uint32_t>(m);
+      values[position] = _values[i];
+    }
+  }
+  return sparse_matrix(_column_count, _row_count, std::move(offsets), std::move(rows),
+                       std::move(values));
+}
+
+matrix sparse_matrix::to_dense(context& context) const {
+  matrix dense(context, _row_count, _column_count, 0.0f);
+  for (size_t m = 0U; m < _row_count; ++m) {
+    float* row = dense[m];
+    for (size_t i = _row_offsets[m]; i < _row_offsets[m + 1U]; ++i) {
+      row[_column_indices[i]] = _values[i];
+    }
+  }
+  return dense;
+}
+
+size_t sparse_matrix::device_copy_count() const {
+  std::lock_guard<std::mutex> lock(_device_copies->mutex);
+  return _device_copies->copies.size();
+}
+
+const sparse_matrix::device_copy&
+sparse_matrix::device_copy_for(uint64_t owner, const device_copy_factory& create) const {
+  std::lock_guard<std::mutex> lock(_device_copies->mutex);
+  for (const auto& copy : _device_copies->copies) {
+    if (copy.first == owner) {
+      return *copy.second;
+    }
+  }
+  _device_copies->copies.emplace_back(owner, create());
+  return *_device_copies->copies.back().second;
+}
+}
+}
@@ -0,0 +1,82 @@
+#ifndef __vinn__sparse_matrix__
+#define __vinn__sparse_matrix__
+
+#include <vi/la/matrix.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace vi {
+namespace la {
+
+/// Host resident matrix in compressed sparse row (CSR) format.
+/// Non-zero values of row m are values()[row_offsets()[m]] up to
+/// values()[row_offsets()[m + 1]], with their columns in column_indices().
+/// The values never change, so contexts may keep copies of them on their devices.
+class sparse_matrix {
+public:
+  /// Values kept on a device by a context, see device_copy_for
+  class device_copy {
+  public:
+    virtual ~device_copy();
+  };
+  typedef std::function<std::unique_ptr<device_copy>()> device_copy_factory;
+
+  sparse_matrix();
+
+  /// \throw incompatible_dimensions if the offsets do not describe row_count rows
+  ///        of the given values or a column index is out of range
+  sparse_matrix(size_t row_count, size_t column_count, std::vector<size_t> row_offsets,
+                std::vector<uint32_t> column_indices, std::vector<float> values);
+
+  size_t row_count() const;
+  size_t column_count() const;
+  size_t non_zero_count() const;
+  /// Bytes of the values, column indices and row offsets
+  size_t stored_bytes() const;
+
+  const std::vector<size_t>& row_offsets() const;
+  const std::vector<uint32_t>& column_indices() const;
+  const std::vector<float>& values() const;
+
+  /// Sparse times dense product in the context of other
+  /// \throw incompatible_dimensions if the column count does not match the rows of other
+  matrix operator*(const matrix& other) const;
+
+  /// Product of the transpose with other without forming the transpose,
+  /// used to compute weight gradients for sparse inputs
+  /// \throw incompatible_dimensions if the row counts do not match
+  matrix transpose_multiply(const matrix& other) const;
+
+  /// Transpose in CSR format, which is the compressed sparse column (CSC)
+  /// format of this matrix
+  sparse_matrix transpose() const;
+
+  /// Expand into a dense matrix with zeros for the missing values
+  matrix to_dense(context& context) const;
+
+  /// \param owner identifies the context, never reused by another one
+  /// \param create makes the copy on first use, called at most once per owner
+  /// \return copy kept for the owner, shared by copies of this matrix and released
+  ///         with the last of them
+  const device_copy& device_copy_for(uint64_t owner, const device_copy_factory& create) const;
+  /// \return number of contexts that keep a copy of the values
+  size_t device_copy_count() const;
+
+private:
+  struct device_copies;
+
+
+  size_t _row_count;
+  size_t _column_count;
+  std::vector<size_t> _row_offsets;
+  std::vector<uint32_t> _column_indices;
+  std::vector<float> _values;
+  std::shared_ptr<device_copies> _device_copies;
+};
+}
+}
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef __vinn__thread_cache__
+#define __vinn__thread_cache__
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace vi {
+namespace la {
+
+/// A value per thread that uses the cache. Threads find their value in thread
+/// local storage by the identifier of the cache, which is never reused, so
+/// that looking it up takes no lock. Values are owned by the cache: they are
+/// destroyed when their thread exits or when the cache is destroyed, whichever
+/// comes first.
+template <typename T> class thread_cache {
+public:
+  thread_cache() : _state(std::make_shared<state>()), _id(next_id()) {}
+  thread_cache(const thread_cache&) = delete;
+  thread_cache& operator=(const thread_cache&) = delete;
+
+  /// Destroy the values of every thread, no thread may use the cache any more
+  ~thread_cache() {
+    std::lock_guard<std::mutex> lock(_state->mutex);
+    _state->alive = false;
+    _state->values.clear();
+  }
+
+  /// \param create returns a std::unique_ptr<T>, called on the first access of a thread
+  /// \return value of the calling thread
+  template <typename Create> T& local(const Create& create) const {
+    thread_entries& entries = local_entries();
+    for (const entry& cached : entries.cached) {
+      if (cached.id == _id) {
+        return *cached.value;
+      }
+    }
+
+    // entries of destroyed caches are dropped, their values are gone already
+    entries.cached.erase(std::remove_if(entries.cached.begin(), entries.cached.end(),
+                                        [](const entry& cached) { return cached.owner.expired(); }),
+                         entries.cached.end());
+    std::unique_ptr<T> value = create();
+    entry created;
+    created.id = _id;
+    created.owner = _state;
+    created.value = value.get();
+    {
+      std::lock_guard<std::mutex> lock(_state->mutex);
+      created.position = _state->values.insert(_state->values.end(), std::move(value));
+    }
+    entries.cached.push_back(created);
+    return *created.value;
+  }
+
+private:
+  /// Values of all threads, shared with the threads so that they can release theirs
+  struct state {
+    state() : alive(true) {}
+
+    std::mutex mutex;
+    bool alive;
+    std::list<std::unique_ptr<T>> values;
+  };
+
+  struct entry {
+    uint64_t id;
+    std::weak_ptr<state> owner;
+    T* value;
+    typename std::list<std::unique_ptr<T>>::iterator position;
+  };
+
+  /// Entries of a thread, which release their values when the thread exits
+  struct thread_entries {
+    ~thread_entries() {
+      for (entry& released : cached) {
+        std::shared_ptr<state> owner = released.owner.lock();
+        if (!owner) {
+          continue;
+        }
+        std::lock_guard<std::mutex> lock(owner->mutex);
+        if (owner->alive) {
+          owner->values.erase(released.position);
+        }
+      }
+    }
+
+    std::vector<entry> cached;
+  };
+
+  static thread_entries& local_entries() {
+    thread_local thread_entries entries;
+    return entries;
+  }
+
+  static uint64_t next_id() {
+    static std::atomic<uint64_t> last_id(0U);
+    return ++last_id;
+  }
+
+  std::shared_ptr<state> _state;
+  /// Identifies the entries of this cache in every thread
+  uint64_t _id;
+};
+}
+}
+
+#endif
@@ -0,0 +1,121 @@
+#include "vi/la/tuning_profile.h"
+
+#include <boost/filesystem.hpp>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+const char* const header = "# vinn tuning profile 1";
+/// Bucket distance is compared within the same device and operation only
+const size_t no_bucket = static_cast<size_t>(-1);
+
+size_t distance(size_t bucket_1, size_t bucket_2) {
+  return bucket_1 > bucket_2 ? bucket_1 - bucket_2 : bucket_2 - bucket_1;
+}
+}
+
+namespace vi {
+namespace la {
+
+std::string tuning_profile::default_path() {
+  const char* path = std::getenv("VINN_TUNING_PROFILE");
+  if (path != nullptr) {
+    return path;
+  }
+  const char* cache_home = std::getenv("XDG_CACHE_HOME");
+  if (cache_home != nullptr && *cache_home != '\0') {
+    return (fs::path(cache_home) / "vinn" / "tuning_profile").string();
+  }
+  const char* home = std::getenv("HOME");
+  if (home != nullptr && *home != '\0') {
+    return (fs::path(home) / ".cache" / "vinn" / "tuning_profile").string();
+  }
+  return std::string();
+}
+
+std::shared_ptr<tuning_profile> tuning_profile::load(const std::string& path) {
+  std::shared_ptr<tuning_profile> profile = std::make_shared<tuning_profile>();
+  if (path.empty()) {
+    return profile;
+  }
+  std::ifstream file(path);
+  std::string line;
+  if (!std::getline(file, line) || line != header) {
+    return profile;
+  }
+
+  // device, operation, bucket and parameters separated by tabs, malformed lines are skipped
+  while (std::getline(file, line)) {
+    std::istringstream fields(line);
+    std::string device, operation, bucket;
+    parameters tuned;
+    if (std::getline(fields, device, '\t') && std::getline(fields, operation, '\t') &&
+        std::getline(fields, bucket, '\t') && fields >> tuned.block_size >> tuned.thread_grain >>
+                                                    tuned.workgroup_rows >>
+                                                    tuned.workgroup_columns) {
+      profile->set(device, operation, std::strtoul(bucket.c_str(), nullptr, 10), tuned);
+    }
+  }
+  return profile;
+}
+
+void tuning_profile::store(const std::string& path) const {
+  const fs::path parent = fs::path(path).parent_path();
+  boost::system::error_code error;
+  if (!parent.empty()) {
+    fs::create_directories(parent, error);
+  }
+  std::ofstream file(path, std::ios::out | std::ios::trunc);
+  file << header << '\n';
+  for (const auto& entry : _entries) {
+    const parameters& tuned = entry.second;
+    file << std::get<0>(entry.first) << '\t' << std::get<1>(entry.first) << '\t'
+         << std::get<2>(entry.first) << '\t' << tuned.block_size << ' ' << tuned.thread_grain
+         << ' ' << tuned.workgroup_rows << ' ' << tuned.workgroup_columns << '\n';
+  }
+  file.close();
+  if (!file) {
+    throw std::runtime_error("failed to write the tuning profile " + path);
+  }
+}
+
+size_t tuning_profile::bucket(size_t largest_dimension) {
+  size_t bucket = 0U;
+  while ((static_cast<size_t>(1U) << bucket) < largest_dimension) {
+    ++bucket;
+  }
+  return bucket;
+}
+
+void tuning_profile::set(const std::string& device, const std::string& operation, size_t bucket,
+                         const parameters& tuned) {
+  _entries[key(device, operation, bucket)] = tuned;
+}
+
+tuning_profile::parameters tuning_profile::find(const std::string& device,
+                                                const std::string& operation, size_t bucket,
+                                                const parameters& defaults) const {
+  // entries of a device and operation are adjacent, ordered by bucket
+  auto entry = _entries.lower_bound(key(device, operation, 0U));
+  size_t nearest = no_bucket;
+  const parameters* found = &defaults;
+  for (; entry != _entries.end() && std::get<0>(entry->first) == device &&
+         std::get<1>(entry->first) == operation;
+       ++entry) {
+    const size_t tuned_bucket = std::get<2>(entry->first);
+    if (nearest == no_bucket || distance(tuned_bucket, bucket) < distance(nearest, bucket)) {
+      nearest = tuned_bucket;
+      found = &entry->second;
+    }
+  }
+  return *found;
+}
+
+size_t tuning_profile::size() const { return _entries.size(); }
+}
+}
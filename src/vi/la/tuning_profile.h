@@ -0,0 +1,57 @@
+#ifndef __vinn__tuning_profile__
+#define __vinn__tuning_profile__
+
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+
+namespace vi {
+namespace la {
+
+/// Parameters of the operations tuned for the devices of a machine, written by
+/// the vinn_autotune tool and attached to contexts with context::set_tuning_profile.
+/// Parameters are stored per device, operation and shape bucket, operations on
+/// shapes that were not tuned use the nearest tuned bucket.
+class tuning_profile {
+public:
+  struct parameters {
+    /// Edge of the blocks host products are computed in, zero computes whole rows
+    size_t block_size;
+    /// Multiply-adds a host thread is started for at least, zero uses the calling thread
+    size_t thread_grain;
+    /// Local work size of device kernels, zero lets the driver choose
+    size_t workgroup_rows;
+    size_t workgroup_columns;
+  };
+
+  /// $VINN_TUNING_PROFILE if set, otherwise vinn/tuning_profile under
+  /// $XDG_CACHE_HOME or $HOME/.cache. Empty if none of the variables are set.
+  static std::string default_path();
+
+  /// \return profile stored at path, empty if it does not exist or can not be read
+  static std::shared_ptr<tuning_profile> load(const std::string& path);
+  /// \throw std::runtime_error if the profile can not be written
+  void store(const std::string& path) const;
+
+  /// \return bucket of operations whose largest matrix dimension is the given one,
+  ///         the base 2 logarithm rounded up
+  static size_t bucket(size_t largest_dimension);
+
+  void set(const std::string& device, const std::string& operation, size_t bucket,
+           const parameters& tuned);
+  /// \return parameters of the nearest tuned bucket, defaults if the operation was
+  ///         not tuned on the device
+  parameters find(const std::string& device, const std::string& operation, size_t bucket,
+                  const parameters& defaults) const;
+
+  size_t size() const;
+
+private:
+  typedef std::tuple<std::string, std::string, size_t> key;
+  std::map<key, parameters> _entries;
+};
+}
+}
+
+#endif
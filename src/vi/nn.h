@@ -3,12 +3,22 @@
 
 #include <vi/nn/activation_function.h>
 #include <vi/nn/batch_gradient_descent.h>
+#include <vi/nn/batching_queue.h>
 #include <vi/nn/confusion_table.h>
 #include <vi/nn/cost_function.h>
+#include <vi/nn/epoch_recorder.h>
+#include <vi/nn/dataset.h>
+#include <vi/nn/evaluator.h>
+#include <vi/nn/host_activation.h>
+#include <vi/nn/inference_plan.h>
 #include <vi/nn/label_map.h>
 #include <vi/nn/layer.h>
+#include <vi/nn/loss_scaler.h>
 #include <vi/nn/minibatch_gradient_descent.h>
+#include <vi/nn/minibatch_stream.h>
 #include <vi/nn/network.h>
+#include <vi/nn/quantized_network.h>
+#include <vi/nn/quantizer.h>
 #include <vi/nn/l2_regularizer.h>
 #include <vi/nn/result_measurements.h>
 #include <vi/nn/running_average.h>
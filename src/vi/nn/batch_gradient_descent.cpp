@@ -1,7 +1,9 @@
 #include "vi/nn/batch_gradient_descent.h"
 #include "vi/nn/cost_function.h"
+#include "vi/nn/epoch_recorder.h"
 #include "vi/nn/layer.h"
 #include "vi/nn/l2_regularizer.h"
+#include "vi/nn/loss_scaler.h"
 #include <cassert>
 #include <algorithm>
 #include <iostream>
@@ -34,17 +36,30 @@ float batch_gradient_descent::train(vi::nn::network& network, const vi::la::matr
                                     const vi::nn::l2_regularizer* regularizer) {
   float cost(std::numeric_limits<float>::max());
   const size_t example_count = features.row_count();
+  epoch_recorder recorder(_telemetry, &features.owning_context());
 
   for (size_t epoch = 1U; epoch <= _max_epoch_count; ++epoch) {
+    recorder.start(epoch);
+    const float loss_scale = _loss_scaler ? _loss_scaler->scale() : 1.0f;
+    const epoch_recorder::clock::time_point pass_start = recorder.now();
+    double forward_seconds = 0.0;
     std::pair<float, std::vector<vi::la::matrix>> cost_and_gradients =
-        network.backward(features, targets, cost_function);
+        network.backward(features, targets, cost_function, loss_scale,
+                         recorder.active() ? &forward_seconds : nullptr);
+    recorder.add(&epoch_statistics::forward_seconds, forward_seconds);
+    recorder.add(&epoch_statistics::backward_seconds,
+                 recorder.seconds_since(pass_start) - forward_seconds);
+    const epoch_recorder::clock::time_point update_start = recorder.now();
 
     cost = cost_and_gradients.first / example_count;
     std::vector<vi::la::matrix>& gradients = cost_and_gradients.second;
 
+    // skip the update if scaled gradients overflowed
+    const bool apply_gradients = !_loss_scaler || _loss_scaler->update(gradients);
+
     size_t layer_index = 0U;
     for (std::shared_ptr<layer> l : network) {
-      vi::la::matrix gradient = gradients[layer_index] / example_count;
+      vi::la::matrix gradient = gradients[layer_index] / (example_count * loss_scale);
 
       if (regularizer) {
         std::pair<float, vi::la::matrix> cost_and_gradient_penalty =
@@ -53,11 +68,15 @@ float batch_gradient_descent::train(vi::nn::network& network, const vi::la::matr
         gradient = gradient + (cost_and_gradient_penalty.second / example_count);
       }
 
-      vi::la::matrix new_weights = l->weights() - (gradient * _learning_rate);
-      l->weights(new_weights);
+      if (apply_gradients) {
+        vi::la::matrix new_weights = l->weights() - (gradient * _learning_rate);
+        l->weights(new_weights);
+      }
 
       ++layer_index;
     }
+    recorder.add(&epoch_statistics::update_seconds, recorder.seconds_since(update_start));
+    recorder.finish(cost, example_count);
 
     if (_stop_early && _stop_early(network, epoch, cost)) {
       break;
@@ -0,0 +1,125 @@
+#include "vi/nn/batching_queue.h"
+#include "vi/la/matrix.h"
+#include "vi/nn/network.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <iterator>
+#include <string>
+
+namespace {
+
+vi::la::context& network_context(const vi::nn::network& network) {
+  if (network.begin() == network.end()) {
+    throw vi::nn::invalid_configuration("Network has no layers to evaluate.");
+  }
+  return (*network.begin())->context();
+}
+}
+
+namespace vi {
+namespace nn {
+
+batching_queue::batching_queue(const network& network, size_t max_batch_size,
+                               std::chrono::microseconds max_wait)
+    : _network(network), _context(network_context(network)),
+      _input_count((*network.begin())->input_count()),
+      _output_count((*std::prev(network.end()))->output_count()), _max_batch_size(max_batch_size),
+      _max_wait(max_wait), _stopping(false), _worker(&batching_queue::run, this) {
+  assert(_max_batch_size > 0U);
+}
+
+batching_queue::~batching_queue() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stopping = true;
+  }
+  _queued.notify_all();
+  _worker.join();
+}
+
+std::future<std::vector<float>> batching_queue::submit(const std::vector<float>& features) {
+  if (features.size() != _input_count) {
+    throw vi::la::incompatible_dimensions("Request has " + std::to_string(features.size()) +
+                                          " features, the network expects " +
+                                          std::to_string(_input_count) + ".");
+  }
+
+  request queued;
+  queued.features = features;
+  queued.arrival = clock::now();
+  std::future<std::vector<float>> result = queued.result.get_future();
+
+  bool wake_worker = false;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _requests.push_back(std::move(queued));
+    // the worker only needs waking for the first request or a full batch
+    wake_worker = _requests.size() == 1U || _requests.size() >= _max_batch_size;
+  }
+  if (wake_worker) {
+    _queued.notify_one();
+  }
+  return result;
+}
+
+void batching_queue::run() {
+  std::vector<request> batch;
+  batch.reserve(_max_batch_size);
+
+  std::unique_lock<std::mutex> lock(_mutex);
+  while (true) {
+    _queued.wait(lock, [this]() { return _stopping || !_requests.empty(); });
+    if (_requests.empty()) {
+      return;
+    }
+
+    // hold the batch open until it is full or its oldest request is due
+    const clock::time_point deadline = _requests.front().arrival + _max_wait;
+    _queued.wait_until(lock, deadline,
+                       [this]() { return _stopping || _requests.size() >= _max_batch_size; });
+
+    const size_t batch_size = std::min(_max_batch_size, _requests.size());
+    for (size_t i = 0U; i < batch_size; ++i) {
+      batch.push_back(std::move(_requests.front()));
+      _requests.pop_front();
+    }
+
+    lock.unlock();
+    evaluate(batch);
+    batch.clear();
+    lock.lock();
+  }
+}
+
+void batching_queue::evaluate(std::vector<request>& batch) {
+  vi::la::matrix predictions;
+  try {
+    vi::la::matrix features(_context, batch.size(), _input_count);
+    for (size_t r = 0U; r < batch.size(); ++r) {
+      std::memcpy(features[r], batch[r].features.data(), _input_count * sizeof(float));
+    }
+    predictions = _network.forward(features);
+  } catch (...) {
+    for (request& failed : batch) {
+      failed.result.set_exception(std::current_exception());
+    }
+    return;
+  }
+
+  for (size_t r = 0U; r < batch.size(); ++r) {
+    const float* row = predictions[r];
+    batch[r].result.set_value(std::vector<float>(row, row + _output_count));
+  }
+}
+
+size_t batching_queue::input_count() const { return _input_count; }
+
+size_t batching_queue::output_count() const { return _output_count; }
+
+size_t batching_queue::max_batch_size() const { return _max_batch_size; }
+
+std::chrono::microseconds batching_queue::max_wait() const { return _max_wait; }
+}
+}
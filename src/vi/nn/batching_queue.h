@@ -0,0 +1,78 @@
+#ifndef __vinn__batching_queue__
+#define __vinn__batching_queue__
+
+#include <vi/la/context.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vi {
+namespace nn {
+
+class network;
+
+/// Coalesces independent single example requests into batched forward passes.
+/// A worker thread waits until max_batch_size requests are queued or the oldest
+/// request has waited max_wait, stacks the queued examples into one matrix, runs
+/// a single forward pass and delivers each row of the predictions through the
+/// future returned for its request.
+class batching_queue {
+public:
+  /// \param network trained network, must outlive the queue and not be modified while in use
+  /// \param max_batch_size largest number of requests evaluated in one forward pass
+  /// \param max_wait longest time a request is held back waiting for others to batch with
+  /// \throw invalid_configuration if the network has no layers
+  batching_queue(const network& network, size_t max_batch_size = 32U,
+                 std::chrono::microseconds max_wait = std::chrono::microseconds(1000));
+
+  /// Pending requests are evaluated before the worker thread stops
+  ~batching_queue();
+
+  batching_queue(const batching_queue&) = delete;
+  batching_queue& operator=(const batching_queue&) = delete;
+
+  /// Queue a single example for evaluation
+  /// \param features input vector with input_count() values
+  /// \return future output vector, carries the exception if the forward pass fails
+  /// \throw incompatible_dimensions if the number of features is not input_count()
+  std::future<std::vector<float>> submit(const std::vector<float>& features);
+
+  size_t input_count() const;
+  size_t output_count() const;
+  size_t max_batch_size() const;
+  std::chrono::microseconds max_wait() const;
+
+private:
+  typedef std::chrono::steady_clock clock;
+
+  struct request {
+    std::vector<float> features;
+    std::promise<std::vector<float>> result;
+    clock::time_point arrival;
+  };
+
+  void run();
+  void evaluate(std::vector<request>& batch);
+
+  const network& _network;
+  vi::la::context& _context;
+  size_t _input_count;
+  size_t _output_count;
+  size_t _max_batch_size;
+  std::chrono::microseconds _max_wait;
+
+  std::mutex _mutex;
+  std::condition_variable _queued;
+  std::deque<request> _requests;
+  bool _stopping;
+  std::thread _worker;
+};
+}
+}
+
+#endif
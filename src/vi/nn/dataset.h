@@ -0,0 +1,30 @@
+#ifndef __vinn__dataset__
+#define __vinn__dataset__
+
+#include <cstddef>
+
+namespace vi {
+namespace nn {
+
+/// Source of training examples that is read sequentially, so that datasets
+/// larger than memory can be streamed from disk
+class dataset {
+public:
+  virtual ~dataset() {}
+
+  virtual size_t feature_count() const = 0;
+  virtual size_t target_count() const = 0;
+
+  /// Continue from the first example
+  virtual void rewind() = 0;
+
+  /// Read the next examples into row-major buffers
+  /// \param features room for max_rows * feature_count() values
+  /// \param targets room for max_rows * target_count() values
+  /// \return number of examples read, 0 once every example has been read
+  virtual size_t read(float* features, float* targets, size_t max_rows) = 0;
+};
+}
+}
+
+#endif
@@ -0,0 +1,68 @@
+#include "vi/nn/epoch_recorder.h"
+
+namespace vi {
+namespace nn {
+
+epoch_recorder::epoch_recorder(std::shared_ptr<training_telemetry> telemetry,
+                               const vi::la::context* context)
+    : _telemetry(telemetry), _context(context) {
+  if (active()) {
+    _parts = std::make_shared<parts_telemetry>(*this);
+    _allocations.reset(new vi::la::allocation_tracker());
+  }
+}
+
+void epoch_recorder::start(size_t epoch) {
+  if (!active()) {
+    return;
+  }
+  _current = epoch_statistics();
+  _current.epoch = epoch;
+  _allocations->restart();
+  _transfers = _context ? _context->transfers() : vi::la::transfer_statistics{0U, 0U};
+  _start = clock::now();
+}
+
+void epoch_recorder::finish(float cost, size_t example_count) {
+  if (!active()) {
+    return;
+  }
+  _current.seconds = seconds_since(_start);
+  _current.cost = cost;
+  _current.example_count = example_count;
+  _current.examples_per_second = _current.seconds > 0.0 ? example_count / _current.seconds : 0.0;
+
+  const vi::la::allocation_statistics allocations = _allocations->statistics();
+  _current.allocation_count = allocations.allocation_count;
+  _current.peak_matrix_bytes = allocations.peak_bytes;
+  if (_context) {
+    const vi::la::transfer_statistics transfers = _context->transfers();
+    _current.bytes_to_device = transfers.bytes_to_device - _transfers.bytes_to_device;
+    _current.bytes_to_host = transfers.bytes_to_host - _transfers.bytes_to_host;
+  }
+  (*_telemetry)(_current);
+}
+
+double epoch_recorder::seconds_since(clock::time_point start) const {
+  if (!active()) {
+    return 0.0;
+  }
+  return std::chrono::duration<double>(clock::now() - start).count();
+}
+
+void epoch_recorder::add(double epoch_statistics::*part, double seconds) {
+  if (active()) {
+    _current.*part += seconds;
+  }
+}
+
+std::shared_ptr<training_telemetry> epoch_recorder::parts() { return _parts; }
+
+void epoch_recorder::parts_telemetry::operator()(const vi::nn::epoch_statistics& statistics) {
+  _recorder.add(&epoch_statistics::preparation_seconds, statistics.preparation_seconds);
+  _recorder.add(&epoch_statistics::forward_seconds, statistics.forward_seconds);
+  _recorder.add(&epoch_statistics::backward_seconds, statistics.backward_seconds);
+  _recorder.add(&epoch_statistics::update_seconds, statistics.update_seconds);
+}
+}
+}
@@ -0,0 +1,64 @@
+#ifndef __vinn__epoch_recorder__
+#define __vinn__epoch_recorder__
+
+#include <vi/la/context.h>
+#include <vi/la/matrix_implementation.h>
+#include <vi/nn/trainer.h>
+
+#include <chrono>
+#include <memory>
+
+namespace vi {
+namespace nn {
+
+/// Measures the epochs of a trainer for its telemetry. Without telemetry nothing
+/// is measured, not even the time.
+class epoch_recorder {
+public:
+  typedef std::chrono::steady_clock clock;
+
+  /// \param context context of the trained network whose copies are counted,
+  ///        nullptr counts none
+  epoch_recorder(std::shared_ptr<training_telemetry> telemetry, const vi::la::context* context);
+
+  bool active() const { return _telemetry != nullptr; }
+
+  void start(size_t epoch);
+  /// Report the epoch started last
+  void finish(float cost, size_t example_count);
+
+  /// \return current time while recording, otherwise the epoch of the clock
+  clock::time_point now() const { return active() ? clock::now() : clock::time_point(); }
+  double seconds_since(clock::time_point start) const;
+
+  /// Add seconds to a part of the current epoch
+  void add(double epoch_statistics::*part, double seconds);
+
+  /// \return telemetry adding the parts of the epochs of another trainer to the
+  ///         current epoch, nullptr while not recording
+  std::shared_ptr<training_telemetry> parts();
+
+private:
+  class parts_telemetry : public training_telemetry {
+  public:
+    parts_telemetry(epoch_recorder& recorder) : _recorder(recorder) {}
+    void operator()(const vi::nn::epoch_statistics& statistics);
+
+  private:
+    epoch_recorder& _recorder;
+  };
+
+  std::shared_ptr<training_telemetry> _telemetry;
+  const vi::la::context* _context;
+  std::shared_ptr<parts_telemetry> _parts;
+  /// Allocations of the current epoch, only while recording
+  std::unique_ptr<vi::la::allocation_tracker> _allocations;
+
+  epoch_statistics _current;
+  clock::time_point _start;
+  vi::la::transfer_statistics _transfers;
+};
+}
+}
+
+#endif
@@ -0,0 +1,156 @@
+#include "vi/nn/evaluator.h"
+#include "vi/nn/network.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <thread>
+
+namespace {
+
+vi::la::context& network_context(const vi::nn::network& network) {
+  if (network.begin() == network.end()) {
+    throw vi::nn::invalid_configuration("Network has no layers to evaluate.");
+  }
+  return (*network.begin())->context();
+}
+
+/// Examples held in a feature and a label matrix
+class matrix_dataset : public vi::nn::dataset {
+public:
+  matrix_dataset(const vi::la::matrix& features, const vi::la::matrix& labels)
+      : _features(features), _labels(labels), _row(0U) {}
+
+  size_t feature_count() const { return _features.column_count(); }
+  size_t target_count() const { return _labels.column_count(); }
+
+  void rewind() { _row = 0U; }
+
+  size_t read(float* features, float* targets, size_t max_rows) {
+    const size_t row_count = std::min(max_rows, _features.row_count() - _row);
+    if (row_count != 0U) {
+      std::memcpy(features, _features[_row], row_count * feature_count() * sizeof(float));
+      std::memcpy(targets, _labels[_row], row_count * target_count() * sizeof(float));
+      _row += row_count;
+    }
+    return row_count;
+  }
+
+private:
+  const vi::la::matrix& _features;
+  const vi::la::matrix& _labels;
+  size_t _row;
+};
+}
+
+namespace vi {
+namespace nn {
+
+evaluator::evaluator(const network& network, const label_map& labels, size_t batch_size,
+                     size_t thread_count)
+    : _network(network), _context(network_context(network)), _labels(labels.labels()),
+      _batch_size(std::max<size_t>(batch_size, 1U)),
+      _thread_count(thread_count != 0U
+                        ? thread_count
+                        : std::max<size_t>(1U, std::thread::hardware_concurrency())) {
+  if ((*std::prev(network.end()))->output_count() != _labels.size()) {
+    throw invalid_configuration("Network has " +
+                                std::to_string((*std::prev(network.end()))->output_count()) +
+                                " outputs for " + std::to_string(_labels.size()) + " labels.");
+  }
+}
+
+result_measurements evaluator::evaluate(dataset& examples) const {
+  const size_t input_count = (*_network.begin())->input_count();
+  if (examples.feature_count() != input_count) {
+    throw invalid_configuration("Dataset has " + std::to_string(examples.feature_count()) +
+                                " features, the network expects " +
+                                std::to_string(input_count) + ".");
+  }
+  if (examples.target_count() != 1U && examples.target_count() != _labels.size()) {
+    throw invalid_configuration("Dataset targets must be a label or an activation per label.");
+  }
+
+  result_measurements measurements(_context, _labels);
+  pass state = {examples, measurements, {}, {}};
+  std::vector<std::vector<uint64_t>> counts(_thread_count,
+                                            std::vector<uint64_t>(_labels.size() * _labels.size()));
+  std::vector<std::thread> workers;
+  for (size_t i = 1U; i < _thread_count; ++i) {
+    workers.push_back(
+        std::thread(&evaluator::evaluate_batches, this, std::ref(state), std::ref(counts[i])));
+  }
+  evaluate_batches(state, counts[0]);
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+  if (state.error) {
+    std::rethrow_exception(state.error);
+  }
+
+  for (const std::vector<uint64_t>& thread_counts : counts) {
+    measurements.add_counts(thread_counts);
+  }
+  return measurements;
+}
+
+result_measurements evaluator::evaluate(const vi::la::matrix& features,
+                                        const vi::la::matrix& labels) const {
+  if (features.row_count() != labels.row_count()) {
+    throw vi::la::incompatible_dimensions(features, labels, "evaluate");
+  }
+  matrix_dataset examples(features, labels);
+  return evaluate(examples);
+}
+
+void evaluator::evaluate_batches(pass& state, std::vector<uint64_t>& counts) const {
+  const size_t feature_count = state.examples.feature_count();
+  const size_t target_count = state.examples.target_count();
+  const size_t label_count = _labels.size();
+  std::vector<float> features(_batch_size * feature_count);
+  std::vector<float> targets(_batch_size * target_count);
+
+  try {
+    while (true) {
+      size_t row_count = 0U;
+      {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (state.error) {
+          return;
+        }
+        row_count = state.examples.read(features.data(), targets.data(), _batch_size);
+      }
+      if (row_count == 0U) {
+        return;
+      }
+
+      const vi::la::matrix batch(_context, features.data(), row_count, feature_count);
+      vi::la::matrix actual(_context, row_count, 1U);
+      _context.row_argmax(actual, _network.forward(batch));
+      vi::la::matrix expected(_context, row_count, 1U);
+      if (target_count == 1U) {
+        for (size_t row = 0U; row < row_count; ++row) {
+          expected[row][0] = static_cast<float>(
+              state.measurements.label_index_for_label(static_cast<int>(targets[row])));
+        }
+      } else {
+        _context.row_argmax(expected,
+                            vi::la::matrix(_context, targets.data(), row_count, target_count));
+      }
+
+      for (size_t row = 0U; row < row_count; ++row) {
+        ++counts[static_cast<size_t>(expected[row][0]) * label_count +
+                 static_cast<size_t>(actual[row][0])];
+      }
+    }
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (!state.error) {
+      state.error = std::current_exception();
+    }
+  }
+}
+}
+}
@@ -0,0 +1,63 @@
+#ifndef __vinn__evaluator__
+#define __vinn__evaluator__
+
+#include <vi/la/matrix.h>
+#include <vi/nn/dataset.h>
+#include <vi/nn/label_map.h>
+#include <vi/nn/result_measurements.h>
+
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <vector>
+
+namespace vi {
+namespace nn {
+
+class network;
+
+/// Measures classification results of a network on test sets too large to
+/// forward at once. Worker threads take turns reading batches from a
+/// dataset, forward them concurrently and count the most active output unit
+/// of every row against its expected label in their own confusion matrix.
+/// The confusion matrices are merged once every example has been read, so
+/// memory use only depends on the batch size and the number of threads.
+class evaluator {
+public:
+  /// \param network trained network, must outlive the evaluator and not be modified while in use
+  /// \param labels maps output units of the network to labels
+  /// \param thread_count threads forwarding batches, 0 uses one per core
+  /// \throw invalid_configuration if the network has no layers or its output
+  ///        count does not match the number of labels
+  evaluator(const network& network, const label_map& labels, size_t batch_size = 1024U,
+            size_t thread_count = 0U);
+
+  /// Evaluate every remaining example of a dataset. Targets are either a
+  /// single column of labels or an activation for every label.
+  /// \throw invalid_configuration if the dataset does not match the network
+  result_measurements evaluate(dataset& examples) const;
+
+  /// \param labels column of expected labels for every row of features
+  /// \throw vi::la::incompatible_dimensions if the row counts differ
+  result_measurements evaluate(const vi::la::matrix& features, const vi::la::matrix& labels) const;
+
+private:
+  struct pass {
+    dataset& examples;
+    const result_measurements& measurements;
+    std::mutex mutex;
+    std::exception_ptr error;
+  };
+
+  void evaluate_batches(pass& state, std::vector<uint64_t>& counts) const;
+
+  const network& _network;
+  vi::la::context& _context;
+  std::vector<int> _labels;
+  size_t _batch_size;
+  size_t _thread_count;
+};
+}
+}
+
+#endif
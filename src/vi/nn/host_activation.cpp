@@ -0,0 +1,64 @@
+#include "vi/nn/host_activation.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <typeinfo>
+
+namespace vi {
+namespace nn {
+
+host_activation host_activation_for(const activation_function& activation) {
+  if (typeid(activation) == typeid(sigmoid_activation)) {
+    return host_activation::sigmoid;
+  } else if (typeid(activation) == typeid(hyperbolic_tangent)) {
+    return host_activation::hyperbolic_tangent;
+  } else if (typeid(activation) == typeid(linear_activation)) {
+    return host_activation::linear;
+  } else if (typeid(activation) == typeid(softmax_activation)) {
+    return host_activation::softmax;
+  }
+  return host_activation::unsupported;
+}
+
+bool is_elementwise(host_activation activation) {
+  return activation == host_activation::sigmoid ||
+         activation == host_activation::hyperbolic_tangent ||
+         activation == host_activation::linear;
+}
+
+float activate(float value, host_activation activation) {
+  assert(is_elementwise(activation));
+  switch (activation) {
+  case host_activation::sigmoid:
+    return 1.0f / (1.0f + ::expf(-value));
+  case host_activation::hyperbolic_tangent:
+    return std::tanh(value);
+  default:
+    break;
+  }
+  return value;
+}
+
+void activate_row(float* values, size_t count, host_activation activation) {
+  assert(activation != host_activation::unsupported);
+  if (activation == host_activation::softmax) {
+    // shifting by the maximum does not change the result but avoids overflow
+    const float maximum = *std::max_element(values, values + count);
+    float total(0.0f);
+    for (size_t i = 0U; i < count; ++i) {
+      values[i] = std::exp(values[i] - maximum);
+      total += values[i];
+    }
+    for (size_t i = 0U; i < count; ++i) {
+      values[i] /= total;
+    }
+    return;
+  }
+
+  for (size_t i = 0U; i < count; ++i) {
+    values[i] = activate(values[i], activation);
+  }
+}
+}
+}
@@ -0,0 +1,29 @@
+#ifndef __vinn__host_activation__
+#define __vinn__host_activation__
+
+#include <vi/nn/activation_function.h>
+
+#include <cstddef>
+
+namespace vi {
+namespace nn {
+
+/// Activation functions that inference paths can evaluate directly on host
+/// memory without going through a linear algebra context
+enum class host_activation { sigmoid, hyperbolic_tangent, linear, softmax, unsupported };
+
+/// \return host evaluated equivalent of the activation, unsupported for unknown types
+host_activation host_activation_for(const activation_function& activation);
+
+/// \return true if the activation can be applied one value at a time
+bool is_elementwise(host_activation activation);
+
+/// Apply an elementwise activation to a single value
+float activate(float value, host_activation activation);
+
+/// Apply a supported activation in place to a row of values
+void activate_row(float* values, size_t count, host_activation activation);
+}
+}
+
+#endif
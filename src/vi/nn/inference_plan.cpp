@@ -0,0 +1,147 @@
+#include "vi/nn/inference_plan.h"
+#include "vi/nn/layer.h"
+#include "vi/nn/network.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <string>
+
+namespace {
+
+float dot(const float* a, const float* b, size_t length) {
+  // independent partial sums let the compiler vectorize the loop
+  float sums[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  size_t i = 0U;
+  for (; i + 4U <= length; i += 4U) {
+    sums[0] += a[i] * b[i];
+    sums[1] += a[i + 1U] * b[i + 1U];
+    sums[2] += a[i + 2U] * b[i + 2U];
+    sums[3] += a[i + 3U] * b[i + 3U];
+  }
+  for (; i < length; ++i) {
+    sums[0] += a[i] * b[i];
+  }
+  return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+}
+
+/// outputs[r][o] = biases[o] + weights[o] . inputs[r], each weight row is reused for all rows
+void multiply(float* outputs, const float* inputs, const float* weights, const float* biases,
+              size_t row_count, size_t input_count, size_t output_count) {
+  for (size_t o = 0U; o < output_count; ++o) {
+    const float* weight_row = weights + o * input_count;
+    for (size_t r = 0U; r < row_count; ++r) {
+      outputs[r * output_count + o] =
+          biases[o] + dot(weight_row, inputs + r * input_count, input_count);
+    }
+  }
+}
+}
+
+namespace vi {
+namespace nn {
+
+inference_plan::inference_plan(const network& network, size_t max_batch_size)
+    : _max_batch_size(max_batch_size) {
+  assert(_max_batch_size > 0U);
+  assert(network.size() > 0U);
+
+  for (const std::shared_ptr<layer>& fp32_layer : network) {
+    planned_layer l;
+    l.input_count = fp32_layer->input_count();
+    l.output_count = fp32_layer->output_count();
+    l.weights.resize(l.output_count * l.input_count);
+    l.biases.resize(l.output_count);
+
+    // the first weight column is the bias, layer::forward merges a column of ones for it
+    const vi::la::matrix& weights = fp32_layer->weights();
+    for (size_t o = 0U; o < l.output_count; ++o) {
+      const float* row = weights[o];
+      l.biases[o] = row[0];
+      std::copy(row + 1U, row + 1U + l.input_count, &l.weights[o * l.input_count]);
+    }
+
+    l.activation = fp32_layer->activation();
+    l.host = host_activation_for(*l.activation);
+    _layers.push_back(l);
+  }
+
+  // buffers of the constructing thread are allocated up front
+  thread_scratch();
+}
+
+inference_plan::scratch& inference_plan::thread_scratch() const {
+  return _scratch.local([this]() {
+    std::unique_ptr<scratch> buffers(new scratch);
+    for (const planned_layer& l : _layers) {
+      buffers->push_back(std::vector<float>(_max_batch_size * l.output_count));
+    }
+    return buffers;
+  });
+}
+
+const float* inference_plan::forward(const float* features) const {
+  return forward_rows(features, 1U);
+}
+
+vi::la::matrix inference_plan::forward(const vi::la::matrix& features) const {
+  if (features.column_count() != input_count()) {
+    throw vi::la::incompatible_dimensions("Features have " +
+                                          std::to_string(features.column_count()) +
+                                          " columns, the plan expects " +
+                                          std::to_string(input_count()) + ".");
+  }
+
+  vi::la::matrix predictions(features.owning_context(), features.row_count(), output_count());
+  if (features.row_count() == 0U) {
+    return predictions;
+  }
+
+  // matrix rows are stored contiguously
+  for (size_t start = 0U; start < features.row_count(); start += _max_batch_size) {
+    const size_t row_count = std::min(_max_batch_size, features.row_count() - start);
+    const float* outputs = forward_rows(features[start], row_count);
+    std::memcpy(predictions[start], outputs, row_count * output_count() * sizeof(float));
+  }
+  return predictions;
+}
+
+const float* inference_plan::forward_rows(const float* features, size_t row_count) const {
+  assert(row_count <= _max_batch_size);
+  scratch& activations = thread_scratch();
+
+  const float* inputs = features;
+  for (size_t layer_index = 0U; layer_index < _layers.size(); ++layer_index) {
+    const planned_layer& l = _layers[layer_index];
+    float* outputs = activations[layer_index].data();
+
+    multiply(outputs, inputs, l.weights.data(), l.biases.data(), row_count, l.input_count,
+             l.output_count);
+    apply_activation(l, outputs, row_count);
+    inputs = outputs;
+  }
+  return inputs;
+}
+
+void inference_plan::apply_activation(const planned_layer& l, float* outputs,
+                                      size_t row_count) const {
+  if (l.host != host_activation::unsupported) {
+    for (size_t r = 0U; r < row_count; ++r) {
+      activate_row(outputs + r * l.output_count, l.output_count, l.host);
+    }
+    return;
+  }
+
+  // activations unknown to the plan are applied through a CPU context
+  vi::la::matrix values(_fallback_context, outputs, row_count, l.output_count);
+  l.activation->activate(values);
+  std::memcpy(outputs, values[0], row_count * l.output_count * sizeof(float));
+}
+
+size_t inference_plan::input_count() const { return _layers.front().input_count; }
+
+size_t inference_plan::output_count() const { return _layers.back().output_count; }
+
+size_t inference_plan::max_batch_size() const { return _max_batch_size; }
+}
+}
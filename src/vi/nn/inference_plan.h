@@ -0,0 +1,72 @@
+#ifndef __vinn__inference_plan__
+#define __vinn__inference_plan__
+
+#include <vi/la/cpu/cpu_context.h>
+#include <vi/la/matrix.h>
+#include <vi/la/thread_cache.h>
+#include <vi/nn/activation_function.h>
+#include <vi/nn/host_activation.h>
+
+#include <memory>
+#include <vector>
+
+namespace vi {
+namespace nn {
+
+class network;
+
+/// Inference only copy of a trained network optimized for small batches.
+/// Weights are packed once into contiguous per output rows with separate
+/// biases, and activation buffers for every layer are allocated up front so
+/// that forward passes up to the planned batch size do not allocate.
+/// Single examples are evaluated with matrix-vector products.
+/// Weights are shared read-only and every thread gets its own activation
+/// buffers, so one plan can serve forward passes from many threads. The buffers
+/// of a thread are released when it exits or the plan is destroyed.
+class inference_plan {
+public:
+  /// \param network trained network, later changes to its weights are not reflected
+  /// \param max_batch_size number of rows a forward pass can process without allocating
+  inference_plan(const network& network, size_t max_batch_size = 1U);
+
+  /// Forward pass a single example
+  /// \param features input vector with input_count() values
+  /// \return output activations, valid until the next forward pass on the calling thread
+  const float* forward(const float* features) const;
+
+  /// Forward pass rows of features, processed in chunks of max_batch_size
+  /// \param features matrix with each row containing an input vector
+  /// \return predictions in the context of the features
+  vi::la::matrix forward(const vi::la::matrix& features) const;
+
+  size_t input_count() const;
+  size_t output_count() const;
+  size_t max_batch_size() const;
+
+private:
+  struct planned_layer {
+    size_t input_count;
+    size_t output_count;
+    std::vector<float> weights;
+    std::vector<float> biases;
+    std::shared_ptr<activation_function> activation;
+    host_activation host;
+  };
+
+  /// per-layer activation buffers of one thread
+  typedef std::vector<std::vector<float>> scratch;
+
+  scratch& thread_scratch() const;
+  const float* forward_rows(const float* features, size_t row_count) const;
+  void apply_activation(const planned_layer& l, float* outputs, size_t row_count) const;
+
+  std::vector<planned_layer> _layers;
+  size_t _max_batch_size;
+
+  vi::la::thread_cache<scratch> _scratch;
+  mutable vi::la::cpu_context _fallback_context;
+};
+}
+}
+
+#endif
@@ -1,9 +1,10 @@
 #include "vi/nn/label_map.h"
 
+#include <algorithm>
 #include <cmath>
 #include <limits>
-#include <set>
 #include <sstream>
+#include <utility>
 
 namespace vi {
 namespace nn {
@@ -20,62 +21,100 @@ label_map::label_map(std::vector<int> labels) { create_mappings(labels); }
 
 vi::la::matrix label_map::activations_to_labels(const vi::la::matrix& activations) const {
   vi::la::matrix labels(activations.owning_context(), activations.row_count(), 1U);
+  activations.owning_context().row_argmax(labels, activations);
 
-  for (size_t m = 0U; m < activations.row_count(); ++m) {
-    float current_max_prob(0.0);
-    size_t label_index(0U);
-    for (size_t n = 0U; n < activations.column_count(); ++n) {
-      float probablity(activations[m][n]);
-      if (probablity > current_max_prob) {
-        label_index = n;
-        current_max_prob = probablity;
-      }
-    }
-    labels[m][0U] = _active_unit_to_label[label_index];
+  for (size_t m = 0U; m < labels.row_count(); ++m) {
+    labels[m][0U] = static_cast<float>(_active_unit_to_label[static_cast<size_t>(labels[m][0U])]);
   }
 
   return labels;
 }
 
+top_labels label_map::activations_to_top_labels(const vi::la::matrix& activations,
+                                                size_t k) const {
+  if (activations.column_count() != _active_unit_to_label.size()) {
+    std::ostringstream details;
+    details << "Activations have " << activations.column_count() << " columns for "
+            << _active_unit_to_label.size() << " labels";
+    throw vi::la::incompatible_dimensions(details.str());
+  }
+  if (k == 0U || k > _active_unit_to_label.size()) {
+    std::ostringstream details;
+    details << "Can not select " << k << " of " << _active_unit_to_label.size() << " labels";
+    throw std::out_of_range(details.str());
+  }
+
+  vi::la::context& context = activations.owning_context();
+  top_labels top = {vi::la::matrix(context, activations.row_count(), k),
+                    vi::la::matrix(context, activations.row_count(), k)};
+  context.row_top_k(top.labels, top.scores, activations);
+
+  for (size_t m = 0U; m < top.labels.row_count(); ++m) {
+    float* units = top.labels[m];
+    for (size_t n = 0U; n < k; ++n) {
+      units[n] = static_cast<float>(_active_unit_to_label[static_cast<size_t>(units[n])]);
+    }
+  }
+
+  return top;
+}
+
 vi::la::matrix label_map::labels_to_activations(const vi::la::matrix& labels) const {
-  vi::la::matrix vectors(labels.owning_context(), labels.row_count(), _active_unit_to_label.size(),
-                         0.0);
-
-  for (size_t m = 0U; m < vectors.row_count(); ++m) {
-    bool label_found(false);
-    float label = labels[m][0U];
-    for (size_t n = 0U; n < vectors.column_count(); ++n) {
-      if (std::fabs(_active_unit_to_label[n] - label) < std::numeric_limits<float>::epsilon()) {
-        vectors[m][n] = 1.0;
-        label_found = true;
-        break;
-      }
+  vi::la::matrix vectors(labels.owning_context(), labels.row_count(), _active_unit_to_label.size());
+  labels_to_activations(labels, vectors);
+  return vectors;
+}
+
+void label_map::labels_to_activations(const vi::la::matrix& labels,
+                                      vi::la::matrix& activations) const {
+  if (activations.row_count() != labels.row_count() ||
+      activations.column_count() != _active_unit_to_label.size()) {
+    throw vi::la::incompatible_dimensions(labels, activations, "labels_to_activations");
+  }
+
+  for (size_t m = 0U; m < labels.row_count(); ++m) {
+    std::fill(activations[m], activations[m] + activations.column_count(), 0.0f);
+    const float label = labels[m][0U];
+    const float rounded = std::round(label);
+    std::unordered_map<int, size_t>::const_iterator unit = _label_to_active_unit.end();
+    // float(INT_MAX) rounds up to 2^31, which does not fit in an int
+    if (std::fabs(rounded - label) < std::numeric_limits<float>::epsilon() &&
+        rounded >= -2147483648.0f && rounded < 2147483648.0f) {
+      unit = _label_to_active_unit.find(static_cast<int>(rounded));
     }
 
-    if (!label_found) {
+    if (unit == _label_to_active_unit.end()) {
       std::ostringstream details;
       details << "Row " << m << " contains an unknown label: ";
       details << label << std::endl;
       throw unknown_label_exception(details.str());
     }
+    activations[m][unit->second] = 1.0f;
   }
+}
 
-  return vectors;
+size_t label_map::active_unit_for_label(int label) const {
+  std::unordered_map<int, size_t>::const_iterator unit = _label_to_active_unit.find(label);
+  if (unit == _label_to_active_unit.end()) {
+    std::ostringstream details;
+    details << "Unknown label: " << label << std::endl;
+    throw unknown_label_exception(details.str());
+  }
+  return unit->second;
 }
 
 const std::vector<int>& label_map::labels() const { return _active_unit_to_label; }
 
 void label_map::create_mappings(const std::vector<int>& labels) {
-  std::set<int> duplicates;
+  _label_to_active_unit.clear();
+  _label_to_active_unit.reserve(labels.size());
   for (size_t i = 0U; i < labels.size(); ++i) {
     int label = labels[i];
 
-    if (duplicates.find(label) != duplicates.end()) {
+    if (!_label_to_active_unit.insert(std::make_pair(label, i)).second) {
       std::ostringstream details;
       details << "Duplicate label specified: " << label << std::endl;
       throw unknown_label_exception(details.str());
-    } else {
-      duplicates.insert(label);
     }
   }
 
@@ -2,6 +2,7 @@
 #define __vinn__label_map__
 
 #include <iostream>
+#include <unordered_map>
 #include <vector>
 #include <stdexcept>
 
@@ -16,6 +17,14 @@ public:
   unknown_label_exception(const std::string& error) : std::runtime_error(error) {}
 };
 
+/// Labels of the most active units of every row, best first
+struct top_labels {
+  /// rows x k labels
+  vi::la::matrix labels;
+  /// rows x k activations of the labels
+  vi::la::matrix scores;
+};
+
 /// Map activation units to labels and vice versa
 class label_map {
 public:
@@ -28,9 +37,23 @@ public:
   /// map highest probability activation with corresponding label
   vi::la::matrix activations_to_labels(const vi::la::matrix& activations) const;
 
+  /// map the k highest activations of every row to their labels, ties go to earlier units
+  /// \throw vi::la::incompatible_dimensions if activations does not have a column per label
+  /// \throw std::out_of_range if k is 0 or exceeds the number of labels
+  top_labels activations_to_top_labels(const vi::la::matrix& activations, size_t k) const;
+
   /// map labels into activation vectors based on mapping configuration
   vi::la::matrix labels_to_activations(const vi::la::matrix& labels) const;
 
+  /// one-hot encode labels into a preallocated labels.row_count() x label count matrix
+  /// \throw vi::la::incompatible_dimensions if activations has the wrong shape
+  /// \throw unknown_label_exception if a row contains an unknown label
+  void labels_to_activations(const vi::la::matrix& labels, vi::la::matrix& activations) const;
+
+  /// \return activation unit of a label
+  /// \throw unknown_label_exception if the label is not mapped
+  size_t active_unit_for_label(int label) const;
+
   /// return all available labels
   const std::vector<int>& labels() const;
 
@@ -39,6 +62,7 @@ private:
 
   // vector index of a label indicates active unit
   std::vector<int> _active_unit_to_label;
+  std::unordered_map<int, size_t> _label_to_active_unit;
 };
 }
 }
@@ -5,6 +5,8 @@
 #include <cmath>
 #include <cstdlib>
 #include <iostream>
+#include <utility>
+#include <vector>
 
 namespace {
 
@@ -13,6 +15,42 @@ float random(float start_range, float end_range) {
   float range(end_range - start_range);
   return start_range + value * range;
 }
+
+/// Sparse equivalent of merging a column of ones for the bias in front of the input
+vi::la::sparse_matrix with_bias_column(const vi::la::sparse_matrix& input) {
+  const std::vector<size_t>& offsets = input.row_offsets();
+  std::vector<size_t> row_offsets(offsets.size());
+  std::vector<uint32_t> column_indices(input.non_zero_count() + input.row_count());
+  std::vector<float> values(column_indices.size());
+
+  for (size_t m = 0U; m < input.row_count(); ++m) {
+    size_t position = offsets[m] + m;
+    row_offsets[m] = position;
+    column_indices[position] = 0U;
+    values[position] = 1.0f;
+    for (size_t i = offsets[m]; i < offsets[m + 1U]; ++i) {
+      ++position;
+      column_indices[position] = input.column_indices()[i] + 1U;
+      values[position] = input.values()[i];
+    }
+  }
+  row_offsets.back() = column_indices.size();
+
+  return vi::la::sparse_matrix(input.row_count(), input.column_count() + 1U,
+                               std::move(row_offsets), std::move(column_indices),
+                               std::move(values));
+}
+
+/// Weights are kept transposed where products store operands in reduced precision
+bool keeps_transpose(const vi::la::matrix& weights) {
+  return weights.owning_context().storage_precision() != vi::la::precision::single;
+}
+
+/// \return transposed weights for forward passes to keep, empty where transposing
+///         for every pass costs less memory
+vi::la::matrix kept_transpose(const vi::la::matrix& weights) {
+  return keeps_transpose(weights) ? weights.transpose() : vi::la::matrix();
+}
 }
 
 namespace vi {
@@ -30,12 +68,15 @@ layer::layer(vi::la::context& context, std::shared_ptr<activation_function> acti
       _weights[m][n] = random(-epsilon, epsilon);
     }
   }
+  _transposed_weights = kept_transpose(_weights);
 }
 
 layer::layer(std::shared_ptr<activation_function> activation, const vi::la::matrix& weights)
-    : _activation(activation), _weights(weights) {}
+    : _activation(activation), _weights(weights), _transposed_weights(kept_transpose(weights)) {}
 
-layer::layer(const layer& other) : _activation(other._activation), _weights(other._weights) {}
+layer::layer(const layer& other)
+    : _activation(other._activation), _weights(other._weights),
+      _transposed_weights(other._transposed_weights) {}
 
 layer& layer::operator=(const layer& other) {
   if (this == &other) {
@@ -44,13 +85,14 @@ layer& layer::operator=(const layer& other) {
 
   _activation = other.activation();
   _weights = other.weights();
+  _transposed_weights = other._transposed_weights;
 
   return *this;
 }
 
 vi::la::matrix layer::forward(const vi::la::matrix& input) const {
   const vi::la::matrix bias(context(), input.row_count(), 1U, 1.0);
-  vi::la::matrix z((bias << input) * weights().transpose());
+  vi::la::matrix z((bias << input) * transposed_weights());
   _activation->activate(z);
   return z;
 }
@@ -69,6 +111,24 @@ std::pair<vi::la::matrix, vi::la::matrix> layer::backward(const vi::la::matrix&
   return std::make_pair(delta_out.columns(1U, delta_out.column_count() - 1U), gradient);
 }
 
+vi::la::matrix layer::forward(const vi::la::sparse_matrix& input) const {
+  vi::la::matrix z(with_bias_column(input) * transposed_weights());
+  _activation->activate(z);
+  return z;
+}
+
+std::pair<vi::la::matrix, vi::la::matrix>
+layer::backward(const vi::la::sparse_matrix& inputs, const vi::la::matrix& activations,
+                const vi::la::matrix& error) const {
+  const vi::la::matrix derivative(_activation->gradient(activations));
+  const vi::la::matrix delta = derivative.elementwise_product(error);
+
+  // transpose(delta) * biased_inputs computed as transpose(transpose(biased_inputs) * delta)
+  const vi::la::matrix gradient =
+      with_bias_column(inputs).transpose_multiply(delta).transpose() / -1.0;
+  return std::make_pair(vi::la::matrix(), gradient);
+}
+
 size_t layer::input_count() const {
   // bias unit is internal to the layer
   return weights().column_count() - 1;
@@ -84,7 +144,14 @@ void layer::activation(std::shared_ptr<activation_function> activation) {
 
 const vi::la::matrix& layer::weights() const { return _weights; }
 
-void layer::weights(const vi::la::matrix& weights) { _weights = weights; }
+void layer::weights(const vi::la::matrix& weights) {
+  _weights = weights;
+  _transposed_weights = kept_transpose(weights);
+}
+
+vi::la::matrix layer::transposed_weights() const {
+  return keeps_transpose(_weights) ? _transposed_weights : _weights.transpose();
+}
 
 vi::la::context& layer::context() { return _weights.owning_context(); }
 
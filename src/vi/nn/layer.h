@@ -3,6 +3,7 @@
 
 #include <vi/la/matrix.h>
 #include <vi/la/context.h>
+#include <vi/la/sparse_matrix.h>
 #include "activation_function.h"
 
 namespace vi {
@@ -26,6 +27,15 @@ public:
                                                      const vi::la::matrix& activations,
                                                      const vi::la::matrix& error) const;
 
+  /// Forward pass sparse inputs, only the stored input values are multiplied
+  vi::la::matrix forward(const vi::la::sparse_matrix& input) const;
+
+  /// Backward pass for sparse inputs of a first layer
+  /// \return empty error matrix as inputs are not propagated further, and the gradient
+  std::pair<vi::la::matrix, vi::la::matrix> backward(const vi::la::sparse_matrix& input,
+                                                     const vi::la::matrix& activations,
+                                                     const vi::la::matrix& error) const;
+
   size_t input_count() const;
   size_t output_count() const;
 
@@ -33,14 +43,21 @@ public:
   void activation(std::shared_ptr<activation_function> activation);
 
   const vi::la::matrix& weights() const;
+  /// Weights are read when they are set, write new weights instead of changing them in place
   void weights(const vi::la::matrix& weights);
 
   vi::la::context& context();
   vi::la::context& context() const;
 
 private:
+  /// \return weights transposed for a forward pass
+  vi::la::matrix transposed_weights() const;
+
   std::shared_ptr<activation_function> _activation;
   vi::la::matrix _weights;
+  /// Kept in contexts that store operands in reduced precision, so that their
+  /// packed copy is made once rather than for every forward pass
+  vi::la::matrix _transposed_weights;
 };
 }
 }
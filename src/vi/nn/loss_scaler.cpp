@@ -0,0 +1,54 @@
+#include "vi/nn/loss_scaler.h"
+#include "vi/la/matrix.h"
+
+#include <cassert>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+bool all_finite(const vi::la::matrix& m) {
+  for (size_t row = 0U; row < m.row_count(); ++row) {
+    const float* values = m[row];
+    for (size_t column = 0U; column < m.column_count(); ++column) {
+      if (!std::isfinite(values[column])) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+}
+
+namespace vi {
+namespace nn {
+
+loss_scaler::loss_scaler(float initial_scale, float growth_factor, float backoff_factor,
+                         size_t growth_interval)
+    : _scale(initial_scale), _growth_factor(growth_factor), _backoff_factor(backoff_factor),
+      _growth_interval(growth_interval), _finite_step_count(0U) {
+  assert(_scale > 0.0f);
+  assert(_growth_factor >= 1.0f);
+  assert(_backoff_factor > 0.0f && _backoff_factor < 1.0f);
+  assert(_growth_interval > 0U);
+}
+
+float loss_scaler::scale() const { return _scale; }
+
+bool loss_scaler::update(const std::vector<vi::la::matrix>& scaled_gradients) {
+  for (const vi::la::matrix& gradient : scaled_gradients) {
+    if (!all_finite(gradient)) {
+      _scale = std::max(_scale * _backoff_factor, 1.0f);
+      _finite_step_count = 0U;
+      return false;
+    }
+  }
+
+  if (++_finite_step_count >= _growth_interval) {
+    _scale *= _growth_factor;
+    _finite_step_count = 0U;
+  }
+  return true;
+}
+}
+}
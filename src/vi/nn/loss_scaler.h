@@ -0,0 +1,43 @@
+#ifndef __vinn__loss_scaler__
+#define __vinn__loss_scaler__
+
+#include <cstddef>
+#include <vector>
+
+namespace vi {
+
+namespace la {
+class matrix;
+}
+
+namespace nn {
+
+/// Dynamic loss scaling for training with reduced precision matrix operands.
+/// Errors are multiplied by the current scale before backpropagation so that
+/// small gradients do not underflow. The scale is reduced whenever the scaled
+/// gradients overflow and grown again after a run of finite steps.
+class loss_scaler {
+public:
+  loss_scaler(float initial_scale = 65536.0f, float growth_factor = 2.0f,
+              float backoff_factor = 0.5f, size_t growth_interval = 2000U);
+
+  /// \return scale to multiply errors with before backpropagation
+  float scale() const;
+
+  /// Update the scale after a backward pass
+  /// \param scaled_gradients gradients computed with the current scale
+  /// \return true if the gradients are finite and may be applied, false if
+  ///         the step should be skipped
+  bool update(const std::vector<vi::la::matrix>& scaled_gradients);
+
+private:
+  float _scale;
+  float _growth_factor;
+  float _backoff_factor;
+  size_t _growth_interval;
+  size_t _finite_step_count;
+};
+}
+}
+
+#endif
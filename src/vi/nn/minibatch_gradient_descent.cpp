@@ -1,7 +1,9 @@
 #include "vi/nn/minibatch_gradient_descent.h"
 #include "vi/nn/batch_gradient_descent.h"
 #include "vi/nn/cost_function.h"
+#include "vi/nn/epoch_recorder.h"
 #include "vi/nn/layer.h"
+#include "vi/nn/minibatch_stream.h"
 #include "vi/nn/running_average.h"
 
 #include <cassert>
@@ -44,19 +46,86 @@ float minibatch_gradient_descent::train(vi::nn::network& network, const vi::la::
   const size_t effective_batch_size = std::min(_batch_size, features.row_count());
   const size_t batch_count(features.row_count() / effective_batch_size);
   const size_t maximum_batches_to_average(20U);
-  const size_t batches_to_average(std::min(maximum_batches_to_average, batch_count));
+
+  // consecutive rows, the rows that do not fill a minibatch are left out
+  size_t batch = 0U;
+  const batch_source next_batch = [&](vi::la::matrix& batch_features,
+                                      vi::la::matrix& batch_targets) {
+    if (batch == batch_count) {
+      batch = 0U;
+      return false;
+    }
+    const size_t batch_start = batch * effective_batch_size;
+    const size_t batch_end = batch_start + effective_batch_size - 1U;
+    batch_features = features.rows(batch_start, batch_end);
+    batch_targets = targets.rows(batch_start, batch_end);
+    ++batch;
+    return true;
+  };
+  return train(network, next_batch, cost_function, regularizer,
+               std::min(maximum_batches_to_average, batch_count), features.owning_context());
+}
+
+float minibatch_gradient_descent::train(vi::nn::network& network, vi::nn::dataset& training_set,
+                                        vi::nn::cost_function& cost_function,
+                                        size_t shuffle_buffer_size) {
+  return train(network, training_set, cost_function, nullptr, shuffle_buffer_size);
+}
+
+float minibatch_gradient_descent::train(vi::nn::network& network, vi::nn::dataset& training_set,
+                                        vi::nn::cost_function& cost_function,
+                                        const vi::nn::l2_regularizer& regularizer,
+                                        size_t shuffle_buffer_size) {
+  return train(network, training_set, cost_function, &regularizer, shuffle_buffer_size);
+}
+
+float minibatch_gradient_descent::train(vi::nn::network& network, vi::nn::dataset& training_set,
+                                        vi::nn::cost_function& cost_function,
+                                        const vi::nn::l2_regularizer* regularizer,
+                                        size_t shuffle_buffer_size) {
+  if (network.begin() == network.end()) {
+    throw invalid_configuration("Network has no layers to train.");
+  }
+  minibatch_stream batches(training_set, (*network.begin())->context(), _batch_size,
+                           shuffle_buffer_size);
+  const size_t maximum_batches_to_average(20U);
+
+  bool epoch_finished = false;
+  const batch_source next_batch = [&](vi::la::matrix& batch_features,
+                                      vi::la::matrix& batch_targets) {
+    if (epoch_finished) {
+      batches.rewind();
+      epoch_finished = false;
+    }
+    epoch_finished = !batches.next(batch_features, batch_targets);
+    return !epoch_finished;
+  };
+  return train(network, next_batch, cost_function, regularizer, maximum_batches_to_average,
+               (*network.begin())->context());
+}
+
+float minibatch_gradient_descent::train(vi::nn::network& network, const batch_source& next_batch,
+                                        vi::nn::cost_function& cost_function,
+                                        const vi::nn::l2_regularizer* regularizer,
+                                        size_t batches_to_average, vi::la::context& context) {
   running_average average(batches_to_average);
+  epoch_recorder recorder(_telemetry, &context);
 
   for (size_t epoch = 1U; epoch <= _max_epoch_count; ++epoch) {
+    recorder.start(epoch);
     batch_gradient_descent gd(_batch_iteration_count, _learning_rate);
+    gd.set_loss_scaler(_loss_scaler);
+    gd.set_telemetry(recorder.parts());
 
-    for (size_t batch = 0U; batch < batch_count; ++batch) {
-      size_t batch_start = batch * effective_batch_size;
-      size_t batch_end = batch_start + effective_batch_size - 1U;
-
-      vi::la::matrix batch_features = features.rows(batch_start, batch_end);
-      vi::la::matrix batch_targets = targets.rows(batch_start, batch_end);
-
+    size_t example_count = 0U;
+    vi::la::matrix batch_features;
+    vi::la::matrix batch_targets;
+    epoch_recorder::clock::time_point preparation_start = recorder.now();
+    while (next_batch(batch_features, batch_targets)) {
+      // slicing or waiting for the background thread to read a minibatch counts as preparation
+      recorder.add(&epoch_statistics::preparation_seconds,
+                   recorder.seconds_since(preparation_start));
+      example_count += batch_features.row_count();
       float batch_cost(0.0);
       if (regularizer) {
         batch_cost = gd.train(network, batch_features, batch_targets, cost_function, *regularizer);
@@ -64,9 +133,11 @@ float minibatch_gradient_descent::train(vi::nn::network& network, const vi::la::
         batch_cost = gd.train(network, batch_features, batch_targets, cost_function);
       }
       average.add_value(batch_cost);
+      preparation_start = recorder.now();
     }
 
     const float current_average = average.calculate();
+    recorder.finish(current_average, example_count);
     if (_stop_early && _stop_early(network, epoch, current_average)) {
       return current_average;
     }
@@ -4,9 +4,12 @@
 #include <vi/nn/trainer.h>
 #include <vi/nn/network.h>
 
+#include <functional>
+
 namespace vi {
 namespace nn {
 
+class dataset;
 class l2_regularizer;
 
 class minibatch_gradient_descent : public trainer {
@@ -21,7 +24,32 @@ public:
                       const vi::la::matrix& targets, vi::nn::cost_function& cost_function,
                       const vi::nn::l2_regularizer& regularizer);
 
+  /// Train on minibatches streamed from a dataset by a background thread,
+  /// memory use does not depend on the size of the dataset
+  /// \param shuffle_buffer_size examples held back to shuffle the dataset
+  ///        approximately, 0 trains in dataset order
+  float train(vi::nn::network& network, vi::nn::dataset& training_set,
+              vi::nn::cost_function& cost_function, size_t shuffle_buffer_size = 0U);
+
+  float train(vi::nn::network& network, vi::nn::dataset& training_set,
+              vi::nn::cost_function& cost_function, const vi::nn::l2_regularizer& regularizer,
+              size_t shuffle_buffer_size = 0U);
+
 private:
+  /// Sets the next minibatch of an epoch and returns true, returns false after
+  /// the last minibatch of an epoch and starts the next epoch on the next call
+  typedef std::function<bool(vi::la::matrix& features, vi::la::matrix& targets)> batch_source;
+
+  /// Epoch loop shared by the matrix and the dataset overloads
+  /// \param batches_to_average minibatch costs the reported cost is averaged over
+  float train(vi::nn::network& network, const batch_source& next_batch,
+              vi::nn::cost_function& cost_function, const vi::nn::l2_regularizer* regularizer,
+              size_t batches_to_average, vi::la::context& context);
+
+  float train(vi::nn::network& network, vi::nn::dataset& training_set,
+              vi::nn::cost_function& cost_function, const vi::nn::l2_regularizer* regularizer,
+              size_t shuffle_buffer_size);
+
   float train(vi::nn::network& network, const vi::la::matrix& features,
               const vi::la::matrix& targets, vi::nn::cost_function& cost_function,
               const vi::nn::l2_regularizer* regularizer);
@@ -0,0 +1,180 @@
+#include "vi/nn/minibatch_stream.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace vi {
+namespace nn {
+
+minibatch_stream::minibatch_stream(dataset& source, vi::la::context& context, size_t batch_size,
+                                   size_t shuffle_buffer_size, size_t prefetch_count,
+                                   unsigned seed)
+    : _source(source), _context(context), _feature_count(source.feature_count()),
+      _target_count(source.target_count()), _batch_size(batch_size),
+      _shuffle_buffer_size(shuffle_buffer_size), _prefetch_count(prefetch_count),
+      _generator(seed), _finished(false), _stopping(false) {
+  assert(_batch_size > 0U);
+  assert(_prefetch_count > 0U);
+  start();
+}
+
+minibatch_stream::~minibatch_stream() { stop(); }
+
+void minibatch_stream::rewind() {
+  stop();
+  start();
+}
+
+void minibatch_stream::start() {
+  _batches.clear();
+  _finished = false;
+  _stopping = false;
+  _error = nullptr;
+  _reader = std::thread(&minibatch_stream::read_pass, this);
+}
+
+void minibatch_stream::stop() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stopping = true;
+  }
+  _changed.notify_all();
+  if (_reader.joinable()) {
+    _reader.join();
+  }
+}
+
+bool minibatch_stream::next(vi::la::matrix& features, vi::la::matrix& targets) {
+  batch ready;
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _changed.wait(lock, [this]() { return _finished || !_batches.empty(); });
+    if (_batches.empty()) {
+      if (_error) {
+        std::exception_ptr error = _error;
+        _error = nullptr;
+        std::rethrow_exception(error);
+      }
+      return false;
+    }
+    ready = std::move(_batches.front());
+    _batches.pop_front();
+  }
+  _changed.notify_all();
+
+  features = vi::la::matrix(_context, ready.features.data(), ready.row_count, _feature_count);
+  targets = vi::la::matrix(_context, ready.targets.data(), ready.row_count, _target_count);
+  return true;
+}
+
+void minibatch_stream::read_pass() {
+  try {
+    _source.rewind();
+
+    std::vector<float> incoming_features(_batch_size * _feature_count);
+    std::vector<float> incoming_targets(_batch_size * _target_count);
+    std::vector<float> buffered_features(_shuffle_buffer_size * _feature_count);
+    std::vector<float> buffered_targets(_shuffle_buffer_size * _target_count);
+    size_t buffered_count = 0U;
+    batch current;
+    current.row_count = 0U;
+
+    while (size_t read_count = _source.read(incoming_features.data(), incoming_targets.data(),
+                                            _batch_size)) {
+      for (size_t row = 0U; row < read_count; ++row) {
+        float* features = &incoming_features[row * _feature_count];
+        float* targets = &incoming_targets[row * _target_count];
+        if (_shuffle_buffer_size == 0U) {
+          if (!emit(features, targets, current)) {
+            return;
+          }
+        } else if (buffered_count < _shuffle_buffer_size) {
+          std::memcpy(&buffered_features[buffered_count * _feature_count], features,
+                      _feature_count * sizeof(float));
+          std::memcpy(&buffered_targets[buffered_count * _target_count], targets,
+                      _target_count * sizeof(float));
+          ++buffered_count;
+        } else {
+          // emit a random buffered example and keep the incoming one in its place
+          std::uniform_int_distribution<size_t> pick(0U, buffered_count - 1U);
+          const size_t slot = pick(_generator);
+          float* slot_features = &buffered_features[slot * _feature_count];
+          float* slot_targets = &buffered_targets[slot * _target_count];
+          if (!emit(slot_features, slot_targets, current)) {
+            return;
+          }
+          std::memcpy(slot_features, features, _feature_count * sizeof(float));
+          std::memcpy(slot_targets, targets, _target_count * sizeof(float));
+        }
+      }
+    }
+
+    // drain the shuffle buffer in random order
+    for (; buffered_count > 0U; --buffered_count) {
+      std::uniform_int_distribution<size_t> pick(0U, buffered_count - 1U);
+      const size_t slot = pick(_generator);
+      const size_t last = buffered_count - 1U;
+      if (!emit(&buffered_features[slot * _feature_count],
+                &buffered_targets[slot * _target_count], current)) {
+        return;
+      }
+      if (slot != last) {
+        std::memcpy(&buffered_features[slot * _feature_count],
+                    &buffered_features[last * _feature_count], _feature_count * sizeof(float));
+        std::memcpy(&buffered_targets[slot * _target_count],
+                    &buffered_targets[last * _target_count], _target_count * sizeof(float));
+      }
+    }
+
+    if (current.row_count > 0U) {
+      current.features.resize(current.row_count * _feature_count);
+      current.targets.resize(current.row_count * _target_count);
+      std::lock_guard<std::mutex> lock(_mutex);
+      _batches.push_back(std::move(current));
+    }
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _error = std::current_exception();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _finished = true;
+  }
+  _changed.notify_all();
+}
+
+bool minibatch_stream::emit(const float* features, const float* targets, batch& current) {
+  if (current.row_count == 0U) {
+    current.features.resize(_batch_size * _feature_count);
+    current.targets.resize(_batch_size * _target_count);
+  }
+  std::memcpy(&current.features[current.row_count * _feature_count], features,
+              _feature_count * sizeof(float));
+  std::memcpy(&current.targets[current.row_count * _target_count], targets,
+              _target_count * sizeof(float));
+  ++current.row_count;
+  return push(current);
+}
+
+bool minibatch_stream::push(batch& current) {
+  if (current.row_count < _batch_size) {
+    return true;
+  }
+
+  std::unique_lock<std::mutex> lock(_mutex);
+  _changed.wait(lock, [this]() { return _stopping || _batches.size() < _prefetch_count; });
+  if (_stopping) {
+    return false;
+  }
+  _batches.push_back(std::move(current));
+  lock.unlock();
+  _changed.notify_all();
+
+  current = batch();
+  current.row_count = 0U;
+  return true;
+}
+}
+}
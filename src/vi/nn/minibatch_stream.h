@@ -0,0 +1,83 @@
+#ifndef __vinn__minibatch_stream__
+#define __vinn__minibatch_stream__
+
+#include <vi/la/context.h>
+#include <vi/la/matrix.h>
+#include <vi/nn/dataset.h>
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace vi {
+namespace nn {
+
+/// Splits a dataset into minibatches on a background thread.
+/// The thread reads ahead up to prefetch_count batches while the previous
+/// ones are trained on. Examples pass through a shuffle buffer: each
+/// incoming example replaces a randomly picked buffered one, which is
+/// emitted instead. Memory use is bounded by the shuffle buffer and the
+/// prefetched batches regardless of the size of the dataset.
+class minibatch_stream {
+public:
+  /// \param source dataset to read, must outlive the stream
+  /// \param batch_size examples in each minibatch, the last one of a pass may be smaller
+  /// \param shuffle_buffer_size examples held back for shuffling, 0 keeps the dataset order
+  /// \param prefetch_count minibatches read ahead
+  minibatch_stream(dataset& source, vi::la::context& context, size_t batch_size,
+                   size_t shuffle_buffer_size = 0U, size_t prefetch_count = 2U,
+                   unsigned seed = std::random_device()());
+  ~minibatch_stream();
+
+  minibatch_stream(const minibatch_stream&) = delete;
+  minibatch_stream& operator=(const minibatch_stream&) = delete;
+
+  /// Start a new pass from the first example of the dataset
+  void rewind();
+
+  /// \param features receives the features of the next minibatch
+  /// \param targets receives the targets of the next minibatch
+  /// \return false once every example of the pass has been returned
+  /// \throw the exception the dataset threw while reading
+  bool next(vi::la::matrix& features, vi::la::matrix& targets);
+
+private:
+  struct batch {
+    std::vector<float> features;
+    std::vector<float> targets;
+    size_t row_count;
+  };
+
+  void start();
+  void stop();
+  void read_pass();
+  /// Append an example to the current batch and queue the batch once it is full
+  /// \return false if the stream is stopping
+  bool emit(const float* features, const float* targets, batch& current);
+  bool push(batch& current);
+
+  dataset& _source;
+  vi::la::context& _context;
+  size_t _feature_count;
+  size_t _target_count;
+  size_t _batch_size;
+  size_t _shuffle_buffer_size;
+  size_t _prefetch_count;
+  std::mt19937 _generator;
+
+  std::mutex _mutex;
+  std::condition_variable _changed;
+  std::deque<batch> _batches;
+  bool _finished;
+  bool _stopping;
+  std::exception_ptr _error;
+  std::thread _reader;
+};
+}
+}
+
+#endif
@@ -3,51 +3,111 @@
 #include "vi/la/context.h"
 
 #include <algorithm>
+#include <chrono>
+#include <iterator>
 #include <sstream>
 #include <string>
 
-namespace vi {
-namespace nn {
+namespace {
 
-la::matrix network::forward(const la::matrix& inputs) const {
-  la::matrix activation(inputs);
-  for (const std::shared_ptr<layer>& l : layers_) {
-    activation = l->forward(activation);
-  }
-  return activation;
-}
+typedef std::list<std::shared_ptr<vi::nn::layer>> layer_list;
 
-std::pair<float, std::vector<la::matrix>> network::backward(const la::matrix& features,
-                                                            const la::matrix& targets,
-                                                            cost_function& cost_function) {
+/// Backward pass for dense or sparse features, only the first layer sees the features
+template <typename F>
+std::pair<float, std::vector<vi::la::matrix>>
+backward_pass(const layer_list& layers, const F& features, const vi::la::matrix& targets,
+              vi::nn::cost_function& cost_function, float loss_scale, double* forward_seconds) {
+  std::chrono::steady_clock::time_point start;
+  if (forward_seconds) {
+    start = std::chrono::steady_clock::now();
+  }
   std::vector<vi::la::matrix> activations;
-  activations.push_back(features);
-  for (const std::shared_ptr<layer>& l : layers_) {
-    const vi::la::matrix activation = l->forward(activations.back());
+  for (const std::shared_ptr<vi::nn::layer>& l : layers) {
+    const vi::la::matrix activation =
+        activations.empty() ? l->forward(features) : l->forward(activations.back());
     activations.push_back(activation);
   }
 
   const vi::la::matrix& hypotheses(activations.back());
   const vi::la::matrix costs(cost_function.cost(targets, hypotheses));
-  const float cost = features.owning_context().sum_rows(costs)[0][0];
+  const float cost = hypotheses.owning_context().sum_rows(costs)[0][0];
+  if (forward_seconds) {
+    *forward_seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
 
   vi::la::matrix errors(cost_function.cost_derivative(targets, hypotheses));
+  if (loss_scale != 1.0f) {
+    errors = errors * loss_scale;
+  }
 
   std::vector<vi::la::matrix> gradients;
-  for_each(layers_.rbegin(), layers_.rend(), [&](const std::shared_ptr<layer>& l) {
-    const vi::la::matrix& layer_inputs = *(activations.end() - 2);
+  for_each(layers.rbegin(), layers.rend(), [&](const std::shared_ptr<vi::nn::layer>& l) {
     const vi::la::matrix& layer_activations = activations.back();
     std::pair<vi::la::matrix, vi::la::matrix> error_and_gradient =
-        l->backward(layer_inputs, layer_activations, errors);
+        activations.size() > 1U ? l->backward(*(activations.end() - 2), layer_activations, errors)
+                                : l->backward(features, layer_activations, errors);
     activations.pop_back();
 
     errors = error_and_gradient.first;
-    la::matrix& gradient = error_and_gradient.second;
+    vi::la::matrix& gradient = error_and_gradient.second;
     gradients.insert(gradients.begin(), gradient);
   });
 
   return make_pair(cost, gradients);
 }
+}
+
+namespace vi {
+namespace nn {
+
+la::matrix network::forward(const la::matrix& inputs) const {
+  la::matrix activation(inputs);
+  for (const std::shared_ptr<layer>& l : layers_) {
+    activation = l->forward(activation);
+  }
+  return activation;
+}
+
+std::pair<float, std::vector<la::matrix>> network::backward(const la::matrix& features,
+                                                            const la::matrix& targets,
+                                                            cost_function& cost_function,
+                                                            float loss_scale,
+                                                            double* forward_seconds) {
+  if (layers_.empty()) {
+    // the features are the hypotheses and there are no weights to compute gradients for
+    if (forward_seconds) {
+      *forward_seconds = 0.0;
+    }
+    const la::matrix costs(cost_function.cost(targets, features));
+    return std::make_pair(features.owning_context().sum_rows(costs)[0][0],
+                          std::vector<la::matrix>());
+  }
+  return backward_pass(layers_, features, targets, cost_function, loss_scale, forward_seconds);
+}
+
+la::matrix network::forward(const la::sparse_matrix& features) const {
+  if (layers_.empty()) {
+    throw invalid_configuration("Sparse features can not be forwarded without layers.");
+  }
+
+  la::matrix activation = layers_.front()->forward(features);
+  for (auto l = std::next(layers_.begin()); l != layers_.end(); ++l) {
+    activation = (*l)->forward(activation);
+  }
+  return activation;
+}
+
+std::pair<float, std::vector<la::matrix>> network::backward(const la::sparse_matrix& features,
+                                                            const la::matrix& targets,
+                                                            cost_function& cost_function,
+                                                            float loss_scale,
+                                                            double* forward_seconds) {
+  if (layers_.empty()) {
+    throw invalid_configuration("Sparse features can not be propagated without layers.");
+  }
+  return backward_pass(layers_, features, targets, cost_function, loss_scale, forward_seconds);
+}
 
 void network::add(std::shared_ptr<layer> new_layer) throw(invalid_configuration) {
   if (layers_.size() > 0) {
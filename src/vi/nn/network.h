@@ -4,6 +4,7 @@
 #include <vi/la/context.h>
 #include <vi/nn/layer.h>
 #include <vi/la/matrix.h>
+#include <vi/la/sparse_matrix.h>
 
 #include <list>
 #include <stdexcept>
@@ -28,6 +29,8 @@ public:
   ///        input vector
   /// return predictions with each row containing an output vector for
   ///        a corresponding row in the inputs
+  /// Forward passes only read layer weights, several threads may run them
+  /// concurrently as long as no thread modifies the network.
   vi::la::matrix forward(const vi::la::matrix& features) const;
 
   /// Forward and backward pass through the network
@@ -38,10 +41,29 @@ public:
   /// \param cost_function cost function to use to evaluate
   ///        how much input features deviate from the output
   ///        targets
+  /// \param loss_scale factor to multiply output errors with before they
+  ///        are propagated, gradients are returned scaled by it
+  /// \param forward_seconds receives the seconds the forward half of the pass
+  ///        took, including the cost, when given
   /// return cost and gradients for each layer
   std::pair<float, std::vector<vi::la::matrix>> backward(const vi::la::matrix& features,
                                                          const vi::la::matrix& targets,
-                                                         cost_function& cost_function);
+                                                         cost_function& cost_function,
+                                                         float loss_scale = 1.0f,
+                                                         double* forward_seconds = nullptr);
+
+  /// Forward pass sparse input features, the first layer multiplies only
+  /// the stored feature values
+  /// \throw invalid_configuration if the network has no layers
+  vi::la::matrix forward(const vi::la::sparse_matrix& features) const;
+
+  /// Forward and backward pass sparse input features through the network
+  /// \throw invalid_configuration if the network has no layers
+  std::pair<float, std::vector<vi::la::matrix>> backward(const vi::la::sparse_matrix& features,
+                                                         const vi::la::matrix& targets,
+                                                         cost_function& cost_function,
+                                                         float loss_scale = 1.0f,
+                                                         double* forward_seconds = nullptr);
 
   /// Push a layer on top of existing layers
   /// \param new_layer layer to be added
@@ -0,0 +1,224 @@
+#include "vi/nn/quantized_network.h"
+#include "vi/nn/layer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace {
+
+size_t padded_length(size_t length) {
+  const size_t block_size = vi::la::cpu::int8_block_size;
+  return ((length + block_size - 1U) / block_size) * block_size;
+}
+}
+
+namespace vi {
+namespace nn {
+
+quantization_parameters::quantization_parameters() : _scale(1.0f), _zero_point(0) {}
+
+quantization_parameters::quantization_parameters(float scale, int32_t zero_point)
+    : _scale(scale), _zero_point(zero_point) {
+  assert(_scale > 0.0f);
+  assert(_zero_point >= 0 && _zero_point <= maximum_value);
+}
+
+quantization_parameters quantization_parameters::for_range(float minimum, float maximum) {
+  minimum = std::min(minimum, 0.0f);
+  maximum = std::max(maximum, 0.0f);
+  float scale = (maximum - minimum) / maximum_value;
+  if (scale <= 0.0f) {
+    scale = 1.0f;
+  }
+  const int32_t zero_point = static_cast<int32_t>(std::lrint(-minimum / scale));
+  return quantization_parameters(scale, std::min(std::max(zero_point, 0), maximum_value));
+}
+
+uint8_t quantization_parameters::quantize(float value) const {
+  const long quantized = std::lrint(value / _scale) + _zero_point;
+  return static_cast<uint8_t>(std::min<long>(std::max<long>(quantized, 0L), maximum_value));
+}
+
+float quantization_parameters::dequantize(uint8_t value) const {
+  return _scale * (static_cast<int32_t>(value) - _zero_point);
+}
+
+float quantization_parameters::scale() const { return _scale; }
+
+int32_t quantization_parameters::zero_point() const { return _zero_point; }
+
+quantized_network::quantized_network()
+    : _instruction_set(vi::la::cpu::detect_int8_instruction_set()) {}
+
+void quantized_network::add(const layer& fp32_layer,
+                            const quantization_parameters& input_parameters) {
+  layer_parameters parameters;
+  parameters.input_parameters = input_parameters;
+  parameters.input_count = fp32_layer.input_count();
+  parameters.output_count = fp32_layer.output_count();
+  parameters.weights.assign(parameters.output_count * parameters.input_count, 0);
+  parameters.weight_scales.assign(parameters.output_count, 1.0f);
+  parameters.biases.assign(parameters.output_count, 0.0f);
+  parameters.activation = fp32_layer.activation();
+
+  // symmetric per output channel scales, the first weight column is the bias
+  const vi::la::matrix& weights = fp32_layer.weights();
+  for (size_t o = 0U; o < parameters.output_count; ++o) {
+    const float* row = weights.values() + o * weights.column_count();
+    float maximum(0.0f);
+    for (size_t i = 0U; i < parameters.input_count; ++i) {
+      maximum = std::max(maximum, std::fabs(row[i + 1U]));
+    }
+    const float scale = maximum > 0.0f ? maximum / 127.0f : 1.0f;
+
+    for (size_t i = 0U; i < parameters.input_count; ++i) {
+      const long quantized = std::min(std::max(std::lrint(row[i + 1U] / scale), -127L), 127L);
+      parameters.weights[o * parameters.input_count + i] = static_cast<int8_t>(quantized);
+    }
+    parameters.weight_scales[o] = scale;
+    parameters.biases[o] = row[0];
+  }
+
+  add(parameters);
+}
+
+void quantized_network::add(const layer_parameters& parameters) {
+  if (parameters.input_count == 0U || parameters.output_count == 0U ||
+      parameters.weights.size() != parameters.output_count * parameters.input_count ||
+      parameters.weight_scales.size() != parameters.output_count ||
+      parameters.biases.size() != parameters.output_count || !parameters.activation) {
+    throw invalid_configuration("Quantized layer parameters have inconsistent sizes.");
+  }
+  if (!_layers.empty() && _layers.back().output_count != parameters.input_count) {
+    throw invalid_configuration("Quantized layer inputs do not match the previous layer.");
+  }
+
+  quantized_layer l;
+  l.input_count = parameters.input_count;
+  l.padded_input_count = padded_length(l.input_count);
+  l.output_count = parameters.output_count;
+  l.input_parameters = parameters.input_parameters;
+  l.weights.assign(l.output_count * l.padded_input_count, 0);
+  l.weight_sums.assign(l.output_count, 0);
+  for (size_t o = 0U; o < l.output_count; ++o) {
+    for (size_t i = 0U; i < l.input_count; ++i) {
+      const int8_t weight = parameters.weights[o * l.input_count + i];
+      l.weights[o * l.padded_input_count + i] = weight;
+      l.weight_sums[o] += weight;
+    }
+  }
+  l.weight_scales = parameters.weight_scales;
+  l.biases = parameters.biases;
+  l.activation = parameters.activation;
+  l.host = host_activation_for(*l.activation);
+
+  _layers.push_back(l);
+}
+
+quantized_network::layer_parameters quantized_network::parameters(size_t layer_index) const {
+  const quantized_layer& l = _layers.at(layer_index);
+  layer_parameters parameters;
+  parameters.input_parameters = l.input_parameters;
+  parameters.input_count = l.input_count;
+  parameters.output_count = l.output_count;
+  parameters.weights.resize(l.output_count * l.input_count);
+  for (size_t o = 0U; o < l.output_count; ++o) {
+    std::copy(l.weights.begin() + o * l.padded_input_count,
+              l.weights.begin() + o * l.padded_input_count + l.input_count,
+              parameters.weights.begin() + o * l.input_count);
+  }
+  parameters.weight_scales = l.weight_scales;
+  parameters.biases = l.biases;
+  parameters.activation = l.activation;
+  return parameters;
+}
+
+void quantized_network::accumulate(const quantized_layer& l, const std::vector<uint8_t>& inputs,
+                                   size_t row_count, std::vector<int32_t>& accumulators) const {
+  accumulators.resize(row_count * l.output_count);
+  vi::la::cpu::multiply_u8s8(accumulators.data(), inputs.data(), l.weights.data(), row_count,
+                             l.output_count, l.padded_input_count, _instruction_set);
+}
+
+vi::la::matrix quantized_network::forward(const vi::la::matrix& features) const {
+  assert(!_layers.empty());
+  assert(features.column_count() == _layers.front().input_count);
+  const size_t row_count = features.row_count();
+
+  std::vector<uint8_t> inputs(row_count * _layers.front().padded_input_count, 0U);
+  const quantized_layer& first = _layers.front();
+  for (size_t m = 0U; m < row_count; ++m) {
+    const float* row = features[m];
+    uint8_t* quantized_row = &inputs[m * first.padded_input_count];
+    for (size_t n = 0U; n < first.input_count; ++n) {
+      quantized_row[n] = first.input_parameters.quantize(row[n]);
+    }
+  }
+
+  std::vector<int32_t> accumulators;
+  for (size_t layer_index = 0U; layer_index < _layers.size(); ++layer_index) {
+    const quantized_layer& l = _layers[layer_index];
+    accumulate(l, inputs, row_count, accumulators);
+
+    const bool last_layer = layer_index + 1U == _layers.size();
+    const quantized_layer* next = last_layer ? nullptr : &_layers[layer_index + 1U];
+    const int32_t input_zero_point = l.input_parameters.zero_point();
+
+    if (last_layer || !is_elementwise(l.host)) {
+      // dequantize and apply the activation in the context of the features
+      vi::la::matrix outputs(features.owning_context(), row_count, l.output_count);
+      for (size_t m = 0U; m < row_count; ++m) {
+        float* output_row = outputs[m];
+        for (size_t o = 0U; o < l.output_count; ++o) {
+          const int32_t accumulator =
+              accumulators[m * l.output_count + o] - input_zero_point * l.weight_sums[o];
+          output_row[o] =
+              accumulator * l.input_parameters.scale() * l.weight_scales[o] + l.biases[o];
+        }
+      }
+      l.activation->activate(outputs);
+
+      if (last_layer) {
+        return outputs;
+      }
+
+      inputs.assign(row_count * next->padded_input_count, 0U);
+      for (size_t m = 0U; m < row_count; ++m) {
+        const float* output_row = outputs[m];
+        for (size_t o = 0U; o < l.output_count; ++o) {
+          inputs[m * next->padded_input_count + o] = next->input_parameters.quantize(output_row[o]);
+        }
+      }
+      continue;
+    }
+
+    // requantize to the next layer's input parameters as part of the activation
+    inputs.assign(row_count * next->padded_input_count, 0U);
+    for (size_t m = 0U; m < row_count; ++m) {
+      uint8_t* next_row = &inputs[m * next->padded_input_count];
+      for (size_t o = 0U; o < l.output_count; ++o) {
+        const int32_t accumulator =
+            accumulators[m * l.output_count + o] - input_zero_point * l.weight_sums[o];
+        const float value =
+            accumulator * l.input_parameters.scale() * l.weight_scales[o] + l.biases[o];
+        next_row[o] = next->input_parameters.quantize(activate(value, l.host));
+      }
+    }
+  }
+
+  // unreachable, the last layer always returns
+  return vi::la::matrix();
+}
+
+size_t quantized_network::size() const { return _layers.size(); }
+
+vi::la::cpu::int8_instruction_set quantized_network::instruction_set() const {
+  return _instruction_set;
+}
+
+void quantized_network::instruction_set(vi::la::cpu::int8_instruction_set instruction_set) {
+  _instruction_set = instruction_set;
+}
+}
+}
@@ -0,0 +1,112 @@
+#ifndef __vinn__quantized_network__
+#define __vinn__quantized_network__
+
+#include <vi/la/cpu/int8_multiply.h>
+#include <vi/la/matrix.h>
+#include <vi/nn/activation_function.h>
+#include <vi/nn/host_activation.h>
+#include <vi/nn/network.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace vi {
+namespace nn {
+
+class layer;
+
+/// Affine mapping between real and quantized values:
+///   real = scale * (quantized - zero_point)
+class quantization_parameters {
+public:
+  quantization_parameters();
+  quantization_parameters(float scale, int32_t zero_point);
+
+  /// Choose parameters that cover the range [minimum, maximum] and zero
+  static quantization_parameters for_range(float minimum, float maximum);
+
+  uint8_t quantize(float value) const;
+  float dequantize(uint8_t value) const;
+
+  float scale() const;
+  int32_t zero_point() const;
+
+  /// Largest quantized value, activations use all 8 bits
+  static const int32_t maximum_value = 255;
+
+private:
+  float _scale;
+  int32_t _zero_point;
+};
+
+/// Inference only network with 8-bit weights and activations. Layers
+/// accumulate in 32-bit integers and requantize their outputs directly to the
+/// input parameters of the next layer as part of the activation.
+class quantized_network {
+public:
+  /// Quantized weights of a layer and the parameters to interpret them with
+  struct layer_parameters {
+    /// Calibrated quantization parameters of the layer inputs
+    quantization_parameters input_parameters;
+    size_t input_count;
+    size_t output_count;
+    /// output_count rows of input_count weights within [-127, 127]
+    std::vector<int8_t> weights;
+    /// Real weights are the quantized weights of a row times the scale of the row
+    std::vector<float> weight_scales;
+    std::vector<float> biases;
+    std::shared_ptr<activation_function> activation;
+  };
+
+  quantized_network();
+
+  /// Append a quantized copy of a layer
+  /// \param fp32_layer layer whose weights are quantized per output channel
+  /// \param input_parameters calibrated quantization parameters of the layer inputs
+  void add(const layer& fp32_layer, const quantization_parameters& input_parameters);
+
+  /// Append a layer quantized before, such as one loaded from a file
+  /// \throw invalid_configuration if the sizes are inconsistent or do not match the
+  ///        previous layer
+  void add(const layer_parameters& parameters);
+
+  /// \return quantized weights and parameters of a layer
+  layer_parameters parameters(size_t layer_index) const;
+
+  /// Forward pass the provided input features trough the network
+  /// \param features matrix with each row containing an input vector
+  /// \return predictions in the context of the features
+  vi::la::matrix forward(const vi::la::matrix& features) const;
+
+  /// Number of layers contained in this network
+  size_t size() const;
+
+  /// Instruction set used for integer matrix products, defaults to the fastest available
+  vi::la::cpu::int8_instruction_set instruction_set() const;
+  void instruction_set(vi::la::cpu::int8_instruction_set instruction_set);
+
+private:
+  struct quantized_layer {
+    size_t input_count;
+    size_t padded_input_count;
+    size_t output_count;
+    quantization_parameters input_parameters;
+    std::vector<int8_t> weights;
+    std::vector<int32_t> weight_sums;
+    std::vector<float> weight_scales;
+    std::vector<float> biases;
+    std::shared_ptr<activation_function> activation;
+    host_activation host;
+  };
+
+  void accumulate(const quantized_layer& l, const std::vector<uint8_t>& inputs, size_t row_count,
+                  std::vector<int32_t>& accumulators) const;
+
+  std::vector<quantized_layer> _layers;
+  vi::la::cpu::int8_instruction_set _instruction_set;
+};
+}
+}
+
+#endif
@@ -0,0 +1,59 @@
+#include "vi/nn/quantizer.h"
+#include "vi/nn/layer.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+void update_range(std::pair<float, float>& range, const vi::la::matrix& values) {
+  for (size_t m = 0U; m < values.row_count(); ++m) {
+    const float* row = values.values() + m * values.column_count();
+    for (size_t n = 0U; n < values.column_count(); ++n) {
+      range.first = std::min(range.first, row[n]);
+      range.second = std::max(range.second, row[n]);
+    }
+  }
+}
+}
+
+namespace vi {
+namespace nn {
+
+quantizer::quantizer(const network& network) {
+  for (const std::shared_ptr<layer>& l : network) {
+    _layers.push_back(*l);
+  }
+}
+
+void quantizer::calibrate(const vi::la::matrix& features) {
+  if (_input_ranges.empty()) {
+    _input_ranges.assign(_layers.size(), std::make_pair(std::numeric_limits<float>::max(),
+                                                        std::numeric_limits<float>::lowest()));
+  }
+
+  vi::la::matrix inputs(features);
+  size_t layer_index = 0U;
+  for (const layer& l : _layers) {
+    update_range(_input_ranges[layer_index], inputs);
+    inputs = l.forward(inputs);
+    ++layer_index;
+  }
+}
+
+quantized_network quantizer::quantize() const {
+  if (_input_ranges.size() != _layers.size() || _input_ranges.empty()) {
+    throw invalid_configuration("Network must be calibrated before it can be quantized.");
+  }
+
+  quantized_network quantized;
+  size_t layer_index = 0U;
+  for (const layer& l : _layers) {
+    const std::pair<float, float>& range = _input_ranges[layer_index];
+    quantized.add(l, quantization_parameters::for_range(range.first, range.second));
+    ++layer_index;
+  }
+  return quantized;
+}
+}
+}
@@ -0,0 +1,40 @@
+#ifndef __vinn__quantizer__
+#define __vinn__quantizer__
+
+#include <vi/nn/layer.h>
+#include <vi/nn/network.h>
+#include <vi/nn/quantized_network.h>
+
+#include <utility>
+#include <vector>
+
+namespace vi {
+namespace nn {
+
+/// Post-training quantization of a trained network to 8-bit integers.
+/// Weights are quantized per output channel, activations per layer using
+/// ranges observed while forwarding a representative sample of inputs.
+/// vi::io::quantized_model_file stores the result, tools/quantize.cpp
+/// quantizes a stored model from the command line.
+class quantizer {
+public:
+  /// \param network trained network, the quantizer keeps a copy of its layers, so later
+  ///        changes to its weights are not reflected
+  quantizer(const network& network);
+
+  /// Observe the range of every layer's inputs, may be called with several batches
+  /// \param features matrix with each row containing an input vector
+  void calibrate(const vi::la::matrix& features);
+
+  /// \return int8 copy of the network
+  /// \throw invalid_configuration if the quantizer has not been calibrated
+  quantized_network quantize() const;
+
+private:
+  std::vector<layer> _layers;
+  std::vector<std::pair<float, float>> _input_ranges;
+};
+}
+}
+
+#endif
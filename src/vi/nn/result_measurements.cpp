@@ -1,6 +1,7 @@
 #include "vi/nn/result_measurements.h"
 #include <cmath>
 #include <limits>
+#include <stdexcept>
 
 using vi::la::matrix;
 
@@ -23,7 +24,12 @@ namespace vi {
 namespace nn {
 
 result_measurements::result_measurements(vi::la::context& context, const std::vector<int>& labels)
-    : _confusion_matrix(context, labels.size(), labels.size(), 0.0), _labels(labels) {}
+    : _context(context), _counts(labels.size() * labels.size(), 0U), _labels(labels) {
+  for (size_t i = 0U; i < labels.size(); ++i) {
+    // the first of duplicate labels wins
+    _label_indices.insert(std::make_pair(labels[i], i));
+  }
+}
 
 void result_measurements::add_results(const std::vector<int>& expected,
                                       const std::vector<int>& actual) {
@@ -35,23 +41,32 @@ void result_measurements::add_results(const vi::la::matrix& expected,
   add_results(column_vector_to_vector(expected), column_vector_to_vector(actual));
 }
 
+void result_measurements::add_counts(const std::vector<uint64_t>& counts) {
+  if (counts.size() != _counts.size()) {
+    throw std::invalid_argument("Expected " + std::to_string(_counts.size()) + " counts.");
+  }
+  for (size_t i = 0U; i < counts.size(); ++i) {
+    _counts[i] += counts[i];
+  }
+}
+
 void result_measurements::update_confusion_matrix(const std::vector<int>& expected,
                                                   const std::vector<int>& actual) {
   for (size_t m = 0U; m < actual.size(); ++m) {
     const size_t actual_index(label_index_for_label(actual[m]));
     const size_t expected_index(label_index_for_label(expected[m]));
 
-    _confusion_matrix[expected_index][actual_index] += 1.0;
+    ++_counts[expected_index * _labels.size() + actual_index];
   }
 }
 
 float result_measurements::accuracy() const {
-  float total(0.0);
-  float correct(0.0);
+  uint64_t total(0U);
+  uint64_t correct(0U);
 
-  for (size_t m = 0U; m < _confusion_matrix.row_count(); ++m) {
-    for (size_t n = 0U; n < _confusion_matrix.column_count(); ++n) {
-      float count(_confusion_matrix[m][n]);
+  for (size_t m = 0U; m < _labels.size(); ++m) {
+    for (size_t n = 0U; n < _labels.size(); ++n) {
+      const uint64_t count(_counts[m * _labels.size() + n]);
       total += count;
       if (m == n) {
         correct += count;
@@ -59,7 +74,7 @@ float result_measurements::accuracy() const {
     }
   }
 
-  return correct / total;
+  return static_cast<float>(static_cast<double>(correct) / static_cast<double>(total));
 }
 
 float result_measurements::average_accuracy() const {
@@ -141,29 +156,30 @@ float result_measurements::micro_fscore(float beta) const {
 }
 
 size_t result_measurements::label_index_for_label(int label) const {
-  size_t label_index = 0U;
-  for (size_t i = 0U; i < _labels.size(); ++i) {
-    if (label == _labels[i]) {
-      label_index = i;
-      break;
+  const std::unordered_map<int, size_t>::const_iterator index = _label_indices.find(label);
+  return index != _label_indices.end() ? index->second : 0U;
+}
+
+vi::la::matrix result_measurements::confusion_matrix() const {
+  vi::la::matrix confusion_matrix(_context, _labels.size(), _labels.size());
+  for (size_t m = 0U; m < _labels.size(); ++m) {
+    for (size_t n = 0U; n < _labels.size(); ++n) {
+      confusion_matrix[m][n] = static_cast<float>(_counts[m * _labels.size() + n]);
     }
   }
-
-  return label_index;
+  return confusion_matrix;
 }
 
-vi::la::matrix result_measurements::confusion_matrix() const { return _confusion_matrix; }
-
 confusion_table result_measurements::confusion_table_for_label(int label) const {
-  float true_positives(0.0);
-  float true_negatives(0.0);
-  float false_positives(0.0);
-  float false_negatives(0.0);
+  uint64_t true_positives(0U);
+  uint64_t true_negatives(0U);
+  uint64_t false_positives(0U);
+  uint64_t false_negatives(0U);
   size_t label_index = label_index_for_label(label);
 
-  for (size_t m = 0U; m < _confusion_matrix.row_count(); ++m) {
-    for (size_t n = 0U; n < _confusion_matrix.column_count(); ++n) {
-      float predictions(_confusion_matrix[m][n]);
+  for (size_t m = 0U; m < _labels.size(); ++m) {
+    for (size_t n = 0U; n < _labels.size(); ++n) {
+      const uint64_t predictions(_counts[m * _labels.size() + n]);
 
       if (m == label_index) {
         if (n == label_index) {
@@ -1,7 +1,9 @@
 #ifndef __vinn__result_measurements__
 #define __vinn__result_measurements__
 
+#include <cstdint>
 #include <ostream>
+#include <unordered_map>
 #include <vector>
 
 #include <vi/nn/confusion_table.h>
@@ -23,6 +25,15 @@ public:
   void add_results(const std::vector<int>& expected, const std::vector<int>& actual);
   void add_results(const vi::la::matrix& expected, const vi::la::matrix& actual);
 
+  /// Add counts gathered separately, e.g. by other threads
+  /// \param counts labels().size() x labels().size() row-major counts with
+  ///        a row for each expected and a column for each actual label
+  /// \throw std::invalid_argument if the number of counts does not match
+  void add_counts(const std::vector<uint64_t>& counts);
+
+  /// \return index of a label in labels(), 0 for unknown labels
+  size_t label_index_for_label(int label) const;
+
   float accuracy() const;
 
   /// Macro averages - treat all classes the same
@@ -44,11 +55,13 @@ public:
   const std::vector<int>& labels() const;
 
 private:
-  size_t label_index_for_label(int label) const;
   void update_confusion_matrix(const std::vector<int>& expected, const std::vector<int>& actual);
 
-  vi::la::matrix _confusion_matrix;
+  vi::la::context& _context;
+  /// integer counts stay exact beyond the 2^24 predictions a float can count
+  std::vector<uint64_t> _counts;
   const std::vector<int> _labels;
+  std::unordered_map<int, size_t> _label_indices;
 };
 
 std::ostream& operator<<(std::ostream& os, const result_measurements& measurements);
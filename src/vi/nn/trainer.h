@@ -2,6 +2,7 @@
 #define __vinn__trainer__
 
 #include <functional>
+#include <memory>
 
 #include <iostream>
 
@@ -16,6 +17,7 @@ namespace nn {
 class cost_function;
 class network;
 class l2_regularizer;
+class loss_scaler;
 
 class training_callback {
 public:
@@ -24,6 +26,36 @@ public:
                           float current_cost) = 0;
 };
 
+/// Measurements of a training epoch. Operations of the contexts wait for their
+/// results, so the time of every part includes the computation it started.
+struct epoch_statistics {
+  size_t epoch;
+  float cost;
+  size_t example_count;
+  double seconds;
+  double examples_per_second;
+  /// Seconds spent slicing or reading minibatches
+  double preparation_seconds;
+  double forward_seconds;
+  double backward_seconds;
+  /// Seconds spent applying gradients to the weights
+  double update_seconds;
+  /// Matrices allocated during the epoch in host or device memory. Like the
+  /// peak, counted for the whole process, including concurrent training.
+  size_t allocation_count;
+  /// Most bytes of matrix values allocated at once during the epoch
+  size_t peak_matrix_bytes;
+  size_t bytes_to_device;
+  size_t bytes_to_host;
+};
+
+/// Receives statistics after every epoch, nothing is measured without it
+class training_telemetry {
+public:
+  virtual ~training_telemetry() {}
+  virtual void operator()(const vi::nn::epoch_statistics& statistics) = 0;
+};
+
 class trainer {
 public:
   virtual ~trainer() {}
@@ -46,7 +78,15 @@ public:
     });
   }
 
+  /// Scale losses dynamically during backpropagation, pass nullptr to disable
+  void set_loss_scaler(std::shared_ptr<loss_scaler> scaler) { _loss_scaler = scaler; }
+
+  /// Report statistics of every epoch, pass nullptr to disable
+  void set_telemetry(std::shared_ptr<training_telemetry> telemetry) { _telemetry = telemetry; }
+
 protected:
+  std::shared_ptr<loss_scaler> _loss_scaler;
+  std::shared_ptr<training_telemetry> _telemetry;
   std::function<bool(const vi::nn::network& network, size_t current_epoch, float current_cost)>
       _stop_early;
 };
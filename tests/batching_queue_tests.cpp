@@ -0,0 +1,95 @@
+#include "test.h"
+#include "vi/nn/activation_function.h"
+#include "vi/nn/batching_queue.h"
+#include "vi/nn/network.h"
+
+#include <cmath>
+#include <thread>
+
+using vi::la::matrix;
+using vi::nn::layer;
+using vi::nn::network;
+
+class batching_queue_tests : public ::testing::TestWithParam<vi::la::context*> {
+protected:
+  virtual void SetUp() {
+    vi::la::context& context = *GetParam();
+    _network.add(
+        std::make_shared<layer>(context, std::make_shared<vi::nn::sigmoid_activation>(), 25, 13));
+    _network.add(
+        std::make_shared<layer>(context, std::make_shared<vi::nn::softmax_activation>(), 10, 25));
+
+    _features = matrix(context, 16U, 13U);
+    for (size_t m = 0U; m < _features.row_count(); ++m) {
+      for (size_t n = 0U; n < _features.column_count(); ++n) {
+        _features[m][n] = std::sin(static_cast<float>(m * 13U + n));
+      }
+    }
+  }
+
+  std::vector<float> row(size_t index) const {
+    return std::vector<float>(_features[index], _features[index] + _features.column_count());
+  }
+
+  network _network;
+  matrix _features;
+};
+
+INSTANTIATE_TEST_CASE_P(context, batching_queue_tests, ::testing::ValuesIn(test::all_contexts()));
+
+TEST_P(batching_queue_tests, single_request_completes_after_max_wait) {
+  vi::nn::batching_queue queue(_network, 8U, std::chrono::microseconds(100));
+  matrix expected = _network.forward(_features);
+
+  std::vector<float> actual = queue.submit(row(0U)).get();
+
+  ASSERT_EQ(queue.output_count(), actual.size());
+  for (size_t n = 0U; n < actual.size(); ++n) {
+    EXPECT_NEAR(expected[0][n], actual[n], 1.0e-5f);
+  }
+}
+
+TEST_P(batching_queue_tests, concurrent_requests_match_network_forward) {
+  vi::nn::batching_queue queue(_network, 4U, std::chrono::microseconds(500));
+  matrix expected = _network.forward(_features);
+
+  std::vector<std::vector<float>> actual(_features.row_count());
+  std::vector<std::thread> clients;
+  for (size_t m = 0U; m < _features.row_count(); ++m) {
+    clients.push_back(std::thread([&, m]() { actual[m] = queue.submit(row(m)).get(); }));
+  }
+  for (std::thread& client : clients) {
+    client.join();
+  }
+
+  for (size_t m = 0U; m < _features.row_count(); ++m) {
+    ASSERT_EQ(queue.output_count(), actual[m].size());
+    for (size_t n = 0U; n < actual[m].size(); ++n) {
+      EXPECT_NEAR(expected[m][n], actual[m][n], 1.0e-5f);
+    }
+  }
+}
+
+TEST_P(batching_queue_tests, pending_requests_complete_on_destruction) {
+  std::vector<std::future<std::vector<float>>> results;
+  {
+    vi::nn::batching_queue queue(_network, 64U, std::chrono::seconds(60));
+    for (size_t m = 0U; m < _features.row_count(); ++m) {
+      results.push_back(queue.submit(row(m)));
+    }
+  }
+
+  for (std::future<std::vector<float>>& result : results) {
+    EXPECT_EQ(10U, result.get().size());
+  }
+}
+
+TEST_P(batching_queue_tests, submit_with_wrong_feature_count_throws) {
+  vi::nn::batching_queue queue(_network);
+
+  EXPECT_THROW(queue.submit(std::vector<float>(12U, 0.0f)), vi::la::incompatible_dimensions);
+}
+
+TEST(batching_queue_tests, network_without_layers_throws) {
+  EXPECT_THROW(vi::nn::batching_queue(vi::nn::network()), vi::nn::invalid_configuration);
+}
@@ -0,0 +1,74 @@
+#include "test.h"
+#include "vi/la/scheduling/cost_model.h"
+
+#include <sstream>
+
+using vi::la::scheduling::backend;
+using vi::la::scheduling::cost_model;
+using vi::la::scheduling::operation;
+
+TEST(cost_model_tests, defaults_favor_device_for_large_work) {
+  cost_model model;
+  EXPECT_TRUE(model.empty());
+  EXPECT_LT(model.predict(backend::host, operation::multiply, 100.0),
+            model.predict(backend::device, operation::multiply, 100.0));
+  EXPECT_GT(model.predict(backend::host, operation::multiply, 1e9),
+            model.predict(backend::device, operation::multiply, 1e9));
+}
+
+TEST(cost_model_tests, fits_overhead_and_time_per_work) {
+  cost_model model;
+  for (double work : {1000.0, 2000.0, 4000.0, 8000.0}) {
+    model.record(backend::device, operation::elementwise, work, 0.5 + 0.001 * work);
+  }
+  EXPECT_FALSE(model.empty());
+  EXPECT_NEAR(0.5 + 0.001 * 16000.0,
+              model.predict(backend::device, operation::elementwise, 16000.0), 1e-6);
+  EXPECT_NEAR(0.5, model.predict(backend::device, operation::elementwise, 0.0), 1e-6);
+}
+
+TEST(cost_model_tests, single_size_scales_with_work) {
+  cost_model model;
+  model.record(backend::host, operation::copy, 1000.0, 0.25);
+  model.record(backend::host, operation::copy, 1000.0, 0.25);
+  EXPECT_NEAR(0.5, model.predict(backend::host, operation::copy, 2000.0), 1e-9);
+}
+
+TEST(cost_model_tests, recent_samples_weigh_more) {
+  cost_model model;
+  for (size_t i = 0U; i < 100U; ++i) {
+    model.record_transfer(1000U, 1.0);
+  }
+  for (size_t i = 0U; i < 100U; ++i) {
+    model.record_transfer(1000U, 2.0);
+  }
+  EXPECT_GT(model.predict_transfer(1000U), 1.8);
+}
+
+TEST(cost_model_tests, saved_model_loads) {
+  cost_model model;
+  model.record(backend::host, operation::multiply, 1e6, 1e-3);
+  model.record(backend::host, operation::multiply, 4e6, 3e-3);
+  model.record(backend::device, operation::convolution, 1e6, 1e-4);
+  model.record_transfer(1U << 20U, 1e-4);
+
+  std::stringstream text;
+  model.save(text);
+  cost_model loaded = cost_model::load(text);
+  EXPECT_DOUBLE_EQ(model.predict(backend::host, operation::multiply, 2e6),
+                   loaded.predict(backend::host, operation::multiply, 2e6));
+  EXPECT_DOUBLE_EQ(model.predict(backend::device, operation::convolution, 2e6),
+                   loaded.predict(backend::device, operation::convolution, 2e6));
+  EXPECT_DOUBLE_EQ(model.predict_transfer(1U << 21U), loaded.predict_transfer(1U << 21U));
+  EXPECT_DOUBLE_EQ(model.predict(backend::device, operation::copy, 1e3),
+                   loaded.predict(backend::device, operation::copy, 1e3));
+}
+
+TEST(cost_model_tests, invalid_input_fails_to_load) {
+  std::stringstream other("some other file");
+  EXPECT_THROW(cost_model::load(other), cost_model::exception);
+  std::stringstream unknown("vinn-cost-model 1\nhost division 1 1 1 1 1\n");
+  EXPECT_THROW(cost_model::load(unknown), cost_model::exception);
+  std::stringstream truncated("vinn-cost-model 1\ntransfer 1 2\n");
+  EXPECT_THROW(cost_model::load(truncated), cost_model::exception);
+}
@@ -0,0 +1,80 @@
+#include "test.h"
+#include "vi/io/csv_dataset.h"
+
+#include <sstream>
+#include <vector>
+
+TEST(csv_dataset, reads_features_and_trailing_targets) {
+  std::stringstream stream("x,y,label\n1,2,3\n4,5,6\r\n\n7,8,9\n");
+  vi::io::csv_dataset dataset(stream, 1U, ',', true);
+  EXPECT_EQ(2U, dataset.feature_count());
+  EXPECT_EQ(1U, dataset.target_count());
+
+  std::vector<float> features(4U);
+  std::vector<float> targets(2U);
+  ASSERT_EQ(2U, dataset.read(features.data(), targets.data(), 2U));
+  EXPECT_EQ(std::vector<float>({1.0f, 2.0f, 4.0f, 5.0f}), features);
+  EXPECT_EQ(std::vector<float>({3.0f, 6.0f}), targets);
+
+  ASSERT_EQ(1U, dataset.read(features.data(), targets.data(), 2U));
+  EXPECT_EQ(7.0f, features[0]);
+  EXPECT_EQ(9.0f, targets[0]);
+  EXPECT_EQ(0U, dataset.read(features.data(), targets.data(), 2U));
+}
+
+TEST(csv_dataset, rewind_restarts_after_header) {
+  std::stringstream stream("a;b\n1;2\n3;4");
+  vi::io::csv_dataset dataset(stream, 1U, ';', true);
+
+  std::vector<float> features(2U);
+  std::vector<float> targets(2U);
+  EXPECT_EQ(2U, dataset.read(features.data(), targets.data(), 2U));
+  dataset.rewind();
+  ASSERT_EQ(2U, dataset.read(features.data(), targets.data(), 2U));
+  EXPECT_EQ(std::vector<float>({1.0f, 3.0f}), features);
+  EXPECT_EQ(std::vector<float>({2.0f, 4.0f}), targets);
+}
+
+TEST(csv_dataset, short_rows_are_padded) {
+  std::stringstream stream("1,2,3,4\n5,6\n");
+  vi::io::csv_dataset dataset(stream, 2U);
+
+  std::vector<float> features(4U);
+  std::vector<float> targets(4U);
+  ASSERT_EQ(2U, dataset.read(features.data(), targets.data(), 2U));
+  EXPECT_EQ(std::vector<float>({1.0f, 2.0f, 5.0f, 6.0f}), features);
+  EXPECT_EQ(std::vector<float>({3.0f, 4.0f, 0.0f, 0.0f}), targets);
+}
+
+TEST(csv_dataset, long_lines_span_blocks) {
+  std::stringstream csv;
+  for (size_t row = 0U; row < 3U; ++row) {
+    for (size_t column = 0U; column < 5000U; ++column) {
+      csv << row * 10000U + column << (column + 1U < 5000U ? "," : "\n");
+    }
+  }
+  vi::io::csv_dataset dataset(csv, 1U);
+
+  std::vector<float> features(3U * 4999U);
+  std::vector<float> targets(3U);
+  ASSERT_EQ(3U, dataset.read(features.data(), targets.data(), 3U));
+  EXPECT_EQ(24998.0f, features[2U * 4999U + 4998U]);
+  EXPECT_EQ(24999.0f, targets[2]);
+}
+
+TEST(csv_dataset, invalid_rows_throw) {
+  std::stringstream invalid_value("1,2\n3,x\n");
+  vi::io::csv_dataset invalid_value_dataset(invalid_value, 1U);
+  std::vector<float> features(2U);
+  std::vector<float> targets(2U);
+  EXPECT_THROW(invalid_value_dataset.read(features.data(), targets.data(), 2U),
+               vi::io::csv_dataset::exception);
+
+  std::stringstream long_row("1,2\n3,4,5\n");
+  vi::io::csv_dataset long_row_dataset(long_row, 1U);
+  EXPECT_THROW(long_row_dataset.read(features.data(), targets.data(), 2U),
+               vi::io::csv_dataset::exception);
+
+  std::stringstream targets_only("1\n2\n");
+  EXPECT_THROW(vi::io::csv_dataset dataset(targets_only, 1U), vi::io::csv_dataset::exception);
+}
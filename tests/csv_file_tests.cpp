@@ -1,7 +1,10 @@
 #include "test.h"
 #include "vi/io/csv_file.h"
 
+#include <cmath>
+#include <cstdio>
 #include <fstream>
+#include <random>
 #include <sstream>
 
 using namespace std;
@@ -71,6 +74,29 @@ TEST_P(csv_file_tests, load_in_valid_string_fails) {
   EXPECT_THROW(csv.load(m), std::exception);
 }
 
+TEST_P(csv_file_tests, load_without_rows_leaves_matrix_unchanged) {
+  for (const string& contents : {string(""), string("a,b,c\n")}) {
+    stringstream stream(contents);
+    vi::io::csv_file csv(stream);
+    vi::la::matrix m(*GetParam(), {{5.0}});
+    std::vector<std::string> header;
+    EXPECT_THROW(csv.load(m, header), vi::io::csv_file::exception);
+    EXPECT_EQ(contents.empty() ? 0U : 3U, header.size());
+    EXPECT_MATRIX_EQ(vi::la::matrix(*GetParam(), {{5.0}}), m);
+  }
+}
+
+TEST_P(csv_file_tests, load_starts_at_stream_position) {
+  stringstream stream("skipped\n1,2\n3,4\n");
+  string skipped;
+  getline(stream, skipped);
+  vi::io::csv_file csv(stream);
+  vi::la::matrix m(*GetParam(), {{0.0}});
+  csv.load(m);
+
+  EXPECT_MATRIX_EQ(vi::la::matrix(*GetParam(), {{1.0, 2.0}, {3.0, 4.0}}), m);
+}
+
 TEST_P(csv_file_tests, load_valid_string_succeeds) {
   stringstream stream;
   stream << "1,2,3\n4,5,6\n7,8,9";
@@ -108,3 +134,78 @@ TEST_P(csv_file_tests, storing_matrix_and_header_succeeds) {
   const string expected_string = "col0,col1,col2\n1,2,3\n4,5,6\n7,8,9\n";
   EXPECT_EQ(expected_string, output.str());
 }
+
+TEST_P(csv_file_tests, short_rows_are_padded_with_zeros) {
+  stringstream stream;
+  stream << "1,2,3\n4\n\n7,8,\n";
+  vi::io::csv_file csv(stream);
+  vi::la::matrix m(*GetParam(), {{0.0}});
+  csv.load(m);
+
+  vi::la::matrix expected(*GetParam(),
+                          {{1.0, 2.0, 3.0}, {4.0, 0.0, 0.0}, {0.0, 0.0, 0.0}, {7.0, 8.0, 0.0}});
+  EXPECT_MATRIX_EQ(expected, m);
+}
+
+TEST_P(csv_file_tests, parsing_carriage_returns_and_blanks_succeeds) {
+  stringstream stream;
+  stream << "col0,col1\r\n 1.5, -2e3\r\n+0.25 ,1E-2\r\n";
+  vi::io::csv_file csv(stream);
+  vi::la::matrix m(*GetParam(), {{0.0}});
+  std::vector<std::string> header;
+  csv.load(m, header);
+
+  std::vector<std::string> expected_header = {"col0", "col1"};
+  vi::la::matrix expected(*GetParam(), {{1.5f, -2000.0f}, {0.25f, 0.01f}});
+  EXPECT_MATRIX_EQ(expected, m);
+  EXPECT_EQ(expected_header, header);
+}
+
+TEST_P(csv_file_tests, load_invalid_value_fails) {
+  stringstream stream;
+  stream << "1,2,3\n4,five,6\n";
+  vi::io::csv_file csv(stream);
+  vi::la::matrix m(*GetParam(), {{0.0}});
+  EXPECT_THROW(csv.load(m), vi::io::csv_file::exception);
+}
+
+TEST_P(csv_file_tests, load_empty_value_fails) {
+  stringstream stream;
+  stream << "1,,3\n";
+  vi::io::csv_file csv(stream);
+  vi::la::matrix m(*GetParam(), {{0.0}});
+  EXPECT_THROW(csv.load(m), vi::io::csv_file::exception);
+}
+
+TEST_P(csv_file_tests, parsed_values_match_stof) {
+  // large enough to be split into several chunks parsed concurrently
+  const size_t row_count = 40000U;
+  const size_t column_count = 8U;
+  std::vector<std::string> values;
+  std::mt19937 generator(7U);
+  std::uniform_real_distribution<double> mantissas(-10.0, 10.0);
+  std::uniform_int_distribution<int> exponents(-30, 30);
+  stringstream stream;
+  for (size_t row = 0U; row < row_count; ++row) {
+    for (size_t column = 0U; column < column_count; ++column) {
+      char value[64];
+      const int digits = 1 + static_cast<int>((row + column) % 17U);
+      std::snprintf(value, sizeof(value), "%.*g", digits,
+                    mantissas(generator) * std::pow(10.0, exponents(generator)));
+      values.push_back(value);
+      stream << value << (column + 1U < column_count ? "," : "\n");
+    }
+  }
+  vi::io::csv_file csv(stream);
+  vi::la::matrix m(*GetParam(), {{0.0}});
+  csv.load(m);
+
+  ASSERT_EQ(row_count, m.row_count());
+  ASSERT_EQ(column_count, m.column_count());
+  for (size_t row = 0U; row < row_count; ++row) {
+    for (size_t column = 0U; column < column_count; ++column) {
+      ASSERT_EQ(std::stof(values[row * column_count + column]), m[row][column])
+          << values[row * column_count + column];
+    }
+  }
+}
@@ -0,0 +1,176 @@
+#include "test.h"
+#include "vi/io/csv_dataset.h"
+#include "vi/io/csv_file.h"
+#include "vi/io/csv_writer.h"
+#include "vi/io/text_formatter.h"
+#include "vi/nn/activation_function.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <sstream>
+
+using namespace std;
+
+namespace {
+
+std::string format(float value) {
+  char text[vi::io::max_float_length];
+  return std::string(text, vi::io::format_float(value, text));
+}
+
+/// Shortest number of significant digits with which snprintf round trips
+int shortest_digits(float value) {
+  char text[64];
+  for (int digits = 1; digits < 9; ++digits) {
+    std::snprintf(text, sizeof(text), "%.*e", digits - 1, value);
+    if (std::strtof(text, nullptr) == value) {
+      return digits;
+    }
+  }
+  return 9;
+}
+
+int significant_digits(const std::string& text) {
+  const std::string mantissa = text.substr(0U, text.find('e'));
+  const size_t first = mantissa.find_first_of("123456789");
+  // trailing zeros of integers are not significant
+  const size_t last = mantissa.find('.') == std::string::npos
+                          ? mantissa.find_last_of("123456789")
+                          : mantissa.find_last_of("0123456789");
+  int digits = 0;
+  for (size_t i = first; i <= last; ++i) {
+    digits += mantissa[i] != '.' ? 1 : 0;
+  }
+  return digits;
+}
+
+vi::la::matrix random_matrix(vi::la::context& context, size_t rows, size_t columns) {
+  std::mt19937 generator(3U);
+  std::uniform_real_distribution<float> values(-100.0f, 100.0f);
+  vi::la::matrix m(context, rows, columns);
+  for (size_t row = 0U; row < rows; ++row) {
+    for (size_t column = 0U; column < columns; ++column) {
+      m[row][column] = values(generator);
+    }
+  }
+  return m;
+}
+}
+
+class csv_writer_tests : public ::testing::TestWithParam<vi::la::context*> {};
+INSTANTIATE_TEST_CASE_P(context, csv_writer_tests, ::testing::ValuesIn(test::all_contexts()));
+
+TEST(format_float, writes_special_values) {
+  EXPECT_EQ("0", format(0.0f));
+  EXPECT_EQ("-0", format(-0.0f));
+  EXPECT_EQ("inf", format(std::numeric_limits<float>::infinity()));
+  EXPECT_EQ("-inf", format(-std::numeric_limits<float>::infinity()));
+  EXPECT_EQ("nan", format(std::numeric_limits<float>::quiet_NaN()));
+}
+
+TEST(format_float, writes_fixed_and_scientific_notation) {
+  EXPECT_EQ("1", format(1.0f));
+  EXPECT_EQ("-2000", format(-2000.0f));
+  EXPECT_EQ("12.5", format(12.5f));
+  EXPECT_EQ("0.1", format(0.1f));
+  EXPECT_EQ("0.00001", format(1e-5f));
+  EXPECT_EQ("1e-6", format(1e-6f));
+  EXPECT_EQ("1.5e10", format(1.5e10f));
+  EXPECT_EQ("3.4028235e38", format(std::numeric_limits<float>::max()));
+  EXPECT_EQ("1e-45", format(std::numeric_limits<float>::denorm_min()));
+}
+
+TEST(format_float, matches_shortest_round_trip) {
+  std::mt19937 generator(11U);
+  for (size_t i = 0U; i < 50000U; ++i) {
+    const uint32_t bits = generator();
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    if (value != value) {
+      continue;
+    }
+    const std::string text = format(value);
+    ASSERT_LE(text.size(), vi::io::max_float_length);
+    const float parsed = std::strtof(text.c_str(), nullptr);
+    ASSERT_EQ(0, std::memcmp(&value, &parsed, sizeof(value))) << text;
+    if (value != 0.0f) {
+      ASSERT_EQ(shortest_digits(value), significant_digits(text)) << text;
+    }
+  }
+}
+
+TEST_P(csv_writer_tests, writes_header_and_rows) {
+  stringstream output;
+  vi::io::csv_writer writer(output, ';');
+  writer.write_header({"a", "b"});
+  writer.append(vi::la::matrix(*GetParam(), {{1.0f, 0.5f}}));
+  writer.append(vi::la::matrix(*GetParam(), {{-3.0f, 1e-7f}, {100.0f, 0.1f}}));
+  writer.flush();
+
+  EXPECT_EQ("a;b\n1;0.5\n-3;1e-7\n100;0.1\n", output.str());
+  EXPECT_EQ(3U, writer.row_count());
+}
+
+TEST_P(csv_writer_tests, mismatched_columns_throw) {
+  stringstream output;
+  vi::io::csv_writer writer(output);
+  writer.append(vi::la::matrix(*GetParam(), {{1.0f, 2.0f}}));
+  EXPECT_THROW(writer.append(vi::la::matrix(*GetParam(), {{1.0f}})),
+               vi::la::incompatible_dimensions);
+  EXPECT_THROW(writer.write_header({"a", "b"}), vi::io::csv_writer::exception);
+}
+
+TEST_P(csv_writer_tests, concurrent_formatting_matches_single_thread) {
+  const vi::la::matrix m = random_matrix(*GetParam(), 3000U, 100U);
+  stringstream single;
+  {
+    vi::io::csv_writer writer(single);
+    writer.append(m);
+  }
+  stringstream concurrent;
+  {
+    vi::io::csv_writer writer(concurrent, ',', 4U);
+    writer.append(m.rows(0U, 9U));
+    writer.append(m.rows(10U, m.row_count() - 1U));
+  }
+  EXPECT_EQ(single.str(), concurrent.str());
+}
+
+TEST_P(csv_writer_tests, stored_values_load_exactly) {
+  const vi::la::matrix m = random_matrix(*GetParam(), 500U, 17U);
+  stringstream stream;
+  vi::io::csv_file csv(stream);
+  csv.store(m);
+
+  vi::la::matrix loaded(*GetParam(), 1U, 1U);
+  csv.load(loaded);
+  EXPECT_MATRIX_EQ(m, loaded);
+}
+
+TEST_P(csv_writer_tests, stores_predictions_batch_by_batch) {
+  vi::nn::network network;
+  network.add(std::make_shared<vi::nn::layer>(
+      *GetParam(), std::make_shared<vi::nn::sigmoid_activation>(), 3U, 4U));
+
+  const vi::la::matrix examples = random_matrix(*GetParam(), 10U, 5U);
+  stringstream input;
+  {
+    vi::io::csv_writer writer(input);
+    writer.append(examples);
+  }
+  vi::io::csv_dataset dataset(input, 1U);
+  stringstream output;
+  vi::io::csv_writer writer(output);
+  EXPECT_EQ(10U, vi::io::store_predictions(network, dataset, *GetParam(), writer, 4U));
+  writer.flush();
+
+  stringstream expected;
+  {
+    vi::io::csv_writer expected_writer(expected);
+    expected_writer.append(network.forward(examples.columns(0U, 3U)));
+  }
+  EXPECT_EQ(expected.str(), output.str());
+}
@@ -0,0 +1,171 @@
+#include "test.h"
+#include "vi/io/cache_dataset.h"
+#include "vi/io/dataset_cache.h"
+
+#include <boost/filesystem.hpp>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+std::string temporary_path(const std::string& name) {
+  fs::path path(fs::temp_directory_path());
+  path /= name;
+  return path.string();
+}
+
+vi::la::matrix sequence(vi::la::context& context, size_t rows, size_t columns, float first) {
+  vi::la::matrix values(context, rows, columns);
+  for (size_t m = 0U; m < rows; ++m) {
+    for (size_t n = 0U; n < columns; ++n) {
+      values[m][n] = first + static_cast<float>(m * columns + n);
+    }
+  }
+  return values;
+}
+
+std::vector<vi::io::compression> available_compressions() {
+  std::vector<vi::io::compression> available;
+  for (vi::io::compression compression :
+       {vi::io::compression::none, vi::io::compression::lz4, vi::io::compression::zstd}) {
+    if (vi::io::compression_available(compression)) {
+      available.push_back(compression);
+    }
+  }
+  return available;
+}
+}
+
+class dataset_cache_tests : public ::testing::TestWithParam<vi::la::context*> {};
+INSTANTIATE_TEST_CASE_P(context, dataset_cache_tests, ::testing::ValuesIn(test::all_contexts()));
+
+TEST_P(dataset_cache_tests, round_trip) {
+  const std::string path = temporary_path("dataset_cache_round_trip.cache");
+  vi::la::matrix features = sequence(*GetParam(), 10U, 3U, 0.5f);
+  vi::la::matrix targets = sequence(*GetParam(), 10U, 2U, -100.0f);
+
+  for (vi::io::compression compression : available_compressions()) {
+    {
+      vi::io::dataset_cache_writer writer(path, 3U, 2U, compression, 4U);
+      writer.append(features, targets);
+      writer.close();
+    }
+
+    vi::io::dataset_cache_reader reader(path);
+    EXPECT_EQ(10U, reader.row_count());
+    EXPECT_EQ(3U, reader.feature_count());
+    EXPECT_EQ(2U, reader.target_count());
+    EXPECT_EQ(compression, reader.compression());
+    EXPECT_EQ(3U, reader.chunk_count());
+    EXPECT_EQ(2U, reader.chunk_row_count(2U));
+
+    std::pair<vi::la::matrix, vi::la::matrix> loaded = reader.load(*GetParam());
+    EXPECT_MATRIX_EQ(features, loaded.first);
+    EXPECT_MATRIX_EQ(targets, loaded.second);
+  }
+  std::remove(path.c_str());
+}
+
+TEST_P(dataset_cache_tests, appends_are_chunked_independently_of_append_sizes) {
+  const std::string path = temporary_path("dataset_cache_appends.cache");
+  vi::la::matrix features = sequence(*GetParam(), 7U, 2U, 1.0f);
+  vi::la::matrix targets = sequence(*GetParam(), 7U, 1U, 50.0f);
+  {
+    vi::io::dataset_cache_writer writer(path, 2U, 1U, vi::io::compression::none, 3U);
+    writer.append(features.rows(0U, 1U), targets.rows(0U, 1U));
+    writer.append(features.rows(2U, 6U), targets.rows(2U, 6U));
+    EXPECT_EQ(7U, writer.row_count());
+  }
+
+  vi::io::dataset_cache_reader reader(path);
+  ASSERT_EQ(3U, reader.chunk_count());
+  EXPECT_EQ(3U, reader.chunk_first_row(1U));
+
+  vi::la::matrix chunk_features(*GetParam(), 3U, 2U);
+  vi::la::matrix chunk_targets(*GetParam(), 3U, 1U);
+  reader.read_chunk(1U, chunk_features, chunk_targets);
+  EXPECT_MATRIX_EQ(features.rows(3U, 5U), chunk_features);
+  EXPECT_MATRIX_EQ(targets.rows(3U, 5U), chunk_targets);
+  std::remove(path.c_str());
+}
+
+TEST_P(dataset_cache_tests, read_chunk_into_too_small_matrices_throws) {
+  const std::string path = temporary_path("dataset_cache_too_small.cache");
+  {
+    vi::io::dataset_cache_writer writer(path, 2U, 1U, vi::io::compression::none, 4U);
+    writer.append(sequence(*GetParam(), 4U, 2U, 0.0f), sequence(*GetParam(), 4U, 1U, 0.0f));
+  }
+
+  vi::io::dataset_cache_reader reader(path);
+  vi::la::matrix features(*GetParam(), 4U, 2U);
+  vi::la::matrix targets(*GetParam(), 4U, 1U);
+  EXPECT_THROW(reader.read_chunk(0U, features, targets, 1U), vi::la::incompatible_dimensions);
+  std::remove(path.c_str());
+}
+
+TEST_P(dataset_cache_tests, append_with_wrong_shape_throws) {
+  const std::string path = temporary_path("dataset_cache_wrong_shape.cache");
+  vi::io::dataset_cache_writer writer(path, 2U, 1U);
+  vi::la::matrix features(*GetParam(), 2U, 3U);
+  vi::la::matrix targets(*GetParam(), 2U, 1U);
+  EXPECT_THROW(writer.append(features, targets), vi::la::incompatible_dimensions);
+  EXPECT_THROW(writer.close(), vi::io::dataset_cache_writer::exception);
+  std::remove(path.c_str());
+}
+
+TEST_P(dataset_cache_tests, corrupted_chunk_throws) {
+  const std::string path = temporary_path("dataset_cache_corrupted.cache");
+  for (vi::io::compression compression : available_compressions()) {
+    {
+      vi::io::dataset_cache_writer writer(path, 4U, 1U, compression, 2U);
+      writer.append(sequence(*GetParam(), 6U, 4U, 0.0f), sequence(*GetParam(), 6U, 1U, 0.0f));
+    }
+    {
+      // first chunk starts right after the header
+      std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+      file.seekp(130);
+      file.put('x');
+    }
+
+    vi::io::dataset_cache_reader reader(path);
+    EXPECT_THROW(reader.load(*GetParam()), vi::io::dataset_cache_reader::exception);
+  }
+  std::remove(path.c_str());
+}
+
+TEST_P(dataset_cache_tests, other_file_throws) {
+  const std::string path = temporary_path("dataset_cache_other.cache");
+  std::ofstream(path) << std::string(200U, '1');
+  EXPECT_THROW(vi::io::dataset_cache_reader reader(path), vi::io::dataset_cache_reader::exception);
+  std::remove(path.c_str());
+}
+
+TEST_P(dataset_cache_tests, cache_dataset_streams_all_rows) {
+  const std::string path = temporary_path("dataset_cache_stream.cache");
+  vi::la::matrix features = sequence(*GetParam(), 9U, 2U, 0.0f);
+  vi::la::matrix targets = sequence(*GetParam(), 9U, 1U, 100.0f);
+  {
+    vi::io::dataset_cache_writer writer(path, 2U, 1U, vi::io::compression::none, 4U);
+    writer.append(features, targets);
+  }
+
+  vi::io::cache_dataset dataset(path);
+  EXPECT_EQ(2U, dataset.feature_count());
+  EXPECT_EQ(1U, dataset.target_count());
+  for (size_t pass = 0U; pass < 2U; ++pass) {
+    dataset.rewind();
+    std::vector<float> streamed_features(18U);
+    std::vector<float> streamed_targets(9U);
+    // reads span chunk boundaries
+    EXPECT_EQ(3U, dataset.read(&streamed_features[0], &streamed_targets[0], 3U));
+    EXPECT_EQ(6U, dataset.read(&streamed_features[6], &streamed_targets[3], 10U));
+    EXPECT_EQ(0U, dataset.read(&streamed_features[0], &streamed_targets[0], 1U));
+    EXPECT_MATRIX_EQ(features, vi::la::matrix(*GetParam(), streamed_features.data(), 9U, 2U));
+    EXPECT_MATRIX_EQ(targets, vi::la::matrix(*GetParam(), streamed_targets.data(), 9U, 1U));
+  }
+  std::remove(path.c_str());
+}
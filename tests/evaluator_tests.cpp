@@ -0,0 +1,90 @@
+#include "test.h"
+#include "vi/nn/activation_function.h"
+#include "vi/nn/evaluator.h"
+#include "vi/nn/label_map.h"
+#include "vi/nn/network.h"
+
+#include <random>
+#include <stdexcept>
+
+using vi::la::matrix;
+using vi::nn::evaluator;
+using vi::nn::label_map;
+using vi::nn::layer;
+using vi::nn::network;
+
+class evaluator_tests : public ::testing::TestWithParam<vi::la::context*> {
+protected:
+  virtual void SetUp() {
+    _network.add(std::make_shared<layer>(*GetParam(),
+                                         std::make_shared<vi::nn::sigmoid_activation>(), 8U, 6U));
+    _network.add(std::make_shared<layer>(*GetParam(),
+                                         std::make_shared<vi::nn::softmax_activation>(), 4U, 8U));
+
+    std::mt19937 generator(5U);
+    std::uniform_real_distribution<float> values(-1.0f, 1.0f);
+    std::uniform_int_distribution<int> classes(0, 3);
+    _features = matrix(*GetParam(), 3000U, 6U);
+    _labels = matrix(*GetParam(), 3000U, 1U);
+    for (size_t row = 0U; row < _features.row_count(); ++row) {
+      for (size_t column = 0U; column < _features.column_count(); ++column) {
+        _features[row][column] = values(generator);
+      }
+      _labels[row][0] = static_cast<float>(_map.labels()[classes(generator)]);
+    }
+  }
+
+  network _network;
+  label_map _map = label_map(std::vector<int>({3, 1, 4, 2}));
+  matrix _features;
+  matrix _labels;
+};
+
+INSTANTIATE_TEST_CASE_P(context, evaluator_tests, ::testing::ValuesIn(test::all_contexts()));
+
+namespace {
+
+class failing_dataset : public vi::nn::dataset {
+public:
+  size_t feature_count() const { return 6U; }
+  size_t target_count() const { return 1U; }
+  void rewind() {}
+  size_t read(float*, float*, size_t) { throw std::runtime_error("read failed"); }
+};
+}
+
+TEST_P(evaluator_tests, matches_measurements_of_single_forward) {
+  vi::nn::result_measurements expected(*GetParam(), _map.labels());
+  expected.add_results(_labels, _map.activations_to_labels(_network.forward(_features)));
+
+  for (size_t thread_count : {1U, 4U}) {
+    evaluator evaluator(_network, _map, 128U, thread_count);
+    const vi::nn::result_measurements measurements = evaluator.evaluate(_features, _labels);
+    EXPECT_MATRIX_EQ(expected.confusion_matrix(), measurements.confusion_matrix());
+    EXPECT_FLOAT_EQ(expected.accuracy(), measurements.accuracy());
+  }
+}
+
+TEST_P(evaluator_tests, activation_targets_match_label_targets) {
+  const matrix targets = _map.labels_to_activations(_labels);
+  evaluator evaluator(_network, _map, 100U, 2U);
+  EXPECT_MATRIX_EQ(evaluator.evaluate(_features, _labels).confusion_matrix(),
+                   evaluator.evaluate(_features, targets).confusion_matrix());
+}
+
+TEST_P(evaluator_tests, mismatched_configurations_throw) {
+  EXPECT_THROW(evaluator(_network, label_map(3U)), vi::nn::invalid_configuration);
+  EXPECT_THROW(evaluator(network(), _map), vi::nn::invalid_configuration);
+
+  evaluator evaluator(_network, _map);
+  EXPECT_THROW(evaluator.evaluate(_features.columns(0U, 4U), _labels),
+               vi::nn::invalid_configuration);
+  EXPECT_THROW(evaluator.evaluate(_features, _labels.rows(0U, 9U)),
+               vi::la::incompatible_dimensions);
+}
+
+TEST_P(evaluator_tests, dataset_errors_are_rethrown) {
+  failing_dataset examples;
+  evaluator evaluator(_network, _map, 16U, 3U);
+  EXPECT_THROW(evaluator.evaluate(examples), std::runtime_error);
+}
@@ -0,0 +1,129 @@
+#include "test.h"
+#include "vi/nn/activation_function.h"
+#include "vi/nn/inference_plan.h"
+#include "vi/nn/network.h"
+
+#include <cmath>
+#include <thread>
+
+using vi::la::matrix;
+using vi::nn::layer;
+using vi::nn::network;
+
+namespace {
+
+/// activation the plan has no host implementation for
+class doubling_activation : public vi::nn::activation_function {
+public:
+  activation_function* clone() const { return new doubling_activation(*this); }
+  void activate(vi::la::matrix& inputs) const { inputs = inputs * 2.0f; }
+  vi::la::matrix gradient(const vi::la::matrix& activations) const {
+    return vi::la::matrix(activations.owning_context(), activations.size(), 2.0f);
+  }
+};
+}
+
+class inference_plan_tests : public ::testing::TestWithParam<vi::la::context*> {
+protected:
+  virtual void SetUp() {
+    vi::la::context& context = *GetParam();
+    _network.add(
+        std::make_shared<layer>(context, std::make_shared<vi::nn::sigmoid_activation>(), 25, 13));
+    _network.add(
+        std::make_shared<layer>(context, std::make_shared<vi::nn::hyperbolic_tangent>(), 17, 25));
+    _network.add(
+        std::make_shared<layer>(context, std::make_shared<vi::nn::softmax_activation>(), 10, 17));
+
+    _features = matrix(context, 9U, 13U);
+    for (size_t m = 0U; m < _features.row_count(); ++m) {
+      for (size_t n = 0U; n < _features.column_count(); ++n) {
+        _features[m][n] = std::sin(static_cast<float>(m * 13U + n));
+      }
+    }
+  }
+
+  network _network;
+  matrix _features;
+};
+
+INSTANTIATE_TEST_CASE_P(context, inference_plan_tests, ::testing::ValuesIn(test::all_contexts()));
+
+TEST_P(inference_plan_tests, dimensions) {
+  vi::nn::inference_plan plan(_network, 4U);
+  EXPECT_EQ(13U, plan.input_count());
+  EXPECT_EQ(10U, plan.output_count());
+  EXPECT_EQ(4U, plan.max_batch_size());
+}
+
+TEST_P(inference_plan_tests, forward_single_example_matches_network) {
+  vi::nn::inference_plan plan(_network);
+  matrix expected = _network.forward(_features);
+
+  for (size_t m = 0U; m < _features.row_count(); ++m) {
+    const float* actual = plan.forward(_features[m]);
+    for (size_t n = 0U; n < plan.output_count(); ++n) {
+      EXPECT_NEAR(expected[m][n], actual[n], 1.0e-5f);
+    }
+  }
+}
+
+TEST_P(inference_plan_tests, forward_batches_match_network) {
+  vi::nn::inference_plan plan(_network, 4U);
+  matrix expected = _network.forward(_features);
+  matrix actual = plan.forward(_features);
+
+  ASSERT_EQ(expected.size(), actual.size());
+  EXPECT_EQ(&_features.owning_context(), &actual.owning_context());
+  for (size_t m = 0U; m < expected.row_count(); ++m) {
+    for (size_t n = 0U; n < expected.column_count(); ++n) {
+      EXPECT_NEAR(expected[m][n], actual[m][n], 1.0e-5f);
+    }
+  }
+}
+
+TEST_P(inference_plan_tests, forward_invalid_dimensions_fails) {
+  vi::nn::inference_plan plan(_network);
+  matrix features(*GetParam(), 1U, 7U);
+  EXPECT_THROW(plan.forward(features), vi::la::incompatible_dimensions);
+}
+
+TEST_P(inference_plan_tests, forward_with_custom_activation) {
+  network network;
+  network.add(std::make_shared<layer>(*GetParam(), std::make_shared<doubling_activation>(), 3, 13));
+  vi::nn::inference_plan plan(network, 2U);
+
+  matrix expected = network.forward(_features);
+  matrix actual = plan.forward(_features);
+  for (size_t m = 0U; m < expected.row_count(); ++m) {
+    for (size_t n = 0U; n < expected.column_count(); ++n) {
+      EXPECT_NEAR(expected[m][n], actual[m][n], 1.0e-5f);
+    }
+  }
+}
+
+TEST_P(inference_plan_tests, forward_concurrently_matches_single_thread) {
+  const vi::nn::inference_plan plan(_network);
+  matrix expected = _network.forward(_features);
+
+  const size_t thread_count = 4U;
+  std::vector<std::vector<float>> actual(thread_count);
+  std::vector<std::thread> threads;
+  for (size_t t = 0U; t < thread_count; ++t) {
+    threads.push_back(std::thread([&, t]() {
+      // every thread scores its own row repeatedly
+      for (size_t i = 0U; i < 100U; ++i) {
+        const float* outputs = plan.forward(_features[t]);
+        actual[t].assign(outputs, outputs + plan.output_count());
+      }
+    }));
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  for (size_t t = 0U; t < thread_count; ++t) {
+    for (size_t n = 0U; n < plan.output_count(); ++n) {
+      EXPECT_NEAR(expected[t][n], actual[t][n], 1.0e-5f);
+    }
+  }
+}
@@ -97,3 +97,57 @@ TEST_P(label_map_tests, mapping_unknown_label_throws) {
   label_matrix[0U][2U] = 1;
   EXPECT_THROW(map.labels_to_activations(label_matrix), unknown_label_exception);
 }
+
+TEST_P(label_map_tests, maps_negative_activations_to_largest_unit) {
+  label_map map(vector<int>({42, 7, 3}));
+  const matrix activations(*GetParam(), {{-3.0, -1.0, -2.0}});
+  EXPECT_FLOAT_EQ(7.0, map.activations_to_labels(activations)[0][0]);
+}
+
+TEST_P(label_map_tests, maps_labels_to_preallocated_vectors) {
+  label_map map(vector<int>({42, 7, -1}));
+  const matrix label_matrix(*GetParam(), {{-1.0}, {42.0}, {7.0}, {-1.0}});
+
+  matrix activations(*GetParam(), label_matrix.row_count(), 3U, 5.0);
+  map.labels_to_activations(label_matrix, activations);
+  const matrix expected(*GetParam(), {{0.0, 0.0, 1.0}, {1.0, 0.0, 0.0}, {0.0, 1.0, 0.0},
+                                      {0.0, 0.0, 1.0}});
+  EXPECT_MATRIX_EQ(expected, activations);
+
+  matrix wrong_shape(*GetParam(), label_matrix.row_count(), 2U);
+  EXPECT_THROW(map.labels_to_activations(label_matrix, wrong_shape), incompatible_dimensions);
+}
+
+TEST_P(label_map_tests, mapping_label_outside_int_range_throws) {
+  label_map map(vector<int>({1, 2}));
+  // 2^31 is the float nearest to INT_MAX
+  const matrix label_matrix(*GetParam(), {{2147483648.0}});
+  EXPECT_THROW(map.labels_to_activations(label_matrix), unknown_label_exception);
+}
+
+TEST_P(label_map_tests, mapping_fractional_label_throws) {
+  label_map map(vector<int>({1, 2}));
+  const matrix label_matrix(*GetParam(), {{1.5}});
+  EXPECT_THROW(map.labels_to_activations(label_matrix), unknown_label_exception);
+}
+
+TEST_P(label_map_tests, finds_active_unit_for_label) {
+  label_map map(vector<int>({42, 7}));
+  EXPECT_EQ(0U, map.active_unit_for_label(42));
+  EXPECT_EQ(1U, map.active_unit_for_label(7));
+  EXPECT_THROW(map.active_unit_for_label(3), unknown_label_exception);
+}
+
+TEST_P(label_map_tests, maps_top_activations_to_labels) {
+  label_map map(vector<int>({42, 7, 3, 9}));
+  const matrix activations(*GetParam(), {{0.1, 0.4, 0.2, 0.3}, {0.5, 0.0, 0.5, 0.0}});
+
+  const vi::nn::top_labels top = map.activations_to_top_labels(activations, 2U);
+  EXPECT_MATRIX_EQ(matrix(*GetParam(), {{7.0, 9.0}, {42.0, 3.0}}), top.labels);
+  EXPECT_MATRIX_EQ(matrix(*GetParam(), {{0.4, 0.3}, {0.5, 0.5}}), top.scores);
+
+  EXPECT_THROW(map.activations_to_top_labels(activations, 0U), std::out_of_range);
+  EXPECT_THROW(map.activations_to_top_labels(activations, 5U), std::out_of_range);
+  EXPECT_THROW(map.activations_to_top_labels(activations.columns(0U, 2U), 1U),
+               incompatible_dimensions);
+}
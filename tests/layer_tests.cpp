@@ -190,3 +190,24 @@ TEST_P(layer_tests, gradient_check_softmax_activation) {
     }
   }
 }
+
+TEST_P(layer_tests, sparse_forward_and_backward_match_dense) {
+  matrix weights(*GetParam(), {{0.5f, -0.25f, 0.0f, 1.0f, 0.75f},
+                               {-0.5f, 0.25f, 0.5f, -1.0f, 0.125f}});
+  layer l(std::make_shared<sigmoid_activation>(), weights);
+  sparse_matrix sparse_input(3U, 4U, {0U, 2U, 2U, 4U}, {1U, 3U, 0U, 2U},
+                             {2.0f, -1.0f, 0.5f, 4.0f});
+  const matrix dense_input = sparse_input.to_dense(*GetParam());
+
+  const matrix activations = l.forward(dense_input);
+  EXPECT_MATRIX_EQ(activations, l.forward(sparse_input));
+
+  const matrix error(*GetParam(), {{0.5f, -0.5f}, {0.25f, 1.0f}, {-1.0f, 0.0f}});
+  const matrix dense_gradient = l.backward(dense_input, activations, error).second;
+  const matrix sparse_gradient = l.backward(sparse_input, activations, error).second;
+  for (size_t m = 0U; m < dense_gradient.row_count(); ++m) {
+    for (size_t n = 0U; n < dense_gradient.column_count(); ++n) {
+      EXPECT_NEAR(dense_gradient[m][n], sparse_gradient[m][n], 1.0e-6f);
+    }
+  }
+}
@@ -0,0 +1,44 @@
+#include "test.h"
+#include "vi/io/libsvm_dataset.h"
+
+#include <sstream>
+#include <vector>
+
+TEST(libsvm_dataset, reads_dense_rows) {
+  std::stringstream stream("# comment\n1 1:0.5 3:2\n\n0,7 2:-1 9:4 # ignored\n");
+  vi::io::libsvm_dataset dataset(stream, 3U, 2U);
+  EXPECT_EQ(3U, dataset.feature_count());
+  EXPECT_EQ(2U, dataset.target_count());
+
+  std::vector<float> features(9U, -1.0f);
+  std::vector<float> targets(6U, -1.0f);
+  ASSERT_EQ(2U, dataset.read(features.data(), targets.data(), 3U));
+  EXPECT_EQ(std::vector<float>({0.5f, 0.0f, 2.0f, 0.0f, -1.0f, 0.0f}),
+            std::vector<float>(features.begin(), features.begin() + 6));
+  EXPECT_EQ(std::vector<float>({1.0f, 0.0f, 0.0f, 7.0f}),
+            std::vector<float>(targets.begin(), targets.begin() + 4));
+  EXPECT_EQ(0U, dataset.read(features.data(), targets.data(), 3U));
+}
+
+TEST(libsvm_dataset, rewind_restarts) {
+  std::stringstream stream("1 1:1\n2 1:2\n3 1:3\n");
+  vi::io::libsvm_dataset dataset(stream, 1U);
+
+  std::vector<float> features(2U);
+  std::vector<float> targets(2U);
+  EXPECT_EQ(2U, dataset.read(features.data(), targets.data(), 2U));
+  EXPECT_EQ(1U, dataset.read(features.data(), targets.data(), 2U));
+  dataset.rewind();
+  ASSERT_EQ(2U, dataset.read(features.data(), targets.data(), 2U));
+  EXPECT_EQ(std::vector<float>({1.0f, 2.0f}), targets);
+}
+
+TEST(libsvm_dataset, invalid_features_throw) {
+  std::stringstream stream("1 0:1\n");
+  vi::io::libsvm_dataset dataset(stream, 2U);
+
+  std::vector<float> features(2U);
+  std::vector<float> targets(1U);
+  EXPECT_THROW(dataset.read(features.data(), targets.data(), 1U),
+               vi::io::libsvm_dataset::exception);
+}
@@ -129,3 +129,100 @@ TEST_P(libsvm_file_tests, load_data_with_comments) {
   EXPECT_EQ(0.159f, labels_and_features.second[1][158]);
   EXPECT_EQ(0.160f, labels_and_features.second[1][159]);
 }
+
+TEST_P(libsvm_file_tests, load_sparse_features) {
+  const char* contents = R"Contents(5 1:1 3:3
+# comment only line
+
+2,1 2:0.5 160:0.160)Contents";
+
+  std::stringstream stream(contents);
+  libsvm_file file(stream);
+
+  auto labels_and_features = file.load_labels_and_sparse_features(*GetParam());
+
+  EXPECT_EQ(2U, labels_and_features.first.row_count());
+  EXPECT_EQ(2U, labels_and_features.first.column_count());
+  EXPECT_EQ(5.0f, labels_and_features.first[0][0]);
+  EXPECT_EQ(0.0f, labels_and_features.first[0][1]);
+  EXPECT_EQ(2.0f, labels_and_features.first[1][0]);
+  EXPECT_EQ(1.0f, labels_and_features.first[1][1]);
+
+  const vi::la::sparse_matrix& features = labels_and_features.second;
+  EXPECT_EQ(2U, features.row_count());
+  EXPECT_EQ(160U, features.column_count());
+  EXPECT_EQ(4U, features.non_zero_count());
+  EXPECT_EQ(std::vector<size_t>({0U, 2U, 4U}), features.row_offsets());
+  EXPECT_EQ(std::vector<uint32_t>({0U, 2U, 1U, 159U}), features.column_indices());
+  EXPECT_EQ(std::vector<float>({1.0f, 3.0f, 0.5f, 0.160f}), features.values());
+}
+
+TEST_P(libsvm_file_tests, load_sparse_features_with_max_feature_count) {
+  const char* contents = R"Contents(5 1:1 3:3 159:159
+2 2:0.5 160:0.160)Contents";
+
+  std::stringstream stream(contents);
+  libsvm_file file(stream);
+
+  auto labels_and_features = file.load_labels_and_sparse_features(*GetParam(), 3U);
+
+  const vi::la::sparse_matrix& features = labels_and_features.second;
+  EXPECT_EQ(3U, features.column_count());
+  EXPECT_EQ(std::vector<size_t>({0U, 2U, 3U}), features.row_offsets());
+  EXPECT_EQ(std::vector<uint32_t>({0U, 2U, 1U}), features.column_indices());
+  EXPECT_EQ(std::vector<float>({1.0f, 3.0f, 0.5f}), features.values());
+}
+
+TEST_P(libsvm_file_tests, sparse_and_dense_features_match_for_many_rows) {
+  // large enough to be split into several chunks parsed concurrently
+  std::stringstream stream;
+  for (size_t row = 0U; row < 50000U; ++row) {
+    stream << (row % 3U);
+    for (size_t feature = 1U + row % 7U; feature <= 40U; feature += 1U + row % 5U) {
+      stream << " " << feature << ":" << 0.25f * feature;
+    }
+    stream << "\n";
+  }
+
+  libsvm_file file(stream);
+  auto sparse = file.load_labels_and_sparse_features(*GetParam(), 30U);
+  auto dense = file.load_labels_and_features(*GetParam(), 30U);
+
+  EXPECT_MATRIX_EQ(dense.first, sparse.first);
+  EXPECT_MATRIX_EQ(dense.second, sparse.second.to_dense(*GetParam()));
+  EXPECT_EQ(30U, dense.second.column_count());
+  EXPECT_EQ(2.0f, dense.second[3][7]);
+}
+
+TEST_P(libsvm_file_tests, dense_features_are_sized_by_largest_index) {
+  std::stringstream stream("1 2:0.5\n2\n# comment\n3,4 7:1.5 1:2\n");
+  libsvm_file file(stream);
+  auto dense = file.load_labels_and_features(*GetParam());
+  auto sparse = file.load_labels_and_sparse_features(*GetParam());
+
+  EXPECT_EQ(7U, dense.second.column_count());
+  EXPECT_MATRIX_EQ(vi::la::matrix(*GetParam(), {{1.0f, 0.0f}, {2.0f, 0.0f}, {3.0f, 4.0f}}),
+                   dense.first);
+  EXPECT_MATRIX_EQ(sparse.second.to_dense(*GetParam()), dense.second);
+}
+
+TEST_P(libsvm_file_tests, load_invalid_feature_fails) {
+  std::stringstream stream("1 1:0.5 2\n");
+  libsvm_file file(stream);
+
+  EXPECT_THROW(file.load_labels_and_sparse_features(*GetParam()), libsvm_file::exception);
+}
+
+TEST_P(libsvm_file_tests, load_zero_feature_index_fails) {
+  std::stringstream stream("1 0:0.5\n");
+  libsvm_file file(stream);
+
+  EXPECT_THROW(file.load_labels_and_features(*GetParam()), libsvm_file::exception);
+}
+
+TEST_P(libsvm_file_tests, load_empty_stream_fails) {
+  std::stringstream stream;
+  libsvm_file file(stream);
+
+  EXPECT_THROW(file.load_labels_and_features(*GetParam()), libsvm_file::exception);
+}
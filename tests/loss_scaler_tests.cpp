@@ -0,0 +1,50 @@
+#include "test.h"
+#include "vi/la/matrix.h"
+#include "vi/nn/loss_scaler.h"
+
+#include <limits>
+
+class loss_scaler_tests : public ::testing::TestWithParam<vi::la::context*> {};
+INSTANTIATE_TEST_CASE_P(context, loss_scaler_tests, ::testing::ValuesIn(test::all_contexts()));
+
+TEST_P(loss_scaler_tests, finite_gradients_are_applied) {
+  vi::la::context& context = *GetParam();
+  vi::nn::loss_scaler scaler(128.0f, 2.0f, 0.5f, 2U);
+  std::vector<vi::la::matrix> gradients = {vi::la::matrix(context, {{1.0, 2.0}, {3.0, 4.0}})};
+
+  EXPECT_TRUE(scaler.update(gradients));
+  EXPECT_FLOAT_EQ(128.0f, scaler.scale());
+  EXPECT_TRUE(scaler.update(gradients));
+  EXPECT_FLOAT_EQ(256.0f, scaler.scale());
+}
+
+TEST_P(loss_scaler_tests, overflowing_gradients_are_skipped) {
+  vi::la::context& context = *GetParam();
+  vi::nn::loss_scaler scaler(128.0f, 2.0f, 0.5f, 2U);
+  vi::la::matrix gradient(context, {{1.0, 2.0}, {3.0, 4.0}});
+  gradient[1][0] = std::numeric_limits<float>::infinity();
+  std::vector<vi::la::matrix> gradients = {gradient};
+
+  EXPECT_FALSE(scaler.update(gradients));
+  EXPECT_FLOAT_EQ(64.0f, scaler.scale());
+
+  gradient[1][0] = std::numeric_limits<float>::quiet_NaN();
+  EXPECT_FALSE(scaler.update(gradients));
+  EXPECT_FLOAT_EQ(32.0f, scaler.scale());
+}
+
+TEST_P(loss_scaler_tests, overflow_resets_growth_interval) {
+  vi::la::context& context = *GetParam();
+  vi::nn::loss_scaler scaler(128.0f, 2.0f, 0.5f, 2U);
+  vi::la::matrix gradient(context, {{1.0}});
+  std::vector<vi::la::matrix> gradients = {gradient};
+
+  EXPECT_TRUE(scaler.update(gradients));
+  gradient[0][0] = std::numeric_limits<float>::infinity();
+  EXPECT_FALSE(scaler.update(gradients));
+  gradient[0][0] = 1.0f;
+  EXPECT_TRUE(scaler.update(gradients));
+  EXPECT_FLOAT_EQ(64.0f, scaler.scale());
+  EXPECT_TRUE(scaler.update(gradients));
+  EXPECT_FLOAT_EQ(128.0f, scaler.scale());
+}
@@ -1,6 +1,10 @@
 #include "test.h"
 #include "vi/la/matrix.h"
 
+#include <algorithm>
+#include <limits>
+#include <vector>
+
 using namespace std;
 using namespace vi::la;
 
@@ -260,6 +264,116 @@ TEST_P(matrix_tests, sum_columns) {
   matrix expected(*GetParam(), {{6.0}, {15.0}});
 }
 
+TEST_P(matrix_tests, row_argmax) {
+  matrix a(*GetParam(), {{1.0, 3.0, 2.0}, {-4.0, -5.0, -6.0}, {7.0, 9.0, 9.0}});
+  matrix indices(*GetParam(), 3U, 1U);
+  GetParam()->row_argmax(indices, a);
+  matrix expected(*GetParam(), {{1.0}, {0.0}, {1.0}});
+  EXPECT_MATRIX_EQ(expected, indices);
+}
+
+TEST_P(matrix_tests, row_argmax_of_wide_rows) {
+  const size_t column_count = 1000U + 3U;
+  matrix a(*GetParam(), 4U, column_count, 0.0);
+  const size_t largest[] = {0U, 17U, column_count - 1U, 500U};
+  for (size_t row = 0U; row < a.row_count(); ++row) {
+    for (size_t column = 0U; column < column_count; ++column) {
+      a[row][column] = static_cast<float>((column * 7U + row) % 13U);
+    }
+    a[row][largest[row]] = 20.0f;
+  }
+  // ties go to the first column
+  a[3U][900U] = 20.0f;
+
+  matrix indices(*GetParam(), 4U, 1U);
+  GetParam()->row_argmax(indices, a);
+  for (size_t row = 0U; row < a.row_count(); ++row) {
+    EXPECT_FLOAT_EQ(static_cast<float>(largest[row]), indices[row][0]);
+  }
+}
+
+TEST_P(matrix_tests, row_argmax_orders_nan_below_numbers) {
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  // wide rows take the vectorized path, a NaN in the first block must not hide later columns
+  for (size_t column_count : {3U, 40U}) {
+    matrix a(*GetParam(), 3U, column_count, nan);
+    for (size_t column = 1U; column < column_count; ++column) {
+      a[0][column] = static_cast<float>(column % 5U);
+    }
+    a[1][column_count - 1U] = -1.0f;
+
+    matrix indices(*GetParam(), 3U, 1U);
+    GetParam()->row_argmax(indices, a);
+    EXPECT_FLOAT_EQ(static_cast<float>(std::min<size_t>(4U, column_count - 1U)), indices[0][0]);
+    EXPECT_FLOAT_EQ(static_cast<float>(column_count - 1U), indices[1][0]);
+    // a row of NaN has its first column
+    EXPECT_FLOAT_EQ(0.0f, indices[2][0]);
+  }
+}
+
+TEST_P(matrix_tests, row_top_k) {
+  matrix a(*GetParam(), {{1.0, 3.0, 2.0, 3.0}, {-4.0, -5.0, -6.0, -1.0}});
+  matrix indices(*GetParam(), 2U, 3U);
+  matrix values(*GetParam(), 2U, 3U);
+  GetParam()->row_top_k(indices, values, a);
+  EXPECT_MATRIX_EQ(matrix(*GetParam(), {{1.0, 3.0, 2.0}, {3.0, 0.0, 1.0}}), indices);
+  EXPECT_MATRIX_EQ(matrix(*GetParam(), {{3.0, 3.0, 2.0}, {-1.0, -4.0, -5.0}}), values);
+}
+
+TEST_P(matrix_tests, row_top_k_of_wide_rows) {
+  const size_t column_count = 2000U + 5U;
+  const size_t k = 40U;
+  matrix a(*GetParam(), 3U, column_count);
+  for (size_t row = 0U; row < a.row_count(); ++row) {
+    for (size_t column = 0U; column < column_count; ++column) {
+      // plenty of ties among the largest values
+      a[row][column] = static_cast<float>((column * 37U + row * 11U) % 101U);
+    }
+  }
+
+  matrix indices(*GetParam(), a.row_count(), k);
+  matrix values(*GetParam(), a.row_count(), k);
+  GetParam()->row_top_k(indices, values, a);
+  for (size_t row = 0U; row < a.row_count(); ++row) {
+    std::vector<size_t> columns(column_count);
+    for (size_t column = 0U; column < column_count; ++column) {
+      columns[column] = column;
+    }
+    const float* row_values = a[row];
+    std::stable_sort(columns.begin(), columns.end(), [row_values](size_t x, size_t y) {
+      return row_values[x] > row_values[y];
+    });
+    for (size_t n = 0U; n < k; ++n) {
+      EXPECT_FLOAT_EQ(static_cast<float>(columns[n]), indices[row][n]);
+      EXPECT_FLOAT_EQ(row_values[columns[n]], values[row][n]);
+    }
+  }
+}
+
+TEST_P(matrix_tests, row_top_k_of_changing_shapes) {
+  // scratch kept from a larger call must not leak into a smaller one
+  for (size_t k : {5U, 2U, 7U, 1U}) {
+    const size_t row_count = 9U - k;
+    matrix a(*GetParam(), row_count, 3U * k + 4U);
+    for (size_t row = 0U; row < a.row_count(); ++row) {
+      for (size_t column = 0U; column < a.column_count(); ++column) {
+        a[row][column] = static_cast<float>(column + row);
+      }
+    }
+
+    matrix indices(*GetParam(), row_count, k);
+    matrix values(*GetParam(), row_count, k);
+    GetParam()->row_top_k(indices, values, a);
+    for (size_t row = 0U; row < row_count; ++row) {
+      for (size_t n = 0U; n < k; ++n) {
+        const size_t column = a.column_count() - 1U - n;
+        EXPECT_FLOAT_EQ(static_cast<float>(column), indices[row][n]);
+        EXPECT_FLOAT_EQ(static_cast<float>(column + row), values[row][n]);
+      }
+    }
+  }
+}
+
 TEST_P(matrix_tests, splice_columns_with_invalid_indices) {
   matrix a(*GetParam(), 3U, 5U);
   EXPECT_THROW(a.columns(1U, a.column_count()), std::out_of_range);
@@ -396,3 +510,18 @@ TEST_P(DISABLED_matrix_convolution_tests, convolve_2d_even_mask) {
   GetParam()->convolve_2d(result, mask, a, 1);
   EXPECT_MATRIX_EQ(expected, result);
 }
+
+TEST_P(matrix_tests, allocation_trackers_keep_separate_peaks) {
+  allocation_tracker outer;
+  const size_t live_bytes = outer.statistics().live_bytes;
+  { const matrix large(*GetParam(), 64U, 64U, 1.0f); }
+  allocation_tracker inner;
+  const matrix small(*GetParam(), 2U, 2U, 1.0f);
+  inner.restart();
+
+  // the inner tracker started after the large matrix was released
+  EXPECT_LE(live_bytes + 64U * 64U * sizeof(float), outer.statistics().peak_bytes);
+  EXPECT_GT(live_bytes + 64U * 64U * sizeof(float), inner.statistics().peak_bytes);
+  EXPECT_EQ(0U, inner.statistics().allocation_count);
+  EXPECT_LE(2U, outer.statistics().allocation_count);
+}
@@ -0,0 +1,138 @@
+#include "test.h"
+#include "vi/nn/activation_function.h"
+#include "vi/nn/cost_function.h"
+#include "vi/nn/dataset.h"
+#include "vi/nn/layer.h"
+#include "vi/nn/minibatch_gradient_descent.h"
+#include "vi/nn/minibatch_stream.h"
+#include "vi/nn/network.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+/// Examples with feature i, i + 0.5 and target -i
+class counting_dataset : public vi::nn::dataset {
+public:
+  counting_dataset(size_t row_count, size_t failing_row = 0U)
+      : _row_count(row_count), _failing_row(failing_row), _next_row(0U) {}
+
+  size_t feature_count() const { return 2U; }
+  size_t target_count() const { return 1U; }
+  void rewind() { _next_row = 0U; }
+
+  size_t read(float* features, float* targets, size_t max_rows) {
+    size_t row_count = 0U;
+    for (; row_count < max_rows && _next_row < _row_count; ++row_count, ++_next_row) {
+      if (_failing_row != 0U && _next_row == _failing_row) {
+        throw std::runtime_error("read failed");
+      }
+      features[row_count * 2U] = static_cast<float>(_next_row);
+      features[row_count * 2U + 1U] = static_cast<float>(_next_row) + 0.5f;
+      targets[row_count] = -static_cast<float>(_next_row);
+    }
+    return row_count;
+  }
+
+private:
+  size_t _row_count;
+  size_t _failing_row;
+  size_t _next_row;
+};
+
+/// First features of every example of a pass, checking that features and targets stay together
+std::vector<float> read_pass(vi::nn::minibatch_stream& stream, std::vector<size_t>& batch_sizes) {
+  std::vector<float> rows;
+  vi::la::matrix features;
+  vi::la::matrix targets;
+  while (stream.next(features, targets)) {
+    batch_sizes.push_back(features.row_count());
+    for (size_t row = 0U; row < features.row_count(); ++row) {
+      EXPECT_EQ(features[row][0] + 0.5f, features[row][1]);
+      EXPECT_EQ(-features[row][0], targets[row][0]);
+      rows.push_back(features[row][0]);
+    }
+  }
+  return rows;
+}
+
+std::vector<float> counting(size_t row_count) {
+  std::vector<float> rows;
+  for (size_t row = 0U; row < row_count; ++row) {
+    rows.push_back(static_cast<float>(row));
+  }
+  return rows;
+}
+}
+
+class minibatch_stream_tests : public ::testing::TestWithParam<vi::la::context*> {};
+INSTANTIATE_TEST_CASE_P(context, minibatch_stream_tests,
+                        ::testing::ValuesIn(test::all_contexts()));
+
+TEST_P(minibatch_stream_tests, yields_examples_in_order_without_shuffling) {
+  counting_dataset dataset(10U);
+  vi::nn::minibatch_stream stream(dataset, *GetParam(), 4U);
+
+  std::vector<size_t> batch_sizes;
+  EXPECT_EQ(counting(10U), read_pass(stream, batch_sizes));
+  EXPECT_EQ(std::vector<size_t>({4U, 4U, 2U}), batch_sizes);
+}
+
+TEST_P(minibatch_stream_tests, shuffling_yields_every_example_once) {
+  counting_dataset dataset(100U);
+  vi::nn::minibatch_stream stream(dataset, *GetParam(), 8U, 16U, 2U, 1U);
+
+  std::vector<size_t> batch_sizes;
+  std::vector<float> rows = read_pass(stream, batch_sizes);
+  EXPECT_NE(counting(100U), rows);
+  std::sort(rows.begin(), rows.end());
+  EXPECT_EQ(counting(100U), rows);
+}
+
+TEST_P(minibatch_stream_tests, rewind_starts_a_new_pass) {
+  counting_dataset dataset(20U);
+  vi::nn::minibatch_stream stream(dataset, *GetParam(), 3U, 5U);
+
+  vi::la::matrix features;
+  vi::la::matrix targets;
+  ASSERT_TRUE(stream.next(features, targets));
+  stream.rewind();
+
+  std::vector<size_t> batch_sizes;
+  std::vector<float> rows = read_pass(stream, batch_sizes);
+  std::sort(rows.begin(), rows.end());
+  EXPECT_EQ(counting(20U), rows);
+}
+
+TEST_P(minibatch_stream_tests, read_errors_are_rethrown) {
+  counting_dataset dataset(50U, 30U);
+  vi::nn::minibatch_stream stream(dataset, *GetParam(), 4U);
+
+  vi::la::matrix features;
+  vi::la::matrix targets;
+  size_t row_count = 0U;
+  EXPECT_THROW(
+      while (stream.next(features, targets)) { row_count += features.row_count(); },
+      std::runtime_error);
+  EXPECT_EQ(28U, row_count);
+}
+
+TEST_P(minibatch_stream_tests, minibatch_gradient_descent_trains_on_stream) {
+  vi::nn::network network;
+  network.add(std::make_shared<vi::nn::layer>(
+      *GetParam(), std::make_shared<vi::nn::linear_activation>(), 1U, 2U));
+
+  counting_dataset dataset(40U);
+  vi::nn::squared_error_cost cost_function;
+  vi::nn::minibatch_gradient_descent trainer(3U, 0.0001f, 8U);
+  size_t epoch_count = 0U;
+  trainer.set_stop_early([&](const vi::nn::network&, size_t, float) {
+    ++epoch_count;
+    return false;
+  });
+
+  EXPECT_LT(0.0f, trainer.train(network, dataset, cost_function, 10U));
+  EXPECT_EQ(3U, epoch_count);
+}
@@ -44,3 +44,64 @@ TEST(model, round_trip) {
 
   fs::remove_all(model_path);
 }
+
+namespace {
+
+vi::nn::network small_network(vi::la::context& context) {
+  vi::nn::network network;
+  network.add(std::make_shared<vi::nn::layer>(
+      context, std::make_shared<vi::nn::hyperbolic_tangent>(), 4, 3));
+  network.add(std::make_shared<vi::nn::layer>(
+      context, std::make_shared<vi::nn::sigmoid_activation>(), 2, 4));
+  return network;
+}
+}
+
+TEST(model, csv_export_round_trip) {
+  fs::path model_path(fs::temp_directory_path());
+  model_path /= "csv_export_test.model";
+
+  vi::la::cpu_context context;
+  vi::nn::network out_network = small_network(context);
+  vi::io::model(model_path.string()).store(out_network, vi::io::model::weight_format::csv);
+  EXPECT_TRUE(fs::exists(model_path / "data" / "0.csv"));
+  EXPECT_FALSE(fs::exists(model_path / "data" / "0.weights"));
+
+  vi::nn::network in_network;
+  vi::io::model(model_path.string()).load(in_network, context);
+  ASSERT_EQ(out_network.size(), in_network.size());
+  vi::nn::network::const_iterator in_iterator = in_network.begin();
+  for (std::shared_ptr<vi::nn::layer> out_layer : out_network) {
+    EXPECT_MATRIX_EQ(out_layer->weights(), (*in_iterator)->weights());
+    ++in_iterator;
+  }
+
+  fs::remove_all(model_path);
+}
+
+TEST(model, stores_binary_weights_by_default) {
+  fs::path model_path(fs::temp_directory_path());
+  model_path /= "binary_weights_test.model";
+
+  vi::la::cpu_context context;
+  vi::io::model(model_path.string()).store(small_network(context));
+  EXPECT_TRUE(fs::exists(model_path / "data" / "1.weights"));
+  EXPECT_FALSE(fs::exists(model_path / "data" / "1.csv"));
+
+  fs::remove_all(model_path);
+}
+
+TEST(model, corrupted_weights_throw) {
+  fs::path model_path(fs::temp_directory_path());
+  model_path /= "corrupted_weights_test.model";
+
+  vi::la::cpu_context context;
+  vi::io::model(model_path.string()).store(small_network(context));
+  fs::resize_file(model_path / "data" / "0.weights", 70U);
+
+  vi::nn::network in_network;
+  EXPECT_THROW(vi::io::model(model_path.string()).load(in_network, context),
+               vi::io::model::exception);
+
+  fs::remove_all(model_path);
+}
@@ -10,6 +10,8 @@
 #include "vi/la/opencl/opencl_context.h"
 #include "vi/nn/result_measurements.h"
 
+#include <thread>
+
 class network_tests : public ::testing::TestWithParam<vi::la::context*> {};
 INSTANTIATE_TEST_CASE_P(context, network_tests, ::testing::ValuesIn(test::all_contexts()));
 
@@ -99,6 +101,20 @@ TEST_P(network_tests, backward_succeeds_with_valid_inputs) {
   ASSERT_EQ((*second_layer)->weights().size(), cost_and_gradients.second[1].size());
 }
 
+TEST_P(network_tests, backward_without_layers_costs_features) {
+  network network;
+  matrix features(*GetParam(), 4, 3, 2.0f);
+  matrix targets(*GetParam(), 4, 3, 1.0f);
+
+  vi::nn::squared_error_cost cost_function;
+  std::pair<float, std::vector<matrix>> cost_and_gradients =
+      network.backward(features, targets, cost_function);
+  EXPECT_LT(0.0f, cost_and_gradients.first);
+  EXPECT_TRUE(cost_and_gradients.second.empty());
+
+  EXPECT_FLOAT_EQ(0.0f, network.backward(targets, targets, cost_function).first);
+}
+
 TEST_P(network_tests, backward_fails_with_invalid_feature_dimensions) {
   network network;
   network.add(
@@ -140,3 +156,77 @@ TEST_P(network_tests, backward_fails_with_invalid_target_dimensions) {
   vi::nn::cross_entropy_cost cost_function;
   EXPECT_THROW(network.backward(features, targets, cost_function), vi::la::incompatible_dimensions);
 }
+
+TEST_P(network_tests, forward_concurrently_matches_single_thread) {
+  network network;
+  network.add(
+      std::make_shared<layer>(*GetParam(), std::make_shared<vi::nn::sigmoid_activation>(), 25, 10));
+  network.add(
+      std::make_shared<layer>(*GetParam(), std::make_shared<vi::nn::softmax_activation>(), 10, 25));
+
+  const size_t thread_count = 4U;
+  std::vector<matrix> inputs;
+  std::vector<matrix> expected;
+  for (size_t t = 0U; t < thread_count; ++t) {
+    inputs.push_back(matrix(*GetParam(), 8U, 10U, 0.1f * t));
+    expected.push_back(network.forward(inputs.back()));
+  }
+
+  std::vector<matrix> actual(thread_count);
+  std::vector<std::thread> threads;
+  for (size_t t = 0U; t < thread_count; ++t) {
+    threads.push_back(std::thread([&, t]() {
+      for (size_t i = 0U; i < 10U; ++i) {
+        actual[t] = network.forward(inputs[t]);
+      }
+    }));
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  for (size_t t = 0U; t < thread_count; ++t) {
+    EXPECT_MATRIX_EQ(expected[t], actual[t]);
+  }
+}
+
+TEST_P(network_tests, sparse_backward_matches_dense) {
+  network network;
+  network.add(
+      std::make_shared<layer>(*GetParam(), std::make_shared<vi::nn::sigmoid_activation>(), 5, 8));
+  network.add(
+      std::make_shared<layer>(*GetParam(), std::make_shared<vi::nn::softmax_activation>(), 3, 5));
+  vi::la::sparse_matrix features(2U, 8U, {0U, 3U, 4U}, {0U, 4U, 7U, 2U},
+                                 {1.0f, 0.5f, -2.0f, 3.0f});
+  const matrix dense_features = features.to_dense(*GetParam());
+  matrix targets(*GetParam(), {{1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f}});
+  vi::nn::cross_entropy_cost cost_function;
+
+  auto dense = network.backward(dense_features, targets, cost_function);
+  auto sparse = network.backward(features, targets, cost_function);
+
+  EXPECT_NEAR(dense.first, sparse.first, 1.0e-5f);
+  ASSERT_EQ(dense.second.size(), sparse.second.size());
+  for (size_t i = 0U; i < dense.second.size(); ++i) {
+    ASSERT_EQ(dense.second[i].size(), sparse.second[i].size());
+    for (size_t m = 0U; m < dense.second[i].row_count(); ++m) {
+      for (size_t n = 0U; n < dense.second[i].column_count(); ++n) {
+        EXPECT_NEAR(dense.second[i][m][n], sparse.second[i][m][n], 1.0e-5f);
+      }
+    }
+  }
+  matrix dense_predictions = network.forward(dense_features);
+  matrix sparse_predictions = network.forward(features);
+  for (size_t m = 0U; m < dense_predictions.row_count(); ++m) {
+    for (size_t n = 0U; n < dense_predictions.column_count(); ++n) {
+      EXPECT_NEAR(dense_predictions[m][n], sparse_predictions[m][n], 1.0e-6f);
+    }
+  }
+}
+
+TEST_P(network_tests, sparse_forward_without_layers_throws) {
+  network network;
+  vi::la::sparse_matrix features(1U, 2U, {0U, 1U}, {1U}, {1.0f});
+
+  EXPECT_THROW(network.forward(features), vi::nn::invalid_configuration);
+}
@@ -3,6 +3,7 @@
 #include "vi/la/opencl/memory_source_loader.h"
 #include "vi/la/opencl/opencl_builder.h"
 
+#include <boost/filesystem.hpp>
 #include <CL/cl.hpp>
 #include <vector>
 
@@ -151,3 +152,41 @@ TEST_P(opencl_builder_tests, building_with_unavailable_extensions_fails) {
   cl::Context ctx = GetParam();
   EXPECT_FALSE(builder.build(ctx).success());
 }
+
+TEST_P(opencl_builder_tests, building_with_cache_loads_binaries_on_second_build) {
+  const boost::filesystem::path cache_directory =
+      boost::filesystem::temp_directory_path() /
+      boost::filesystem::unique_path("opencl_builder_cache_%%%%%%%%");
+  program_cache cache(cache_directory.string());
+  disk_source_loader loader(source_root);
+  builder builder(loader);
+  builder.add_source_paths({"tests/fixtures/kernel.cl"});
+
+  cl::Context ctx = GetParam();
+  build_result first = builder.build(ctx, cache);
+  EXPECT_TRUE(first.success());
+  EXPECT_FALSE(first.cached());
+
+  build_result second = builder.build(ctx, cache);
+  EXPECT_TRUE(second.success());
+  EXPECT_TRUE(second.cached());
+  EXPECT_NO_THROW({ cl::Kernel kernel(second.program(), "add_numbers"); });
+
+  // other build options must not load the binaries built without them
+  builder.add_build_options({"-DNONSENSE"});
+  EXPECT_FALSE(builder.build(ctx, cache).cached());
+
+  boost::system::error_code error;
+  boost::filesystem::remove_all(cache_directory, error);
+}
+
+TEST_P(opencl_builder_tests, devices_are_checked_without_a_context) {
+  disk_source_loader loader(source_root);
+  builder builder(loader);
+  cl::Context ctx = GetParam();
+  for (const cl::Device& device : ctx.getInfo<CL_CONTEXT_DEVICES>()) {
+    EXPECT_TRUE(builder.can_build(device));
+    builder.add_extension_requirements({"made_up_extension"});
+    EXPECT_FALSE(builder.can_build(device));
+  }
+}
@@ -0,0 +1,134 @@
+#include "test.h"
+#include "vi/la/cpu/cpu_context.h"
+#include "vi/la/matrix.h"
+#include "vi/la/opencl/opencl_context.h"
+#include "vi/la/sparse_matrix.h"
+
+#include <vector>
+
+using vi::la::matrix;
+
+namespace {
+
+matrix sequence(vi::la::context& context, size_t rows, size_t columns) {
+  matrix values(context, rows, columns, 0.0f);
+  for (size_t row = 0U; row < rows; ++row) {
+    for (size_t column = 0U; column < columns; ++column) {
+      values[row][column] = static_cast<float>((row * 7U + column) % 11U) / 11.0f;
+    }
+  }
+  return values;
+}
+}
+
+TEST(opencl_matrix_tests, repeated_kernels_stay_on_device) {
+  for (cl_device_id device : vi::la::opencl_context::supported_devices()) {
+    vi::la::opencl_context context({device});
+    matrix values = sequence(context, 16U, 32U);
+    const size_t byte_count = 16U * 32U * sizeof(float);
+
+    context.sigmoid(values);
+    const vi::la::transfer_statistics before = context.transfers();
+    for (size_t i = 0U; i < 10U; ++i) {
+      context.multiply(values, values, 1.0f);
+      context.add(values, values, 0.0f);
+    }
+    EXPECT_EQ(before.bytes_to_device, context.transfers().bytes_to_device);
+    EXPECT_EQ(before.bytes_to_host, context.transfers().bytes_to_host);
+
+    // reading the values copies them once
+    vi::la::cpu_context host;
+    matrix expected = sequence(host, 16U, 32U);
+    host.sigmoid(expected);
+    EXPECT_MATRIX_EQ(expected, values);
+    EXPECT_MATRIX_EQ(expected, values);
+    EXPECT_EQ(before.bytes_to_host + byte_count, context.transfers().bytes_to_host);
+  }
+}
+
+TEST(opencl_matrix_tests, host_writes_reach_device) {
+  for (cl_device_id device : vi::la::opencl_context::supported_devices()) {
+    vi::la::opencl_context context({device});
+    matrix values = sequence(context, 8U, 8U);
+    context.sigmoid(values);
+    values[3][4] = 20.0f;
+    context.hyperbolic_tangent(values);
+
+    vi::la::cpu_context host;
+    matrix expected = sequence(host, 8U, 8U);
+    host.sigmoid(expected);
+    expected[3][4] = 20.0f;
+    host.hyperbolic_tangent(expected);
+    EXPECT_MATRIX_EQ(expected, values);
+  }
+}
+
+TEST(opencl_matrix_tests, reading_values_does_not_copy_them_back) {
+  for (cl_device_id device : vi::la::opencl_context::supported_devices()) {
+    vi::la::opencl_context context({device});
+    matrix values = sequence(context, 16U, 32U);
+    context.sigmoid(values);
+    const vi::la::transfer_statistics before = context.transfers();
+
+    const float* read = values.values();
+    EXPECT_LT(0.0f, read[0]);
+    context.hyperbolic_tangent(values);
+    EXPECT_EQ(before.bytes_to_device, context.transfers().bytes_to_device);
+    EXPECT_EQ(before.bytes_to_host + 16U * 32U * sizeof(float), context.transfers().bytes_to_host);
+  }
+}
+
+TEST(opencl_matrix_tests, host_pointers_stay_valid_after_kernels) {
+  for (cl_device_id device : vi::la::opencl_context::supported_devices()) {
+    vi::la::opencl_context context({device});
+    matrix values = sequence(context, 8U, 8U);
+    float* row = values[2];
+    context.sigmoid(values);
+
+    // the pointer is the same, the values are current once the row is read again
+    EXPECT_EQ(row, values[2]);
+    EXPECT_EQ(row, values.values() + 2U * 8U);
+    vi::la::cpu_context host;
+    matrix expected = sequence(host, 8U, 8U);
+    host.sigmoid(expected);
+    EXPECT_FLOAT_EQ(expected[2][5], row[5]);
+  }
+}
+
+TEST(opencl_matrix_tests, results_are_created_on_device) {
+  for (cl_device_id device : vi::la::opencl_context::supported_devices()) {
+    vi::la::opencl_context context({device});
+    matrix operand_1 = sequence(context, 32U, 16U);
+    matrix operand_2 = sequence(context, 16U, 24U);
+
+    const vi::la::transfer_statistics before = context.transfers();
+    matrix product = operand_1 * operand_2;
+    matrix sum = product + product;
+    EXPECT_EQ(before.bytes_to_device, context.transfers().bytes_to_device);
+    EXPECT_EQ(before.bytes_to_host, context.transfers().bytes_to_host);
+  }
+}
+
+TEST(opencl_matrix_tests, sparse_operands_are_copied_once) {
+  for (cl_device_id device : vi::la::opencl_context::supported_devices()) {
+    vi::la::opencl_context context({device});
+    const vi::la::sparse_matrix sparse(3U, 4U, {0U, 2U, 2U, 5U}, {0U, 3U, 1U, 2U, 3U},
+                                       {1.0f, 2.0f, -1.0f, 0.5f, 4.0f});
+    matrix operand = sequence(context, 4U, 8U);
+    matrix transposed_operand = sequence(context, 3U, 8U);
+    matrix product = sparse * operand;
+    matrix transpose_product = sparse.transpose_multiply(transposed_operand);
+
+    const vi::la::transfer_statistics before = context.transfers();
+    for (size_t i = 0U; i < 4U; ++i) {
+      product = sparse * operand;
+      transpose_product = sparse.transpose_multiply(transposed_operand);
+    }
+    EXPECT_EQ(before.bytes_to_device, context.transfers().bytes_to_device);
+
+    vi::la::cpu_context host;
+    matrix dense = sparse.to_dense(host);
+    EXPECT_MATRIX_EQ(dense * sequence(host, 4U, 8U), product);
+    EXPECT_MATRIX_EQ(dense.transpose() * sequence(host, 3U, 8U), transpose_product);
+  }
+}
@@ -0,0 +1,168 @@
+#include "test.h"
+#include "vi/la/matrix.h"
+#include "vi/la/opencl/opencl_context.h"
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+/// Two devices sharing a platform, split from a single CPU device when
+/// there are no two such devices
+class device_pair {
+public:
+  device_pair() {
+    std::vector<cl_device_id> devices =
+        vi::la::opencl_context::supported_devices(CL_DEVICE_TYPE_CPU);
+#ifdef CL_DEVICE_PARTITION_EQUALLY
+    for (cl_device_id device : devices) {
+      cl_uint compute_units = 0U;
+      clGetDeviceInfo(device, CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(compute_units), &compute_units,
+                      nullptr);
+      if (compute_units < 2U) {
+        continue;
+      }
+
+      const cl_device_partition_property properties[] = {
+          CL_DEVICE_PARTITION_EQUALLY,
+          static_cast<cl_device_partition_property>(compute_units / 2U), 0};
+      cl_uint sub_device_count = 0U;
+      if (clCreateSubDevices(device, properties, 0U, nullptr, &sub_device_count) != CL_SUCCESS ||
+          sub_device_count < 2U) {
+        continue;
+      }
+      _sub_devices.resize(sub_device_count);
+      clCreateSubDevices(device, properties, sub_device_count, _sub_devices.data(), nullptr);
+      _devices.assign(_sub_devices.begin(), _sub_devices.begin() + 2);
+      return;
+    }
+#endif
+  }
+
+  ~device_pair() {
+#ifdef CL_DEVICE_PARTITION_EQUALLY
+    for (cl_device_id device : _sub_devices) {
+      clReleaseDevice(device);
+    }
+#endif
+  }
+
+  bool available() const { return _devices.size() == 2U; }
+  const std::vector<cl_device_id>& devices() const { return _devices; }
+
+private:
+  std::vector<cl_device_id> _sub_devices;
+  std::vector<cl_device_id> _devices;
+};
+
+vi::la::matrix sequence(vi::la::context& context, size_t rows, size_t columns) {
+  vi::la::matrix values(context, rows, columns, 0.0f);
+  for (size_t row = 0U; row < rows; ++row) {
+    for (size_t column = 0U; column < columns; ++column) {
+      values[row][column] = static_cast<float>((row * 7U + column * 13U) % 23U) / 23.0f - 0.5f;
+    }
+  }
+  return values;
+}
+}
+
+TEST(opencl_multi_device_tests, splits_large_products) {
+  device_pair pair;
+  if (!pair.available()) {
+    return;
+  }
+  vi::la::opencl_context single({pair.devices()[0]});
+  vi::la::opencl_context multiple(pair.devices());
+  EXPECT_EQ(2U, multiple.device_count());
+
+  // odd row counts leave blocks that are not a multiple of the alignment
+  vi::la::matrix expected = sequence(single, 601U, 500U) * sequence(single, 500U, 300U);
+  vi::la::matrix product = sequence(multiple, 601U, 500U) * sequence(multiple, 500U, 300U);
+  EXPECT_MATRIX_EQ(expected, product);
+}
+
+TEST(opencl_multi_device_tests, splits_large_elementwise_operations) {
+  device_pair pair;
+  if (!pair.available()) {
+    return;
+  }
+  vi::la::opencl_context single({pair.devices()[0]});
+  vi::la::opencl_context multiple(pair.devices());
+
+  const size_t rows = 1201U;
+  const size_t columns = 1000U;
+  vi::la::matrix expected = sequence(single, rows, columns);
+  vi::la::matrix actual = sequence(multiple, rows, columns);
+  expected = (expected + sequence(single, rows, columns)) * 0.5f;
+  actual = (actual + sequence(multiple, rows, columns)) * 0.5f;
+  EXPECT_MATRIX_EQ(expected, actual);
+
+  vi::la::matrix expected_sigmoid(single, rows, columns, 0.0f);
+  vi::la::matrix actual_sigmoid(multiple, rows, columns, 0.0f);
+  single.sigmoid_gradient(expected_sigmoid, expected);
+  multiple.sigmoid_gradient(actual_sigmoid, actual);
+  EXPECT_MATRIX_EQ(expected_sigmoid, actual_sigmoid);
+
+  single.hyperbolic_tangent(expected);
+  multiple.hyperbolic_tangent(actual);
+  EXPECT_MATRIX_EQ(expected, actual);
+}
+
+TEST(opencl_multi_device_tests, splits_operations_in_place) {
+  device_pair pair;
+  if (!pair.available()) {
+    return;
+  }
+  vi::la::opencl_context single({pair.devices()[0]});
+  vi::la::opencl_context multiple(pair.devices());
+
+  // the result is also an operand, every device gets one sub-buffer of it
+  const size_t rows = 1201U;
+  const size_t columns = 1000U;
+  vi::la::matrix expected = sequence(single, rows, columns);
+  vi::la::matrix actual = sequence(multiple, rows, columns);
+  single.multiply(expected, expected, 2.0f);
+  multiple.multiply(actual, actual, 2.0f);
+  single.add(expected, expected, expected);
+  multiple.add(actual, actual, actual);
+  single.multiply_elementwise(expected, expected, expected);
+  multiple.multiply_elementwise(actual, actual, actual);
+  EXPECT_MATRIX_EQ(expected, actual);
+}
+
+TEST(opencl_multi_device_tests, weights_decide_the_split) {
+  device_pair pair;
+  if (!pair.available()) {
+    return;
+  }
+  vi::la::opencl_context single({pair.devices()[0]});
+  vi::la::opencl_context multiple(pair.devices());
+  ASSERT_EQ(2U, multiple.device_weights().size());
+  EXPECT_LT(0.0, multiple.device_weights()[0]);
+  EXPECT_LT(0.0, multiple.device_weights()[1]);
+
+  vi::la::matrix expected = sequence(single, 512U, 512U) * sequence(single, 512U, 512U);
+  for (const std::vector<double>& weights :
+       std::vector<std::vector<double>>{{1.0, 0.0}, {0.0, 1.0}, {1.0, 3.0}}) {
+    multiple.set_device_weights(weights);
+    EXPECT_EQ(weights, multiple.device_weights());
+    vi::la::matrix product = sequence(multiple, 512U, 512U) * sequence(multiple, 512U, 512U);
+    EXPECT_MATRIX_EQ(expected, product);
+  }
+
+  EXPECT_THROW(multiple.set_device_weights({1.0}), std::invalid_argument);
+  EXPECT_THROW(multiple.set_device_weights({0.0, 0.0}), std::invalid_argument);
+  EXPECT_THROW(multiple.set_device_weights({-1.0, 2.0}), std::invalid_argument);
+}
+
+TEST(opencl_multi_device_tests, single_device_has_unit_weight) {
+  std::vector<cl_device_id> devices = vi::la::opencl_context::supported_devices();
+  if (devices.empty()) {
+    return;
+  }
+  vi::la::opencl_context context({devices[0]});
+  EXPECT_EQ(1U, context.device_count());
+  EXPECT_EQ(std::vector<double>{1.0}, context.device_weights());
+  EXPECT_THROW(context.set_device_weights({1.0, 1.0}), std::invalid_argument);
+}
@@ -0,0 +1,143 @@
+#include "test.h"
+#include "vi/la/cpu/cpu_context.h"
+#include "vi/la/matrix.h"
+#include "vi/la/matrix_implementation.h"
+#include "vi/la/opencl/opencl_context.h"
+#include "vi/la/precision.h"
+
+#include <cmath>
+#include <limits>
+
+TEST(precision_tests, bytes_per_element) {
+  EXPECT_EQ(4U, vi::la::bytes_per_element(vi::la::precision::single));
+  EXPECT_EQ(2U, vi::la::bytes_per_element(vi::la::precision::bfloat16));
+  EXPECT_EQ(2U, vi::la::bytes_per_element(vi::la::precision::half));
+}
+
+TEST(precision_tests, bfloat16_round_trip) {
+  EXPECT_EQ(0x3f80U, vi::la::to_bfloat16(1.0f));
+  EXPECT_EQ(0xc000U, vi::la::to_bfloat16(-2.0f));
+  EXPECT_FLOAT_EQ(1.0f, vi::la::from_bfloat16(0x3f80U));
+  EXPECT_FLOAT_EQ(3.140625f, vi::la::from_bfloat16(vi::la::to_bfloat16(3.14159f)));
+}
+
+TEST(precision_tests, bfloat16_rounds_ties_to_even) {
+  // 1 + 2^-8 is halfway between 1 and 1 + 2^-7
+  EXPECT_EQ(0x3f80U, vi::la::to_bfloat16(1.00390625f));
+  // 1 + 3 * 2^-8 is halfway between 1 + 2^-7 and 1 + 2^-6
+  EXPECT_EQ(0x3f82U, vi::la::to_bfloat16(1.01171875f));
+}
+
+TEST(precision_tests, bfloat16_keeps_nan) {
+  EXPECT_TRUE(std::isnan(
+      vi::la::from_bfloat16(vi::la::to_bfloat16(std::numeric_limits<float>::quiet_NaN()))));
+}
+
+TEST(precision_tests, half_round_trip) {
+  EXPECT_EQ(0x3c00U, vi::la::to_half(1.0f));
+  EXPECT_EQ(0xc000U, vi::la::to_half(-2.0f));
+  EXPECT_EQ(0x7bffU, vi::la::to_half(65504.0f));
+  EXPECT_FLOAT_EQ(0.333251953125f, vi::la::from_half(vi::la::to_half(1.0f / 3.0f)));
+}
+
+TEST(precision_tests, half_overflows_to_infinity) {
+  EXPECT_EQ(0x7c00U, vi::la::to_half(65520.0f));
+  EXPECT_EQ(0xfc00U, vi::la::to_half(-1.0e6f));
+  EXPECT_TRUE(std::isinf(vi::la::from_half(vi::la::to_half(1.0e6f))));
+}
+
+TEST(precision_tests, half_subnormals) {
+  const float smallest_subnormal = std::ldexp(1.0f, -24);
+  EXPECT_EQ(0x0001U, vi::la::to_half(smallest_subnormal));
+  EXPECT_FLOAT_EQ(smallest_subnormal, vi::la::from_half(0x0001U));
+  EXPECT_EQ(0x0000U, vi::la::to_half(smallest_subnormal / 2.0f));
+  EXPECT_EQ(0x03ffU, vi::la::to_half(std::ldexp(1023.0f, -24)));
+}
+
+/// Host and device contexts storing operands in every reduced precision
+std::vector<vi::la::context*> reduced_precision_contexts() {
+  static std::vector<vi::la::context*> contexts = {};
+
+  if (contexts.size() == 0) {
+    for (vi::la::precision storage_precision :
+         {vi::la::precision::bfloat16, vi::la::precision::half}) {
+      contexts.push_back(new vi::la::cpu_context(storage_precision));
+      for (cl_device_id device_id : vi::la::opencl_context::supported_devices()) {
+        contexts.push_back(new vi::la::opencl_context({device_id}, storage_precision));
+      }
+    }
+  }
+
+  return contexts;
+}
+
+class precision_tests_multiply : public ::testing::TestWithParam<vi::la::context*> {};
+INSTANTIATE_TEST_CASE_P(context, precision_tests_multiply,
+                        ::testing::ValuesIn(reduced_precision_contexts()));
+
+TEST_P(precision_tests_multiply, multiply_exact_values) {
+  vi::la::context& context = *GetParam();
+  EXPECT_NE(vi::la::precision::single, context.storage_precision());
+
+  vi::la::matrix a(context, {{1.0, 2.0, 3.0}, {4.0, 5.0, 6.0}});
+  vi::la::matrix b(context, {{1.0, 2.0}, {3.0, 4.0}, {5.0, 6.0}});
+  vi::la::matrix expected(context, {{22.0, 28.0}, {49.0, 64.0}});
+  EXPECT_MATRIX_EQ(expected, a * b);
+}
+
+TEST_P(precision_tests_multiply, multiply_uses_written_operands) {
+  vi::la::context& context = *GetParam();
+  vi::la::matrix a(context, {{1.0, 2.0}, {3.0, 4.0}});
+  vi::la::matrix b(context, {{1.0, 0.0}, {0.0, 1.0}});
+  EXPECT_MATRIX_EQ(a, a * b);
+
+  // both operands change between the products
+  b[0][0] = 2.0f;
+  a[1][1] = 8.0f;
+  vi::la::matrix expected(context, {{2.0, 2.0}, {6.0, 8.0}});
+  EXPECT_MATRIX_EQ(expected, a * b);
+
+  // the product overwrites an operand
+  context.multiply(a, a, b);
+  EXPECT_MATRIX_EQ(expected, a);
+  EXPECT_MATRIX_EQ(vi::la::matrix(context, {{4.0, 2.0}, {12.0, 8.0}}), a * b);
+}
+
+TEST_P(precision_tests_multiply, packed_operand_kept_between_products) {
+  vi::la::context& context = *GetParam();
+  vi::la::matrix a(context, {{1.0, 2.0}, {3.0, 4.0}});
+  vi::la::matrix b(context, {{1.0, 0.0}, {0.0, 1.0}});
+  vi::la::allocation_tracker allocations;
+  EXPECT_MATRIX_EQ(a, a * b);
+  // the product and the packed copy of b
+  EXPECT_EQ(2U, allocations.statistics().allocation_count);
+
+  allocations.restart();
+  EXPECT_MATRIX_EQ(a, a * b);
+  EXPECT_EQ(1U, allocations.statistics().allocation_count);
+}
+
+TEST_P(precision_tests_multiply, multiply_close_to_single_precision) {
+  vi::la::cpu_context single_context;
+  vi::la::context& reduced_context = *GetParam();
+
+  const size_t size = 64U;
+  vi::la::matrix a(single_context, size, size);
+  vi::la::matrix b(single_context, size, size);
+  for (size_t row = 0U; row < size; ++row) {
+    for (size_t column = 0U; column < size; ++column) {
+      a[row][column] = std::sin(static_cast<float>(row * size + column));
+      b[row][column] = std::cos(static_cast<float>(row * size + column));
+    }
+  }
+  vi::la::matrix reduced_a(reduced_context, a[0], size, size);
+  vi::la::matrix reduced_b(reduced_context, b[0], size, size);
+
+  vi::la::matrix expected = a * b;
+  vi::la::matrix actual = reduced_a * reduced_b;
+  for (size_t row = 0U; row < size; ++row) {
+    for (size_t column = 0U; column < size; ++column) {
+      EXPECT_NEAR(expected[row][column], actual[row][column], 0.25f);
+    }
+  }
+}
@@ -0,0 +1,120 @@
+#include "test.h"
+#include "vi/la/context.h"
+#include "vi/la/cpu/cpu_context.h"
+#include "vi/la/matrix.h"
+#include "vi/la/profiler.h"
+#include "vi/la/sparse_matrix.h"
+
+#include <memory>
+#include <sstream>
+
+using vi::la::matrix;
+using vi::la::profiler;
+
+class profiler_tests : public ::testing::TestWithParam<vi::la::context*> {};
+INSTANTIATE_TEST_CASE_P(context, profiler_tests, ::testing::ValuesIn(test::all_contexts()));
+
+TEST_P(profiler_tests, records_operations) {
+  vi::la::context& context = *GetParam();
+  matrix operand_1(context, 4U, 3U, 1.0f);
+  matrix operand_2(context, 3U, 5U, 2.0f);
+
+  std::shared_ptr<profiler> recorder = std::make_shared<profiler>();
+  context.set_profiler(recorder);
+  matrix product = operand_1 * operand_2;
+  context.sigmoid(product);
+  context.set_profiler(nullptr);
+  matrix ignored = product + product;
+
+  bool multiplied = false;
+  bool activated = false;
+  for (const profiler::event& recorded : recorder->events()) {
+    if (recorded.name == "multiply") {
+      multiplied = true;
+      EXPECT_EQ(4U, recorded.rows);
+      EXPECT_EQ(5U, recorded.columns);
+      EXPECT_DOUBLE_EQ(2.0 * 4.0 * 5.0 * 3.0, recorded.flops);
+      EXPECT_DOUBLE_EQ((12.0 + 15.0 + 20.0) * sizeof(float), recorded.bytes);
+      EXPECT_GE(recorded.wall_seconds, 0.0);
+    }
+    activated = activated || recorded.name == "sigmoid";
+    EXPECT_NE("add", recorded.name);
+  }
+  EXPECT_TRUE(multiplied);
+  EXPECT_TRUE(activated);
+}
+
+TEST(profiler_tests, summaries_aggregate_calls) {
+  vi::la::cpu_context context;
+  std::shared_ptr<profiler> recorder = std::make_shared<profiler>();
+  context.set_profiler(recorder);
+  matrix values(context, 8U, 8U, 0.5f);
+  for (size_t i = 0U; i < 3U; ++i) {
+    context.sigmoid(values);
+  }
+  values = values * values;
+
+  const std::vector<profiler::summary> summaries = recorder->summaries();
+  ASSERT_EQ(2U, summaries.size());
+  for (const profiler::summary& operation : summaries) {
+    EXPECT_EQ(operation.name == "sigmoid" ? 3U : 1U, operation.calls);
+    EXPECT_EQ(0.0, operation.device_seconds);
+  }
+  EXPECT_GE(summaries[0].wall_seconds, summaries[1].wall_seconds);
+
+  recorder->clear();
+  EXPECT_TRUE(recorder->events().empty());
+}
+
+TEST(profiler_tests, counts_sparse_operand_bytes) {
+  vi::la::cpu_context context;
+  std::shared_ptr<profiler> recorder = std::make_shared<profiler>();
+  context.set_profiler(recorder);
+  const vi::la::sparse_matrix sparse(2U, 3U, {0U, 1U, 3U}, {2U, 0U, 1U}, {1.0f, 2.0f, 3.0f});
+  const matrix dense(context, 3U, 4U, 1.0f);
+  matrix product = sparse * dense;
+
+  ASSERT_EQ(1U, recorder->events().size());
+  const profiler::event& recorded = recorder->events()[0];
+  EXPECT_DOUBLE_EQ(2.0 * 3.0 * 4.0, recorded.flops);
+  EXPECT_EQ(3U * sizeof(float) + 3U * sizeof(uint32_t) + 3U * sizeof(size_t),
+            sparse.stored_bytes());
+  EXPECT_DOUBLE_EQ((8.0 + 12.0) * sizeof(float) + sparse.stored_bytes(), recorded.bytes);
+}
+
+TEST(profiler_tests, roofline_fraction) {
+  profiler recorder;
+  profiler::summary operation = {"multiply", 1U, 2.0, 0.0, 4e9, 1e9};
+  EXPECT_EQ(0.0, recorder.roofline_fraction(operation));
+
+  recorder.set_ceilings({4e9, 1e9});
+  // one second of arithmetic and one of memory traffic took two seconds
+  EXPECT_DOUBLE_EQ(0.5, recorder.roofline_fraction(operation));
+  // memory bound, device time is preferred over wall time
+  operation.bytes = 4e9;
+  operation.device_seconds = 8.0;
+  EXPECT_DOUBLE_EQ(0.5, recorder.roofline_fraction(operation));
+}
+
+TEST(profiler_tests, writes_trace_and_report) {
+  vi::la::cpu_context context;
+  std::shared_ptr<profiler> recorder = std::make_shared<profiler>();
+  context.set_profiler(recorder);
+  matrix values(context, 2U, 3U, 1.0f);
+  context.hyperbolic_tangent(values);
+  matrix transposed = values.transpose();
+
+  std::stringstream trace;
+  recorder->write_trace(trace);
+  EXPECT_EQ(0U, trace.str().find("{\"traceEvents\":["));
+  EXPECT_NE(std::string::npos,
+            trace.str().find("\"name\":\"hyperbolic_tangent\",\"cat\":\"la\",\"ph\":\"X\""));
+  EXPECT_NE(std::string::npos, trace.str().find("\"name\":\"transpose\""));
+  EXPECT_NE(std::string::npos, trace.str().find("\"rows\":3,\"columns\":2"));
+
+  std::stringstream report;
+  recorder->write_report(report);
+  EXPECT_EQ(0U, report.str().find("operation"));
+  EXPECT_NE(std::string::npos, report.str().find("\nhyperbolic_tangent "));
+  EXPECT_NE(std::string::npos, report.str().find("\ntranspose "));
+}
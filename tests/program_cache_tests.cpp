@@ -0,0 +1,120 @@
+#include "test.h"
+#include "vi/la/opencl/program_cache.h"
+
+#include <boost/filesystem.hpp>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using vi::la::opencl::program_cache;
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+class temporary_directory {
+public:
+  temporary_directory()
+      : _path(fs::temp_directory_path() / fs::unique_path("program_cache_%%%%%%%%")) {}
+  ~temporary_directory() {
+    boost::system::error_code error;
+    fs::remove_all(_path, error);
+  }
+
+  std::string path() const { return _path.string(); }
+
+private:
+  fs::path _path;
+};
+
+const std::string description = "device: test\ndriver: 1.0\noptions: \nsources: 0 bytes\n";
+const std::vector<unsigned char> binary = {0x7f, 'E', 'L', 'F', 1, 2, 3, 4, 5};
+}
+
+TEST(program_cache_tests, stored_binary_loads) {
+  temporary_directory directory;
+  program_cache cache(directory.path());
+  cache.store(description, binary);
+
+  std::vector<unsigned char> loaded;
+  EXPECT_TRUE(cache.load(description, loaded));
+  EXPECT_EQ(binary, loaded);
+}
+
+TEST(program_cache_tests, other_description_misses) {
+  temporary_directory directory;
+  program_cache cache(directory.path());
+  cache.store(description, binary);
+
+  std::vector<unsigned char> loaded;
+  EXPECT_FALSE(cache.load(description + "driver: 2.0\n", loaded));
+  EXPECT_TRUE(loaded.empty());
+}
+
+TEST(program_cache_tests, corrupted_entry_misses) {
+  temporary_directory directory;
+  program_cache cache(directory.path());
+  cache.store(description, binary);
+
+  for (fs::directory_iterator entry(directory.path()); entry != fs::directory_iterator();
+       ++entry) {
+    // last byte of the binary
+    std::fstream file(entry->path().string(), std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(-1, std::ios::end);
+    file.put('x');
+  }
+
+  std::vector<unsigned char> loaded;
+  EXPECT_FALSE(cache.load(description, loaded));
+}
+
+TEST(program_cache_tests, truncated_entry_misses) {
+  temporary_directory directory;
+  program_cache cache(directory.path());
+  cache.store(description, binary);
+
+  for (fs::directory_iterator entry(directory.path()); entry != fs::directory_iterator();
+       ++entry) {
+    fs::resize_file(entry->path(), fs::file_size(entry->path()) - 2U);
+  }
+
+  std::vector<unsigned char> loaded;
+  EXPECT_FALSE(cache.load(description, loaded));
+}
+
+TEST(program_cache_tests, empty_directory_disables_cache) {
+  program_cache cache("");
+  cache.store(description, binary);
+
+  std::vector<unsigned char> loaded;
+  EXPECT_FALSE(cache.load(description, loaded));
+}
+
+TEST(program_cache_tests, unwritable_directory_is_ignored) {
+  temporary_directory directory;
+  fs::create_directories(directory.path());
+  const std::string file_path = (fs::path(directory.path()) / "file").string();
+  std::ofstream(file_path) << "not a directory";
+
+  program_cache cache(file_path);
+  EXPECT_NO_THROW(cache.store(description, binary));
+  std::vector<unsigned char> loaded;
+  EXPECT_FALSE(cache.load(description, loaded));
+}
+
+TEST(program_cache_tests, environment_selects_default_directory) {
+  const char* previous = std::getenv("VINN_OPENCL_CACHE");
+  const std::string previous_value = previous != nullptr ? previous : "";
+
+  setenv("VINN_OPENCL_CACHE", "/tmp/kernels", 1);
+  EXPECT_EQ("/tmp/kernels", program_cache::default_directory());
+  setenv("VINN_OPENCL_CACHE", "", 1);
+  EXPECT_EQ("", program_cache::default_directory());
+
+  if (previous != nullptr) {
+    setenv("VINN_OPENCL_CACHE", previous_value.c_str(), 1);
+  } else {
+    unsetenv("VINN_OPENCL_CACHE");
+  }
+}
@@ -0,0 +1,99 @@
+#include "test.h"
+#include "vi/io/quantized_model_file.h"
+#include "vi/nn/activation_function.h"
+#include "vi/nn/network.h"
+#include "vi/nn/quantizer.h"
+
+#include <boost/filesystem.hpp>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+std::string temporary_path(const std::string& name) {
+  fs::path path(fs::temp_directory_path());
+  path /= name;
+  return path.string();
+}
+
+void overwrite_byte(const std::string& path, size_t offset) {
+  std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+  file.seekg(offset);
+  const char original = static_cast<char>(file.get());
+  file.seekp(offset);
+  file.put(static_cast<char>(original ^ 0x5a));
+}
+}
+
+class quantized_model_file_tests : public ::testing::TestWithParam<vi::la::context*> {
+protected:
+  void SetUp() {
+    _features = vi::la::matrix(*GetParam(), 32U, 6U);
+    for (size_t m = 0U; m < _features.row_count(); ++m) {
+      for (size_t n = 0U; n < _features.column_count(); ++n) {
+        _features[m][n] = std::sin(static_cast<float>(m * 6U + n));
+      }
+    }
+
+    vi::nn::network network;
+    network.add(std::make_shared<vi::nn::layer>(
+        *GetParam(), std::make_shared<vi::nn::sigmoid_activation>(), 10, 6));
+    network.add(std::make_shared<vi::nn::layer>(
+        *GetParam(), std::make_shared<vi::nn::softmax_activation>(), 3, 10));
+    vi::nn::quantizer quantizer(network);
+    quantizer.calibrate(_features);
+    _quantized = quantizer.quantize();
+  }
+
+  vi::la::matrix _features;
+  vi::nn::quantized_network _quantized;
+};
+
+INSTANTIATE_TEST_CASE_P(context, quantized_model_file_tests,
+                        ::testing::ValuesIn(test::all_contexts()));
+
+TEST_P(quantized_model_file_tests, round_trip) {
+  const std::string path = temporary_path("quantized_model_file_round_trip.qmodel");
+  vi::io::quantized_model_file(path).store(_quantized);
+
+  vi::nn::quantized_network loaded = vi::io::quantized_model_file(path).load();
+  ASSERT_EQ(_quantized.size(), loaded.size());
+  EXPECT_MATRIX_EQ(_quantized.forward(_features), loaded.forward(_features));
+  std::remove(path.c_str());
+}
+
+TEST_P(quantized_model_file_tests, truncated_file_fails) {
+  const std::string path = temporary_path("quantized_model_file_truncated.qmodel");
+  vi::io::quantized_model_file(path).store(_quantized);
+  fs::resize_file(path, fs::file_size(path) - 1U);
+
+  EXPECT_THROW(vi::io::quantized_model_file(path).load(), vi::io::quantized_model_file::exception);
+  std::remove(path.c_str());
+}
+
+TEST_P(quantized_model_file_tests, corrupted_data_fails) {
+  const std::string path = temporary_path("quantized_model_file_corrupted.qmodel");
+  vi::io::quantized_model_file(path).store(_quantized);
+  overwrite_byte(path, fs::file_size(path) - 1U);
+
+  EXPECT_THROW(vi::io::quantized_model_file(path).load(), vi::io::quantized_model_file::exception);
+  std::remove(path.c_str());
+}
+
+TEST_P(quantized_model_file_tests, other_file_fails) {
+  const std::string path = temporary_path("quantized_model_file_other.qmodel");
+  vi::io::quantized_model_file(path).store(_quantized);
+  overwrite_byte(path, 0U);
+
+  EXPECT_THROW(vi::io::quantized_model_file(path).load(), vi::io::quantized_model_file::exception);
+  std::remove(path.c_str());
+}
+
+TEST(quantized_model_file, missing_file_fails) {
+  EXPECT_THROW(vi::io::quantized_model_file(temporary_path("quantized_model_file_missing")).load(),
+               vi::io::quantized_model_file::exception);
+}
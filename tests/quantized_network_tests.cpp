@@ -0,0 +1,170 @@
+#include "test.h"
+#include "vi/la/cpu/int8_multiply.h"
+#include "vi/nn/activation_function.h"
+#include "vi/nn/batch_gradient_descent.h"
+#include "vi/nn/cost_function.h"
+#include "vi/nn/label_map.h"
+#include "vi/nn/network.h"
+#include "vi/nn/quantizer.h"
+#include "vi/nn/result_measurements.h"
+
+#include <cmath>
+
+using vi::la::matrix;
+using vi::nn::layer;
+using vi::nn::network;
+
+TEST(int8_multiply_tests, instruction_sets_match_scalar) {
+  const size_t m = 5U;
+  const size_t n = 7U;
+  const size_t k = 2U * vi::la::cpu::int8_block_size;
+  std::vector<uint8_t> operand_1(m * k);
+  std::vector<int8_t> operand_2(n * k);
+  for (size_t i = 0U; i < operand_1.size(); ++i) {
+    operand_1[i] = static_cast<uint8_t>((i * 37U) % 256U);
+  }
+  for (size_t i = 0U; i < operand_2.size(); ++i) {
+    operand_2[i] = static_cast<int8_t>(static_cast<int>((i * 53U) % 255U) - 127);
+  }
+
+  std::vector<int32_t> expected(m * n);
+  vi::la::cpu::multiply_u8s8(expected.data(), operand_1.data(), operand_2.data(), m, n, k,
+                             vi::la::cpu::int8_instruction_set::scalar);
+
+  const vi::la::cpu::int8_instruction_set instruction_sets[] = {
+      vi::la::cpu::int8_instruction_set::avx2, vi::la::cpu::int8_instruction_set::avx_vnni,
+      vi::la::cpu::int8_instruction_set::avx512_vnni};
+  for (vi::la::cpu::int8_instruction_set instruction_set : instruction_sets) {
+    std::vector<int32_t> actual(m * n);
+    vi::la::cpu::multiply_u8s8(actual.data(), operand_1.data(), operand_2.data(), m, n, k,
+                               instruction_set);
+    EXPECT_EQ(expected, actual) << vi::la::cpu::int8_instruction_set_name(instruction_set);
+  }
+}
+
+TEST(quantization_parameters_tests, range_includes_zero) {
+  vi::nn::quantization_parameters parameters =
+      vi::nn::quantization_parameters::for_range(2.0f, 255.0f);
+  EXPECT_FLOAT_EQ(1.0f, parameters.scale());
+  EXPECT_EQ(0, parameters.zero_point());
+  EXPECT_EQ(0U, parameters.quantize(-1.0f));
+  EXPECT_EQ(255U, parameters.quantize(1000.0f));
+}
+
+TEST(quantization_parameters_tests, round_trip) {
+  vi::nn::quantization_parameters parameters =
+      vi::nn::quantization_parameters::for_range(-1.0f, 1.0f);
+  EXPECT_EQ(127, parameters.zero_point());
+  EXPECT_NEAR(0.0f, parameters.dequantize(parameters.quantize(0.0f)), parameters.scale() / 2.0f);
+  EXPECT_NEAR(0.5f, parameters.dequantize(parameters.quantize(0.5f)), parameters.scale() / 2.0f);
+  EXPECT_NEAR(-0.9f, parameters.dequantize(parameters.quantize(-0.9f)), parameters.scale() / 2.0f);
+}
+
+class quantized_network_tests : public ::testing::TestWithParam<vi::la::context*> {
+protected:
+  /// two classes separated along every feature, examples from different first_example
+  /// values have different noise so that they can be held out
+  void create_examples(vi::la::context& context, size_t example_count,
+                       size_t first_example = 0U) {
+    _features = matrix(context, example_count, 8U);
+    _targets = matrix(context, example_count, 2U, 0.0f);
+    _labels = matrix(context, example_count, 1U);
+    for (size_t m = 0U; m < example_count; ++m) {
+      const size_t label = m % 2U;
+      for (size_t n = 0U; n < 8U; ++n) {
+        const float noise = std::sin(static_cast<float>((first_example + m) * 8U + n));
+        _features[m][n] = (label == 0U ? -1.0f : 1.0f) + noise;
+      }
+      _targets[m][label] = 1.0f;
+      _labels[m][0] = label;
+    }
+  }
+
+  matrix _features;
+  matrix _targets;
+  matrix _labels;
+};
+
+INSTANTIATE_TEST_CASE_P(context, quantized_network_tests,
+                        ::testing::ValuesIn(test::all_contexts()));
+
+TEST_P(quantized_network_tests, quantize_without_calibration_fails) {
+  network network;
+  network.add(
+      std::make_shared<layer>(*GetParam(), std::make_shared<vi::nn::sigmoid_activation>(), 4, 8));
+
+  vi::nn::quantizer quantizer(network);
+  EXPECT_THROW(quantizer.quantize(), vi::nn::invalid_configuration);
+}
+
+TEST_P(quantized_network_tests, forward_matches_single_precision) {
+  network network;
+  network.add(
+      std::make_shared<layer>(*GetParam(), std::make_shared<vi::nn::sigmoid_activation>(), 40, 8));
+  network.add(
+      std::make_shared<layer>(*GetParam(), std::make_shared<vi::nn::hyperbolic_tangent>(), 20, 40));
+  network.add(
+      std::make_shared<layer>(*GetParam(), std::make_shared<vi::nn::softmax_activation>(), 2, 20));
+  create_examples(*GetParam(), 64U);
+
+  vi::nn::quantizer quantizer(network);
+  quantizer.calibrate(_features);
+  vi::nn::quantized_network quantized = quantizer.quantize();
+  ASSERT_EQ(3U, quantized.size());
+
+  matrix expected = network.forward(_features);
+  matrix actual = quantized.forward(_features);
+  ASSERT_EQ(expected.size(), actual.size());
+  for (size_t m = 0U; m < expected.row_count(); ++m) {
+    for (size_t n = 0U; n < expected.column_count(); ++n) {
+      EXPECT_NEAR(expected[m][n], actual[m][n], 0.05f);
+    }
+  }
+}
+
+TEST_P(quantized_network_tests, quantizer_keeps_layers_it_was_created_with) {
+  network network;
+  network.add(
+      std::make_shared<layer>(*GetParam(), std::make_shared<vi::nn::sigmoid_activation>(), 16, 8));
+  network.add(
+      std::make_shared<layer>(*GetParam(), std::make_shared<vi::nn::softmax_activation>(), 2, 16));
+  create_examples(*GetParam(), 64U);
+
+  vi::nn::quantizer quantizer(network);
+  quantizer.calibrate(_features);
+  matrix expected = quantizer.quantize().forward(_features);
+
+  vi::nn::cross_entropy_cost cost_function;
+  vi::nn::batch_gradient_descent trainer(10U, 0.5f);
+  trainer.train(network, _features, _targets, cost_function);
+  EXPECT_MATRIX_EQ(expected, quantizer.quantize().forward(_features));
+}
+
+TEST_P(quantized_network_tests, held_out_accuracy_close_to_single_precision) {
+  network network;
+  network.add(
+      std::make_shared<layer>(*GetParam(), std::make_shared<vi::nn::sigmoid_activation>(), 16, 8));
+  network.add(
+      std::make_shared<layer>(*GetParam(), std::make_shared<vi::nn::softmax_activation>(), 2, 16));
+  create_examples(*GetParam(), 200U);
+
+  vi::nn::cross_entropy_cost cost_function;
+  vi::nn::batch_gradient_descent trainer(50U, 0.5f);
+  trainer.train(network, _features, _targets, cost_function);
+  vi::nn::quantizer quantizer(network);
+  quantizer.calibrate(_features);
+  vi::nn::quantized_network quantized = quantizer.quantize();
+
+  // both networks are measured against the labels of examples seen by neither
+  create_examples(*GetParam(), 200U, 200U);
+  vi::nn::label_map labels(2U);
+  vi::nn::result_measurements fp32_measurements(*GetParam(), labels.labels());
+  fp32_measurements.add_results(_labels, labels.activations_to_labels(network.forward(_features)));
+  vi::nn::result_measurements int8_measurements(*GetParam(), labels.labels());
+  int8_measurements.add_results(_labels,
+                                labels.activations_to_labels(quantized.forward(_features)));
+
+  EXPECT_LT(0.9f, fp32_measurements.accuracy());
+  EXPECT_LT(0.9f, int8_measurements.accuracy());
+  EXPECT_NEAR(fp32_measurements.accuracy(), int8_measurements.accuracy(), 0.02f);
+}
@@ -80,3 +80,23 @@ TEST_P(result_measurements_tests, matrix_results_all_correct) {
   EXPECT_FLOAT_EQ(1.0, measures.recall());
   EXPECT_FLOAT_EQ(1.0, measures.fscore());
 }
+
+TEST_P(result_measurements_tests, added_counts_are_exact) {
+  // more predictions than a float can count one by one
+  const uint64_t many = (uint64_t(1) << 24) + 1U;
+  result_measurements measures(*GetParam(), labels);
+  measures.add_counts({many, 0U, 1U, many});
+  measures.add_results(expected, {Cat, Dog});
+
+  EXPECT_FLOAT_EQ(1.0f - 1.0f / (2.0f * many + 3.0f), measures.accuracy());
+  EXPECT_EQ(many + 1U, measures.confusion_table_for_label(Cat).true_positives());
+  EXPECT_EQ(1U, measures.confusion_table_for_label(Cat).false_positives());
+  EXPECT_THROW(measures.add_counts({1U}), std::invalid_argument);
+}
+
+TEST_P(result_measurements_tests, label_indices_follow_labels) {
+  result_measurements measures(*GetParam(), {7, -2, 5});
+  EXPECT_EQ(0U, measures.label_index_for_label(7));
+  EXPECT_EQ(1U, measures.label_index_for_label(-2));
+  EXPECT_EQ(2U, measures.label_index_for_label(5));
+}
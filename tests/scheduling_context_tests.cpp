@@ -0,0 +1,182 @@
+#include "test.h"
+#include "vi/la/cpu/cpu_context.h"
+#include "vi/la/matrix.h"
+#include "vi/la/scheduling/scheduling_context.h"
+
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using vi::la::matrix;
+using vi::la::scheduling::backend;
+using vi::la::scheduling::cost_model;
+using vi::la::scheduling::operation;
+
+namespace {
+
+/// Model predicting every operation to take the given seconds per unit of work
+/// on each backend, copies between them are nearly free
+cost_model constant_model(double host_seconds_per_work, double device_seconds_per_work) {
+  cost_model model;
+  for (size_t kind = 0U; kind <= static_cast<size_t>(operation::convolution); ++kind) {
+    for (double work : {1.0, 1000.0}) {
+      model.record(backend::host, static_cast<operation>(kind), work,
+                   host_seconds_per_work * work);
+      model.record(backend::device, static_cast<operation>(kind), work,
+                   device_seconds_per_work * work);
+    }
+  }
+  model.record_transfer(1U, 1e-15);
+  model.record_transfer(1000U, 1e-12);
+  return model;
+}
+
+matrix sequence(vi::la::context& context, size_t rows, size_t columns) {
+  matrix values(context, rows, columns, 0.0f);
+  for (size_t row = 0U; row < rows; ++row) {
+    for (size_t column = 0U; column < columns; ++column) {
+      values[row][column] = static_cast<float>((row * 5U + column * 3U) % 17U) / 17.0f;
+    }
+  }
+  return values;
+}
+}
+
+TEST(scheduling_context_tests, runs_on_faster_backend) {
+  vi::la::cpu_context host;
+  vi::la::cpu_context device;
+  vi::la::scheduling_context host_favored(host, device, constant_model(1e-9, 1e-6));
+  vi::la::scheduling_context device_favored(host, device, constant_model(1e-6, 1e-9));
+
+  matrix on_host = sequence(host_favored, 8U, 8U) + sequence(host_favored, 8U, 8U);
+  matrix on_device = sequence(device_favored, 8U, 8U) + sequence(device_favored, 8U, 8U);
+  EXPECT_MATRIX_EQ(sequence(host, 8U, 8U) * 2.0f, on_host);
+  EXPECT_MATRIX_EQ(sequence(host, 8U, 8U) * 2.0f, on_device);
+
+  EXPECT_EQ(1U, host_favored.counters().host_operations);
+  EXPECT_EQ(0U, host_favored.counters().device_operations);
+  EXPECT_EQ(0U, device_favored.counters().host_operations);
+  EXPECT_EQ(1U, device_favored.counters().device_operations);
+  // both operands went to the device and the sum came back to compare it
+  EXPECT_EQ(3U * 8U * 8U * sizeof(float), device_favored.counters().copied_bytes);
+}
+
+TEST(scheduling_context_tests, copies_stale_values) {
+  vi::la::cpu_context host;
+  vi::la::cpu_context device;
+  vi::la::scheduling_context context(host, device, constant_model(1e-6, 1e-9));
+
+  matrix values = sequence(context, 4U, 6U);
+  context.sigmoid(values);
+  // written on the host while the device copy holds the sigmoid
+  values[1][2] = 10.0f;
+  context.hyperbolic_tangent(values);
+
+  matrix expected = sequence(host, 4U, 6U);
+  host.sigmoid(expected);
+  expected[1][2] = 10.0f;
+  host.hyperbolic_tangent(expected);
+  EXPECT_MATRIX_EQ(expected, values);
+  EXPECT_MATRIX_EQ(host.sum_rows(expected), context.sum_rows(values));
+}
+
+TEST(scheduling_context_tests, reading_values_keeps_device_copy) {
+  vi::la::cpu_context host;
+  vi::la::cpu_context device;
+  vi::la::scheduling_context context(host, device, constant_model(1e-6, 1e-9));
+  const size_t byte_count = 4U * 6U * sizeof(float);
+
+  matrix values = sequence(context, 4U, 6U);
+  context.sigmoid(values);
+  const size_t copied_bytes = context.counters().copied_bytes;
+  matrix expected = sequence(host, 4U, 6U);
+  host.sigmoid(expected);
+  EXPECT_MATRIX_EQ(expected, values);
+  EXPECT_EQ(copied_bytes + byte_count, context.counters().copied_bytes);
+
+  // the device copy is still current, so it is not copied back
+  context.hyperbolic_tangent(values);
+  EXPECT_EQ(copied_bytes + byte_count, context.counters().copied_bytes);
+}
+
+TEST(scheduling_context_tests, concurrent_reads_copy_once) {
+  vi::la::cpu_context host;
+  vi::la::cpu_context device;
+  vi::la::scheduling_context context(host, device, constant_model(1e-6, 1e-9));
+
+  const matrix shared = sequence(context, 16U, 16U);
+  std::vector<matrix> results(8U);
+  std::vector<std::thread> threads;
+  for (matrix& result : results) {
+    threads.emplace_back([&shared, &result]() { result = shared * 2.0f; });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  // the shared operand went to the device once, however many threads read it
+  EXPECT_EQ(16U * 16U * sizeof(float), context.counters().copied_bytes);
+  for (const matrix& result : results) {
+    EXPECT_MATRIX_EQ(sequence(host, 16U, 16U) * 2.0f, result);
+  }
+}
+
+TEST(scheduling_context_tests, splits_large_products) {
+  vi::la::cpu_context host;
+  vi::la::cpu_context device;
+  vi::la::scheduling_context context(host, device, constant_model(1e-9, 1e-9));
+
+  matrix product = sequence(context, 203U, 150U) * sequence(context, 150U, 160U);
+  EXPECT_EQ(1U, context.counters().split_operations);
+  EXPECT_MATRIX_EQ(sequence(host, 203U, 150U) * sequence(host, 150U, 160U), product);
+
+  // a small product is not worth splitting
+  matrix small_product = sequence(context, 8U, 8U) * sequence(context, 8U, 8U);
+  EXPECT_EQ(1U, context.counters().split_operations);
+  EXPECT_MATRIX_EQ(sequence(host, 8U, 8U) * sequence(host, 8U, 8U), small_product);
+}
+
+TEST(scheduling_context_tests, splits_products_of_device_operands) {
+  vi::la::cpu_context host;
+  vi::la::cpu_context device;
+  cost_model model = constant_model(1e-9, 1e-9);
+  for (size_t i = 0U; i < 1000U; ++i) {
+    model.record(backend::device, operation::transcendental, 1.0, 1e-15);
+    model.record(backend::device, operation::transcendental, 1000.0, 1e-12);
+  }
+  vi::la::scheduling_context context(host, device, model);
+
+  // the sigmoid leaves the first operand current on the device only
+  matrix operand_1 = sequence(context, 256U, 128U);
+  context.sigmoid(operand_1);
+  EXPECT_EQ(1U, context.counters().device_operations);
+  matrix product = operand_1 * sequence(context, 128U, 256U);
+  EXPECT_EQ(1U, context.counters().split_operations);
+
+  matrix expected = sequence(host, 256U, 128U);
+  host.sigmoid(expected);
+  EXPECT_MATRIX_EQ(expected * sequence(host, 128U, 256U), product);
+}
+
+TEST(scheduling_context_tests, measures_operations) {
+  vi::la::cpu_context host;
+  vi::la::cpu_context device;
+  vi::la::scheduling_context context(host, device);
+  EXPECT_FALSE(context.model().empty());
+  const cost_model calibrated = context.model();
+
+  // the product runs on one of the backends and updates its prediction
+  matrix product = sequence(context, 64U, 64U) * sequence(context, 64U, 64U);
+  const cost_model updated = context.model();
+  EXPECT_TRUE(calibrated.predict(backend::host, operation::multiply, 1e6) !=
+                  updated.predict(backend::host, operation::multiply, 1e6) ||
+              calibrated.predict(backend::device, operation::multiply, 1e6) !=
+                  updated.predict(backend::device, operation::multiply, 1e6));
+  EXPECT_MATRIX_EQ(sequence(host, 64U, 64U) * sequence(host, 64U, 64U), product);
+}
+
+TEST(scheduling_context_tests, storage_precisions_must_match) {
+  vi::la::cpu_context host;
+  vi::la::cpu_context device(vi::la::precision::bfloat16);
+  EXPECT_THROW(vi::la::scheduling_context(host, device), std::invalid_argument);
+}
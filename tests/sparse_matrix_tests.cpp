@@ -0,0 +1,128 @@
+#include "test.h"
+#include "vi/la/sparse_matrix.h"
+
+#include <memory>
+
+using vi::la::matrix;
+using vi::la::sparse_matrix;
+
+class sparse_matrix_tests : public ::testing::TestWithParam<vi::la::context*> {};
+INSTANTIATE_TEST_CASE_P(context, sparse_matrix_tests, ::testing::ValuesIn(test::all_contexts()));
+
+TEST_P(sparse_matrix_tests, default_constructed_is_empty) {
+  sparse_matrix m;
+
+  EXPECT_EQ(0U, m.row_count());
+  EXPECT_EQ(0U, m.column_count());
+  EXPECT_EQ(0U, m.non_zero_count());
+  EXPECT_EQ(std::vector<size_t>({0U}), m.row_offsets());
+}
+
+TEST_P(sparse_matrix_tests, to_dense_fills_missing_values_with_zeros) {
+  sparse_matrix m(3U, 4U, {0U, 2U, 2U, 3U}, {0U, 3U, 1U}, {1.0f, 2.0f, 3.0f});
+
+  matrix expected(*GetParam(), {{1.0f, 0.0f, 0.0f, 2.0f}, {0.0f, 0.0f, 0.0f, 0.0f},
+                                {0.0f, 3.0f, 0.0f, 0.0f}});
+  EXPECT_MATRIX_EQ(expected, m.to_dense(*GetParam()));
+  EXPECT_EQ(3U, m.non_zero_count());
+}
+
+TEST_P(sparse_matrix_tests, construct_with_mismatching_offsets_throws) {
+  EXPECT_THROW(sparse_matrix(2U, 4U, {0U, 2U}, {0U, 3U}, {1.0f, 2.0f}),
+               vi::la::incompatible_dimensions);
+  EXPECT_THROW(sparse_matrix(1U, 4U, {0U, 3U}, {0U, 3U}, {1.0f, 2.0f}),
+               vi::la::incompatible_dimensions);
+  EXPECT_THROW(sparse_matrix(2U, 4U, {0U, 2U, 1U}, {0U}, {1.0f}),
+               vi::la::incompatible_dimensions);
+}
+
+TEST_P(sparse_matrix_tests, construct_with_column_out_of_range_throws) {
+  EXPECT_THROW(sparse_matrix(1U, 4U, {0U, 1U}, {4U}, {1.0f}), vi::la::incompatible_dimensions);
+}
+
+TEST_P(sparse_matrix_tests, transpose_swaps_rows_and_columns) {
+  sparse_matrix m(2U, 3U, {0U, 2U, 3U}, {0U, 2U, 1U}, {1.0f, 2.0f, 3.0f});
+
+  sparse_matrix transposed = m.transpose();
+
+  EXPECT_EQ(3U, transposed.row_count());
+  EXPECT_EQ(2U, transposed.column_count());
+  EXPECT_EQ(std::vector<size_t>({0U, 1U, 2U, 3U}), transposed.row_offsets());
+  EXPECT_EQ(std::vector<uint32_t>({0U, 1U, 0U}), transposed.column_indices());
+  EXPECT_EQ(std::vector<float>({1.0f, 3.0f, 2.0f}), transposed.values());
+}
+
+TEST_P(sparse_matrix_tests, device_copies_are_made_once_per_owner) {
+  sparse_matrix m(2U, 3U, {0U, 2U, 3U}, {0U, 2U, 1U}, {1.0f, 2.0f, 3.0f});
+  size_t created = 0U;
+  const sparse_matrix::device_copy_factory create = [&created]() {
+    ++created;
+    return std::unique_ptr<sparse_matrix::device_copy>(new sparse_matrix::device_copy);
+  };
+
+  const sparse_matrix::device_copy* first = &m.device_copy_for(1U, create);
+  EXPECT_EQ(first, &m.device_copy_for(1U, create));
+  const sparse_matrix copied = m;
+  EXPECT_EQ(first, &copied.device_copy_for(1U, create));
+  EXPECT_EQ(1U, created);
+
+  EXPECT_NE(first, &m.device_copy_for(2U, create));
+  EXPECT_EQ(2U, created);
+}
+
+TEST_P(sparse_matrix_tests, multiply_matches_dense_product) {
+  sparse_matrix a(3U, 4U, {0U, 2U, 2U, 5U}, {0U, 3U, 1U, 2U, 3U},
+                  {1.0f, 2.0f, -1.0f, 0.5f, 4.0f});
+  matrix b(*GetParam(), {{1.0f, 2.0f}, {3.0f, 4.0f}, {5.0f, 6.0f}, {7.0f, 8.0f}});
+
+  matrix expected = a.to_dense(*GetParam()) * b;
+  EXPECT_MATRIX_EQ(expected, a * b);
+}
+
+TEST_P(sparse_matrix_tests, transpose_multiply_matches_dense_product) {
+  sparse_matrix a(3U, 4U, {0U, 2U, 2U, 5U}, {0U, 3U, 1U, 2U, 3U},
+                  {1.0f, 2.0f, -1.0f, 0.5f, 4.0f});
+  matrix b(*GetParam(), {{1.0f, 2.0f}, {3.0f, 4.0f}, {5.0f, 6.0f}});
+
+  matrix expected = a.to_dense(*GetParam()).transpose() * b;
+  EXPECT_MATRIX_EQ(expected, a.transpose_multiply(b));
+}
+
+TEST_P(sparse_matrix_tests, large_products_match_dense_products) {
+  // enough work to be split across threads
+  const size_t row_count = 300U;
+  const size_t column_count = 500U;
+  std::vector<size_t> offsets(1U, 0U);
+  std::vector<uint32_t> columns;
+  std::vector<float> values;
+  for (size_t m = 0U; m < row_count; ++m) {
+    for (size_t n = m % 7U; n < column_count; n += 5U + m % 11U) {
+      columns.push_back(static_cast<uint32_t>(n));
+      values.push_back(static_cast<float>((m + n) % 9U) - 4.0f);
+    }
+    offsets.push_back(columns.size());
+  }
+  sparse_matrix a(row_count, column_count, offsets, columns, values);
+  matrix b(*GetParam(), column_count, 64U);
+  matrix c(*GetParam(), row_count, 64U);
+  for (size_t n = 0U; n < 64U; ++n) {
+    for (size_t m = 0U; m < column_count; ++m) {
+      b[m][n] = static_cast<float>((m * 3U + n) % 5U) * 0.5f;
+    }
+    for (size_t m = 0U; m < row_count; ++m) {
+      c[m][n] = static_cast<float>((m + n * 7U) % 3U);
+    }
+  }
+
+  const matrix dense = a.to_dense(*GetParam());
+  EXPECT_MATRIX_EQ(dense * b, a * b);
+  EXPECT_MATRIX_EQ(dense.transpose() * c, a.transpose_multiply(c));
+}
+
+TEST_P(sparse_matrix_tests, multiply_with_incompatible_dimensions_throws) {
+  sparse_matrix a(2U, 3U, {0U, 1U, 1U}, {2U}, {1.0f});
+  matrix b(*GetParam(), 2U, 2U);
+
+  EXPECT_THROW(a * b, vi::la::incompatible_dimensions);
+  EXPECT_THROW(a.transpose_multiply(matrix(*GetParam(), 3U, 2U)), vi::la::incompatible_dimensions);
+}
@@ -5,6 +5,7 @@
 #include "vi/la/opencl/opencl_builder.h"
 #include "vi/la/opencl/disk_source_loader.h"
 #include "vi/la/opencl/opencl_ostream.h"
+#include "vi/la/scheduling/scheduling_context.h"
 
 #include <algorithm>
 
@@ -19,11 +20,14 @@ std::vector<vi::la::context*> all_contexts() {
   static std::vector<vi::la::context*> contexts = {};
 
   if (contexts.size() == 0) {
-    contexts.push_back(new vi::la::cpu_context());
+    vi::la::cpu_context* host = new vi::la::cpu_context();
+    contexts.push_back(host);
 
     std::vector<cl_device_id> device_ids = vi::la::opencl_context::supported_devices();
     for (cl_device_id device_id : device_ids) {
-      contexts.push_back(new vi::la::opencl_context({device_id}));
+      vi::la::opencl_context* device = new vi::la::opencl_context({device_id});
+      contexts.push_back(device);
+      contexts.push_back(new vi::la::scheduling_context(*host, *device));
     }
   }
 
@@ -43,15 +47,20 @@ std::vector<vi::la::context*> all_contexts() {
            << actual.column_count();
   }
 
+  // read only, so that comparing does not copy device values back to the device
+  const float* expected_values = expected.values();
+  const float* actual_values = actual.values();
   for (size_t m = 0U; m < expected.row_count(); ++m) {
     for (size_t n = 0U; n < expected.column_count(); ++n) {
+      const size_t index = m * expected.column_count() + n;
       // using googletest internals, but this class has not changed in years
-      const ::testing::internal::FloatingPoint<float> lhs(expected[m][n]), rhs(actual[m][n]);
+      const ::testing::internal::FloatingPoint<float> lhs(expected_values[index]),
+          rhs(actual_values[index]);
       if (!lhs.AlmostEquals(rhs)) {
         return ::testing::AssertionFailure()
                << "Matrices \"" << expected_expression << "\" and \"" << actual_expression
                << "\" are not equal - elements at " << m << "," << n
-               << " differ: " << expected[m][n] << " != " << actual[m][n];
+               << " differ: " << expected_values[index] << " != " << actual_values[index];
       }
     }
   }
@@ -0,0 +1,59 @@
+#include "test.h"
+#include "vi/io/text_parser.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<std::string> blocks_of(std::istream& stream, size_t block_size) {
+  vi::io::line_reader lines(stream, block_size);
+  std::vector<std::string> blocks;
+  vi::io::text_range block;
+  while (lines.next_lines(block)) {
+    blocks.push_back(std::string(block.first, block.second));
+  }
+  return blocks;
+}
+}
+
+TEST(text_parser_tests, next_lines_hands_out_whole_lines) {
+  std::stringstream stream("1,2\n3,4\n5,6\n7,8");
+  const std::vector<std::string> blocks = blocks_of(stream, 6U);
+
+  std::string joined;
+  for (const std::string& block : blocks) {
+    EXPECT_FALSE(block.empty());
+    if (&block != &blocks.back()) {
+      EXPECT_EQ('\n', block.back());
+    }
+    joined += block;
+  }
+  EXPECT_LT(1U, blocks.size());
+  EXPECT_EQ("1,2\n3,4\n5,6\n7,8", joined);
+}
+
+TEST(text_parser_tests, next_lines_grows_for_long_lines) {
+  const std::string line(100U, 'x');
+  std::stringstream stream(line + "\n" + line + "\n");
+  const std::vector<std::string> blocks = blocks_of(stream, 8U);
+
+  ASSERT_EQ(2U, blocks.size());
+  EXPECT_EQ(line + "\n", blocks[0]);
+  EXPECT_EQ(line + "\n", blocks[1]);
+}
+
+TEST(text_parser_tests, rewind_returns_to_start_position) {
+  std::stringstream stream("header\n1\n2\n");
+  std::string header;
+  std::getline(stream, header);
+  vi::io::line_reader lines(stream, 4U);
+
+  vi::io::text_range line;
+  ASSERT_TRUE(lines.next(line));
+  EXPECT_EQ("1", std::string(line.first, line.second));
+  lines.rewind();
+  ASSERT_TRUE(lines.next(line));
+  EXPECT_EQ("1", std::string(line.first, line.second));
+}
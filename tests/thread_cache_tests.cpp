@@ -0,0 +1,72 @@
+#include "test.h"
+#include "vi/la/thread_cache.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+/// Counts the live values
+class counted {
+public:
+  counted() { ++live; }
+  ~counted() { --live; }
+
+  static std::atomic<int> live;
+};
+
+std::atomic<int> counted::live(0);
+
+std::unique_ptr<counted> create() { return std::unique_ptr<counted>(new counted); }
+}
+
+TEST(thread_cache_tests, value_per_thread) {
+  vi::la::thread_cache<counted> cache;
+  counted* main_value = &cache.local(create);
+  EXPECT_EQ(main_value, &cache.local(create));
+
+  counted* other_value = nullptr;
+  std::thread other([&]() { other_value = &cache.local(create); });
+  other.join();
+  EXPECT_NE(main_value, other_value);
+}
+
+TEST(thread_cache_tests, values_released_when_thread_exits) {
+  const int live = counted::live;
+  vi::la::thread_cache<counted> cache;
+  std::thread other([&]() {
+    cache.local(create);
+    EXPECT_EQ(live + 1, counted::live);
+  });
+  other.join();
+  EXPECT_EQ(live, counted::live);
+}
+
+TEST(thread_cache_tests, values_released_when_cache_destroyed) {
+  const int live = counted::live;
+  std::unique_ptr<vi::la::thread_cache<counted>> destroyed(new vi::la::thread_cache<counted>);
+  destroyed->local(create);
+
+  // the other thread exits after the cache is gone
+  std::mutex mutex;
+  std::unique_lock<std::mutex> holding(mutex);
+  std::thread other([&]() {
+    destroyed->local(create);
+    std::lock_guard<std::mutex> wait(mutex);
+  });
+  while (counted::live != live + 2) {
+    std::this_thread::yield();
+  }
+  destroyed.reset();
+  EXPECT_EQ(live, counted::live);
+  holding.unlock();
+  other.join();
+  EXPECT_EQ(live, counted::live);
+
+  // a new cache does not find the values of the destroyed one
+  vi::la::thread_cache<counted> cache;
+  cache.local(create);
+  EXPECT_EQ(live + 1, counted::live);
+}
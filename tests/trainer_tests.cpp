@@ -3,6 +3,7 @@
 #include "vi/nn/activation_function.h"
 #include "vi/nn/cost_function.h"
 #include "vi/nn/l2_regularizer.h"
+#include "vi/nn/loss_scaler.h"
 #include "vi/nn/network.h"
 #include "vi/nn/trainer.h"
 
@@ -82,6 +83,90 @@ TEST_P(trainer_tests, train_stops_training_early) {
   EXPECT_EQ(1U, early_stopping_called);
 }
 
+namespace {
+
+/// Keeps the statistics of every epoch
+class recorded_epochs : public vi::nn::training_telemetry {
+public:
+  void operator()(const vi::nn::epoch_statistics& statistics) { epochs.push_back(statistics); }
+
+  std::vector<vi::nn::epoch_statistics> epochs;
+};
+}
+
+TEST_P(trainer_tests, train_reports_telemetry) {
+  std::shared_ptr<recorded_epochs> recorder = std::make_shared<recorded_epochs>();
+  const recorded_epochs& telemetry = *recorder;
+  _trainer->set_telemetry(recorder);
+  float final_cost = _trainer->train(*_network, *_features, *_targets, _cost_function);
+  _trainer->set_telemetry(nullptr);
+
+  ASSERT_EQ(_max_epochs, telemetry.epochs.size());
+  for (size_t i = 0U; i < telemetry.epochs.size(); ++i) {
+    const vi::nn::epoch_statistics& epoch = telemetry.epochs[i];
+    EXPECT_EQ(i + 1U, epoch.epoch);
+    EXPECT_EQ(100U, epoch.example_count);
+    EXPECT_LT(0.0f, epoch.cost);
+    EXPECT_LT(0.0, epoch.seconds);
+    EXPECT_LE(epoch.preparation_seconds + epoch.forward_seconds + epoch.backward_seconds +
+                  epoch.update_seconds,
+              epoch.seconds);
+    EXPECT_LT(0.0, epoch.forward_seconds);
+    EXPECT_LT(0.0, epoch.backward_seconds);
+    EXPECT_LT(0U, epoch.allocation_count);
+    // at least the weights and the gradients of the first layer are allocated
+    EXPECT_LE(2U * 25U * 401U * sizeof(float), epoch.peak_matrix_bytes);
+  }
+  EXPECT_EQ(final_cost, telemetry.epochs.back().cost);
+}
+
+TEST_P(trainer_tests, train_with_loss_scaler_matches_unscaled_training) {
+  std::vector<vi::la::matrix> initial_weights;
+  for (std::shared_ptr<vi::nn::layer> l : *_network) {
+    initial_weights.push_back(l->weights().clone());
+  }
+  float unscaled_cost = _trainer->train(*_network, *_features, *_targets, _cost_function);
+
+  size_t layer_index = 0U;
+  for (std::shared_ptr<vi::nn::layer> l : *_network) {
+    l->weights(initial_weights[layer_index++].clone());
+  }
+  std::shared_ptr<vi::nn::loss_scaler> scaler = std::make_shared<vi::nn::loss_scaler>(1024.0f);
+  std::shared_ptr<recorded_epochs> recorder = std::make_shared<recorded_epochs>();
+  _trainer->set_loss_scaler(scaler);
+  _trainer->set_telemetry(recorder);
+  float scaled_cost = _trainer->train(*_network, *_features, *_targets, _cost_function);
+  _trainer->set_loss_scaler(nullptr);
+  _trainer->set_telemetry(nullptr);
+
+  // the scale is a power of two and the gradients stay finite, so every step is applied
+  // and the training converges as it does without scaling
+  EXPECT_EQ(1024.0f, scaler->scale());
+  EXPECT_NEAR(unscaled_cost, scaled_cost, 1.0e-4f * unscaled_cost);
+  ASSERT_EQ(_max_epochs, recorder->epochs.size());
+  EXPECT_GT(recorder->epochs.front().cost, recorder->epochs.back().cost);
+}
+
+TEST_P(trainer_tests, train_with_loss_scaler_skips_overflowing_steps) {
+  std::vector<vi::la::matrix> initial_weights;
+  for (std::shared_ptr<vi::nn::layer> l : *_network) {
+    initial_weights.push_back(l->weights().clone());
+  }
+
+  // scaled gradients overflow for every step, the scale backs off slowly
+  std::shared_ptr<vi::nn::loss_scaler> scaler =
+      std::make_shared<vi::nn::loss_scaler>(3.0e38f, 2.0f, 0.99f, 1U);
+  _trainer->set_loss_scaler(scaler);
+  _trainer->train(*_network, *_features, *_targets, _cost_function);
+  _trainer->set_loss_scaler(nullptr);
+
+  EXPECT_GT(3.0e38f, scaler->scale());
+  size_t layer_index = 0U;
+  for (std::shared_ptr<vi::nn::layer> l : *_network) {
+    EXPECT_MATRIX_EQ(initial_weights[layer_index++], l->weights());
+  }
+}
+
 #include "vi/nn/batch_gradient_descent.h"
 #include "vi/nn/minibatch_gradient_descent.h"
 
@@ -0,0 +1,117 @@
+#include "test.h"
+#include "vi/la/autotuner.h"
+#include "vi/la/context.h"
+#include "vi/la/cpu/cpu_context.h"
+#include "vi/la/matrix.h"
+#include "vi/la/tuning_profile.h"
+
+#include <boost/filesystem.hpp>
+#include <memory>
+
+namespace fs = boost::filesystem;
+using vi::la::matrix;
+using vi::la::tuning_profile;
+
+class tuning_profile_tests : public ::testing::TestWithParam<vi::la::context*> {
+protected:
+  /// Restore the profile attached to the context, other tests share the context
+  void TearDown() { GetParam()->set_tuning_profile(_loaded); }
+  std::shared_ptr<const tuning_profile> _loaded = GetParam()->attached_tuning_profile();
+};
+INSTANTIATE_TEST_CASE_P(context, tuning_profile_tests, ::testing::ValuesIn(test::all_contexts()));
+
+TEST(tuning_profile_tests, bucket) {
+  EXPECT_EQ(0U, tuning_profile::bucket(1U));
+  EXPECT_EQ(6U, tuning_profile::bucket(64U));
+  EXPECT_EQ(7U, tuning_profile::bucket(65U));
+}
+
+TEST(tuning_profile_tests, finds_nearest_bucket) {
+  const tuning_profile::parameters defaults = {0U, 1U, 2U, 3U};
+  tuning_profile profile;
+  profile.set("host", "multiply", 6U, {32U, 100U, 0U, 0U});
+  profile.set("host", "multiply", 10U, {64U, 200U, 0U, 0U});
+
+  EXPECT_EQ(32U, profile.find("host", "multiply", 4U, defaults).block_size);
+  EXPECT_EQ(32U, profile.find("host", "multiply", 7U, defaults).block_size);
+  EXPECT_EQ(64U, profile.find("host", "multiply", 9U, defaults).block_size);
+  EXPECT_EQ(200U, profile.find("host", "multiply", 20U, defaults).thread_grain);
+  EXPECT_EQ(3U, profile.find("host", "sparse_multiply", 6U, defaults).workgroup_columns);
+  EXPECT_EQ(2U, profile.find("device", "multiply", 6U, defaults).workgroup_rows);
+}
+
+TEST(tuning_profile_tests, store_and_load) {
+  const fs::path path = fs::temp_directory_path() / fs::unique_path("tuning_%%%%%%%%") / "profile";
+  tuning_profile profile;
+  profile.set("host", "multiply", 8U, {64U, 1U << 16, 0U, 0U});
+  profile.set("Some Device", "elementwise", 10U, {0U, 0U, 8U, 4U});
+  profile.store(path.string());
+
+  std::shared_ptr<tuning_profile> loaded = tuning_profile::load(path.string());
+  fs::remove_all(path.parent_path());
+  const tuning_profile::parameters defaults = {0U, 0U, 0U, 0U};
+  EXPECT_EQ(2U, loaded->size());
+  EXPECT_EQ(64U, loaded->find("host", "multiply", 8U, defaults).block_size);
+  EXPECT_EQ(1U << 16, loaded->find("host", "multiply", 8U, defaults).thread_grain);
+  EXPECT_EQ(8U, loaded->find("Some Device", "elementwise", 10U, defaults).workgroup_rows);
+  EXPECT_EQ(4U, loaded->find("Some Device", "elementwise", 10U, defaults).workgroup_columns);
+}
+
+TEST(tuning_profile_tests, missing_profile_is_empty) {
+  EXPECT_EQ(0U, tuning_profile::load("/nonexistent/tuning_profile")->size());
+  EXPECT_EQ(0U, tuning_profile::load("")->size());
+}
+
+TEST(tuning_profile_tests, contexts_start_untuned) {
+  // results must not depend on a profile stored on the machine
+  vi::la::cpu_context context;
+  EXPECT_FALSE(context.attached_tuning_profile());
+}
+
+TEST_P(tuning_profile_tests, tuned_operations_match) {
+  vi::la::context& context = *GetParam();
+  std::shared_ptr<tuning_profile> tuned = std::make_shared<tuning_profile>();
+  for (const std::string& device : context.tuned_devices()) {
+    tuned->set(device, "multiply", tuning_profile::bucket(40U), {16U, 64U, 4U, 4U});
+    tuned->set(device, "elementwise", tuning_profile::bucket(40U), {0U, 0U, 4U, 4U});
+  }
+
+  // small integers keep every sum exact whatever the order
+  matrix operand_1(context, 40U, 24U);
+  matrix operand_2(context, 24U, 36U);
+  for (size_t row = 0U; row < operand_1.row_count(); ++row) {
+    for (size_t column = 0U; column < operand_1.column_count(); ++column) {
+      operand_1[row][column] = static_cast<float>((row + column) % 5U);
+    }
+  }
+  for (size_t row = 0U; row < operand_2.row_count(); ++row) {
+    for (size_t column = 0U; column < operand_2.column_count(); ++column) {
+      operand_2[row][column] = static_cast<float>((row * column) % 3U);
+    }
+  }
+  const matrix expected_product = operand_1 * operand_2;
+  const matrix expected_sum = expected_product + expected_product;
+
+  context.set_tuning_profile(tuned);
+  const matrix product = operand_1 * operand_2;
+  const matrix sum = product + product;
+  for (size_t row = 0U; row < product.row_count(); ++row) {
+    for (size_t column = 0U; column < product.column_count(); ++column) {
+      EXPECT_EQ(expected_product[row][column], product[row][column]);
+      EXPECT_EQ(expected_sum[row][column], sum[row][column]);
+    }
+  }
+}
+
+TEST(tuning_profile_tests, autotuner_tunes_host_operations) {
+  vi::la::cpu_context context;
+  tuning_profile profile;
+  vi::la::autotuner tuner({16U, 32U});
+  tuner.tune(context, profile);
+
+  EXPECT_EQ(4U, profile.size());
+  EXPECT_EQ(context.attached_tuning_profile()->size(), profile.size());
+  // no candidate has a block size of one
+  const tuning_profile::parameters defaults = {1U, 0U, 0U, 0U};
+  EXPECT_NE(1U, profile.find("host", "multiply", tuning_profile::bucket(32U), defaults).block_size);
+}
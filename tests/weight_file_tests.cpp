@@ -0,0 +1,126 @@
+#include "test.h"
+#include "vi/io/checksum.h"
+#include "vi/io/weight_file.h"
+
+#include <boost/filesystem.hpp>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+std::string temporary_path(const std::string& name) {
+  fs::path path(fs::temp_directory_path());
+  path /= name;
+  return path.string();
+}
+
+void overwrite_byte(const std::string& path, size_t offset) {
+  std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+  file.seekg(offset);
+  const char original = static_cast<char>(file.get());
+  file.seekp(offset);
+  file.put(static_cast<char>(original ^ 0x5a));
+}
+}
+
+class weight_file_tests : public ::testing::TestWithParam<vi::la::context*> {};
+INSTANTIATE_TEST_CASE_P(context, weight_file_tests, ::testing::ValuesIn(test::all_contexts()));
+
+TEST_P(weight_file_tests, round_trip) {
+  const std::string path = temporary_path("weight_file_round_trip.weights");
+  vi::la::matrix weights(*GetParam(), {{0.5f, -1.25f, 3.0f}, {1e-30f, 7.0f, -0.0f}});
+  vi::io::weight_file(path).store(weights);
+
+  vi::la::matrix loaded = vi::io::weight_file(path).load(*GetParam());
+  EXPECT_MATRIX_EQ(weights, loaded);
+  std::remove(path.c_str());
+}
+
+TEST_P(weight_file_tests, values_are_aligned) {
+  const std::string path = temporary_path("weight_file_alignment.weights");
+  vi::io::weight_file(path).store(vi::la::matrix(*GetParam(), 3U, 5U, 2.0f));
+  EXPECT_EQ(vi::io::weight_file::value_alignment + 3U * 5U * sizeof(float), fs::file_size(path));
+
+  vi::la::matrix loaded = vi::io::weight_file(path).load(*GetParam());
+  EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(loaded[0]) % vi::io::weight_file::value_alignment);
+  std::remove(path.c_str());
+}
+
+TEST_P(weight_file_tests, modifying_loaded_matrix_leaves_file_intact) {
+  const std::string path = temporary_path("weight_file_copy_on_write.weights");
+  vi::la::matrix weights(*GetParam(), {{1.0f, 2.0f}, {3.0f, 4.0f}});
+  vi::io::weight_file(path).store(weights);
+
+  vi::la::matrix modified = vi::io::weight_file(path).load(*GetParam());
+  modified[1][1] = 10.0f;
+
+  vi::la::matrix reloaded = vi::io::weight_file(path).load(*GetParam());
+  EXPECT_MATRIX_EQ(weights, reloaded);
+  std::remove(path.c_str());
+}
+
+TEST_P(weight_file_tests, loaded_matrix_outlives_file) {
+  const std::string path = temporary_path("weight_file_removed.weights");
+  vi::la::matrix weights(*GetParam(), {{1.0f, 2.0f, 3.0f}});
+  vi::io::weight_file(path).store(weights);
+
+  vi::la::matrix loaded = vi::io::weight_file(path).load(*GetParam());
+  std::remove(path.c_str());
+  EXPECT_MATRIX_EQ(weights, loaded);
+}
+
+TEST_P(weight_file_tests, corrupted_values_throw_when_verified) {
+  const std::string path = temporary_path("weight_file_corrupted.weights");
+  vi::io::weight_file(path).store(vi::la::matrix(*GetParam(), 4U, 4U, 1.0f));
+  overwrite_byte(path, vi::io::weight_file::value_alignment + 17U);
+
+  EXPECT_THROW(
+      vi::io::weight_file(path).load(*GetParam(), vi::io::weight_file::verification::checksum),
+      vi::io::weight_file::exception);
+  std::remove(path.c_str());
+}
+
+TEST_P(weight_file_tests, values_are_not_read_without_verification) {
+  const std::string path = temporary_path("weight_file_unverified.weights");
+  vi::io::weight_file(path).store(vi::la::matrix(*GetParam(), 4U, 4U, 1.0f));
+  overwrite_byte(path, vi::io::weight_file::value_alignment + 17U);
+
+  // only the header is checked, the corrupted value is loaded as stored
+  vi::la::matrix loaded = vi::io::weight_file(path).load(*GetParam());
+  EXPECT_EQ(1.0f, loaded[0][0]);
+  EXPECT_NE(1.0f, loaded[1][0]);
+  std::remove(path.c_str());
+}
+
+TEST_P(weight_file_tests, truncated_file_throws) {
+  const std::string path = temporary_path("weight_file_truncated.weights");
+  vi::io::weight_file(path).store(vi::la::matrix(*GetParam(), 4U, 4U, 1.0f));
+  fs::resize_file(path, fs::file_size(path) - 1U);
+
+  EXPECT_THROW(vi::io::weight_file(path).load(*GetParam()), vi::io::weight_file::exception);
+  std::remove(path.c_str());
+}
+
+TEST_P(weight_file_tests, other_file_throws) {
+  const std::string path = temporary_path("weight_file_other.weights");
+  std::ofstream(path) << "0.5,1.0\n1.5,2.0\n";
+
+  EXPECT_THROW(vi::io::weight_file(path).load(*GetParam()), vi::io::weight_file::exception);
+  std::remove(path.c_str());
+}
+
+TEST_P(weight_file_tests, missing_file_throws) {
+  const std::string path = temporary_path("weight_file_missing.weights");
+  EXPECT_THROW(vi::io::weight_file(path).load(*GetParam()), vi::io::weight_file::exception);
+}
+
+TEST(checksum, matches_reference_values) {
+  EXPECT_EQ(0xef46db3751d8e999ULL, vi::io::checksum("", 0U));
+  EXPECT_EQ(0x44bc2cf5ad770999ULL, vi::io::checksum("abc", 3U));
+  const char* text = "Nobody inspects the spammish repetition";
+  EXPECT_EQ(0xfbcea83c8a378bf1ULL, vi::io::checksum(text, std::strlen(text)));
+}
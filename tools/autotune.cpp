@@ -0,0 +1,43 @@
+#include "vi/la.h"
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+
+/// Tune the host and every supported OpenCL device and store the parameters in
+/// the profile at tuning_profile::default_path(), or at the path given as argument.
+/// Contexts do not load it on their own, attach it with context::set_tuning_profile.
+///
+///   vinn_autotune [profile_path]
+int main(int argc, char** argv) {
+  if (argc > 2) {
+    std::cerr << "usage: " << argv[0] << " [profile_path]" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const std::string path = argc == 2 ? argv[1] : vi::la::tuning_profile::default_path();
+  if (path.empty()) {
+    std::cerr << "no profile path given and neither VINN_TUNING_PROFILE nor HOME is set"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  try {
+    // entries of devices that are not tuned now are kept
+    std::shared_ptr<vi::la::tuning_profile> profile = vi::la::tuning_profile::load(path);
+    vi::la::autotuner tuner({64U, 256U, 512U}, &std::cout);
+
+    vi::la::cpu_context host;
+    tuner.tune(host, *profile);
+    for (cl_device_id device : vi::la::opencl_context::supported_devices()) {
+      vi::la::opencl_context context({device});
+      tuner.tune(context, *profile);
+    }
+
+    profile->store(path);
+    std::cout << "stored " << profile->size() << " entries in " << path << std::endl;
+  } catch (const std::exception& error) {
+    std::cerr << error.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
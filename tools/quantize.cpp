@@ -0,0 +1,118 @@
+#include "vi/io.h"
+#include "vi/la.h"
+#include "vi/nn.h"
+
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+const size_t batch_size = 256U;
+
+/// Whether a prediction picks the same class as its target: the largest of
+/// several outputs, or the side of 0.5 of a single output
+bool correct(const float* prediction, const float* target, size_t count) {
+  if (count == 1U) {
+    return (prediction[0] >= 0.5f) == (target[0] >= 0.5f);
+  }
+  size_t predicted = 0U;
+  size_t expected = 0U;
+  for (size_t i = 1U; i < count; ++i) {
+    predicted = prediction[i] > prediction[predicted] ? i : predicted;
+    expected = target[i] > target[expected] ? i : expected;
+  }
+  return predicted == expected;
+}
+
+/// Classification accuracy of both networks on the examples of a held-out file
+void report_accuracy(const std::string& path, size_t target_count, vi::la::context& context,
+                     const vi::nn::network& network, const vi::nn::quantized_network& quantized) {
+  std::ifstream stream(path);
+  if (!stream) {
+    throw std::runtime_error("Cannot read '" + path + "'.");
+  }
+  vi::io::csv_dataset dataset(stream, target_count);
+  std::vector<float> features(batch_size * dataset.feature_count());
+  std::vector<float> targets(batch_size * target_count);
+
+  size_t example_count = 0U;
+  size_t network_correct = 0U;
+  size_t quantized_correct = 0U;
+  while (size_t rows = dataset.read(features.data(), targets.data(), batch_size)) {
+    const vi::la::matrix batch(context, features.data(), rows, dataset.feature_count());
+    const vi::la::matrix predicted = network.forward(batch);
+    const vi::la::matrix quantized_predicted = quantized.forward(batch);
+    for (size_t row = 0U; row < rows; ++row) {
+      const float* target = targets.data() + row * target_count;
+      network_correct += correct(predicted.values() + row * target_count, target, target_count);
+      quantized_correct +=
+          correct(quantized_predicted.values() + row * target_count, target, target_count);
+    }
+    example_count += rows;
+  }
+  if (example_count == 0U) {
+    throw std::runtime_error("'" + path + "' has no examples.");
+  }
+  std::cout << "accuracy on " << example_count << " examples: fp32 "
+            << double(network_correct) / example_count << ", int8 "
+            << double(quantized_correct) / example_count << std::endl;
+}
+}
+
+/// Quantize a stored model to 8-bit integers with the activation ranges of the
+/// examples in a calibration CSV file, whose rows hold the features followed by
+/// target_count targets, and store it as a vi::io::quantized_model_file. When a
+/// held-out CSV file is given, the classification accuracy of the model before
+/// and after quantization is reported.
+///
+///   vinn_quantize model_path calibration.csv target_count quantized_model [test.csv]
+int main(int argc, char** argv) {
+  if (argc != 5 && argc != 6) {
+    std::cerr << "usage: " << argv[0]
+              << " model_path calibration.csv target_count quantized_model [test.csv]"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+  const size_t target_count = std::strtoul(argv[3], nullptr, 10);
+  if (target_count == 0U) {
+    std::cerr << "target_count must be a positive number" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  try {
+    vi::la::cpu_context context;
+    vi::nn::network network;
+    vi::io::model(argv[1]).load(network, context);
+
+    std::ifstream calibration_stream(argv[2]);
+    if (!calibration_stream) {
+      throw std::runtime_error(std::string("Cannot read '") + argv[2] + "'.");
+    }
+    vi::io::csv_dataset calibration(calibration_stream, target_count);
+    std::vector<float> features(batch_size * calibration.feature_count());
+    std::vector<float> targets(batch_size * target_count);
+    vi::nn::quantizer quantizer(network);
+    size_t example_count = 0U;
+    while (size_t rows = calibration.read(features.data(), targets.data(), batch_size)) {
+      quantizer.calibrate(
+          vi::la::matrix(context, features.data(), rows, calibration.feature_count()));
+      example_count += rows;
+    }
+
+    const vi::nn::quantized_network quantized = quantizer.quantize();
+    vi::io::quantized_model_file(argv[4]).store(quantized);
+    std::cout << "calibrated with " << example_count << " examples, stored " << quantized.size()
+              << " layers in " << argv[4] << std::endl;
+
+    if (argc == 6) {
+      report_accuracy(argv[5], target_count, context, network, quantized);
+    }
+  } catch (const std::exception& error) {
+    std::cerr << error.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}